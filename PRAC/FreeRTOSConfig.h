@@ -49,9 +49,12 @@
 #define configMAX_TASK_NAME_LEN					( 12 )
 #define configTOTAL_HEAP_SIZE					( ( size_t ) ( 48 * 1024 ) )
 
+/* pvPortMalloc() and vPortFree() of heap_tlsf.c instead of heap_1.c. */
+#define configUSE_HEAP_TLSF						1
+
 /* Constants that build features in or out. */
 #define configUSE_MUTEXES						1
-#define configUSE_TICKLESS_IDLE					0
+#define configUSE_TICKLESS_IDLE					2
 #define configUSE_APPLICATION_TASK_TAG			0
 #define configUSE_NEWLIB_REENTRANT 				0
 #define configUSE_CO_ROUTINES 					0
@@ -64,7 +67,7 @@
 #define configUSE_TICK_HOOK						0
 #define configUSE_MALLOC_FAILED_HOOK			0
 
-#define configCHECK_FOR_STACK_OVERFLOW			0
+#define configCHECK_FOR_STACK_OVERFLOW			2
 #define configASSERT( x ) if( ( x ) == 0 ) { taskDISABLE_INTERRUPTS(); for( ;; ); }
 #define configQUEUE_REGISTRY_SIZE				0
 
@@ -80,8 +83,8 @@
 #define INCLUDE_vTaskSuspend					1
 #define INCLUDE_vTaskDelayUntil					1
 #define INCLUDE_vTaskDelay						1
-#define INCLUDE_uxTaskGetStackHighWaterMark		0
-#define INCLUDE_xTaskGetIdleTaskHandle			0
+#define INCLUDE_uxTaskGetStackHighWaterMark		1
+#define INCLUDE_xTaskGetIdleTaskHandle			1
 #define INCLUDE_eTaskGetState					1
 #define INCLUDE_xTaskResumeFromISR				0
 #define INCLUDE_xTaskGetCurrentTaskHandle		1
@@ -129,14 +132,31 @@ CLI commands. */
 /* TI driver library includes. */
 #include <driverlib.h>
 
+/* The idle task stops the tick and sleeps in LPM0 on a TA1 compare, see
+tickless.c. */
 void vPreSleepProcessing( uint32_t ulExpectedIdleTime );
 #define configPRE_SLEEP_PROCESSING( x ) vPreSleepProcessing( x )
 
-/* Constants related to the generation of run time stats.  Run time stats
-are gathered in the full demo, not the blinky demo. */
-#define configGENERATE_RUN_TIME_STATS			0
-#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
-#define portGET_RUN_TIME_COUNTER_VALUE()		0
+/* Run time stats count Timer32 0 and the context switches are counted per
+task, see task_stats.c. */
+void task_stats_timer_init( void );
+uint32_t task_stats_counter( void );
+void task_stats_switched_in( uint32_t ulTaskNumber );
+#define configGENERATE_RUN_TIME_STATS			1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()	task_stats_timer_init()
+#define portGET_RUN_TIME_COUNTER_VALUE()		task_stats_counter()
+#define traceTASK_SWITCHED_IN()					do { task_stats_switched_in( pxCurrentTCB->uxTCBNumber ); kernel_trace_switched_in( pxCurrentTCB->uxTCBNumber ); } while( 0 )
+
+/* The kernel events are recorded in a RAM ring buffer with their cycle count,
+see kernel_trace.h for the other trace macros. */
+#define configUSE_KERNEL_TRACE					1
+#include "kernel_trace.h"
+
+/* Task stacks are painted at creation and their bounds kept for the
+high-water report of stack_profile.c. */
+void stack_profile_task_created( uint32_t ulTaskNumber, void *pvStack, void *pvEndOfStack );
+#define configRECORD_STACK_HIGH_ADDRESS			1
+#define traceTASK_CREATE( pxNewTCB )			stack_profile_task_created( ( pxNewTCB )->uxTCBNumber, ( pxNewTCB )->pxStack, ( pxNewTCB )->pxEndOfStack )
 
 /* The blinky demo can use a slow tick rate to save power. */
 #define configTICK_RATE_HZ						( ( TickType_t ) 100 )
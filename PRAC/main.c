@@ -36,7 +36,7 @@
 
 /* Standard includes */
 #include <stdlib.h>
-#include <stdio.h>
+#include <string.h>
 
 
 /* Free-RTOS includes */
@@ -50,6 +50,13 @@
 /* MSP432 drivers includes */
 #include "msp432_launchpad_board.h"
 #include "uart_driver.h"
+#include "telemetry.h"
+#include "task_stats.h"
+#include "kernel_trace.h"
+#include "stack_profile.h"
+#include "tickless.h"
+#include "event_dispatch.h"
+#include "format.h"
 #include "edu_boosterpack_joystick.h"
 #include "edu_boosterpack_buttons.h"
 
@@ -64,24 +71,40 @@
 /*----------------------------------------------------------------------------*/
 
 #define TASK_PRIORITY               ( tskIDLE_PRIORITY + 2 )
-#define HEARTBEAT_TASK_PRIORITY     ( tskIDLE_PRIORITY + 1 )
 
 #define TASK_STACK_SIZE             ( 1024 )
-#define HEARTBEAT_STACK_SIZE        ( 128 )
 
 #define HEART_BEAT_ON_MS            ( 10 )
 #define HEART_BEAT_OFF_MS           ( 990 )
-#define DELAY_MS                    ( 100 )
-#define DELAY_DEBOUNCING            ( 400 )
 
-#define QUEUE_SIZE                  ( 10 )
+#define JOYSTICK_LEFT_THRESHOLD     ( 3000 )
+#define JOYSTICK_RIGHT_THRESHOLD    ( 13000 )
+#define JOYSTICK_HYSTERESIS         ( 1000 )
+#define JOYSTICK_SAMPLE_RATE_HZ     ( 50 )
+
 #define TX_UART_MESSAGE_LENGTH      ( 80 )
 
+#define TELEMETRY_GAME_RESULT       ( 0x01 )
+#define TELEMETRY_TASK_STATS        ( 0x02 )
+#define TELEMETRY_KERNEL_TRACE      ( 0x03 )
+#define TELEMETRY_STACK_PROFILE     ( 0x04 )
+#define TELEMETRY_POWER             ( 0x05 )
+
+// Lines received on the UART that poll the task stats, the stack usage and the
+// tickless idle counters, and dump the kernel trace
+#define TASK_STATS_COMMAND          "stats"
+#define KERNEL_TRACE_COMMAND        "trace"
+#define STACK_PROFILE_COMMAND       "stacks"
+#define POWER_COMMAND               "power"
+#define UART_COMMAND_LENGTH         ( 16 )
+
+// A full trace frame takes 43 ms at 57600 bauds, the next waits for it
+#define KERNEL_TRACE_FRAME_MS       ( 50 )
+
 
 /*----------------------------------------------------------------------------*/
 
 // Tasks
-static void HeartBeatTask(void *pvParameters);
 static void ADCReadingTask(void *pvParameters);
 static void UARTPrintingTask(void *pvParameters);
 static void ProcessingTask(void *pvParameters);
@@ -89,40 +112,59 @@ static void LCDTask(void *pvParameters);
 
 // callbacks & functions
 void callback(adc_result input);
+void joystickCallback(uint8_t event);
 void buttonCallback(void);
+void uartCallback(circ_buffer_t* buffer);
+void sendKernelTrace(void);
 const char* getMove(int play);
 void restartGame();
 void InitializeLCD();
 enum message_code getMessageWinner(void);
 
 //Task sync tools and variables
-SemaphoreHandle_t xButtonPressed;   //semforo para activar la tarea ProcessingTask cuando se pulsa S1
-QueueHandle_t xQueueCommands;       //cola para que tanto la tarea ADCReadingTask como ProcessingTask envien comandos de tipo message_code a la tarea UARTPrintingTask
-QueueHandle_t xQueueADC;
 SemaphoreHandle_t xPlayMutex;
 static Graphics_Context g_sContext;
 
+//Result of a game, the first byte of its telemetry
 typedef enum message_code{
-    play_update_message = 0,
     i_win_message = 1,
     machine_wins_message = 2,
     tie_message = 3,
 } message_code;
 
+//Events the tasks wait for instead of polling, each one consumed by a single task.
+//Their input-to-display latency is measured in the host simulation with host/sim/game.txt
+typedef enum game_event{
+    joystick_left_event = 0,
+    joystick_right_event = 1,
+    button_event = 2,
+    play_update_event = 3,
+    result_event = 4,
+    new_game_event = 5,
+    display_event = 6,
+    task_stats_event = 7,
+    kernel_trace_event = 8,
+    stack_profile_event = 9,
+    power_event = 10,
+} game_event;
+
+//States that last until cleared
+typedef enum game_state{
+    game_over_state = 0,
+} game_state;
+
 typedef enum{
     rock = 0,
     paper = 1,
     scissors = 2,
 }play;
 
-TickType_t xTicks;
 play my_play                = paper;    //variables globales que contienen la jugada del usuario (my_play) y la jugada de la mquina (machine_play)
-play machine_play           = NULL;
+play machine_play           = rock;
+message_code gameResult     = tie_message;
 
 //Helper variables
 bool firstInitialization    = true;
-bool ignoreNextReading      = false;
-bool pendingNewGame         = false;
 bool readFloatingVal        = false;
 
 //Game stadistics
@@ -130,6 +172,23 @@ int gameWon                 = 0;
 int gameLost                = 0;
 int gameTied                = 0;
 
+//Heart beat LED on and off times
+static const uint16_t heartBeatPattern[] = { HEART_BEAT_ON_MS, HEART_BEAT_OFF_MS };
+
+//Per task CPU usage sent on request
+static task_stats_t taskStats;
+static uint8_t taskStatsPayload[TASK_STATS_PAYLOAD_MAX_SIZE];
+
+//Stack high water marks and suggested sizes sent on request
+static stack_profile_t stackProfile;
+static uint8_t stackProfilePayload[STACK_PROFILE_PAYLOAD_MAX_SIZE];
+
+//Sleeps and wake-ups of the idle task sent on request
+static uint8_t powerPayload[TICKLESS_PAYLOAD_SIZE];
+
+//Kernel trace dumped on request
+static uint8_t kernelTracePayload[TELEMETRY_PAYLOAD_MAX_SIZE];
+
 //Strings for each LCD line
 char LCDL1[TX_UART_MESSAGE_LENGTH] = "";
 char LCDL2[TX_UART_MESSAGE_LENGTH] = "";
@@ -140,15 +199,6 @@ char LCDL6[TX_UART_MESSAGE_LENGTH] = "";
 char LCDL7[TX_UART_MESSAGE_LENGTH] = "";
 /*----------------------------------------------------------------------------*/
 
-static void HeartBeatTask(void *pvParameters){
-    for(;;){
-        led_toggle(MSP432_LAUNCHPAD_LED_RED);
-        vTaskDelay( pdMS_TO_TICKS(HEART_BEAT_ON_MS) );
-        led_toggle(MSP432_LAUNCHPAD_LED_RED);
-        vTaskDelay( pdMS_TO_TICKS(HEART_BEAT_OFF_MS) );
-    }
-}
-
 void InitializeLCD() {
     Crystalfontz128x128_Init();
     Crystalfontz128x128_SetOrientation(LCD_ORIENTATION_UP);
@@ -160,7 +210,15 @@ void InitializeLCD() {
 }
 
 static void LCDTask(void *pvParameters){
+    event_dispatch_set_t events = 0;
+
+    //Draws only after the strings change
+    event_dispatch_subscribe(EVENT_DISPATCH_BIT(display_event) | EVENT_DISPATCH_BIT(new_game_event));
     for(;;){
+        if (events & EVENT_DISPATCH_BIT(new_game_event)) {
+            Graphics_clearDisplay(&g_sContext);
+        }
+
         Graphics_drawString(&g_sContext,
                             LCDL1,
                             AUTO_STRING_LENGTH,
@@ -208,78 +266,113 @@ static void LCDTask(void *pvParameters){
                             10,
                             110,
                             OPAQUE_TEXT);
-        vTaskDelay( pdMS_TO_TICKS(DELAY_MS) );
+
+        events = event_dispatch_wait(portMAX_DELAY);
     }
 }
 
 static void ADCReadingTask(void *pvParameters) {
-    float x;
+    event_dispatch_set_t events;
+
+    //The ADC window comparator only wakes us up when the stick leaves the dead zone
+    event_dispatch_subscribe(EVENT_DISPATCH_BIT(joystick_left_event) | EVENT_DISPATCH_BIT(joystick_right_event));
+    edu_boosterpack_joystick_threshold_start(JOYSTICK_LEFT_THRESHOLD, JOYSTICK_RIGHT_THRESHOLD,
+                                             JOYSTICK_HYSTERESIS, JOYSTICK_SAMPLE_RATE_HZ, joystickCallback);
     for(;;){
-        if (!ignoreNextReading) {
-            edu_boosterpack_joystick_read();
-            if( xQueueReceive( xQueueADC, &x, portMAX_DELAY ) == pdPASS){
+        events = event_dispatch_wait(portMAX_DELAY);
+        if (events != 0) {
+            if (events & (EVENT_DISPATCH_BIT(joystick_right_event) | EVENT_DISPATCH_BIT(joystick_left_event))) {
 
                xSemaphoreTake(xPlayMutex, portMAX_DELAY);
                //Right choice
-               if (x > 13000) {
+               if (events & EVENT_DISPATCH_BIT(joystick_right_event)) {
                    int newPlay = (((int)my_play+1) > 2) ? 0 : (int)my_play+1;
                    my_play = newPlay;
-                   ignoreNextReading = true;
-                   message_code message = play_update_message;
-                   xQueueSendFromISR(xQueueCommands, &message, NULL);
                }
 
                //Left choice
-               if (x < 3000) {
+               if (events & EVENT_DISPATCH_BIT(joystick_left_event)) {
                    int newPlay = (((int)my_play-1) < 0) ? 2 : (int)my_play-1;
                    my_play = newPlay;
-                   ignoreNextReading = true;
-                   message_code message = play_update_message;
-                   xQueueSendFromISR(xQueueCommands, &message, NULL);
                }
                xSemaphoreGive(xPlayMutex);
+
+               event_dispatch_signal(play_update_event);
             }
-        } else {
-            ignoreNextReading = false;
         }
-
-        vTaskDelay( pdMS_TO_TICKS(DELAY_MS) );
     }
 }
 
 static void UARTPrintingTask(void *pvParameters) {
     char toPrint[TX_UART_MESSAGE_LENGTH];
-    message_code message;
+    event_dispatch_set_t events;
+
+    event_dispatch_subscribe(EVENT_DISPATCH_BIT(play_update_event) | EVENT_DISPATCH_BIT(result_event) |
+                             EVENT_DISPATCH_BIT(task_stats_event) | EVENT_DISPATCH_BIT(kernel_trace_event) |
+                             EVENT_DISPATCH_BIT(stack_profile_event) | EVENT_DISPATCH_BIT(power_event));
     for(;;){
-        if( xQueueReceive( xQueueCommands, &message, portMAX_DELAY ) == pdPASS){
-            if (message == play_update_message) {
-                strncpy(LCDL1, "Chose your move: ", TX_UART_MESSAGE_LENGTH);
-                sprintf(toPrint,  "%s", getMove(my_play));
-                strncpy(LCDL2, toPrint, TX_UART_MESSAGE_LENGTH);
-            } else {
-                strncpy(LCDL3, "The AI chosed: ", TX_UART_MESSAGE_LENGTH);
-                sprintf(toPrint,  "%s", getMove(machine_play));
-                strncpy(LCDL4, toPrint, TX_UART_MESSAGE_LENGTH);
-
-                if (message == i_win_message) {
-                    strncpy(LCDL5, "You win!", TX_UART_MESSAGE_LENGTH);
-                    gameWon++;
-                } else if (message == machine_wins_message) {
-                    strncpy(LCDL5, "You lose!", TX_UART_MESSAGE_LENGTH);
-                    gameLost++;
-                }else if (message == tie_message) {
-                    strncpy(LCDL5, "Tie!", TX_UART_MESSAGE_LENGTH);
-                    gameTied++;
-                }
-
-                sprintf(toPrint,  "Win %d Tie %d Los %d!", gameWon, gameTied, gameLost);
-                strncpy(LCDL6, toPrint, TX_UART_MESSAGE_LENGTH);
-                strncpy(LCDL7, "S1 to play again!", TX_UART_MESSAGE_LENGTH);
-                pendingNewGame = true;
+        events = event_dispatch_wait(portMAX_DELAY);
+
+        //The display is updated before any telemetry is sent
+        if (events & EVENT_DISPATCH_BIT(play_update_event)) {
+            strncpy(LCDL1, "Chose your move: ", TX_UART_MESSAGE_LENGTH);
+            format_snprintf(toPrint, sizeof(toPrint), "%s", getMove(my_play));
+            strncpy(LCDL2, toPrint, TX_UART_MESSAGE_LENGTH);
+            event_dispatch_signal(display_event);
+        }
+
+        if (events & EVENT_DISPATCH_BIT(result_event)) {
+            message_code message = gameResult;
+
+            strncpy(LCDL3, "The AI chosed: ", TX_UART_MESSAGE_LENGTH);
+            format_snprintf(toPrint, sizeof(toPrint), "%s", getMove(machine_play));
+            strncpy(LCDL4, toPrint, TX_UART_MESSAGE_LENGTH);
+
+            if (message == i_win_message) {
+                strncpy(LCDL5, "You win!", TX_UART_MESSAGE_LENGTH);
+                gameWon++;
+            } else if (message == machine_wins_message) {
+                strncpy(LCDL5, "You lose!", TX_UART_MESSAGE_LENGTH);
+                gameLost++;
+            }else if (message == tie_message) {
+                strncpy(LCDL5, "Tie!", TX_UART_MESSAGE_LENGTH);
+                gameTied++;
+            }
+
+            format_snprintf(toPrint, sizeof(toPrint), "Win %d Tie %d Los %d!", gameWon, gameTied, gameLost);
+            strncpy(LCDL6, toPrint, TX_UART_MESSAGE_LENGTH);
+            strncpy(LCDL7, "S1 to play again!", TX_UART_MESSAGE_LENGTH);
+            event_dispatch_signal(display_event);
+
+            uint8_t result[] = {message, my_play, machine_play, gameWon, gameTied, gameLost};
+            telemetry_send(TELEMETRY_GAME_RESULT, result, sizeof(result));
+        }
+
+        if (events & EVENT_DISPATCH_BIT(task_stats_event)) {
+            if (task_stats_sample(&taskStats)) {
+                uint16_t length = task_stats_encode(&taskStats, taskStatsPayload, sizeof(taskStatsPayload));
+                telemetry_send(TELEMETRY_TASK_STATS, taskStatsPayload, length);
             }
         }
 
-        vTaskDelay( pdMS_TO_TICKS(DELAY_MS) );
+        if (events & EVENT_DISPATCH_BIT(stack_profile_event)) {
+            if (stack_profile_sample(&stackProfile)) {
+                uint16_t length = stack_profile_encode(&stackProfile, stackProfilePayload, sizeof(stackProfilePayload));
+                telemetry_send(TELEMETRY_STACK_PROFILE, stackProfilePayload, length);
+            }
+        }
+
+        if (events & EVENT_DISPATCH_BIT(power_event)) {
+            tickless_stats_t powerStats;
+            tickless_get_stats(&powerStats);
+            uint16_t length = tickless_encode(&powerStats, xTaskGetTickCount(), powerPayload, sizeof(powerPayload));
+            telemetry_send(TELEMETRY_POWER, powerPayload, length);
+        }
+
+        //The last, it takes several frames
+        if (events & EVENT_DISPATCH_BIT(kernel_trace_event)) {
+            sendKernelTrace();
+        }
     }
 }
 
@@ -293,20 +386,19 @@ void startGame() {
     memset(LCDL5, 0, TX_UART_MESSAGE_LENGTH);
     memset(LCDL6, 0, TX_UART_MESSAGE_LENGTH);
 
-    //Clear display
-    Graphics_clearDisplay(&g_sContext);
-
     //Set new game strings
     strncpy(LCDL1, "Chose your move: ", TX_UART_MESSAGE_LENGTH);
-    sprintf(toPrint,  "%s", getMove(my_play));
+    format_snprintf(toPrint, sizeof(toPrint), "%s", getMove(my_play));
     strncpy(LCDL2, toPrint, TX_UART_MESSAGE_LENGTH);
 
     //Set scores
-    sprintf(toPrint,  "Win %d Tie %d Los %d!", gameWon, gameTied, gameLost);
+    format_snprintf(toPrint, sizeof(toPrint), "Win %d Tie %d Los %d!", gameWon, gameTied, gameLost);
     strncpy(LCDL7, toPrint, TX_UART_MESSAGE_LENGTH);
 
+    //The LCD task clears the display and draws them
+    event_dispatch_signal(new_game_event);
+
     firstInitialization = false;
-    ignoreNextReading = false;
 }
 
 const char* getMove(int play) {
@@ -326,26 +418,29 @@ const char* getMove(int play) {
 }
 
 static void ProcessingTask(void *pvParameters) {
-    message_code winner;
-
+    event_dispatch_subscribe(EVENT_DISPATCH_BIT(button_event));
     for(;;){
-        if (xSemaphoreTake(xButtonPressed, portMAX_DELAY) == pdPASS) {
-            if (xTicks == NULL || (xTaskGetTickCount()-xTicks) > pdMS_TO_TICKS(DELAY_DEBOUNCING)) {
-                xTicks = xTaskGetTickCount();
-                int randVal = rand() % 3;
-                if (randVal == 0) {
-                    machine_play = rock;
-                }else if (randVal == 1) {
-                    machine_play = paper;
-                } else {
-                    machine_play = scissors;
-                }
-
-                winner = getMessageWinner();
-                xQueueSendFromISR(xQueueCommands, &winner, NULL);
+        if (event_dispatch_wait(portMAX_DELAY) & EVENT_DISPATCH_BIT(button_event)) {
+            /* The buttons driver only reports debounced presses */
+            if (event_dispatch_state_get() & EVENT_DISPATCH_BIT(game_over_state)) {
+                event_dispatch_state_clear(EVENT_DISPATCH_BIT(game_over_state));
+                startGame();
+                continue;
             }
+
+            int randVal = rand() % 3;
+            if (randVal == 0) {
+                machine_play = rock;
+            }else if (randVal == 1) {
+                machine_play = paper;
+            } else {
+                machine_play = scissors;
+            }
+
+            gameResult = getMessageWinner();
+            event_dispatch_state_set(EVENT_DISPATCH_BIT(game_over_state));
+            event_dispatch_signal(result_event);
         }
-        vTaskDelay( pdMS_TO_TICKS(DELAY_MS) );
     }
 }
 
@@ -372,25 +467,81 @@ enum message_code getMessageWinner(void) {
 }
 
 void callback(adc_result input) {
-    float x = input[0];
-
     if (readFloatingVal) {
         float floatValue = input[1];
         srand(floatValue);
         readFloatingVal = false;
     }
 
-    xQueueSendFromISR(xQueueADC, &x, NULL);
 }
 
+void joystickCallback(uint8_t event) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    if (event == JOYSTICK_EVENT_LEFT) {
+        event_dispatch_signal_from_isr(joystick_left_event, &xHigherPriorityTaskWoken);
+    } else if (event == JOYSTICK_EVENT_RIGHT) {
+        event_dispatch_signal_from_isr(joystick_right_event, &xHigherPriorityTaskWoken);
+    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+//Called from the debounce interrupt, the new game is started by ProcessingTask
 void buttonCallback(void) {
-    if (pendingNewGame) {
-        startGame();
-        pendingNewGame = false;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    event_dispatch_signal_from_isr(button_event, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+//Called from the UART interrupt with each line received
+void uartCallback(circ_buffer_t* buffer) {
+    char command[UART_COMMAND_LENGTH];
+    uint8_t length = 0;
+
+    while (!circ_buffer_is_empty(buffer)) {
+        char data = circ_buffer_pop(buffer);
+        if ((data != '\r') && (data != '\n') && (length < (UART_COMMAND_LENGTH - 1))) {
+            command[length++] = data;
+        }
+    }
+    command[length] = '\0';
+
+    game_event event;
+    if (strcmp(command, TASK_STATS_COMMAND) == 0) {
+        event = task_stats_event;
+    } else if (strcmp(command, KERNEL_TRACE_COMMAND) == 0) {
+        event = kernel_trace_event;
+    } else if (strcmp(command, STACK_PROFILE_COMMAND) == 0) {
+        event = stack_profile_event;
+    } else if (strcmp(command, POWER_COMMAND) == 0) {
+        event = power_event;
     } else {
-        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-        xSemaphoreGiveFromISR(xButtonPressed,  xHigherPriorityTaskWoken);
+        return;
     }
+
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    event_dispatch_signal_from_isr(event, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+//Sends the info and the records of the kernel trace, which restarts after them
+void sendKernelTrace(void) {
+    uint16_t next = 0;
+    uint16_t length;
+
+    kernel_trace_stop();
+
+    length = kernel_trace_encode_info(kernelTracePayload, sizeof(kernelTracePayload));
+    if (length != 0) {
+        telemetry_send(TELEMETRY_KERNEL_TRACE, kernelTracePayload, length);
+        vTaskDelay( pdMS_TO_TICKS(KERNEL_TRACE_FRAME_MS) );
+
+        while ((length = kernel_trace_encode_records(&next, kernelTracePayload, sizeof(kernelTracePayload))) != 0) {
+            telemetry_send(TELEMETRY_KERNEL_TRACE, kernelTracePayload, length);
+            vTaskDelay( pdMS_TO_TICKS(KERNEL_TRACE_FRAME_MS) );
+        }
+    }
+
+    kernel_trace_start();
 }
 /*----------------------------------------------------------------------------*/
 
@@ -399,17 +550,25 @@ int main(int argc, char** argv)
     int32_t retVal = -1;
     bool useLotId  = false;
 
-    // Initialize semaphores and queue
-    xButtonPressed = xSemaphoreCreateBinary ();
-    xQueueCommands = xQueueCreate( QUEUE_SIZE, sizeof( message_code ) );
-    xQueueADC      = xQueueCreate( QUEUE_SIZE, sizeof( adc_result ) );
+    // Paint the main stack for its high water mark
+    stack_profile_init();
+
+    // Initialize the mutex and the events between the tasks
+    bool eventsReady = event_dispatch_init();
     xPlayMutex     = xSemaphoreCreateMutex();
     /* Initialize the board */
     board_init();
+
+    /* Start recording the kernel events */
+    kernel_trace_init();
+
+    /* The idle task sleeps without the tick on the TA1 time base */
+    tickless_init();
     InitializeLCD();
 
     /* Initialize the UART */  //configurada para trabajar a 57600bauds/s
-    uart_init(NULL);
+    uart_init(uartCallback);
+    telemetry_init();
 
     /* Initialize the button */
     edu_boosterpack_buttons_init();
@@ -429,15 +588,12 @@ int main(int argc, char** argv)
 
     startGame();
 
-    if ( (xButtonPressed != NULL) && (xQueueCommands != NULL) && (xQueueADC != NULL) && (xPlayMutex != NULL)) {
+    if ( eventsReady && (xPlayMutex != NULL)) {
 
-        /* Create tasks */
-        retVal = xTaskCreate(HeartBeatTask, "HeartBeatTask", HEARTBEAT_STACK_SIZE, NULL, HEARTBEAT_TASK_PRIORITY, NULL );
-        if(retVal < 0) {
-            led_on(MSP432_LAUNCHPAD_LED_RED);
-            while(1);
-        }
+        /* The heartbeat LED is driven by a timer, not a task */
+        board_heartbeat_start(heartBeatPattern, 2);
 
+        /* Create tasks */
         retVal = xTaskCreate(ADCReadingTask, "ADCReadingTask", TASK_STACK_SIZE, NULL, TASK_PRIORITY, NULL );
         if(retVal < 0) {
             led_on(MSP432_LAUNCHPAD_LED_RED);
@@ -52,11 +52,23 @@ extern void SystemInit(void);
 extern unsigned long __STACK_END;
 
 /* External declarations for the interrupt handlers used by the application. */
+extern void PORT1_IRQHandler(void);
 extern void PORT2_IRQHandler(void);
+extern void PORT3_IRQHandler(void);
+extern void PORT4_IRQHandler(void);
 extern void EUSCIA0_IRQHandler(void);
-extern void PORT1_Handler(void);
 extern void ADC_Handler(void);
 extern void PORT5_IRQHandler(void);
+extern void PORT6_IRQHandler(void);
+extern void DMA_INT1_IRQHandler(void);
+extern void DMA_INT2_IRQHandler(void);
+extern void DMA_INT3_IRQHandler(void);
+extern void T32_INT1_IRQHandler(void);
+extern void T32_INT2_IRQHandler(void);
+extern void TA0_0_IRQHandler(void);
+extern void TA1_0_IRQHandler(void);
+extern void TA1_N_IRQHandler(void);
+extern void AES256_IRQHandler(void);
 
 
 /* External declarations for the FreeRTOS interrupt handlers. */
@@ -94,10 +106,10 @@ void (* const interruptVectors[])(void) =
     defaultISR,                             /* FLCTL ISR                 */
     defaultISR,                             /* COMP0 ISR                 */
     defaultISR,                             /* COMP1 ISR                 */
-    defaultISR,                             /* TA0_0 ISR                 */
+    TA0_0_IRQHandler,                       /* TA0_0 ISR                 */
     defaultISR,                             /* TA0_N ISR                 */
-	defaultISR,                             /* TA1_0 ISR                 */
-    defaultISR,                             /* TA1_N ISR                 */
+    TA1_0_IRQHandler,                       /* TA1_0 ISR                 */
+    TA1_N_IRQHandler,                       /* TA1_N ISR                 */
 	defaultISR,                             /* TA2_0 ISR                 */
     defaultISR,                             /* TA2_N ISR                 */
     defaultISR,                             /* TA3_0 ISR                 */
@@ -111,22 +123,22 @@ void (* const interruptVectors[])(void) =
     defaultISR,                             /* EUSCIB2 ISR               */
     defaultISR,                             /* EUSCIB3 ISR               */
     ADC_Handler,                            /* ADC14 ISR                 */
-    defaultISR,                             /* T32_INT1 ISR              */
-    defaultISR,                             /* T32_INT2 ISR              */
+    T32_INT1_IRQHandler,                    /* T32_INT1 ISR              */
+    T32_INT2_IRQHandler,                    /* T32_INT2 ISR              */
     defaultISR,                             /* T32_INTC ISR              */
-    defaultISR,                             /* AES ISR                   */
+    AES256_IRQHandler,                      /* AES ISR                   */
     defaultISR,                             /* RTC ISR                   */
     defaultISR,                             /* DMA_ERR ISR               */
-    defaultISR,                             /* DMA_INT3 ISR              */
-    defaultISR,                             /* DMA_INT2 ISR              */
-    defaultISR,                             /* DMA_INT1 ISR              */
+    DMA_INT3_IRQHandler,                    /* DMA_INT3 ISR              */
+    DMA_INT2_IRQHandler,                    /* DMA_INT2 ISR              */
+    DMA_INT1_IRQHandler,                    /* DMA_INT1 ISR              */
     defaultISR,                             /* DMA_INT0 ISR              */
-    PORT1_Handler,                          /* PORT1 ISR                 */
-	defaultISR,                             /* PORT2 ISR                 */
-	defaultISR,                             /* PORT3 ISR                 */
-    defaultISR,                             /* PORT4 ISR                 */
+    PORT1_IRQHandler,                       /* PORT1 ISR                 */
+    PORT2_IRQHandler,                       /* PORT2 ISR                 */
+    PORT3_IRQHandler,                       /* PORT3 ISR                 */
+    PORT4_IRQHandler,                       /* PORT4 ISR                 */
     PORT5_IRQHandler,                       /* PORT5 ISR                 */
-    defaultISR,                             /* PORT6 ISR                 */
+    PORT6_IRQHandler,                       /* PORT6 ISR                 */
     defaultISR,                             /* Reserved 41               */
     defaultISR,                             /* Reserved 42               */
     defaultISR,                             /* Reserved 43               */
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * FreeRTOS configuration for the Linux host build, see host/Makefile. It
+ * follows PRAC/FreeRTOSConfig.h so the scheduling behaviour is the same as on
+ * the target; only the hardware related settings differ.
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include <assert.h>
+
+/* Constants related to the behaviour or the scheduler. */
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION	1
+#define configUSE_PREEMPTION					1
+#define configUSE_TIME_SLICING					1
+#define configMAX_PRIORITIES					( 7 )
+#define configIDLE_SHOULD_YIELD					1
+#define configUSE_16_BIT_TICKS					0
+
+/* Constants that describe the hardware and memory usage. Stack words are 64
+bits wide on the host, so the heap is larger than on the target. */
+#define configCPU_CLOCK_HZ						( 48000000UL )
+#define configMINIMAL_STACK_SIZE				( ( uint16_t ) 100 )
+#define configMAX_TASK_NAME_LEN					( 12 )
+/* The heap benchmark builds heap_tlsf.c and heap_1.c with the size of the
+target. */
+#ifndef configTOTAL_HEAP_SIZE
+	#define configTOTAL_HEAP_SIZE				( ( size_t ) ( 256 * 1024 ) )
+#endif
+#ifndef configUSE_HEAP_TLSF
+	#define configUSE_HEAP_TLSF					1
+#endif
+
+/* Constants that build features in or out. */
+#define configUSE_MUTEXES						1
+#define configUSE_TICKLESS_IDLE					0
+#define configUSE_APPLICATION_TASK_TAG			0
+#define configUSE_NEWLIB_REENTRANT 				0
+#define configUSE_CO_ROUTINES 					0
+#define configUSE_COUNTING_SEMAPHORES 			1
+#define configUSE_RECURSIVE_MUTEXES				1
+#define configUSE_QUEUE_SETS					0
+#define configUSE_TASK_NOTIFICATIONS			1
+
+/* The peripheral simulation advances its virtual time from the idle task. */
+#ifdef HOST_SIMULATION
+#define configUSE_IDLE_HOOK						1
+#else
+#define configUSE_IDLE_HOOK						0
+#endif
+#define configUSE_TICK_HOOK						0
+#define configUSE_MALLOC_FAILED_HOOK			0
+
+#define configCHECK_FOR_STACK_OVERFLOW			0
+#define configASSERT( x )						assert( x )
+#define configQUEUE_REGISTRY_SIZE				0
+
+/* The timer service is built on the host so timers.c can be exercised. */
+#define configUSE_TIMERS						1
+#define configTIMER_TASK_PRIORITY				( 3 )
+#define configTIMER_QUEUE_LENGTH				5
+#define configTIMER_TASK_STACK_DEPTH			( configMINIMAL_STACK_SIZE  )
+
+#define INCLUDE_vTaskPrioritySet				1
+#define INCLUDE_uxTaskPriorityGet				1
+#define INCLUDE_vTaskDelete						1
+#define INCLUDE_vTaskCleanUpResources			0
+#define INCLUDE_vTaskSuspend					1
+#define INCLUDE_vTaskDelayUntil					1
+#define INCLUDE_vTaskDelay						1
+#define INCLUDE_uxTaskGetStackHighWaterMark		1
+#define INCLUDE_xTaskGetIdleTaskHandle			1
+#define INCLUDE_eTaskGetState					1
+#define INCLUDE_xTaskResumeFromISR				0
+#define INCLUDE_xTaskGetCurrentTaskHandle		1
+#define INCLUDE_xTaskGetSchedulerState			0
+#define INCLUDE_xSemaphoreGetMutexHolder		0
+#define INCLUDE_xTimerPendFunctionCall			0
+
+#define configUSE_STATS_FORMATTING_FUNCTIONS	0
+
+/* Interrupt priorities as on the target, for the drivers that use them. */
+#define configPRIO_BITS							3
+#define configLIBRARY_LOWEST_INTERRUPT_PRIORITY			0x07
+#define configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY	5
+
+#define configKERNEL_INTERRUPT_PRIORITY 		( configLIBRARY_LOWEST_INTERRUPT_PRIORITY << (8 - configPRIO_BITS) )
+#define configMAX_SYSCALL_INTERRUPT_PRIORITY 	( configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY << (8 - configPRIO_BITS) )
+
+#define configUSE_TRACE_FACILITY				1
+
+/* The simulation counts the run time on its Timer32 as the target does, see
+task_stats.c. */
+#ifdef HOST_SIMULATION
+void task_stats_timer_init( void );
+uint32_t task_stats_counter( void );
+void task_stats_switched_in( uint32_t ulTaskNumber );
+#define configGENERATE_RUN_TIME_STATS			1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()	task_stats_timer_init()
+#define portGET_RUN_TIME_COUNTER_VALUE()		task_stats_counter()
+#define traceTASK_SWITCHED_IN()					do { task_stats_switched_in( pxCurrentTCB->uxTCBNumber ); kernel_trace_switched_in( pxCurrentTCB->uxTCBNumber ); } while( 0 )
+
+/* And records the kernel events, see kernel_trace.h. */
+#define configUSE_KERNEL_TRACE					1
+#include "kernel_trace.h"
+
+/* And keeps the stack bounds for stack_profile.c. */
+void stack_profile_task_created( uint32_t ulTaskNumber, void *pvStack, void *pvEndOfStack );
+#define configRECORD_STACK_HIGH_ADDRESS			1
+#define traceTASK_CREATE( pxNewTCB )			stack_profile_task_created( ( pxNewTCB )->uxTCBNumber, ( pxNewTCB )->pxStack, ( pxNewTCB )->pxEndOfStack )
+#else
+#define configGENERATE_RUN_TIME_STATS			0
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()		0
+#endif
+
+#define configTICK_RATE_HZ						( ( TickType_t ) 100 )
+
+#endif /* FREERTOS_CONFIG_H */
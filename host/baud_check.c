@@ -0,0 +1,358 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Reports the error of the baud rates that uart_driver.c configures, for
+ * SMCLK frequencies and baud rates from 9600 bauds to the megabaud range:
+ *
+ *   baud_check
+ *
+ * uart_set_baudrate() runs on stubs of driverlib that keep the eUSCI
+ * configuration. Each bit of a character lasts UCBRx BRCLK cycles (times 16
+ * plus UCBRFx with oversampling) plus the bit of UCBRSx that modulates it, so
+ * the edges drift from the ideal ones within the character. Prints one JSON
+ * object per combination, with the error of the mean rate and the worst edge
+ * in percent of a bit, and fails if an edge is off by more than
+ * BAUD_CHECK_EDGE_MAX percent, if a combination that the eUSCI can generate
+ * under it with some UCBRSx is refused or if a refused one changes the
+ * configuration.
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "driverlib.h"
+
+#include "uart_driver.h"
+#include "interrupts.h"
+
+/*---------------------------------defines------------------------------------*/
+
+// Start, 8 data and stop bits
+#define BAUD_CHECK_BITS             ( 10 )
+
+// The receiver samples in the middle of the bits and the other end drifts too
+#define BAUD_CHECK_EDGE_MAX         ( 5.0 )
+
+// The slowest BRCLK of a bit, in low frequency mode
+#define BAUD_CHECK_MIN_N            ( 3 )
+
+/*--------------------------------prototypes----------------------------------*/
+
+static double baud_check_edge_error(uint32_t clock, uint32_t baudrate, const eUSCI_UART_Config* config);
+static double baud_check_best_edge_error(uint32_t clock, uint32_t baudrate);
+
+/*--------------------------------variables-----------------------------------*/
+
+static const uint32_t baud_check_clocks[] =
+{
+  3000000, 12000000, 24000000, 40000000, 48000000
+};
+
+static const uint32_t baud_check_baudrates[] =
+{
+  9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600, 1000000, 2000000, 3000000, 4000000, 8000000
+};
+
+// Stub state: SMCLK and the configuration of the last UART_initModule()
+static uint32_t baud_check_smclk;
+static eUSCI_UART_Config baud_check_config;
+
+/*----------------------------------public------------------------------------*/
+
+int main(void)
+{
+  eUSCI_UART_Config previous;
+  uint32_t clock;
+  uint32_t baudrate;
+  uint32_t actual;
+  uint32_t combinations = 0;
+  uint32_t refused = 0;
+  uint32_t errors = 0;
+  double rate_error;
+  double edge_error;
+  double edge_error_max = 0.0;
+  uint8_t status;
+  uint16_t i;
+  uint16_t j;
+
+  baud_check_smclk = baud_check_clocks[0];
+  uart_init(NULL);
+
+  for (i = 0; i < sizeof(baud_check_clocks) / sizeof(baud_check_clocks[0]); i++)
+  {
+    for (j = 0; j < sizeof(baud_check_baudrates) / sizeof(baud_check_baudrates[0]); j++)
+    {
+      clock = baud_check_clocks[i];
+      baudrate = baud_check_baudrates[j];
+      baud_check_smclk = clock;
+      combinations++;
+
+      status = uart_set_baudrate(baudrate);
+      if (status != 0)
+      {
+        refused++;
+        // The driver takes UCBRSx from the table of the TRM, a rate only reached at the limit may go either way
+        edge_error = baud_check_best_edge_error(clock, baudrate);
+        if (edge_error < BAUD_CHECK_EDGE_MAX)
+        {
+          errors++;
+        }
+        printf("{\"smclk\":%u,\"baudrate\":%u,\"supported\":false,\"best_edge_error_pct\":%.2f}\n",
+               clock, baudrate, edge_error);
+        continue;
+      }
+
+      actual = uart_get_baudrate();
+      rate_error = 100.0 * ((double) actual - (double) baudrate) / (double) baudrate;
+      edge_error = baud_check_edge_error(clock, baudrate, &baud_check_config);
+      if (edge_error > edge_error_max)
+      {
+        edge_error_max = edge_error;
+      }
+      if (edge_error > BAUD_CHECK_EDGE_MAX)
+      {
+        errors++;
+      }
+
+      printf("{\"smclk\":%u,\"baudrate\":%u,\"supported\":true,\"oversampling\":%s,\"ucbr\":%u,\"ucbrf\":%u,"
+             "\"ucbrs\":\"0x%02X\",\"actual\":%u,\"rate_error_pct\":%.3f,\"edge_error_pct\":%.2f}\n",
+             clock, baudrate,
+             (baud_check_config.overSampling == EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION) ? "true" : "false",
+             (unsigned) baud_check_config.clockPrescalar, (unsigned) baud_check_config.firstModReg,
+             (unsigned) baud_check_config.secondModReg,
+             actual, rate_error, edge_error);
+    }
+  }
+
+  /* A rate the divider cannot reach keeps the configuration in use */
+  baud_check_smclk = 48000000;
+  uart_set_baudrate(57600);
+  previous = baud_check_config;
+  actual = uart_get_baudrate();
+  if ((uart_set_baudrate(40) == 0) || (uart_get_baudrate() != actual) ||
+      (baud_check_config.clockPrescalar != previous.clockPrescalar))
+  {
+    errors++;
+  }
+
+  printf("{\"combinations\":%u,\"refused\":%u,\"edge_error_max_pct\":%.2f,\"errors\":%u}\n",
+         combinations, refused, edge_error_max, errors);
+
+  return (errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*---------------------------------private------------------------------------*/
+
+// Worst distance of an edge of a character from the ideal one, in percent of a bit
+static double baud_check_edge_error(uint32_t clock, uint32_t baudrate, const eUSCI_UART_Config* config)
+{
+  uint64_t cycles = 0;
+  double error;
+  double error_max = 0.0;
+  uint8_t bit;
+
+  for (bit = 0; bit < BAUD_CHECK_BITS; bit++)
+  {
+    if (config->overSampling == EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION)
+    {
+      cycles += 16 * config->clockPrescalar + config->firstModReg;
+    }
+    else
+    {
+      cycles += config->clockPrescalar;
+    }
+    cycles += (config->secondModReg >> (bit % 8)) & 0x01;
+
+    // Cycles of the edge against the ideal ones, (bit + 1) * clock / baudrate
+    error = 100.0 * ((double) cycles * baudrate - (double) (bit + 1) * clock) / (double) clock;
+    if (error < 0)
+    {
+      error = -error;
+    }
+    if (error > error_max)
+    {
+      error_max = error;
+    }
+  }
+
+  return error_max;
+}
+
+/*
+ * Lowest worst edge error over every UCBRSx, with UCBRx and UCBRFx from the
+ * formulas of the TRM. Above BRCLK / 3 no divider works.
+ */
+static double baud_check_best_edge_error(uint32_t clock, uint32_t baudrate)
+{
+  eUSCI_UART_Config config;
+  double error;
+  double error_min = 100.0;
+  uint16_t brs;
+
+  if (clock / baudrate < BAUD_CHECK_MIN_N)
+  {
+    return error_min;
+  }
+
+  if (clock / baudrate >= 16)
+  {
+    config.overSampling = EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION;
+    config.clockPrescalar = clock / (16 * baudrate);
+    config.firstModReg = (clock % (16 * baudrate)) / baudrate;
+  }
+  else
+  {
+    config.overSampling = EUSCI_A_UART_LOW_FREQUENCY_BAUDRATE_GENERATION;
+    config.clockPrescalar = clock / baudrate;
+    config.firstModReg = 0;
+  }
+
+  for (brs = 0; brs <= 0xFF; brs++)
+  {
+    config.secondModReg = brs;
+    error = baud_check_edge_error(clock, baudrate, &config);
+    if (error < error_min)
+    {
+      error_min = error;
+    }
+  }
+
+  return error_min;
+}
+
+/*---------------------------------driverlib stubs----------------------------*/
+
+uint32_t CS_getSMCLK(void)
+{
+  return baud_check_smclk;
+}
+
+bool UART_initModule(uint32_t moduleInstance, const eUSCI_UART_Config* config)
+{
+  (void) moduleInstance;
+
+  baud_check_config = *config;
+
+  return true;
+}
+
+// Never busy, the transfers are not modeled
+uint_fast8_t UART_queryStatusFlags(uint32_t moduleInstance, uint_fast8_t mask)
+{
+  (void) moduleInstance;
+  (void) mask;
+
+  return 0;
+}
+
+void UART_enableModule(uint32_t moduleInstance)
+{
+  (void) moduleInstance;
+}
+
+void UART_enableInterrupt(uint32_t moduleInstance, uint_fast8_t mask)
+{
+  (void) moduleInstance;
+  (void) mask;
+}
+
+void UART_disableInterrupt(uint32_t moduleInstance, uint_fast8_t mask)
+{
+  (void) moduleInstance;
+  (void) mask;
+}
+
+uint_fast8_t UART_getEnabledInterruptStatus(uint32_t moduleInstance)
+{
+  (void) moduleInstance;
+
+  return 0;
+}
+
+void UART_clearInterruptFlag(uint32_t moduleInstance, uint_fast8_t mask)
+{
+  (void) moduleInstance;
+  (void) mask;
+}
+
+uint8_t UART_receiveData(uint32_t moduleInstance)
+{
+  (void) moduleInstance;
+
+  return 0;
+}
+
+void UART_transmitData(uint32_t moduleInstance, uint_fast8_t transmitData)
+{
+  (void) moduleInstance;
+  (void) transmitData;
+}
+
+void GPIO_setAsPeripheralModuleFunctionInputPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins,
+                                                uint_fast8_t mode)
+{
+  (void) selectedPort;
+  (void) selectedPins;
+  (void) mode;
+}
+
+void Interrupt_enableInterrupt(uint32_t interruptNumber)
+{
+  (void) interruptNumber;
+}
+
+void Interrupt_setPriority(uint32_t interruptNumber, uint8_t priority)
+{
+  (void) interruptNumber;
+  (void) priority;
+}
+
+bool Interrupt_enableMaster(void)
+{
+  return true;
+}
+
+// The buffers of the driver are only used from here
+uint32_t interrupts_disable(void)
+{
+  return 0;
+}
+
+void interrupts_restore(uint32_t status)
+{
+  (void) status;
+}
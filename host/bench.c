@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Runs the kernel microbenchmarks of kernel_bench.c on the host port and
+ * prints their results to stdout, one JSON object per line.
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "kernel_bench.h"
+
+/*---------------------------------defines------------------------------------*/
+
+#define BENCH_STACK_SIZE            ( 4 * configMINIMAL_STACK_SIZE )
+
+/*--------------------------------prototypes----------------------------------*/
+
+static void bench_task(void* parameters);
+static uint8_t bench_print(char* line);
+
+/*--------------------------------variables-----------------------------------*/
+
+static int bench_status = EXIT_FAILURE;
+
+/*----------------------------------public------------------------------------*/
+
+int main(void)
+{
+  if (xTaskCreate(bench_task, "Bench", BENCH_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL) != pdPASS)
+  {
+    fprintf(stderr, "cannot create the benchmark task\n");
+    return EXIT_FAILURE;
+  }
+
+  vTaskStartScheduler();
+
+  return bench_status;
+}
+
+/*---------------------------------private------------------------------------*/
+
+static void bench_task(void* parameters)
+{
+  (void) parameters;
+
+  if (kernel_bench_run(bench_print) == true)
+  {
+    bench_status = EXIT_SUCCESS;
+  }
+  else
+  {
+    taskENTER_CRITICAL();
+    fprintf(stderr, "cannot create the benchmark tasks\n");
+    taskEXIT_CRITICAL();
+  }
+
+  vTaskEndScheduler();
+}
+
+// stdio takes locks, so it runs where the tick cannot switch tasks
+static uint8_t bench_print(char* line)
+{
+  taskENTER_CRITICAL();
+  puts(line);
+  fflush(stdout);
+  taskEXIT_CRITICAL();
+
+  return true;
+}
@@ -0,0 +1,362 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Checks that the packed (dual 16-bit SIMD) paths of filter.c are bit exact
+ * with filter_process_reference(), then benchmarks both:
+ *
+ *   filter_check [blocks [seed]]
+ *
+ * Every stage that has a packed path runs on two channels of random 14-bit
+ * samples, in blocks of random lengths, next to the same stage on the
+ * reference path, and a pipeline runs next to its stages one by one. On the
+ * host the packed path uses the portable lanes instead of the intrinsics,
+ * so this checks the algorithms, not the instructions. Prints one JSON object
+ * per stage with the time per sample of each path, in CPU cycles where the
+ * host has a cycle counter, and fails on the first sample that differs.
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "filter.h"
+
+/*---------------------------------defines------------------------------------*/
+
+#define FILTER_CHECK_BLOCKS         ( 30000 )
+#define FILTER_CHECK_SEED           ( 1 )
+
+#define FILTER_CHECK_CHANNELS       ( 2 )
+#define FILTER_CHECK_FRAMES_MAX     ( 64 )
+#define FILTER_CHECK_SAMPLE_MASK    ( (1 << FILTER_SAMPLE_BITS) - 1 )
+
+// Blocks of FILTER_CHECK_BENCH_FRAMES frames timed per path
+#define FILTER_CHECK_BENCH_BLOCKS   ( 20000 )
+#define FILTER_CHECK_BENCH_FRAMES   ( 32 )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  const char* name;
+  uint8_t type;
+  uint8_t parameter;
+} filter_check_case_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+static bool filter_check_init(const filter_check_case_t* test, filter_stage_t* stage);
+static uint32_t filter_check_stage(const filter_check_case_t* test, uint32_t blocks);
+static uint32_t filter_check_pipeline(uint32_t blocks);
+static void filter_check_bench(const filter_check_case_t* test);
+static uint16_t filter_check_block(uint16_t* samples);
+static uint64_t filter_check_clock(void);
+static uint32_t filter_check_random(void);
+
+/*--------------------------------variables-----------------------------------*/
+
+static const filter_check_case_t filter_check_cases[] =
+{
+  { "moving_average_2", FILTER_MOVING_AVERAGE, 2 },
+  { "moving_average_4", FILTER_MOVING_AVERAGE, 4 },
+  { "moving_average_16", FILTER_MOVING_AVERAGE, 16 },
+  { "median_3", FILTER_MEDIAN, 3 },
+  { "median_5", FILTER_MEDIAN, 5 },
+  { "iir_1", FILTER_IIR, 1 },
+  { "iir_3", FILTER_IIR, 3 },
+  { "iir_8", FILTER_IIR, 8 },
+};
+
+static uint32_t filter_check_state;
+
+/*----------------------------------public------------------------------------*/
+
+int main(int argc, char* argv[])
+{
+  uint32_t blocks = FILTER_CHECK_BLOCKS;
+  uint32_t errors = 0;
+  uint16_t i;
+
+  filter_check_state = FILTER_CHECK_SEED;
+  if (argc > 1)
+  {
+    blocks = strtoul(argv[1], NULL, 0);
+  }
+  if (argc > 2)
+  {
+    filter_check_state = strtoul(argv[2], NULL, 0);
+  }
+
+  for (i = 0; i < sizeof(filter_check_cases) / sizeof(filter_check_cases[0]); i++)
+  {
+    errors += filter_check_stage(&filter_check_cases[i], blocks);
+  }
+  errors += filter_check_pipeline(blocks);
+
+  for (i = 0; i < sizeof(filter_check_cases) / sizeof(filter_check_cases[0]); i++)
+  {
+    filter_check_bench(&filter_check_cases[i]);
+  }
+
+  printf("{\"blocks\":%u,\"errors\":%u}\n", blocks, errors);
+
+  return (errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*---------------------------------private------------------------------------*/
+
+static bool filter_check_init(const filter_check_case_t* test, filter_stage_t* stage)
+{
+  switch (test->type)
+  {
+    case FILTER_MOVING_AVERAGE:
+      return filter_moving_average_init(stage, FILTER_CHECK_CHANNELS, test->parameter);
+    case FILTER_MEDIAN:
+      return filter_median_init(stage, FILTER_CHECK_CHANNELS, test->parameter);
+    case FILTER_IIR:
+      return filter_iir_init(stage, FILTER_CHECK_CHANNELS, test->parameter);
+    default:
+      return false;
+  }
+}
+
+// Returns the number of blocks that differ, reported the first time
+static uint32_t filter_check_stage(const filter_check_case_t* test, uint32_t blocks)
+{
+  filter_stage_t packed;
+  filter_stage_t reference;
+  uint16_t samples[FILTER_CHECK_FRAMES_MAX * FILTER_CHECK_CHANNELS];
+  uint16_t expected[FILTER_CHECK_FRAMES_MAX * FILTER_CHECK_CHANNELS];
+  uint16_t frames;
+  uint32_t errors = 0;
+  uint32_t i;
+
+  if ((filter_check_init(test, &packed) == false) || (filter_check_init(test, &reference) == false))
+  {
+    fprintf(stderr, "%s: cannot initialize the stage\n", test->name);
+    return 1;
+  }
+
+  for (i = 0; i < blocks; i++)
+  {
+    frames = filter_check_block(samples);
+    memcpy(expected, samples, frames * FILTER_CHECK_CHANNELS * sizeof(uint16_t));
+
+    if ((filter_process(&packed, samples, frames) != filter_process_reference(&reference, expected, frames)) ||
+        (memcmp(samples, expected, frames * FILTER_CHECK_CHANNELS * sizeof(uint16_t)) != 0))
+    {
+      if (errors == 0)
+      {
+        fprintf(stderr, "%s: block %u differs from the reference\n", test->name, i);
+      }
+      errors++;
+    }
+
+    // A reset now and then, so the priming runs again
+    if ((filter_check_random() % 1024) == 0)
+    {
+      filter_reset(&packed);
+      filter_reset(&reference);
+    }
+  }
+
+  return errors;
+}
+
+// A joystick chain, the pipeline against its stages on the reference path
+static uint32_t filter_check_pipeline(uint32_t blocks)
+{
+  filter_stage_t stages[4];
+  filter_stage_t reference[4];
+  filter_pipeline_t pipeline;
+  uint16_t samples[FILTER_CHECK_FRAMES_MAX * FILTER_CHECK_CHANNELS];
+  uint16_t expected[FILTER_CHECK_FRAMES_MAX * FILTER_CHECK_CHANNELS];
+  uint16_t frames;
+  uint16_t left;
+  uint32_t errors = 0;
+  uint32_t i;
+  uint8_t j;
+
+  for (j = 0; j < 2; j++)
+  {
+    filter_stage_t* chain = (j == 0) ? stages : reference;
+
+    filter_median_init(&chain[0], FILTER_CHECK_CHANNELS, 3);
+    filter_moving_average_init(&chain[1], FILTER_CHECK_CHANNELS, 4);
+    filter_dead_zone_init(&chain[2], FILTER_CHECK_CHANNELS, 8192, 1000, 200);
+    filter_decimate_init(&chain[3], FILTER_CHECK_CHANNELS, 3);
+  }
+
+  filter_pipeline_init(&pipeline);
+  for (j = 0; j < 4; j++)
+  {
+    filter_pipeline_add(&pipeline, &stages[j]);
+  }
+
+  for (i = 0; i < blocks; i++)
+  {
+    frames = filter_check_block(samples);
+    memcpy(expected, samples, frames * FILTER_CHECK_CHANNELS * sizeof(uint16_t));
+
+    left = frames;
+    for (j = 0; j < 4; j++)
+    {
+      left = filter_process_reference(&reference[j], expected, left);
+    }
+
+    if ((filter_pipeline_process(&pipeline, samples, frames) != left) ||
+        (memcmp(samples, expected, left * FILTER_CHECK_CHANNELS * sizeof(uint16_t)) != 0))
+    {
+      if (errors == 0)
+      {
+        fprintf(stderr, "pipeline: block %u differs from the reference\n", i);
+      }
+      errors++;
+    }
+  }
+
+  return errors;
+}
+
+// Time per sample of each path on blocks of the same random samples
+static void filter_check_bench(const filter_check_case_t* test)
+{
+  static uint16_t input[FILTER_CHECK_BENCH_FRAMES * FILTER_CHECK_CHANNELS];
+  uint16_t samples[FILTER_CHECK_BENCH_FRAMES * FILTER_CHECK_CHANNELS];
+  filter_stage_t stage;
+  uint64_t start;
+  uint64_t elapsed[2];
+  double samples_total = (double) FILTER_CHECK_BENCH_BLOCKS * FILTER_CHECK_BENCH_FRAMES * FILTER_CHECK_CHANNELS;
+  uint32_t i;
+  uint8_t path;
+
+  for (i = 0; i < FILTER_CHECK_BENCH_FRAMES * FILTER_CHECK_CHANNELS; i++)
+  {
+    input[i] = filter_check_random() & FILTER_CHECK_SAMPLE_MASK;
+  }
+
+  for (path = 0; path < 2; path++)
+  {
+    filter_check_init(test, &stage);
+
+    start = filter_check_clock();
+    for (i = 0; i < FILTER_CHECK_BENCH_BLOCKS; i++)
+    {
+      memcpy(samples, input, sizeof(samples));
+      if (path == 0)
+      {
+        filter_process(&stage, samples, FILTER_CHECK_BENCH_FRAMES);
+      }
+      else
+      {
+        filter_process_reference(&stage, samples, FILTER_CHECK_BENCH_FRAMES);
+      }
+    }
+    elapsed[path] = filter_check_clock() - start;
+  }
+
+  printf("{\"stage\":\"%s\",\"channels\":%u,\"frames\":%u,\"unit\":\"%s\",\"packed_per_sample\":%.2f,"
+         "\"reference_per_sample\":%.2f}\n",
+         test->name, FILTER_CHECK_CHANNELS, FILTER_CHECK_BENCH_FRAMES,
+#if defined(__x86_64__) || defined(__i386__)
+         "cycles",
+#else
+         "ns",
+#endif
+         (double) elapsed[0] / samples_total, (double) elapsed[1] / samples_total);
+}
+
+// Random 14-bit samples, with steps and spikes as from a joystick
+static uint16_t filter_check_block(uint16_t* samples)
+{
+  static uint16_t level[FILTER_CHECK_CHANNELS] = { 8192, 8192 };
+  uint16_t frames = 1 + filter_check_random() % FILTER_CHECK_FRAMES_MAX;
+  uint16_t i;
+  uint8_t c;
+
+  for (i = 0; i < frames; i++)
+  {
+    for (c = 0; c < FILTER_CHECK_CHANNELS; c++)
+    {
+      switch (filter_check_random() % 16)
+      {
+        case 0:
+          level[c] = filter_check_random() & FILTER_CHECK_SAMPLE_MASK;
+          samples[i * FILTER_CHECK_CHANNELS + c] = level[c];
+          break;
+        case 1:
+          samples[i * FILTER_CHECK_CHANNELS + c] = filter_check_random() & FILTER_CHECK_SAMPLE_MASK;
+          break;
+        default:
+          samples[i * FILTER_CHECK_CHANNELS + c] = (level[c] + filter_check_random() % 64) & FILTER_CHECK_SAMPLE_MASK;
+          break;
+      }
+    }
+  }
+
+  return frames;
+}
+
+// CPU cycles where the host counts them, nanoseconds otherwise
+static uint64_t filter_check_clock(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (uint64_t) now.tv_sec * 1000000000ull + (uint64_t) now.tv_nsec;
+#endif
+}
+
+// xorshift32
+static uint32_t filter_check_random(void)
+{
+  filter_check_state ^= filter_check_state << 13;
+  filter_check_state ^= filter_check_state >> 17;
+  filter_check_state ^= filter_check_state << 5;
+
+  return filter_check_state;
+}
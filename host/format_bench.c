@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Checks format.c and the ftoa() of helper.c against the C library, then
+ * times them against sprintf:
+ *
+ *   format_bench [values [seed]]
+ *
+ * format_snprintf() must give the same output and return value as snprintf
+ * for random integers on the conversions, flags and widths it supports, with
+ * and without truncation, and ftoa() a list of known answers, among them the
+ * values that overflowed 32 bits once scaled. The host C library stands for
+ * newlib, the timings compare the algorithms rather than the target. Prints
+ * one JSON object per benchmark and fails on the first difference.
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "format.h"
+#include "helper.h"
+
+/*---------------------------------defines------------------------------------*/
+
+#define FORMAT_BENCH_VALUES         ( 200000 )
+#define FORMAT_BENCH_SEED           ( 1 )
+#define FORMAT_BENCH_CALLS          ( 1000000 )
+#define FORMAT_BENCH_LENGTH         ( 64 )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  float value;
+  int decimals;
+  const char* expected;
+} format_bench_ftoa_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+static uint32_t format_bench_compare(const char* format, uint32_t value, uint16_t size);
+static void format_bench_time(const char* name, uint8_t test);
+static uint64_t format_bench_now(void);
+static uint32_t format_bench_random(void);
+
+/*--------------------------------variables-----------------------------------*/
+
+static const char* format_bench_formats[] =
+{
+  "%d", "%i", "%u", "%x", "%X", "%c", "%%%d%%", "%8d", "%-8d|", "%08d", "%08X", "%-6u|", "%3x",
+  "Win %d Tie %d Los %d!", "[%s] %05i", "%s",
+};
+
+static const format_bench_ftoa_t format_bench_ftoa[] =
+{
+  { 0.0f, 0, "0" },
+  { 0.0f, 3, "0.000" },
+  { 1.25f, 2, "1.25" },
+  { -1.25f, 2, "-1.25" },
+  { -0.5f, 1, "-0.5" },
+  { 3.14159f, 4, "3.1415" },
+  { 25.0f, 1, "25.0" },
+  { 1023.75f, 2, "1023.75" },
+  { 30000.5f, 5, "30000.50000" },
+  { -30000.5f, 5, "-30000.50000" },
+  { 123456.5f, 9, "123456.500000000" },
+  { 3000000000.0f, 2, "3000000000.00" },
+  { -4294967040.0f, 1, "-4294967040.0" },
+  { 1e20f, 2, "4294967295.00" },
+  { 0.001f, 12, "0.001000000" },
+};
+
+static volatile uint32_t format_bench_sink;
+static uint32_t format_bench_state;
+
+/*----------------------------------public------------------------------------*/
+
+int main(int argc, char* argv[])
+{
+  char result[FORMAT_BENCH_LENGTH];
+  uint32_t values = FORMAT_BENCH_VALUES;
+  uint32_t errors = 0;
+  uint32_t value;
+  uint32_t i;
+  uint16_t j;
+
+  format_bench_state = FORMAT_BENCH_SEED;
+  if (argc > 1)
+  {
+    values = strtoul(argv[1], NULL, 0);
+  }
+  if (argc > 2)
+  {
+    format_bench_state = strtoul(argv[2], NULL, 0);
+  }
+
+  /* Random values of every magnitude, the limits and truncated outputs */
+  for (i = 0; i < values; i++)
+  {
+    value = format_bench_random() >> (format_bench_random() % 32);
+    if (i < 4)
+    {
+      value = (i == 0) ? 0 : (i == 1) ? 0x7FFFFFFF : (i == 2) ? 0x80000000 : 0xFFFFFFFF;
+    }
+
+    for (j = 0; j < sizeof(format_bench_formats) / sizeof(format_bench_formats[0]); j++)
+    {
+      errors += format_bench_compare(format_bench_formats[j], value, FORMAT_BENCH_LENGTH);
+      errors += format_bench_compare(format_bench_formats[j], value, 1 + format_bench_random() % 8);
+    }
+  }
+
+  for (j = 0; j < sizeof(format_bench_ftoa) / sizeof(format_bench_ftoa[0]); j++)
+  {
+    memset(result, 0x55, sizeof(result));
+    ftoa(format_bench_ftoa[j].value, result, format_bench_ftoa[j].decimals);
+    if (strcmp(result, format_bench_ftoa[j].expected) != 0)
+    {
+      fprintf(stderr, "ftoa(%.9g, %d): \"%s\" instead of \"%s\"\n", format_bench_ftoa[j].value,
+              format_bench_ftoa[j].decimals, result, format_bench_ftoa[j].expected);
+      errors++;
+    }
+  }
+
+  format_bench_time("int", 0);
+  format_bench_time("counters", 1);
+  format_bench_time("hex", 2);
+  format_bench_time("fixed", 3);
+
+  printf("{\"values\":%u,\"formats\":%u,\"ftoa_cases\":%u,\"errors\":%u}\n", values,
+         (unsigned) (sizeof(format_bench_formats) / sizeof(format_bench_formats[0])),
+         (unsigned) (sizeof(format_bench_ftoa) / sizeof(format_bench_ftoa[0])), errors);
+
+  return (errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*---------------------------------private------------------------------------*/
+
+// The value goes to every conversion of format, returns 1 if the outputs differ
+static uint32_t format_bench_compare(const char* format, uint32_t value, uint16_t size)
+{
+  char expected[FORMAT_BENCH_LENGTH];
+  char result[FORMAT_BENCH_LENGTH];
+  const char* text = (value & 1) ? "telemetry" : "";
+  int expected_length;
+  int length;
+
+  memset(expected, 0x55, sizeof(expected));
+  memset(result, 0x55, sizeof(result));
+
+  if (strcmp(format, "%c") == 0)
+  {
+    value = 1 + value % 255;
+  }
+
+  if (strstr(format, "%s") != NULL)
+  {
+    expected_length = snprintf(expected, size, format, text, (int32_t) value);
+    length = format_snprintf(result, size, format, text, (int32_t) value);
+  }
+  else
+  {
+    expected_length = snprintf(expected, size, format, value, value, value);
+    length = format_snprintf(result, size, format, value, value, value);
+  }
+
+  if ((length != expected_length) || (memcmp(result, expected, size) != 0))
+  {
+    fprintf(stderr, "\"%s\" of %u in %u bytes: \"%s\" (%d) instead of \"%s\" (%d)\n", format, value, size,
+            result, length, expected, expected_length);
+    return 1;
+  }
+
+  return 0;
+}
+
+// Nanoseconds per call of format.c and of the C library on the same values
+static void format_bench_time(const char* name, uint8_t test)
+{
+  char buffer[FORMAT_BENCH_LENGTH];
+  uint64_t start;
+  uint64_t elapsed[2];
+  int32_t value;
+  uint32_t i;
+  uint8_t path;
+
+  for (path = 0; path < 2; path++)
+  {
+    format_bench_state = FORMAT_BENCH_SEED;
+    start = format_bench_now();
+
+    for (i = 0; i < FORMAT_BENCH_CALLS; i++)
+    {
+      value = (int32_t) (format_bench_random() >> (i % 32));
+
+      switch (test)
+      {
+        case 0:
+          format_bench_sink += (path == 0) ? format_int(buffer, value) : sprintf(buffer, "%d", value);
+          break;
+        case 1:
+          format_bench_sink += (path == 0) ?
+                               format_snprintf(buffer, sizeof(buffer), "Win %d Tie %d Los %d!", value & 0xFF, i & 0xFF, 7) :
+                               snprintf(buffer, sizeof(buffer), "Win %d Tie %d Los %d!", value & 0xFF, i & 0xFF, 7);
+          break;
+        case 2:
+          format_bench_sink += (path == 0) ? format_snprintf(buffer, sizeof(buffer), "%08X", value) :
+                                             snprintf(buffer, sizeof(buffer), "%08X", value);
+          break;
+        default:
+          if (path == 0)
+          {
+            ftoa((float) (value % 100000) / 16.0f, buffer, 3);
+          }
+          else
+          {
+            sprintf(buffer, "%.3f", (float) (value % 100000) / 16.0f);
+          }
+          format_bench_sink += (uint8_t) buffer[0];
+          break;
+      }
+    }
+
+    elapsed[path] = format_bench_now() - start;
+  }
+
+  printf("{\"benchmark\":\"%s\",\"calls\":%u,\"format_ns\":%.1f,\"libc_ns\":%.1f,\"speedup\":%.2f}\n", name,
+         FORMAT_BENCH_CALLS, (double) elapsed[0] / FORMAT_BENCH_CALLS, (double) elapsed[1] / FORMAT_BENCH_CALLS,
+         (double) elapsed[1] / (double) elapsed[0]);
+}
+
+static uint64_t format_bench_now(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (uint64_t) now.tv_sec * 1000000000ull + (uint64_t) now.tv_nsec;
+}
+
+// xorshift32
+static uint32_t format_bench_random(void)
+{
+  format_bench_state ^= format_bench_state << 13;
+  format_bench_state ^= format_bench_state >> 17;
+  format_bench_state ^= format_bench_state << 5;
+
+  return format_bench_state;
+}
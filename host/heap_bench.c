@@ -0,0 +1,439 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Runs allocation traces on heap_tlsf.c and heap_1.c, both built with the
+ * heap size of the target, and prints one JSON object per line and heap:
+ *
+ *   heap_bench [operations [seed]]
+ *
+ * "startup" allocates the kernel objects of the application once and frees
+ * nothing. "session" creates and deletes the objects of a game session over
+ * and over, "fuzz" allocates random sizes and frees random blocks. Every
+ * block is filled with a pattern checked when it is freed, and the TLSF heap
+ * is walked with xPortCheckHeap() as the trace runs. heap_1.c cannot free, so
+ * its frees are skipped and count as leaked.
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*---------------------------------defines------------------------------------*/
+
+#define HEAP_BENCH_OPERATIONS       ( 200000 )
+#define HEAP_BENCH_SEED             ( 1 )
+
+// Blocks alive at once
+#define HEAP_BENCH_SLOTS            ( 128 )
+
+// Operations between two walks of the TLSF heap
+#define HEAP_BENCH_CHECK_PERIOD     ( 64 )
+
+// Bytes of the kernel objects, as the 32-bit target allocates them
+#define HEAP_BENCH_TCB_SIZE         ( 96 )
+#define HEAP_BENCH_QUEUE_SIZE       ( 80 )
+#define HEAP_BENCH_STACK_WORD       ( 4 )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  const char* name;
+  void* (*malloc)(size_t size);
+  void (*free)(void* pointer);  // NULL if the heap cannot free
+  void (*reset)(void);
+  size_t (*free_bytes)(void);
+  size_t (*largest_block)(void);
+  size_t (*minimum_ever_free)(void);
+  BaseType_t (*check)(void);    // NULL if the heap cannot be walked
+} heap_bench_heap_t;
+
+typedef struct
+{
+  void* pointer;
+  size_t size;
+  uint8_t pattern;
+} heap_bench_slot_t;
+
+typedef struct
+{
+  const heap_bench_heap_t* heap;
+  heap_bench_slot_t slots[HEAP_BENCH_SLOTS];
+  uint32_t operations;
+  uint32_t mallocs;
+  uint32_t frees;
+  uint32_t failures;
+  long first_failure;
+  uint64_t malloc_ns;
+  uint64_t malloc_max_ns;
+  uint64_t free_ns;
+  uint64_t free_max_ns;
+  bool corrupted;
+} heap_bench_run_t;
+
+typedef void (*heap_bench_trace_t)(heap_bench_run_t* run, uint32_t operations);
+
+/*--------------------------------prototypes----------------------------------*/
+
+// heap_tlsf.c and heap_1.c built with their functions renamed, see the Makefile
+void* tlsf_malloc(size_t size);
+void tlsf_free(void* pointer);
+void tlsf_reset(void);
+size_t tlsf_free_bytes(void);
+size_t tlsf_minimum_ever_free(void);
+void tlsf_stats(HeapStats_t* stats);
+BaseType_t tlsf_check(void);
+
+void* heap1_malloc(size_t size);
+void heap1_reset(void);
+size_t heap1_free_bytes(void);
+
+static size_t heap_bench_tlsf_largest(void);
+
+static void heap_bench_run(const heap_bench_heap_t* heap, const char* name, heap_bench_trace_t trace, uint32_t operations);
+static void heap_bench_startup(heap_bench_run_t* run, uint32_t operations);
+static void heap_bench_session(heap_bench_run_t* run, uint32_t operations);
+static void heap_bench_fuzz(heap_bench_run_t* run, uint32_t operations);
+
+static bool heap_bench_malloc(heap_bench_run_t* run, uint32_t slot, size_t size);
+static void heap_bench_free(heap_bench_run_t* run, uint32_t slot);
+static void heap_bench_check(heap_bench_run_t* run);
+static uint64_t heap_bench_now(void);
+static uint32_t heap_bench_random(void);
+
+/*--------------------------------variables-----------------------------------*/
+
+static const heap_bench_heap_t heap_bench_heaps[] =
+{
+  { "tlsf", tlsf_malloc, tlsf_free, tlsf_reset, tlsf_free_bytes, heap_bench_tlsf_largest, tlsf_minimum_ever_free, tlsf_check },
+  { "heap_1", heap1_malloc, NULL, heap1_reset, heap1_free_bytes, heap1_free_bytes, heap1_free_bytes, NULL },
+};
+
+static uint32_t heap_bench_seed;
+static uint32_t heap_bench_state;
+static int heap_bench_status = EXIT_SUCCESS;
+
+/*----------------------------------public------------------------------------*/
+
+int main(int argc, char* argv[])
+{
+  uint32_t operations = HEAP_BENCH_OPERATIONS;
+  uint32_t i;
+
+  heap_bench_seed = HEAP_BENCH_SEED;
+  if (argc > 1)
+  {
+    operations = strtoul(argv[1], NULL, 0);
+  }
+  if (argc > 2)
+  {
+    heap_bench_seed = strtoul(argv[2], NULL, 0);
+  }
+
+  printf("{\"config\":{\"heap_bytes\":%u,\"operations\":%u,\"seed\":%u,\"slots\":%u}}\n",
+         (unsigned int) configTOTAL_HEAP_SIZE, operations, heap_bench_seed, HEAP_BENCH_SLOTS);
+
+  for (i = 0; i < sizeof(heap_bench_heaps) / sizeof(heap_bench_heaps[0]); i++)
+  {
+    heap_bench_run(&heap_bench_heaps[i], "startup", heap_bench_startup, operations);
+    heap_bench_run(&heap_bench_heaps[i], "session", heap_bench_session, operations);
+    heap_bench_run(&heap_bench_heaps[i], "fuzz", heap_bench_fuzz, operations);
+  }
+
+  return heap_bench_status;
+}
+
+// The heaps run without the scheduler
+void vTaskSuspendAll(void)
+{
+}
+
+BaseType_t xTaskResumeAll(void)
+{
+  return pdFALSE;
+}
+
+/*---------------------------------private------------------------------------*/
+
+static size_t heap_bench_tlsf_largest(void)
+{
+  HeapStats_t stats;
+
+  tlsf_stats(&stats);
+
+  return stats.xSizeOfLargestFreeBlockInBytes;
+}
+
+static void heap_bench_run(const heap_bench_heap_t* heap, const char* name, heap_bench_trace_t trace, uint32_t operations)
+{
+  static heap_bench_run_t run;
+
+  memset(&run, 0, sizeof(run));
+  run.heap = heap;
+  run.first_failure = -1;
+
+  heap->reset();
+  heap_bench_state = heap_bench_seed;
+
+  trace(&run, operations);
+  heap_bench_check(&run);
+
+  printf("{\"heap\":\"%s\",\"trace\":\"%s\",\"operations\":%u,\"mallocs\":%u,\"frees\":%u,"
+         "\"failures\":%u,\"first_failure\":%ld,"
+         "\"malloc_avg_ns\":%llu,\"malloc_max_ns\":%llu,\"free_avg_ns\":%llu,\"free_max_ns\":%llu,"
+         "\"free_bytes\":%zu,\"largest_block\":%zu,\"minimum_ever_free\":%zu,\"check\":\"%s\"}\n",
+         heap->name, name, run.operations, run.mallocs, run.frees, run.failures, run.first_failure,
+         (unsigned long long) (run.mallocs ? run.malloc_ns / run.mallocs : 0), (unsigned long long) run.malloc_max_ns,
+         (unsigned long long) (run.frees ? run.free_ns / run.frees : 0), (unsigned long long) run.free_max_ns,
+         heap->free_bytes(), heap->largest_block(), heap->minimum_ever_free(),
+         run.corrupted ? "fail" : "pass");
+  fflush(stdout);
+
+  if (run.corrupted == true)
+  {
+    heap_bench_status = EXIT_FAILURE;
+  }
+}
+
+// Stacks, TCBs and queues of the application, created before the scheduler
+static void heap_bench_startup(heap_bench_run_t* run, uint32_t operations)
+{
+  static const size_t sizes[] =
+  {
+    HEAP_BENCH_TCB_SIZE, 1024 * HEAP_BENCH_STACK_WORD,
+    HEAP_BENCH_TCB_SIZE, 512 * HEAP_BENCH_STACK_WORD,
+    HEAP_BENCH_TCB_SIZE, 256 * HEAP_BENCH_STACK_WORD,
+    HEAP_BENCH_TCB_SIZE, 256 * HEAP_BENCH_STACK_WORD,
+    HEAP_BENCH_QUEUE_SIZE + 4 * 8, HEAP_BENCH_QUEUE_SIZE + 16 * 4,
+    HEAP_BENCH_QUEUE_SIZE + 10 * 16, HEAP_BENCH_QUEUE_SIZE, HEAP_BENCH_QUEUE_SIZE,
+    HEAP_BENCH_TCB_SIZE, 100 * HEAP_BENCH_STACK_WORD,
+  };
+  uint32_t i;
+
+  (void) operations;
+
+  for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+  {
+    heap_bench_malloc(run, i, sizes[i]);
+  }
+}
+
+/*
+ * A game session creates its task and queues and deletes them at the end, a
+ * message of random length allocated in between stays until the session after.
+ */
+static void heap_bench_session(heap_bench_run_t* run, uint32_t operations)
+{
+  static const size_t sizes[] =
+  {
+    HEAP_BENCH_TCB_SIZE, 512 * HEAP_BENCH_STACK_WORD,
+    HEAP_BENCH_QUEUE_SIZE + 8 * 4, HEAP_BENCH_QUEUE_SIZE + 4 * 16, HEAP_BENCH_QUEUE_SIZE,
+  };
+  const uint32_t count = sizeof(sizes) / sizeof(sizes[0]);
+  uint32_t message = count;
+  uint32_t i;
+
+  while (run->operations < operations)
+  {
+    for (i = 0; i < count; i++)
+    {
+      heap_bench_malloc(run, i, sizes[i]);
+    }
+
+    heap_bench_free(run, message);
+    heap_bench_malloc(run, message, 16 + heap_bench_random() % 240);
+    message = (message == count) ? count + 1 : count;
+
+    for (i = 0; i < count; i++)
+    {
+      heap_bench_free(run, i);
+    }
+  }
+}
+
+// Sizes spread over powers of two from 1 to 2048 bytes, blocks freed at random
+static void heap_bench_fuzz(heap_bench_run_t* run, uint32_t operations)
+{
+  uint32_t slot;
+  size_t size;
+
+  while (run->operations < operations)
+  {
+    slot = heap_bench_random() % HEAP_BENCH_SLOTS;
+
+    if (run->slots[slot].size != 0)
+    {
+      heap_bench_free(run, slot);
+    }
+    else
+    {
+      size = (size_t) 1 << (heap_bench_random() % 11);
+      size += heap_bench_random() % size;
+      heap_bench_malloc(run, slot, size);
+    }
+  }
+}
+
+static bool heap_bench_malloc(heap_bench_run_t* run, uint32_t slot, size_t size)
+{
+  heap_bench_slot_t* entry = &run->slots[slot];
+  uint64_t start;
+  uint64_t elapsed;
+
+  start = heap_bench_now();
+  entry->pointer = run->heap->malloc(size);
+  elapsed = heap_bench_now() - start;
+
+  if (entry->pointer == NULL)
+  {
+    if (run->first_failure < 0)
+    {
+      run->first_failure = run->operations;
+    }
+    run->failures++;
+    entry->size = 0;
+  }
+  else
+  {
+    run->mallocs++;
+    run->malloc_ns += elapsed;
+    if (elapsed > run->malloc_max_ns)
+    {
+      run->malloc_max_ns = elapsed;
+    }
+
+    if (((uintptr_t) entry->pointer & portBYTE_ALIGNMENT_MASK) != 0)
+    {
+      run->corrupted = true;
+    }
+
+    entry->size = size;
+    entry->pattern = (uint8_t) (run->operations * 31 + slot);
+    memset(entry->pointer, entry->pattern, size);
+  }
+
+  run->operations++;
+  if ((run->operations % HEAP_BENCH_CHECK_PERIOD) == 0)
+  {
+    heap_bench_check(run);
+  }
+
+  return (entry->pointer != NULL);
+}
+
+static void heap_bench_free(heap_bench_run_t* run, uint32_t slot)
+{
+  heap_bench_slot_t* entry = &run->slots[slot];
+  const uint8_t* data = entry->pointer;
+  uint64_t start;
+  uint64_t elapsed;
+  size_t i;
+
+  if (entry->size == 0)
+  {
+    return;
+  }
+
+  // Written over by another block
+  for (i = 0; i < entry->size; i++)
+  {
+    if (data[i] != entry->pattern)
+    {
+      run->corrupted = true;
+      break;
+    }
+  }
+
+  if (run->heap->free != NULL)
+  {
+    start = heap_bench_now();
+    run->heap->free(entry->pointer);
+    elapsed = heap_bench_now() - start;
+
+    run->frees++;
+    run->free_ns += elapsed;
+    if (elapsed > run->free_max_ns)
+    {
+      run->free_max_ns = elapsed;
+    }
+  }
+
+  entry->pointer = NULL;
+  entry->size = 0;
+
+  run->operations++;
+  if ((run->operations % HEAP_BENCH_CHECK_PERIOD) == 0)
+  {
+    heap_bench_check(run);
+  }
+}
+
+static void heap_bench_check(heap_bench_run_t* run)
+{
+  if ((run->heap->check != NULL) && (run->heap->check() != pdPASS))
+  {
+    if (run->corrupted == false)
+    {
+      fprintf(stderr, "%s: heap check failed after %u operations\n", run->heap->name, run->operations);
+    }
+    run->corrupted = true;
+  }
+}
+
+static uint64_t heap_bench_now(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (uint64_t) now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+// xorshift32, the same trace for every heap
+static uint32_t heap_bench_random(void)
+{
+  heap_bench_state ^= heap_bench_state << 13;
+  heap_bench_state ^= heap_bench_state >> 17;
+  heap_bench_state ^= heap_bench_state << 5;
+
+  return heap_bench_state;
+}
@@ -0,0 +1,621 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Shares one mem_pool_t between tasks and an interrupt on the POSIX port and
+ * checks that no block is ever handed out twice:
+ *
+ *   pool_check [ticks [seed]]
+ *
+ * The tick is replaced by a faster SIGALRM, which preempts the running task
+ * anywhere, in mem_pool.c too, and runs an interrupt through
+ * xPortRunInterrupt(): it takes and frees blocks from the interrupt, and every
+ * POOL_CHECK_INTERRUPTS_PER_TICK of them it also runs the kernel tick. Tasks
+ * at two priorities take blocks with random timeouts, hold a few and free
+ * them, and now and then free an address the pool must refuse. Every holder
+ * marks the block in a table and in the block itself, so that a block handed
+ * out twice or changed while held is seen. Once per tick the control task
+ * compares the free list, the counters and the owners with the interrupts
+ * masked. After the given ticks the tasks and the interrupt free their blocks
+ * and the scheduler is stopped. Prints one JSON object and fails if a block
+ * was handed out twice, the counters disagreed with what the tasks and the
+ * interrupt saw or the pool was not contended.
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "mem_pool.h"
+
+/*---------------------------------defines------------------------------------*/
+
+#define POOL_CHECK_TICKS            ( 300 )
+#define POOL_CHECK_SEED             ( 1 )
+
+#define POOL_CHECK_STACK_SIZE       ( configMINIMAL_STACK_SIZE )
+
+// Fewer blocks than the tasks and the interrupt want, so that they wait for them
+#define POOL_CHECK_BLOCKS           ( 8 )
+#define POOL_CHECK_BLOCK_SIZE       ( 32 )
+#define POOL_CHECK_WORKERS          ( 4 )
+#define POOL_CHECK_TASK_HOLD        ( 4 )
+#define POOL_CHECK_ISR_HOLD         ( 3 )
+
+// One allocation in POOL_CHECK_WAIT_MASK + 1 waits, up to POOL_CHECK_TIMEOUT_MAX ticks
+#define POOL_CHECK_WAIT_MASK        ( 0xF )
+#define POOL_CHECK_TIMEOUT_MAX      ( 2 )
+
+#define POOL_CHECK_INTERRUPT_US     ( 50 )
+#define POOL_CHECK_INTERRUPTS_PER_TICK ( 1000000 / configTICK_RATE_HZ / POOL_CHECK_INTERRUPT_US )
+
+// The tag of the interrupt in the table of holders, the workers use 1 to POOL_CHECK_WORKERS
+#define POOL_CHECK_TAG_ISR          ( POOL_CHECK_WORKERS + 1 )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  uint32_t tag;
+  uint32_t state;
+  void* held[POOL_CHECK_TASK_HOLD];
+  uint16_t count;
+} pool_check_worker_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+static void pool_check_worker(void* parameters);
+static void pool_check_control(void* parameters);
+static void pool_check_interrupt(void);
+static void pool_check_signal(int signal);
+static bool pool_check_claim(void* block, uint32_t tag, void* owner);
+static bool pool_check_release(void* block, uint32_t tag, void* owner);
+static void pool_check_bad_free(uint32_t* state, bool from_isr);
+static void pool_check_audit(void);
+static uint32_t pool_check_random(uint32_t* state);
+
+/*--------------------------------variables-----------------------------------*/
+
+MEM_POOL_DEFINE(pool_check_pool, POOL_CHECK_BLOCKS, POOL_CHECK_BLOCK_SIZE);
+
+static pool_check_worker_t pool_check_workers[POOL_CHECK_WORKERS];
+static TickType_t pool_check_ticks = POOL_CHECK_TICKS;
+
+// Tag of the holder of each block, 0 while the pool has it
+static uint32_t pool_check_holders[POOL_CHECK_BLOCKS];
+static uint32_t pool_check_claimed = 0;
+static uint32_t pool_check_peak = 0;
+
+// The interrupt, which only the next interrupt can change
+static void* pool_check_isr_held[POOL_CHECK_ISR_HOLD];
+static uint16_t pool_check_isr_count = 0;
+static uint32_t pool_check_isr_state;
+
+/*
+ * The tasks change the counters with atomics, the interrupt could come between
+ * their load and their store; it cannot be interrupted itself.
+ */
+static volatile bool pool_check_stopping = false;
+static uint32_t pool_check_stopped = 0;
+
+static uint32_t pool_check_interrupts = 0;
+static uint32_t pool_check_refused = 0;
+static uint32_t pool_check_allocs = 0;
+static uint32_t pool_check_isr_allocs = 0;
+static uint32_t pool_check_waited = 0;
+static uint32_t pool_check_woken = 0;
+static uint32_t pool_check_failures = 0;
+static uint32_t pool_check_bad_frees = 0;
+static uint32_t pool_check_audits = 0;
+
+// What must never happen
+static uint32_t pool_check_doubles = 0;
+static uint32_t pool_check_corrupted = 0;
+static uint32_t pool_check_owner_errors = 0;
+static uint32_t pool_check_refused_frees = 0;
+static uint32_t pool_check_accepted_bad_frees = 0;
+static uint32_t pool_check_inconsistent = 0;
+
+static mem_pool_stats_t pool_check_stats;
+static uint16_t pool_check_owned;
+static UBaseType_t pool_check_available;
+
+/*----------------------------------public------------------------------------*/
+
+int main(int argc, char* argv[])
+{
+  uint32_t seed = POOL_CHECK_SEED;
+  uint32_t errors = 0;
+  uint16_t i;
+
+  if (argc > 1)
+  {
+    pool_check_ticks = strtoul(argv[1], NULL, 0);
+  }
+  if (argc > 2)
+  {
+    seed = strtoul(argv[2], NULL, 0);
+  }
+
+  // xorshift32 never leaves 0
+  pool_check_isr_state = (seed != 0) ? seed : POOL_CHECK_SEED;
+
+  if (mem_pool_init(&pool_check_pool) == false)
+  {
+    fprintf(stderr, "cannot create the pool\n");
+    return EXIT_FAILURE;
+  }
+
+  for (i = 0; i < POOL_CHECK_WORKERS; i++)
+  {
+    pool_check_workers[i].tag = i + 1;
+    pool_check_workers[i].state = pool_check_random(&pool_check_isr_state);
+    pool_check_workers[i].count = 0;
+
+    // Half of the workers preempt the other half
+    if (xTaskCreate(pool_check_worker, "Worker", POOL_CHECK_STACK_SIZE, &pool_check_workers[i],
+                    tskIDLE_PRIORITY + 1 + (i % 2), NULL) != pdPASS)
+    {
+      fprintf(stderr, "cannot create the tasks\n");
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (xTaskCreate(pool_check_control, "Control", POOL_CHECK_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, NULL) != pdPASS)
+  {
+    fprintf(stderr, "cannot create the tasks\n");
+    return EXIT_FAILURE;
+  }
+
+  vTaskStartScheduler();
+
+  // Every block came back, and each failed allocation and refused free was counted once
+  if ((pool_check_doubles != 0) || (pool_check_corrupted != 0) || (pool_check_owner_errors != 0) ||
+      (pool_check_refused_frees != 0) || (pool_check_accepted_bad_frees != 0) || (pool_check_inconsistent != 0))
+  {
+    errors++;
+  }
+  if ((pool_check_stats.used != 0) || (pool_check_owned != 0) || (pool_check_claimed != 0) ||
+      (pool_check_available != POOL_CHECK_BLOCKS))
+  {
+    errors++;
+  }
+  if ((pool_check_stats.max_used > POOL_CHECK_BLOCKS) || (pool_check_stats.max_used < pool_check_peak))
+  {
+    errors++;
+  }
+  if ((pool_check_stats.failures != pool_check_failures) || (pool_check_stats.errors != pool_check_bad_frees))
+  {
+    errors++;
+  }
+  // Without these the check proves nothing
+  if ((pool_check_isr_allocs == 0) || (pool_check_waited == 0) || (pool_check_failures == 0) ||
+      (pool_check_stats.max_used != POOL_CHECK_BLOCKS))
+  {
+    errors++;
+  }
+
+  printf("{\"ticks\":%u,\"interrupts\":%u,\"refused\":%u,\"allocs\":%u,\"isr_allocs\":%u,\"waited\":%u,"
+         "\"woken\":%u,\"failures\":%u,\"bad_frees\":%u,\"audits\":%u,\"max_used\":%u,\"peak\":%u,"
+         "\"doubles\":%u,\"corrupted\":%u,\"owner_errors\":%u,\"inconsistent\":%u,\"errors\":%u}\n",
+         (unsigned) pool_check_ticks, pool_check_interrupts, pool_check_refused, pool_check_allocs,
+         pool_check_isr_allocs, pool_check_waited, pool_check_woken, pool_check_stats.failures,
+         pool_check_stats.errors, pool_check_audits, pool_check_stats.max_used, pool_check_peak,
+         pool_check_doubles, pool_check_corrupted, pool_check_owner_errors, pool_check_inconsistent, errors);
+
+  return (errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+ * Replaces the SIGALRM tick of the port with one every POOL_CHECK_INTERRUPT_US, not
+ * deferred while its handler runs, so that the handler sees the mask of the
+ * task it interrupted.
+ */
+void vPortSetupTimerInterrupt(void)
+{
+  struct sigaction action;
+  struct itimerval timer;
+
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = pool_check_signal;
+  action.sa_flags = SA_RESTART | SA_NODEFER;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGALRM, &action, NULL);
+
+  timer.it_interval.tv_sec = 0;
+  timer.it_interval.tv_usec = POOL_CHECK_INTERRUPT_US;
+  timer.it_value = timer.it_interval;
+  setitimer(ITIMER_REAL, &timer, NULL);
+}
+
+/*---------------------------------private------------------------------------*/
+
+static void pool_check_worker(void* parameters)
+{
+  pool_check_worker_t* worker = (pool_check_worker_t*) parameters;
+  void* owner = xTaskGetCurrentTaskHandle();
+  TickType_t timeout;
+  TickType_t start;
+  uint32_t random;
+  uint16_t i;
+  void* block;
+
+  while (pool_check_stopping == false)
+  {
+    random = pool_check_random(&worker->state);
+
+    if ((worker->count == 0) || ((worker->count < POOL_CHECK_TASK_HOLD) && ((random & 1) != 0)))
+    {
+      timeout = (((random >> 1) & POOL_CHECK_WAIT_MASK) == 0) ? 1 + (random >> 5) % POOL_CHECK_TIMEOUT_MAX : 0;
+      start = xTaskGetTickCount();
+
+      block = mem_pool_alloc(&pool_check_pool, timeout);
+      if (block == NULL)
+      {
+        __atomic_fetch_add(&pool_check_failures, 1, __ATOMIC_SEQ_CST);
+      }
+      else
+      {
+        pool_check_claim(block, worker->tag, owner);
+        worker->held[worker->count++] = block;
+        __atomic_fetch_add(&pool_check_allocs, 1, __ATOMIC_SEQ_CST);
+        if (xTaskGetTickCount() != start)
+        {
+          __atomic_fetch_add(&pool_check_waited, 1, __ATOMIC_SEQ_CST);
+        }
+      }
+    }
+    else
+    {
+      i = (random >> 4) % worker->count;
+      block = worker->held[i];
+      worker->held[i] = worker->held[--worker->count];
+
+      if (pool_check_release(block, worker->tag, owner) == true)
+      {
+        if (mem_pool_free(&pool_check_pool, block) == false)
+        {
+          __atomic_fetch_add(&pool_check_refused_frees, 1, __ATOMIC_SEQ_CST);
+        }
+      }
+    }
+
+    if (((random >> 8) & 0xFF) == 0)
+    {
+      pool_check_bad_free(&worker->state, false);
+    }
+
+    // The workers that preempt the others let them run now and then
+    if (((random >> 16) & 0xFFF) == 0)
+    {
+      vTaskDelay(1);
+    }
+  }
+
+  while (worker->count > 0)
+  {
+    block = worker->held[--worker->count];
+    if (pool_check_release(block, worker->tag, owner) == true)
+    {
+      if (mem_pool_free(&pool_check_pool, block) == false)
+      {
+        __atomic_fetch_add(&pool_check_refused_frees, 1, __ATOMIC_SEQ_CST);
+      }
+    }
+  }
+
+  __atomic_fetch_add(&pool_check_stopped, 1, __ATOMIC_SEQ_CST);
+  vTaskSuspend(NULL);
+}
+
+static void pool_check_control(void* parameters)
+{
+  TickType_t end = xTaskGetTickCount() + pool_check_ticks;
+
+  (void) parameters;
+
+  while (xTaskGetTickCount() < end)
+  {
+    vTaskDelay(1);
+    pool_check_audit();
+  }
+
+  // The interrupt frees its blocks too, on its next run
+  pool_check_stopping = true;
+  while ((__atomic_load_n(&pool_check_stopped, __ATOMIC_SEQ_CST) < POOL_CHECK_WORKERS) ||
+         (__atomic_load_n(&pool_check_isr_count, __ATOMIC_SEQ_CST) != 0))
+  {
+    vTaskDelay(1);
+  }
+
+  pool_check_audit();
+
+  mem_pool_get_stats(&pool_check_pool, &pool_check_stats);
+  pool_check_owned = mem_pool_owned(&pool_check_pool, NULL);
+  pool_check_available = uxSemaphoreGetCount(pool_check_pool.available);
+
+  vTaskEndScheduler();
+}
+
+static void pool_check_interrupt(void)
+{
+  BaseType_t woken = pdFALSE;
+  uint32_t random;
+  uint16_t i;
+  void* block;
+
+  pool_check_interrupts++;
+  if ((pool_check_interrupts % POOL_CHECK_INTERRUPTS_PER_TICK) == 0)
+  {
+    xPortSysTickHandler();
+  }
+
+  random = pool_check_random(&pool_check_isr_state);
+
+  if ((pool_check_stopping == false) && (pool_check_isr_count < POOL_CHECK_ISR_HOLD) && ((random & 3) == 0))
+  {
+    block = mem_pool_alloc_from_isr(&pool_check_pool);
+    if (block == NULL)
+    {
+      pool_check_failures++;
+    }
+    else
+    {
+      pool_check_claim(block, POOL_CHECK_TAG_ISR, MEM_POOL_OWNER_ISR);
+      pool_check_isr_held[pool_check_isr_count] = block;
+      __atomic_store_n(&pool_check_isr_count, pool_check_isr_count + 1, __ATOMIC_SEQ_CST);
+      pool_check_isr_allocs++;
+    }
+  }
+  else if ((pool_check_isr_count > 0) && ((pool_check_stopping == true) || ((random & 3) == 1)))
+  {
+    i = (random >> 4) % pool_check_isr_count;
+    block = pool_check_isr_held[i];
+    pool_check_isr_held[i] = pool_check_isr_held[pool_check_isr_count - 1];
+    __atomic_store_n(&pool_check_isr_count, pool_check_isr_count - 1, __ATOMIC_SEQ_CST);
+
+    if (pool_check_release(block, POOL_CHECK_TAG_ISR, MEM_POOL_OWNER_ISR) == true)
+    {
+      if (mem_pool_free_from_isr(&pool_check_pool, block, &woken) == false)
+      {
+        pool_check_refused_frees++;
+      }
+    }
+  }
+
+  if (((random >> 8) & 0x3FF) == 0)
+  {
+    pool_check_bad_free(&pool_check_isr_state, true);
+  }
+
+  if (woken != pdFALSE)
+  {
+    pool_check_woken++;
+  }
+  portYIELD_FROM_ISR(woken);
+}
+
+// With the interrupts masked the signal waits, as the interrupt would on the target
+static void pool_check_signal(int signal)
+{
+  (void) signal;
+
+  if (xPortRunInterrupt(pool_check_interrupt) == pdFALSE)
+  {
+    pool_check_refused++;
+  }
+}
+
+// Marks a block just taken, false if someone else holds it
+static bool pool_check_claim(void* block, uint32_t tag, void* owner)
+{
+  uint32_t offset = (uint32_t)((uint8_t*) block - pool_check_pool.storage);
+  uint32_t index = offset / pool_check_pool.size;
+  uint32_t claimed;
+  uint32_t peak;
+
+  if (((offset % pool_check_pool.size) != 0) || (index >= POOL_CHECK_BLOCKS))
+  {
+    __atomic_fetch_add(&pool_check_corrupted, 1, __ATOMIC_SEQ_CST);
+    return false;
+  }
+
+  if (__atomic_exchange_n(&pool_check_holders[index], tag, __ATOMIC_SEQ_CST) != 0)
+  {
+    __atomic_fetch_add(&pool_check_doubles, 1, __ATOMIC_SEQ_CST);
+    return false;
+  }
+
+  if (mem_pool_owner(&pool_check_pool, block) != owner)
+  {
+    __atomic_fetch_add(&pool_check_owner_errors, 1, __ATOMIC_SEQ_CST);
+  }
+
+  // Past the link of the free list, which the pool may use only while the block is free
+  memset((uint8_t*) block + sizeof(void*), (int) tag, POOL_CHECK_BLOCK_SIZE - sizeof(void*));
+  memcpy(block, &tag, sizeof(tag));
+
+  claimed = __atomic_add_fetch(&pool_check_claimed, 1, __ATOMIC_SEQ_CST);
+  peak = __atomic_load_n(&pool_check_peak, __ATOMIC_SEQ_CST);
+  while ((claimed > peak) &&
+         (__atomic_compare_exchange_n(&pool_check_peak, &peak, claimed, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST) == false))
+  {
+  }
+
+  return true;
+}
+
+// Checks and unmarks a block about to be freed, false if it was not held by tag
+static bool pool_check_release(void* block, uint32_t tag, void* owner)
+{
+  uint32_t offset = (uint32_t)((uint8_t*) block - pool_check_pool.storage);
+  uint32_t index = offset / pool_check_pool.size;
+  const uint8_t* byte = block;
+  uint32_t head;
+  uint16_t i;
+
+  if (((offset % pool_check_pool.size) != 0) || (index >= POOL_CHECK_BLOCKS))
+  {
+    __atomic_fetch_add(&pool_check_corrupted, 1, __ATOMIC_SEQ_CST);
+    return false;
+  }
+
+  memcpy(&head, block, sizeof(head));
+  for (i = sizeof(void*); i < POOL_CHECK_BLOCK_SIZE; i++)
+  {
+    if (byte[i] != (uint8_t) tag)
+    {
+      break;
+    }
+  }
+  if ((head != tag) || (i != POOL_CHECK_BLOCK_SIZE))
+  {
+    __atomic_fetch_add(&pool_check_corrupted, 1, __ATOMIC_SEQ_CST);
+  }
+
+  if (mem_pool_owner(&pool_check_pool, block) != owner)
+  {
+    __atomic_fetch_add(&pool_check_owner_errors, 1, __ATOMIC_SEQ_CST);
+  }
+
+  if (__atomic_exchange_n(&pool_check_holders[index], 0, __ATOMIC_SEQ_CST) != tag)
+  {
+    __atomic_fetch_add(&pool_check_doubles, 1, __ATOMIC_SEQ_CST);
+    return false;
+  }
+
+  __atomic_fetch_sub(&pool_check_claimed, 1, __ATOMIC_SEQ_CST);
+
+  return true;
+}
+
+// Frees an address inside a block or outside the pool, which must be refused and counted
+static void pool_check_bad_free(uint32_t* state, bool from_isr)
+{
+  BaseType_t woken = pdFALSE;
+  uint32_t random = pool_check_random(state);
+  uint8_t outside;
+  void* address;
+  bool freed;
+
+  if ((random & 1) != 0)
+  {
+    address = pool_check_pool.storage + (random >> 1) % (POOL_CHECK_BLOCKS * pool_check_pool.size - 1) + 1;
+    if ((((uint8_t*) address - pool_check_pool.storage) % pool_check_pool.size) == 0)
+    {
+      address = (uint8_t*) address + 1;
+    }
+  }
+  else
+  {
+    address = &outside;
+  }
+
+  if (from_isr == true)
+  {
+    freed = mem_pool_free_from_isr(&pool_check_pool, address, &woken);
+  }
+  else
+  {
+    freed = mem_pool_free(&pool_check_pool, address);
+  }
+
+  __atomic_fetch_add(&pool_check_bad_frees, 1, __ATOMIC_SEQ_CST);
+  if ((freed == true) || (woken != pdFALSE))
+  {
+    __atomic_fetch_add(&pool_check_accepted_bad_frees, 1, __ATOMIC_SEQ_CST);
+  }
+}
+
+/*
+ * With the interrupts masked the pool is between two operations: the free
+ * list and the owners must both account for every block, and a free block
+ * must not be freed again.
+ */
+static void pool_check_audit(void)
+{
+  void* block;
+  uint16_t length = 0;
+  uint16_t owned;
+
+  taskENTER_CRITICAL();
+
+  for (block = pool_check_pool.free_list; (block != NULL) && (length <= POOL_CHECK_BLOCKS); block = *(void**) block)
+  {
+    if (mem_pool_owner(&pool_check_pool, block) != NULL)
+    {
+      pool_check_inconsistent++;
+    }
+    length++;
+  }
+
+  owned = mem_pool_owned(&pool_check_pool, NULL);
+  if ((length + pool_check_pool.used != POOL_CHECK_BLOCKS) || (owned != pool_check_pool.used) ||
+      (pool_check_pool.max_used < pool_check_pool.used) || (pool_check_pool.max_used > POOL_CHECK_BLOCKS))
+  {
+    pool_check_inconsistent++;
+  }
+
+  if (pool_check_pool.free_list != NULL)
+  {
+    if (mem_pool_free(&pool_check_pool, pool_check_pool.free_list) == true)
+    {
+      pool_check_accepted_bad_frees++;
+    }
+    __atomic_fetch_add(&pool_check_bad_frees, 1, __ATOMIC_SEQ_CST);
+  }
+
+  pool_check_audits++;
+
+  taskEXIT_CRITICAL();
+}
+
+// xorshift32
+static uint32_t pool_check_random(uint32_t* state)
+{
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+
+  return *state;
+}
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Runs a mix of tasks on the POSIX port for a while and checks what each
+ * part of the kernel did:
+ *
+ *   port_check [ticks]
+ *
+ * A producer and a consumer pass a sequence through a queue, two tasks spin
+ * at the same priority and must share the processor by time slicing, an
+ * auto-reload software timer sets an event group bit and the task waiting
+ * for it creates a child that deletes itself. After the given ticks the
+ * highest priority task stops the scheduler, which must return from
+ * vTaskStartScheduler(). Prints one JSON object and fails if the sequence
+ * was broken, a spinning task starved, the timer missed its period or a
+ * child did not run.
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "timers.h"
+#include "event_groups.h"
+
+/*---------------------------------defines------------------------------------*/
+
+#define PORT_CHECK_TICKS            ( 300 )
+
+#define PORT_CHECK_STACK_SIZE       ( configMINIMAL_STACK_SIZE )
+#define PORT_CHECK_QUEUE_LENGTH     ( 8 )
+
+#define PORT_CHECK_TIMER_PERIOD     ( 2 )
+#define PORT_CHECK_TIMER_BIT        ( 1 << 0 )
+
+// The producer blocks once per PORT_CHECK_BURST items, the spinning tasks run then
+#define PORT_CHECK_BURST            ( 1024 )
+
+// The spinning task that ran least must get this share of the other one
+#define PORT_CHECK_SLICE_PERCENT    ( 25 )
+
+/*--------------------------------prototypes----------------------------------*/
+
+static void port_check_producer(void* parameters);
+static void port_check_consumer(void* parameters);
+static void port_check_spin(void* parameters);
+static void port_check_timer(TimerHandle_t timer);
+static void port_check_waiter(void* parameters);
+static void port_check_child(void* parameters);
+static void port_check_control(void* parameters);
+
+/*--------------------------------variables-----------------------------------*/
+
+static QueueHandle_t port_check_queue;
+static EventGroupHandle_t port_check_events;
+static TickType_t port_check_ticks = PORT_CHECK_TICKS;
+static TickType_t port_check_ended;
+
+static volatile uint32_t port_check_received = 0;
+static volatile uint32_t port_check_mismatches = 0;
+static volatile uint32_t port_check_spins[2] = { 0, 0 };
+static volatile uint32_t port_check_timer_calls = 0;
+static volatile uint32_t port_check_children_created = 0;
+static volatile uint32_t port_check_children_run = 0;
+
+/*----------------------------------public------------------------------------*/
+
+int main(int argc, char* argv[])
+{
+  TimerHandle_t timer;
+  uint32_t spin_min;
+  uint32_t spin_max;
+  uint32_t periods;
+  uint32_t errors = 0;
+
+  if (argc > 1)
+  {
+    port_check_ticks = strtoul(argv[1], NULL, 0);
+  }
+
+  port_check_queue = xQueueCreate(PORT_CHECK_QUEUE_LENGTH, sizeof(uint32_t));
+  port_check_events = xEventGroupCreate();
+  timer = xTimerCreate("Timer", PORT_CHECK_TIMER_PERIOD, pdTRUE, NULL, port_check_timer);
+
+  if ((port_check_queue == NULL) || (port_check_events == NULL) || (timer == NULL) ||
+      (xTimerStart(timer, 0) != pdPASS) ||
+      (xTaskCreate(port_check_producer, "Produce", PORT_CHECK_STACK_SIZE, NULL, tskIDLE_PRIORITY + 2, NULL) != pdPASS) ||
+      (xTaskCreate(port_check_consumer, "Consume", PORT_CHECK_STACK_SIZE, NULL, tskIDLE_PRIORITY + 2, NULL) != pdPASS) ||
+      (xTaskCreate(port_check_spin, "SpinA", PORT_CHECK_STACK_SIZE, (void*) &port_check_spins[0], tskIDLE_PRIORITY + 1, NULL) != pdPASS) ||
+      (xTaskCreate(port_check_spin, "SpinB", PORT_CHECK_STACK_SIZE, (void*) &port_check_spins[1], tskIDLE_PRIORITY + 1, NULL) != pdPASS) ||
+      (xTaskCreate(port_check_waiter, "Wait", PORT_CHECK_STACK_SIZE, NULL, tskIDLE_PRIORITY + 4, NULL) != pdPASS) ||
+      (xTaskCreate(port_check_control, "Control", PORT_CHECK_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, NULL) != pdPASS))
+  {
+    fprintf(stderr, "cannot create the kernel objects\n");
+    return EXIT_FAILURE;
+  }
+
+  vTaskStartScheduler();
+
+  /* Only the tasks are stopped, their counters stay as they were */
+  spin_min = (port_check_spins[0] < port_check_spins[1]) ? port_check_spins[0] : port_check_spins[1];
+  spin_max = (port_check_spins[0] < port_check_spins[1]) ? port_check_spins[1] : port_check_spins[0];
+  periods = port_check_ended / PORT_CHECK_TIMER_PERIOD;
+
+  if ((port_check_mismatches != 0) || (port_check_received == 0))
+  {
+    errors++;
+  }
+  if ((spin_min == 0) || ((uint64_t) spin_min * 100 < (uint64_t) spin_max * PORT_CHECK_SLICE_PERCENT))
+  {
+    errors++;
+  }
+  if ((port_check_timer_calls + 1 < periods) || (port_check_timer_calls > periods))
+  {
+    errors++;
+  }
+  if ((port_check_children_run + 1 < port_check_children_created) ||
+      (port_check_children_created + 1 < port_check_timer_calls))
+  {
+    errors++;
+  }
+
+  printf("{\"ticks\":%u,\"received\":%u,\"mismatches\":%u,\"spin_a\":%u,\"spin_b\":%u,\"timer_calls\":%u,"
+         "\"children_created\":%u,\"children_run\":%u,\"errors\":%u}\n", (unsigned) port_check_ended,
+         port_check_received, port_check_mismatches, port_check_spins[0], port_check_spins[1],
+         port_check_timer_calls, port_check_children_created, port_check_children_run, errors);
+
+  return (errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*---------------------------------private------------------------------------*/
+
+static void port_check_producer(void* parameters)
+{
+  uint32_t value = 0;
+
+  (void) parameters;
+
+  while (true)
+  {
+    xQueueSend(port_check_queue, &value, portMAX_DELAY);
+    value++;
+
+    if ((value % PORT_CHECK_BURST) == 0)
+    {
+      vTaskDelay(1);
+    }
+  }
+}
+
+static void port_check_consumer(void* parameters)
+{
+  uint32_t expected = 0;
+  uint32_t value;
+
+  (void) parameters;
+
+  while (true)
+  {
+    xQueueReceive(port_check_queue, &value, portMAX_DELAY);
+    if (value != expected)
+    {
+      port_check_mismatches++;
+    }
+    expected = value + 1;
+    port_check_received++;
+  }
+}
+
+// Never blocks, only the tick takes the processor away
+static void port_check_spin(void* parameters)
+{
+  volatile uint32_t* count = (volatile uint32_t*) parameters;
+
+  while (true)
+  {
+    (*count)++;
+  }
+}
+
+static void port_check_timer(TimerHandle_t timer)
+{
+  (void) timer;
+
+  port_check_timer_calls++;
+  xEventGroupSetBits(port_check_events, PORT_CHECK_TIMER_BIT);
+}
+
+static void port_check_waiter(void* parameters)
+{
+  (void) parameters;
+
+  while (true)
+  {
+    xEventGroupWaitBits(port_check_events, PORT_CHECK_TIMER_BIT, pdTRUE, pdTRUE, portMAX_DELAY);
+    if (xTaskCreate(port_check_child, "Child", PORT_CHECK_STACK_SIZE, NULL, tskIDLE_PRIORITY + 3, NULL) == pdPASS)
+    {
+      port_check_children_created++;
+    }
+  }
+}
+
+// Deleted tasks are freed by the idle task, which has to run for the churn to last
+static void port_check_child(void* parameters)
+{
+  (void) parameters;
+
+  port_check_children_run++;
+  vTaskDelete(NULL);
+}
+
+static void port_check_control(void* parameters)
+{
+  (void) parameters;
+
+  vTaskDelay(port_check_ticks);
+  port_check_ended = xTaskGetTickCount();
+
+  vTaskEndScheduler();
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Cortex-M4 core header of the host simulation, found before the CMSIS one
+ * when building with -DHOST_SIMULATION. It only declares what the drivers
+ * use: the register qualifiers, the core peripherals as plain memory and
+ * the intrinsics, PRIMASK being the one of the simulated core (see sim.c).
+ * msp_compatibility.h builds __get/__set_interrupt_state() on PRIMASK.
+ */
+
+#ifndef __CORE_CM4_H_GENERIC
+#define __CORE_CM4_H_GENERIC
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdint.h>
+
+/*---------------------------------defines------------------------------------*/
+
+#define __CM4_CMSIS_VERSION_MAIN    ( 0x04 )
+#define __CM4_CMSIS_VERSION_SUB     ( 0x00 )
+#define __CORTEX_M                  ( 0x04 )
+
+/* The models write the registers the drivers only read, see sim.h */
+#ifdef SIM_REGISTER_ACCESS
+#define __I                         volatile
+#else
+#define __I                         volatile const
+#endif
+#define __O                         volatile
+#define __IO                        volatile
+#define __IM                        __I
+#define __OM                        volatile
+#define __IOM                       volatile
+
+#define SCB_SCR_SLEEPONEXIT_Msk     ( 1UL << 1 )
+#define SCB_SCR_SLEEPDEEP_Msk       ( 1UL << 2 )
+
+#define DWT_CTRL_CYCCNTENA_Msk      ( 1UL << 0 )
+#define CoreDebug_DEMCR_TRCENA_Msk  ( 1UL << 24 )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  __IO uint32_t ISER[8];
+  uint32_t RESERVED0[24];
+  __IO uint32_t ICER[8];
+  uint32_t RESERVED1[24];
+  __IO uint32_t ISPR[8];
+  uint32_t RESERVED2[24];
+  __IO uint32_t ICPR[8];
+  uint32_t RESERVED3[24];
+  __IO uint32_t IABR[8];
+  uint32_t RESERVED4[56];
+  __IO uint8_t IP[240];
+  uint32_t RESERVED5[644];
+  __O uint32_t STIR;
+} NVIC_Type;
+
+typedef struct
+{
+  __I uint32_t CPUID;
+  __IO uint32_t ICSR;
+  __IO uint32_t VTOR;
+  __IO uint32_t AIRCR;
+  __IO uint32_t SCR;
+  __IO uint32_t CCR;
+  __IO uint8_t SHP[12];
+  __IO uint32_t SHCSR;
+  __IO uint32_t CFSR;
+  __IO uint32_t HFSR;
+  __IO uint32_t DFSR;
+  __IO uint32_t MMFAR;
+  __IO uint32_t BFAR;
+  __IO uint32_t AFSR;
+  __I uint32_t PFR[2];
+  __I uint32_t DFR;
+  __I uint32_t ADR;
+  __I uint32_t MMFR[4];
+  __I uint32_t ISAR[5];
+  uint32_t RESERVED0[5];
+  __IO uint32_t CPACR;
+} SCB_Type;
+
+typedef struct
+{
+  __IO uint32_t CTRL;
+  __IO uint32_t CYCCNT;
+  __IO uint32_t CPICNT;
+  __IO uint32_t EXCCNT;
+  __IO uint32_t SLEEPCNT;
+  __IO uint32_t LSUCNT;
+  __IO uint32_t FOLDCNT;
+  __I uint32_t PCSR;
+} DWT_Type;
+
+typedef struct
+{
+  __IO uint32_t DHCSR;
+  __O uint32_t DCRSR;
+  __IO uint32_t DCRDR;
+  __IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+/*--------------------------------variables-----------------------------------*/
+
+/* The core peripherals are not modeled, they only hold what is written */
+extern NVIC_Type sim_nvic;
+extern SCB_Type sim_scb;
+extern DWT_Type sim_dwt;
+extern CoreDebug_Type sim_core_debug;
+
+#define NVIC                        ( &sim_nvic )
+#define SCB                         ( &sim_scb )
+#define DWT                         ( &sim_dwt )
+#define CoreDebug                   ( &sim_core_debug )
+
+// GE flags of the last SIMD subtraction, read by __SEL()
+extern __thread uint32_t sim_apsr_ge;
+
+/*--------------------------------prototypes----------------------------------*/
+
+uint32_t sim_get_primask(void);
+void sim_set_primask(uint32_t primask);
+void sim_wait_for_interrupt(void);
+
+/*----------------------------------public------------------------------------*/
+
+#define __get_PRIMASK()             sim_get_primask()
+#define __set_PRIMASK(x)            sim_set_primask(x)
+#define __disable_irq()             sim_set_primask(1)
+#define __enable_irq()              sim_set_primask(0)
+
+#define __WFI()                     sim_wait_for_interrupt()
+#define __NOP()                     do { } while (0)
+#define __DSB()                     __sync_synchronize()
+#define __ISB()                     __sync_synchronize()
+
+static inline uint32_t __CLZ(uint32_t value)
+{
+  return (value == 0) ? 32 : (uint32_t) __builtin_clz(value);
+}
+
+static inline uint32_t __RBIT(uint32_t value)
+{
+  uint32_t result = 0;
+  uint8_t i;
+
+  for (i = 0; i < 32; i++)
+  {
+    result = (result << 1) | ((value >> i) & 1);
+  }
+
+  return result;
+}
+
+static inline uint32_t __SADD16(uint32_t a, uint32_t b)
+{
+  return (uint16_t)((int16_t) a + (int16_t) b) |
+         ((uint32_t)(uint16_t)((int16_t)(a >> 16) + (int16_t)(b >> 16)) << 16);
+}
+
+static inline uint32_t __SSUB16(uint32_t a, uint32_t b)
+{
+  return (uint16_t)((int16_t) a - (int16_t) b) |
+         ((uint32_t)(uint16_t)((int16_t)(a >> 16) - (int16_t)(b >> 16)) << 16);
+}
+
+static inline uint32_t __UHADD16(uint32_t a, uint32_t b)
+{
+  return (((a & 0xFFFF) + (b & 0xFFFF)) >> 1) |
+         ((((a >> 16) + (b >> 16)) >> 1) << 16);
+}
+
+static inline uint32_t __USUB16(uint32_t a, uint32_t b)
+{
+  /* GE is set per lane where a >= b */
+  sim_apsr_ge = (((a & 0xFFFF) >= (b & 0xFFFF)) ? 0x0000FFFF : 0) |
+                (((a >> 16) >= (b >> 16)) ? 0xFFFF0000 : 0);
+
+  return (uint16_t)(a - b) | ((uint32_t)(uint16_t)((a >> 16) - (b >> 16)) << 16);
+}
+
+static inline uint32_t __SEL(uint32_t a, uint32_t b)
+{
+  return (a & sim_apsr_ge) | (b & ~sim_apsr_ge);
+}
+
+#endif /* __CORE_CM4_H_GENERIC */
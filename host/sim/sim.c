@@ -0,0 +1,609 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#define _GNU_SOURCE
+
+#include <signal.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "driverlib.h"
+
+#include "sim.h"
+
+/*---------------------------------defines------------------------------------*/
+
+// Peripheral region mapped at its real address, TIMER_A0 to ADC14
+#define SIM_BUS_BASE                ( PERIPH_BASE )
+#define SIM_BUS_SIZE                ( 0x00020000 )
+#define SIM_BUS_PAGE                ( 0x1000 )
+#define SIM_BUS_HOOKS               ( 16 )
+
+// Trap flag of x86 EFLAGS, single steps the faulting write
+#define SIM_EFLAGS_TF               ( 0x100 )
+
+#define SIM_IRQS                    ( NUM_INTERRUPTS + 1 )
+#define SIM_IRQ_PRIORITY_MASK       ( 0xE0 )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  uintptr_t base;
+  uint32_t size;
+  sim_write_hook_t hook;
+} sim_bus_hook_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+static sim_time_t sim_next_event(void);
+static void sim_advance(sim_time_t time);
+static void sim_deliver(void);
+static uint32_t sim_irq_pending(void);
+static void sim_bus_setup(void);
+static void sim_bus_fault(int signal, siginfo_t* info, void* context);
+static void sim_bus_trap(int signal, siginfo_t* info, void* context);
+
+/* The ISRs of the vector table, those of drivers not linked are NULL */
+void TA0_0_IRQHandler(void) __attribute__((weak));
+void TA1_0_IRQHandler(void) __attribute__((weak));
+void TA1_N_IRQHandler(void) __attribute__((weak));
+void EUSCIA0_IRQHandler(void) __attribute__((weak));
+void ADC_Handler(void) __attribute__((weak));
+void T32_INT1_IRQHandler(void) __attribute__((weak));
+void T32_INT2_IRQHandler(void) __attribute__((weak));
+void DMA_INT3_IRQHandler(void) __attribute__((weak));
+void DMA_INT2_IRQHandler(void) __attribute__((weak));
+void DMA_INT1_IRQHandler(void) __attribute__((weak));
+void PORT1_IRQHandler(void) __attribute__((weak));
+void PORT2_IRQHandler(void) __attribute__((weak));
+void PORT3_IRQHandler(void) __attribute__((weak));
+void PORT4_IRQHandler(void) __attribute__((weak));
+void PORT5_IRQHandler(void) __attribute__((weak));
+void PORT6_IRQHandler(void) __attribute__((weak));
+
+/*--------------------------------variables-----------------------------------*/
+
+NVIC_Type sim_nvic;
+SCB_Type sim_scb;
+DWT_Type sim_dwt;
+CoreDebug_Type sim_core_debug;
+
+__thread uint32_t sim_apsr_ge;
+
+static sim_time_t sim_now = 0;
+
+static const sim_model_t* const sim_models[] =
+{
+  &sim_timer_a_model, &sim_timer32_model, &sim_adc_model, &sim_eusci_model
+};
+
+// Same handlers as PRAC/msp432_startup_ccs.c
+static void (* const sim_vectors[SIM_IRQS])(void) =
+{
+  [FAULT_SYSTICK] = xPortSysTickHandler,
+  [INT_TA0_0] = TA0_0_IRQHandler,
+  [INT_TA1_0] = TA1_0_IRQHandler,
+  [INT_TA1_N] = TA1_N_IRQHandler,
+  [INT_EUSCIA0] = EUSCIA0_IRQHandler,
+  [INT_ADC14] = ADC_Handler,
+  [INT_T32_INT1] = T32_INT1_IRQHandler,
+  [INT_T32_INT2] = T32_INT2_IRQHandler,
+  [INT_DMA_INT3] = DMA_INT3_IRQHandler,
+  [INT_DMA_INT2] = DMA_INT2_IRQHandler,
+  [INT_DMA_INT1] = DMA_INT1_IRQHandler,
+  [INT_PORT1] = PORT1_IRQHandler,
+  [INT_PORT2] = PORT2_IRQHandler,
+  [INT_PORT3] = PORT3_IRQHandler,
+  [INT_PORT4] = PORT4_IRQHandler,
+  [INT_PORT5] = PORT5_IRQHandler,
+  [INT_PORT6] = PORT6_IRQHandler
+};
+
+static bool sim_irq_enabled[SIM_IRQS];
+static bool sim_irq_level[SIM_IRQS];
+static uint8_t sim_irq_priority[SIM_IRQS];
+static uint32_t sim_irq_count = 0;
+
+static uint32_t sim_primask = 0;
+
+// The kernel tick, started by the scheduler
+static bool sim_tick_running = false;
+static sim_time_t sim_tick_next;
+
+static uint8_t* sim_bus;
+static sim_bus_hook_t sim_bus_hooks[SIM_BUS_HOOKS];
+static uint8_t sim_bus_hooks_count = 0;
+
+// Page made writable for the single instruction that faulted on it
+static __thread uintptr_t sim_bus_page = 0;
+static __thread uintptr_t sim_bus_address;
+
+/*----------------------------------public------------------------------------*/
+
+sim_time_t sim_time(void)
+{
+  return sim_now;
+}
+
+// Time of the end of the given number of ticks of a hz clock
+sim_time_t sim_ticks_to_time(uint64_t ticks, uint32_t hz)
+{
+  return (sim_time_t)(((unsigned __int128) ticks * SIM_NS_PER_S + hz - 1) / hz);
+}
+
+// Ticks of a hz clock completed at time
+uint64_t sim_time_to_ticks(sim_time_t time, uint32_t hz)
+{
+  return (uint64_t)(((unsigned __int128) time * hz) / SIM_NS_PER_S);
+}
+
+/*
+ * Advances the virtual time up to time, delivering the interrupts on the way.
+ * An ISR may switch to another task that calls it again, so the state is
+ * read again after each delivery.
+ */
+void sim_run_until(sim_time_t time)
+{
+  sim_time_t next;
+
+  for (;;)
+  {
+    sim_deliver();
+
+    next = sim_next_event();
+    if (next > time)
+    {
+      break;
+    }
+
+    sim_advance(next);
+  }
+
+  if ((time != SIM_NEVER) && (time > sim_now))
+  {
+    sim_advance(time);
+    sim_deliver();
+  }
+}
+
+// Busy-waits cycles of MCLK
+void sim_wait_cycles(uint64_t cycles)
+{
+  sim_run_until(sim_now + sim_ticks_to_time(cycles, MAP_CS_getMCLK()));
+}
+
+void sim_stop(int status)
+{
+  sim_script_report();
+  fflush(stdout);
+  exit(status);
+}
+
+// Interrupt lines are level sensitive, models set them on every change
+void sim_irq_set(uint32_t irq, bool level)
+{
+  if (irq < SIM_IRQS)
+  {
+    sim_irq_level[irq] = level;
+  }
+}
+
+void* sim_bus_view(uintptr_t address)
+{
+  if ((address < SIM_BUS_BASE) || (address >= SIM_BUS_BASE + SIM_BUS_SIZE))
+  {
+    sim_error("register 0x%08lx is not simulated", (unsigned long) address);
+  }
+
+  return sim_bus + (address - SIM_BUS_BASE);
+}
+
+// Calls hook after every write of a driver to the registers of [base, base + size)
+void sim_bus_hook(uintptr_t base, uint32_t size, sim_write_hook_t hook)
+{
+  if (sim_bus_hooks_count >= SIM_BUS_HOOKS)
+  {
+    sim_error("too many register hooks");
+  }
+
+  sim_bus_hooks[sim_bus_hooks_count].base = base;
+  sim_bus_hooks[sim_bus_hooks_count].size = size;
+  sim_bus_hooks[sim_bus_hooks_count].hook = hook;
+  sim_bus_hooks_count++;
+}
+
+void sim_error(const char* format, ...)
+{
+  va_list args;
+
+  fflush(stdout);
+  fprintf(stderr, "%llu.%06llu error: ", sim_now / SIM_NS_PER_MS, sim_now % SIM_NS_PER_MS);
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+
+  exit(EXIT_FAILURE);
+}
+
+// One line per event, prefixed by the virtual time in milliseconds
+void sim_log(const char* format, ...)
+{
+  va_list args;
+
+  printf("%llu.%06llu ", sim_now / SIM_NS_PER_MS, sim_now % SIM_NS_PER_MS);
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+  putchar('\n');
+}
+
+/*------------------------------core intrinsics-------------------------------*/
+
+uint32_t sim_get_primask(void)
+{
+  return sim_primask;
+}
+
+// PRIMASK is a critical section of the port, enabling delivers what is pending
+void sim_set_primask(uint32_t primask)
+{
+  primask &= 1;
+  if (primask == sim_primask)
+  {
+    return;
+  }
+
+  sim_primask = primask;
+
+  if (primask != 0)
+  {
+    vPortEnterCritical();
+  }
+  else
+  {
+    vPortExitCritical();
+    sim_deliver();
+  }
+}
+
+// Sleeps until an enabled interrupt is pending, taken or not
+void sim_wait_for_interrupt(void)
+{
+  uint32_t count = sim_irq_count;
+
+  while ((sim_irq_count == count) && (sim_irq_pending() == 0))
+  {
+    sim_advance(sim_next_event());
+    sim_deliver();
+  }
+}
+
+/*-------------------------------driverlib API--------------------------------*/
+
+void Interrupt_enableInterrupt(uint32_t interruptNumber)
+{
+  if (interruptNumber < SIM_IRQS)
+  {
+    sim_irq_enabled[interruptNumber] = true;
+    sim_deliver();
+  }
+}
+
+void Interrupt_disableInterrupt(uint32_t interruptNumber)
+{
+  if (interruptNumber < SIM_IRQS)
+  {
+    sim_irq_enabled[interruptNumber] = false;
+  }
+}
+
+void Interrupt_setPriority(uint32_t interruptNumber, uint8_t priority)
+{
+  if (interruptNumber < SIM_IRQS)
+  {
+    sim_irq_priority[interruptNumber] = priority & SIM_IRQ_PRIORITY_MASK;
+  }
+}
+
+uint8_t Interrupt_getPriority(uint32_t interruptNumber)
+{
+  return (interruptNumber < SIM_IRQS) ? sim_irq_priority[interruptNumber] : 0;
+}
+
+// Both return true if the interrupts were disabled, as CPU_cpsie/cpsid
+bool Interrupt_enableMaster(void)
+{
+  bool disabled = (sim_primask != 0);
+
+  sim_set_primask(0);
+
+  return disabled;
+}
+
+bool Interrupt_disableMaster(void)
+{
+  bool disabled = (sim_primask != 0);
+
+  sim_set_primask(1);
+
+  return disabled;
+}
+
+void Interrupt_enableSleepOnIsrExit(void)
+{
+  sim_scb.SCR |= SCB_SCR_SLEEPONEXIT_Msk;
+}
+
+void Interrupt_disableSleepOnIsrExit(void)
+{
+  sim_scb.SCR &= ~SCB_SCR_SLEEPONEXIT_Msk;
+}
+
+// TivaWare semantics, three cycles per count
+void SysCtlDelay(uint32_t count)
+{
+  sim_wait_cycles((uint64_t) count * 3);
+}
+
+/*--------------------------------kernel hooks--------------------------------*/
+
+// Replaces the SIGALRM tick of the port with one in virtual time
+void vPortSetupTimerInterrupt(void)
+{
+  sim_irq_priority[FAULT_SYSTICK] = configKERNEL_INTERRUPT_PRIORITY;
+  sim_irq_enabled[FAULT_SYSTICK] = true;
+  sim_tick_next = sim_now + SIM_NS_PER_S / configTICK_RATE_HZ;
+  sim_tick_running = true;
+}
+
+// Nothing is ready to run, jump to the next event
+void vApplicationIdleHook(void)
+{
+  sim_run_until(sim_next_event());
+}
+
+/*---------------------------------private------------------------------------*/
+
+// Runs before main(), the script is the first argument of the program
+static void __attribute__((constructor)) sim_setup(int argc, char** argv)
+{
+  if (argc != 2)
+  {
+    fprintf(stderr, "usage: %s script\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+
+  sim_bus_setup();
+  sim_script_load(argv[1]);
+}
+
+static sim_time_t sim_next_event(void)
+{
+  sim_time_t next;
+  sim_time_t time;
+  uint8_t i;
+
+  next = sim_script_next_event();
+
+  if ((sim_tick_running == true) && (sim_tick_next < next))
+  {
+    next = sim_tick_next;
+  }
+
+  for (i = 0; i < sizeof(sim_models) / sizeof(sim_models[0]); i++)
+  {
+    time = sim_models[i]->next_event();
+    if (time < next)
+    {
+      next = time;
+    }
+  }
+
+  if (next == SIM_NEVER)
+  {
+    sim_error("nothing left to simulate");
+  }
+
+  /* An event already due is handled now */
+  return (next < sim_now) ? sim_now : next;
+}
+
+static void sim_advance(sim_time_t time)
+{
+  uint8_t i;
+
+  sim_now = time;
+
+  for (i = 0; i < sizeof(sim_models) / sizeof(sim_models[0]); i++)
+  {
+    sim_models[i]->advance(time);
+  }
+
+  if ((sim_tick_running == true) && (sim_tick_next <= time))
+  {
+    sim_irq_level[FAULT_SYSTICK] = true;
+    sim_tick_next += SIM_NS_PER_S / configTICK_RATE_HZ;
+  }
+
+  sim_script_advance(time);
+}
+
+// Takes the pending interrupts, most urgent first, unless they are masked
+static void sim_deliver(void)
+{
+  uint32_t irq;
+
+  while ((sim_primask == 0) && ((irq = sim_irq_pending()) != 0))
+  {
+    if (sim_vectors[irq] == NULL)
+    {
+      sim_error("interrupt %u has no handler", irq);
+    }
+
+    /* SysTick is an exception, pending until taken */
+    if (irq == FAULT_SYSTICK)
+    {
+      sim_irq_level[irq] = false;
+    }
+
+    if (xPortRunInterrupt(sim_vectors[irq]) == pdFALSE)
+    {
+      /* Masked by the port, taken at a later delivery */
+      if (irq == FAULT_SYSTICK)
+      {
+        sim_irq_level[irq] = true;
+      }
+      break;
+    }
+
+    sim_irq_count++;
+  }
+}
+
+// Lowest priority value first, then lowest number, as the NVIC
+static uint32_t sim_irq_pending(void)
+{
+  uint32_t irq;
+  uint32_t found = 0;
+
+  for (irq = FAULT_SYSTICK; irq < SIM_IRQS; irq++)
+  {
+    if ((sim_irq_enabled[irq] == true) && (sim_irq_level[irq] == true) &&
+        ((found == 0) || (sim_irq_priority[irq] < sim_irq_priority[found])))
+    {
+      found = irq;
+    }
+  }
+
+  return found;
+}
+
+/*
+ * The registers live in a memory file mapped twice: read-only at their real
+ * address for the drivers and writable for the models. A driver write faults,
+ * its page is opened for that single instruction, and the trap that follows
+ * closes it again and calls the hook of the register.
+ */
+static void sim_bus_setup(void)
+{
+  struct sigaction action;
+  void* view;
+  int fd;
+
+  fd = memfd_create("msp432-peripherals", 0);
+  if ((fd < 0) || (ftruncate(fd, SIM_BUS_SIZE) != 0))
+  {
+    sim_error("cannot create the register file");
+  }
+
+  view = mmap((void*) SIM_BUS_BASE, SIM_BUS_SIZE, PROT_READ, MAP_SHARED | MAP_FIXED_NOREPLACE, fd, 0);
+  if (view != (void*) SIM_BUS_BASE)
+  {
+    sim_error("cannot map the registers at 0x%08lx", (unsigned long) SIM_BUS_BASE);
+  }
+
+  sim_bus = mmap(NULL, SIM_BUS_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (sim_bus == MAP_FAILED)
+  {
+    sim_error("cannot map the register file");
+  }
+
+  close(fd);
+
+  memset(&action, 0, sizeof(action));
+  action.sa_flags = SA_SIGINFO | SA_NODEFER;
+  action.sa_sigaction = sim_bus_fault;
+  sigaction(SIGSEGV, &action, NULL);
+  action.sa_sigaction = sim_bus_trap;
+  sigaction(SIGTRAP, &action, NULL);
+}
+
+static void sim_bus_fault(int signal, siginfo_t* info, void* context)
+{
+  ucontext_t* ucontext = (ucontext_t*) context;
+  uintptr_t address = (uintptr_t) info->si_addr;
+
+  if ((address < SIM_BUS_BASE) || (address >= SIM_BUS_BASE + SIM_BUS_SIZE) || (sim_bus_page != 0))
+  {
+    /* A real fault, it happens again without the handler */
+    sigaction(signal, &(struct sigaction) { .sa_handler = SIG_DFL }, NULL);
+    return;
+  }
+
+  sim_bus_page = address & ~((uintptr_t) SIM_BUS_PAGE - 1);
+  sim_bus_address = address;
+  mprotect((void*) sim_bus_page, SIM_BUS_PAGE, PROT_READ | PROT_WRITE);
+
+  ucontext->uc_mcontext.gregs[REG_EFL] |= SIM_EFLAGS_TF;
+}
+
+static void sim_bus_trap(int signal, siginfo_t* info, void* context)
+{
+  ucontext_t* ucontext = (ucontext_t*) context;
+  uintptr_t address = sim_bus_address;
+  uint8_t i;
+
+  (void) info;
+
+  if (sim_bus_page == 0)
+  {
+    sigaction(signal, &(struct sigaction) { .sa_handler = SIG_DFL }, NULL);
+    raise(signal);
+    return;
+  }
+
+  ucontext->uc_mcontext.gregs[REG_EFL] &= ~SIM_EFLAGS_TF;
+  mprotect((void*) sim_bus_page, SIM_BUS_PAGE, PROT_READ);
+  sim_bus_page = 0;
+
+  for (i = 0; i < sim_bus_hooks_count; i++)
+  {
+    if ((address >= sim_bus_hooks[i].base) && (address < sim_bus_hooks[i].base + sim_bus_hooks[i].size))
+    {
+      sim_bus_hooks[i].hook(address);
+      break;
+    }
+  }
+}
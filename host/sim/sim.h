@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Discrete-event simulation of the MSP432 peripherals used by lib_PRAC, to
+ * run the application as a Linux process (see host/Makefile, target sim).
+ *
+ * The simulation implements the driverlib calls of the drivers and models
+ * each peripheral as a source of events in virtual time. Running code takes
+ * no virtual time: time only advances when the application waits, in the
+ * idle task, in a busy-wait on a peripheral or in a delay loop. Interrupts
+ * are delivered there and run the real ISRs through xPortRunInterrupt().
+ *
+ * The registers that the drivers access directly are mapped at their real
+ * addresses, read-only: every write traps into the model of the peripheral,
+ * so this needs Linux on x86-64.
+ */
+
+#ifndef SIM_H_
+#define SIM_H_
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/*---------------------------------defines------------------------------------*/
+
+#define SIM_NEVER                   ( UINT64_MAX )
+
+#define SIM_NS_PER_MS               ( 1000000ULL )
+#define SIM_NS_PER_S                ( 1000000000ULL )
+
+#define SIM_MIN(a, b)               ( ((a) < (b)) ? (a) : (b) )
+
+// Writable view of the registers at address, the drivers see a read-only one
+#define SIM_REGS(regs)              ( (__typeof__(regs)) sim_bus_view((uintptr_t)(regs)) )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+/* Nanoseconds of virtual time since reset */
+typedef uint64_t sim_time_t;
+
+/*
+ * A peripheral model. next_event() returns the time of its next event, or
+ * SIM_NEVER, and advance() updates its state and interrupt lines up to now.
+ */
+typedef struct
+{
+  const char* name;
+  sim_time_t (*next_event)(void);
+  void (*advance)(sim_time_t now);
+} sim_model_t;
+
+/* Called after a driver wrote the register at address */
+typedef void (*sim_write_hook_t)(uintptr_t address);
+
+/*--------------------------------prototypes----------------------------------*/
+
+/* sim.c */
+sim_time_t sim_time(void);
+sim_time_t sim_ticks_to_time(uint64_t ticks, uint32_t hz);
+uint64_t sim_time_to_ticks(sim_time_t time, uint32_t hz);
+void sim_run_until(sim_time_t time);
+void sim_wait_cycles(uint64_t cycles);
+void sim_stop(int status);
+
+void sim_irq_set(uint32_t irq, bool level);
+
+void* sim_bus_view(uintptr_t address);
+void sim_bus_hook(uintptr_t base, uint32_t size, sim_write_hook_t hook);
+
+void sim_error(const char* format, ...) __attribute__((format(printf, 1, 2), noreturn));
+void sim_log(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+/* sim_script.c */
+void sim_script_load(const char* path);
+sim_time_t sim_script_next_event(void);
+void sim_script_advance(sim_time_t now);
+void sim_script_display_changed(void);
+void sim_script_report(void);
+
+/* sim_system.c */
+uint32_t sim_clock_aclk(void);
+
+/* sim_gpio.c */
+bool sim_gpio_set_input(uint8_t port, uint16_t pins, bool high);
+bool sim_gpio_watch(uint8_t port, uint16_t pins);
+
+/* sim_timer.c */
+bool sim_timer_a_output_rises(uint8_t source, sim_time_t* time);
+
+/* sim_adc.c */
+bool sim_adc_set_input(uint8_t channel, uint16_t value);
+
+/* sim_eusci.c */
+void sim_uart_receive(const uint8_t* data, uint32_t length);
+void sim_uart_log(FILE* file);
+bool sim_lcd_snapshot(const char* path);
+
+/*--------------------------------variables-----------------------------------*/
+
+extern const sim_model_t sim_timer_a_model;
+extern const sim_model_t sim_timer32_model;
+extern const sim_model_t sim_adc_model;
+extern const sim_model_t sim_eusci_model;
+
+#endif /* SIM_H_ */
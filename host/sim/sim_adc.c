@@ -0,0 +1,557 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#define SIM_REGISTER_ACCESS
+
+#include <stddef.h>
+
+#include "driverlib.h"
+
+#include "sim.h"
+
+/*---------------------------------defines------------------------------------*/
+
+#define SIM_ADC_MEMORIES            ( 32 )
+#define SIM_ADC_FULL_SCALE          ( 0x3FFF )
+
+// An input nothing drives reads mid-scale, as the joystick at rest
+#define SIM_ADC_DEFAULT_INPUT       ( 0x2000 )
+
+// MODOSC and SYSOSC, the other sources are the system clocks
+#define SIM_ADC_MODOSC_HZ           ( 25000000 )
+#define SIM_ADC_SYSOSC_HZ           ( 5000000 )
+
+#define SIM_ADC_REGS                ( SIM_REGS(ADC14) )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  bool busy;
+  uint8_t memory;           // Converted now, or first of the next conversion
+  sim_time_t done;          // End of the conversion when busy
+  sim_time_t trigger;       // Next edge of the timer trigger
+  uint16_t inputs[SIM_ADC_MEMORIES];
+} sim_adc_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+static sim_time_t sim_adc_next_event(void);
+static void sim_adc_advance(sim_time_t now);
+static void sim_adc_hook(uintptr_t address);
+static uint8_t sim_adc_memory_index(uint32_t memory);
+static void sim_adc_start(sim_time_t time);
+static void sim_adc_complete(void);
+static void sim_adc_changed(void);
+
+/*--------------------------------variables-----------------------------------*/
+
+const sim_model_t sim_adc_model =
+{
+  "adc14", sim_adc_next_event, sim_adc_advance
+};
+
+static sim_adc_t sim_adc;
+
+// Sample-and-hold cycles of each ADC14SHTx code, and conversion cycles of each ADC14RES
+static const uint16_t sim_adc_sample_cycles[] = { 4, 8, 16, 32, 64, 96, 128, 192, 192, 192, 192, 192, 192, 192, 192, 192 };
+static const uint8_t sim_adc_convert_cycles[] = { 9, 11, 14, 16 };
+static const uint8_t sim_adc_predividers[] = { 1, 4, 32, 64 };
+
+/*----------------------------------public------------------------------------*/
+
+// Sets the 14-bit value of an analog input, converted from now on
+bool sim_adc_set_input(uint8_t channel, uint16_t value)
+{
+  if ((channel >= SIM_ADC_MEMORIES) || (value > SIM_ADC_FULL_SCALE))
+  {
+    return false;
+  }
+
+  sim_adc.inputs[channel] = value;
+
+  return true;
+}
+
+/*-------------------------------driverlib API--------------------------------*/
+
+void ADC14_enableModule(void)
+{
+  SIM_ADC_REGS->CTL0 |= ADC14_CTL0_ON;
+}
+
+bool ADC14_initModule(uint32_t clockSource, uint32_t clockPredivider, uint32_t clockDivider, uint32_t internalChannelMask)
+{
+  (void) internalChannelMask;
+
+  if (sim_adc.busy == true)
+  {
+    return false;
+  }
+
+  SIM_ADC_REGS->CTL0 = (SIM_ADC_REGS->CTL0 & ~(ADC14_CTL0_PDIV_MASK | ADC14_CTL0_DIV_MASK | ADC14_CTL0_SSEL_MASK)) |
+                       clockSource | clockPredivider | clockDivider;
+
+  return true;
+}
+
+bool ADC14_setSampleHoldTime(uint32_t firstPulseWidth, uint32_t secondPulseWidth)
+{
+  if (sim_adc.busy == true)
+  {
+    return false;
+  }
+
+  /* The pulse widths are encoded for SHT1 */
+  SIM_ADC_REGS->CTL0 = (SIM_ADC_REGS->CTL0 & ~(ADC14_CTL0_SHT0_MASK | ADC14_CTL0_SHT1_MASK)) |
+                       secondPulseWidth | (firstPulseWidth >> 4);
+
+  return true;
+}
+
+bool ADC14_setSampleHoldTrigger(uint32_t source, bool invertSignal)
+{
+  if (sim_adc.busy == true)
+  {
+    return false;
+  }
+
+  SIM_ADC_REGS->CTL0 = (SIM_ADC_REGS->CTL0 & ~(ADC14_CTL0_SHS_MASK | ADC14_CTL0_ISSH)) |
+                       source | ((invertSignal == true) ? ADC14_CTL0_ISSH : 0);
+
+  return true;
+}
+
+bool ADC14_configureSingleSampleMode(uint32_t memoryDestination, bool repeatMode)
+{
+  if (sim_adc.busy == true)
+  {
+    return false;
+  }
+
+  SIM_ADC_REGS->CTL1 = (SIM_ADC_REGS->CTL1 & ~ADC14_CTL1_CSTARTADD_MASK) |
+                       (sim_adc_memory_index(memoryDestination) << ADC14_CTL1_CSTARTADD_OFS);
+  SIM_ADC_REGS->CTL0 = (SIM_ADC_REGS->CTL0 & ~ADC14_CTL0_CONSEQ_MASK) |
+                       ((repeatMode == true) ? ADC14_CTL0_CONSEQ_2 : ADC14_CTL0_CONSEQ_0);
+
+  return true;
+}
+
+bool ADC14_configureMultiSequenceMode(uint32_t memoryStart, uint32_t memoryEnd, bool repeatMode)
+{
+  uint8_t i;
+
+  if (sim_adc.busy == true)
+  {
+    return false;
+  }
+
+  for (i = 0; i < SIM_ADC_MEMORIES; i++)
+  {
+    SIM_ADC_REGS->MCTL[i] &= ~ADC14_MCTLN_EOS;
+  }
+  SIM_ADC_REGS->MCTL[sim_adc_memory_index(memoryEnd)] |= ADC14_MCTLN_EOS;
+
+  SIM_ADC_REGS->CTL1 = (SIM_ADC_REGS->CTL1 & ~ADC14_CTL1_CSTARTADD_MASK) |
+                       (sim_adc_memory_index(memoryStart) << ADC14_CTL1_CSTARTADD_OFS);
+  SIM_ADC_REGS->CTL0 = (SIM_ADC_REGS->CTL0 & ~ADC14_CTL0_CONSEQ_MASK) |
+                       ((repeatMode == true) ? ADC14_CTL0_CONSEQ_3 : ADC14_CTL0_CONSEQ_1);
+
+  return true;
+}
+
+bool ADC14_configureConversionMemory(uint32_t memorySelect, uint32_t refSelect, uint32_t channelSelect, bool differntialMode)
+{
+  uint8_t i;
+
+  if (sim_adc.busy == true)
+  {
+    return false;
+  }
+
+  for (i = 0; i < SIM_ADC_MEMORIES; i++)
+  {
+    if ((memorySelect & (1u << i)) != 0)
+    {
+      SIM_ADC_REGS->MCTL[i] = (SIM_ADC_REGS->MCTL[i] & ~(ADC14_MCTLN_INCH_MASK | ADC14_MCTLN_VRSEL_MASK | ADC14_MCTLN_DIF)) |
+                              channelSelect | refSelect | ((differntialMode == true) ? ADC14_MCTLN_DIF : 0);
+    }
+  }
+
+  return true;
+}
+
+bool ADC14_enableComparatorWindow(uint32_t memorySelect, uint32_t windowSelect)
+{
+  uint8_t i;
+
+  for (i = 0; i < SIM_ADC_MEMORIES; i++)
+  {
+    if ((memorySelect & (1u << i)) != 0)
+    {
+      SIM_ADC_REGS->MCTL[i] = (SIM_ADC_REGS->MCTL[i] & ~ADC14_MCTLN_WINCTH) | ADC14_MCTLN_WINC |
+                              ((windowSelect == ADC_COMP_WINDOW1) ? ADC14_MCTLN_WINCTH : 0);
+    }
+  }
+
+  return true;
+}
+
+bool ADC14_disableComparatorWindow(uint32_t memorySelect)
+{
+  uint8_t i;
+
+  for (i = 0; i < SIM_ADC_MEMORIES; i++)
+  {
+    if ((memorySelect & (1u << i)) != 0)
+    {
+      SIM_ADC_REGS->MCTL[i] &= ~ADC14_MCTLN_WINC;
+    }
+  }
+
+  return true;
+}
+
+bool ADC14_setComparatorWindowValue(uint32_t window, int16_t low, int16_t high)
+{
+  if (window == ADC_COMP_WINDOW1)
+  {
+    SIM_ADC_REGS->LO1 = low;
+    SIM_ADC_REGS->HI1 = high;
+  }
+  else
+  {
+    SIM_ADC_REGS->LO0 = low;
+    SIM_ADC_REGS->HI0 = high;
+  }
+
+  return true;
+}
+
+bool ADC14_enableSampleTimer(uint32_t multiSampleConvert)
+{
+  if (sim_adc.busy == true)
+  {
+    return false;
+  }
+
+  SIM_ADC_REGS->CTL0 = (SIM_ADC_REGS->CTL0 & ~ADC14_CTL0_MSC) | ADC14_CTL0_SHP | multiSampleConvert;
+
+  return true;
+}
+
+// The conversion starts from the first memory of the sequence
+bool ADC14_enableConversion(void)
+{
+  if ((SIM_ADC_REGS->CTL0 & ADC14_CTL0_ENC) == 0)
+  {
+    sim_adc.memory = (SIM_ADC_REGS->CTL1 & ADC14_CTL1_CSTARTADD_MASK) >> ADC14_CTL1_CSTARTADD_OFS;
+  }
+
+  SIM_ADC_REGS->CTL0 |= ADC14_CTL0_ON | ADC14_CTL0_ENC;
+
+  return true;
+}
+
+// A conversion in progress still completes
+void ADC14_disableConversion(void)
+{
+  SIM_ADC_REGS->CTL0 &= ~(ADC14_CTL0_SC | ADC14_CTL0_ENC);
+}
+
+bool ADC14_toggleConversionTrigger(void)
+{
+  if ((SIM_ADC_REGS->CTL0 & ADC14_CTL0_SHS_MASK) != ADC_TRIGGER_ADCSC)
+  {
+    SIM_ADC_REGS->CTL0 ^= ADC14_CTL0_ISSH;
+    return true;
+  }
+
+  SIM_ADC_REGS->CTL0 |= ADC14_CTL0_SC;
+
+  if ((sim_adc.busy == false) && ((SIM_ADC_REGS->CTL0 & ADC14_CTL0_ENC) != 0))
+  {
+    sim_adc_start(sim_time());
+  }
+
+  return true;
+}
+
+// Polling waits for the conversion in virtual time
+bool ADC14_isBusy(void)
+{
+  if (sim_adc.busy == true)
+  {
+    sim_run_until(sim_adc.done);
+  }
+
+  return sim_adc.busy;
+}
+
+void ADC14_enableInterrupt(uint_fast64_t mask)
+{
+  SIM_ADC_REGS->IER0 |= (uint32_t) mask;
+  SIM_ADC_REGS->IER1 |= (uint32_t)(mask >> 32);
+  sim_adc_changed();
+}
+
+void ADC14_disableInterrupt(uint_fast64_t mask)
+{
+  SIM_ADC_REGS->IER0 &= ~(uint32_t) mask;
+  SIM_ADC_REGS->IER1 &= ~(uint32_t)(mask >> 32);
+  sim_adc_changed();
+}
+
+uint_fast64_t ADC14_getInterruptStatus(void)
+{
+  return ADC14->IFGR0 | ((uint_fast64_t) ADC14->IFGR1 << 32);
+}
+
+uint_fast64_t ADC14_getEnabledInterruptStatus(void)
+{
+  return (ADC14->IFGR0 & ADC14->IER0) | ((uint_fast64_t)(ADC14->IFGR1 & ADC14->IER1) << 32);
+}
+
+void ADC14_clearInterruptFlag(uint_fast64_t mask)
+{
+  SIM_ADC_REGS->IFGR0 &= ~(uint32_t) mask;
+  SIM_ADC_REGS->IFGR1 &= ~(uint32_t)(mask >> 32);
+  sim_adc_changed();
+}
+
+/*---------------------------------private------------------------------------*/
+
+static void __attribute__((constructor)) sim_adc_setup(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < SIM_ADC_MEMORIES; i++)
+  {
+    sim_adc.inputs[i] = SIM_ADC_DEFAULT_INPUT;
+  }
+  sim_adc.trigger = SIM_NEVER;
+
+  SIM_ADC_REGS->CTL1 = ADC14_CTL1_RES_3;
+  sim_bus_hook(ADC14_BASE, sizeof(ADC14_Type), sim_adc_hook);
+}
+
+static sim_time_t sim_adc_next_event(void)
+{
+  uint32_t source = (SIM_ADC_REGS->CTL0 & ADC14_CTL0_SHS_MASK) >> ADC14_CTL0_SHS_OFS;
+
+  if (sim_adc.busy == true)
+  {
+    return sim_adc.done;
+  }
+
+  /* Remembered, the timer has passed the edge when the ADC14 advances */
+  sim_adc.trigger = SIM_NEVER;
+  if (((SIM_ADC_REGS->CTL0 & ADC14_CTL0_ENC) != 0) && (source != 0))
+  {
+    sim_timer_a_output_rises(source, &sim_adc.trigger);
+  }
+
+  return sim_adc.trigger;
+}
+
+static void sim_adc_advance(sim_time_t now)
+{
+  for (;;)
+  {
+    if ((sim_adc.busy == true) && (sim_adc.done <= now))
+    {
+      sim_adc_complete();
+    }
+    else if ((sim_adc.busy == false) && (sim_adc.trigger <= now))
+    {
+      sim_adc_start(sim_adc.trigger);
+      sim_adc.trigger = SIM_NEVER;
+    }
+    else
+    {
+      break;
+    }
+  }
+}
+
+// Writes of the drivers: the interrupt enables and the flag clears
+static void sim_adc_hook(uintptr_t address)
+{
+  switch (address - ADC14_BASE)
+  {
+    case offsetof(ADC14_Type, CLRIFGR0):
+      SIM_ADC_REGS->IFGR0 &= ~SIM_ADC_REGS->CLRIFGR0;
+      SIM_ADC_REGS->CLRIFGR0 = 0;
+      break;
+    case offsetof(ADC14_Type, CLRIFGR1):
+      SIM_ADC_REGS->IFGR1 &= ~SIM_ADC_REGS->CLRIFGR1;
+      SIM_ADC_REGS->CLRIFGR1 = 0;
+      break;
+    default:
+      break;
+  }
+
+  sim_adc_changed();
+}
+
+static uint8_t sim_adc_memory_index(uint32_t memory)
+{
+  return (memory != 0) ? __builtin_ctz(memory) : 0;
+}
+
+// Samples and converts the current memory, the sample time depends on its number
+static void sim_adc_start(sim_time_t time)
+{
+  uint32_t ctl0 = SIM_ADC_REGS->CTL0;
+  uint32_t hz;
+  uint32_t cycles;
+  uint8_t sht;
+
+  switch (ctl0 & ADC14_CTL0_SSEL_MASK)
+  {
+    case ADC_CLOCKSOURCE_ADCOSC:
+      hz = SIM_ADC_MODOSC_HZ;
+      break;
+    case ADC_CLOCKSOURCE_SYSOSC:
+      hz = SIM_ADC_SYSOSC_HZ;
+      break;
+    case ADC_CLOCKSOURCE_ACLK:
+      hz = sim_clock_aclk();
+      break;
+    case ADC_CLOCKSOURCE_SMCLK:
+      hz = CS_getSMCLK();
+      break;
+    case ADC_CLOCKSOURCE_HSMCLK:
+      hz = CS_getHSMCLK();
+      break;
+    default:
+      hz = CS_getMCLK();
+      break;
+  }
+  hz /= sim_adc_predividers[(ctl0 & ADC14_CTL0_PDIV_MASK) >> ADC14_CTL0_PDIV_OFS];
+  hz /= ((ctl0 & ADC14_CTL0_DIV_MASK) >> ADC14_CTL0_DIV_OFS) + 1;
+
+  /* SHT1 times ADC14MEM8 to ADC14MEM23 */
+  if ((sim_adc.memory >= 8) && (sim_adc.memory <= 23))
+  {
+    sht = (ctl0 & ADC14_CTL0_SHT1_MASK) >> ADC14_CTL0_SHT1_OFS;
+  }
+  else
+  {
+    sht = (ctl0 & ADC14_CTL0_SHT0_MASK) >> ADC14_CTL0_SHT0_OFS;
+  }
+
+  cycles = sim_adc_sample_cycles[sht] + sim_adc_convert_cycles[(SIM_ADC_REGS->CTL1 & ADC14_CTL1_RES_MASK) >> ADC14_CTL1_RES_OFS];
+
+  sim_adc.busy = true;
+  sim_adc.done = time + sim_ticks_to_time(cycles, hz);
+  SIM_ADC_REGS->CTL0 = (ctl0 & ~ADC14_CTL0_SC) | ADC14_CTL0_BUSY;
+}
+
+/*
+ * Stores the result and sets the flags of the memory converted, then steps
+ * the sequence: the next conversion follows at once with ADC14MSC, otherwise
+ * it waits for the next trigger.
+ */
+static void sim_adc_complete(void)
+{
+  uint32_t ctl0 = SIM_ADC_REGS->CTL0;
+  uint32_t mctl = SIM_ADC_REGS->MCTL[sim_adc.memory];
+  uint32_t conseq = ctl0 & ADC14_CTL0_CONSEQ_MASK;
+  uint8_t bits = 8 + 2 * ((SIM_ADC_REGS->CTL1 & ADC14_CTL1_RES_MASK) >> ADC14_CTL1_RES_OFS);
+  uint16_t value;
+  int32_t low;
+  int32_t high;
+  bool last;
+
+  if (bits > 12)
+  {
+    bits = 14;
+  }
+  value = sim_adc.inputs[mctl & ADC14_MCTLN_INCH_MASK] >> (14 - bits);
+  SIM_ADC_REGS->MEM[sim_adc.memory] = value;
+  SIM_ADC_REGS->IFGR0 |= 1u << sim_adc.memory;
+
+  if ((mctl & ADC14_MCTLN_WINC) != 0)
+  {
+    low = (int32_t)(int16_t)(((mctl & ADC14_MCTLN_WINCTH) != 0) ? SIM_ADC_REGS->LO1 : SIM_ADC_REGS->LO0);
+    high = (int32_t)(int16_t)(((mctl & ADC14_MCTLN_WINCTH) != 0) ? SIM_ADC_REGS->HI1 : SIM_ADC_REGS->HI0);
+
+    if (value < low)
+    {
+      SIM_ADC_REGS->IFGR1 |= ADC14_IFGR1_LOIFG;
+    }
+    else if (value > high)
+    {
+      SIM_ADC_REGS->IFGR1 |= ADC14_IFGR1_HIIFG;
+    }
+    else
+    {
+      SIM_ADC_REGS->IFGR1 |= ADC14_IFGR1_INIFG;
+    }
+  }
+
+  sim_adc.busy = false;
+  ctl0 &= ~ADC14_CTL0_BUSY;
+
+  last = (conseq == ADC14_CTL0_CONSEQ_0) || (conseq == ADC14_CTL0_CONSEQ_2) ||
+         ((mctl & ADC14_MCTLN_EOS) != 0) || (sim_adc.memory == SIM_ADC_MEMORIES - 1);
+
+  if (last == true)
+  {
+    sim_adc.memory = (SIM_ADC_REGS->CTL1 & ADC14_CTL1_CSTARTADD_MASK) >> ADC14_CTL1_CSTARTADD_OFS;
+  }
+  else
+  {
+    sim_adc.memory++;
+  }
+
+  SIM_ADC_REGS->CTL0 = ctl0;
+
+  if (((ctl0 & ADC14_CTL0_ENC) != 0) && ((ctl0 & ADC14_CTL0_MSC) != 0) && ((ctl0 & ADC14_CTL0_SHP) != 0) &&
+      ((last == false) || (conseq == ADC14_CTL0_CONSEQ_2) || (conseq == ADC14_CTL0_CONSEQ_3)))
+  {
+    sim_adc_start(sim_adc.done);
+  }
+
+  sim_adc_changed();
+}
+
+static void sim_adc_changed(void)
+{
+  sim_irq_set(INT_ADC14, ((SIM_ADC_REGS->IFGR0 & SIM_ADC_REGS->IER0) != 0) ||
+                         ((SIM_ADC_REGS->IFGR1 & SIM_ADC_REGS->IER1) != 0));
+}
@@ -0,0 +1,596 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "driverlib.h"
+
+#include "sim.h"
+
+/*---------------------------------defines------------------------------------*/
+
+#define SIM_UART_BASE               ( EUSCI_A0_BASE )
+#define SIM_UART_RX_SIZE            ( 1024 )
+
+#define SIM_SPI_BASE                ( EUSCI_B0_BASE )
+
+// ST7735 on the SPI, data/command select on P3.7
+#define SIM_LCD_DC_PORT             ( GPIO_PORT_P3 )
+#define SIM_LCD_DC_PIN              ( GPIO_PIN7 )
+
+// Controller memory, the 128x128 panel starts at column 2 and row 1
+#define SIM_LCD_MEMORY_SIZE         ( 132 )
+#define SIM_LCD_SIZE                ( 128 )
+#define SIM_LCD_COLUMN_OFFSET       ( 2 )
+#define SIM_LCD_ROW_OFFSET          ( 1 )
+
+#define SIM_LCD_CASET               ( 0x2A )
+#define SIM_LCD_RASET               ( 0x2B )
+#define SIM_LCD_RAMWR               ( 0x2C )
+#define SIM_LCD_MADCTL              ( 0x36 )
+#define SIM_LCD_MADCTL_MY           ( 0x80 )
+#define SIM_LCD_MADCTL_MX           ( 0x40 )
+#define SIM_LCD_MADCTL_MV           ( 0x20 )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+/*
+ * UART: TXBUF feeds the shift register, TXIFG is set while TXBUF is empty.
+ * Received bytes arrive back to back, one character time apart.
+ */
+typedef struct
+{
+  bool enabled;
+  uint32_t hz;
+  uint32_t clocks_per_bit;
+  uint8_t bits;
+  uint8_t ie;
+  uint8_t ifg;
+  bool tx_shifting;
+  bool tx_full;
+  uint8_t tx_buffer;
+  uint8_t tx_shift;
+  sim_time_t tx_done;
+  uint8_t rx_buffer;
+  uint8_t rx_queue[SIM_UART_RX_SIZE];
+  uint16_t rx_head;
+  uint16_t rx_count;
+  sim_time_t rx_next;
+  FILE* log;
+} sim_uart_t;
+
+typedef struct
+{
+  uint32_t hz;
+  bool shifting;
+  bool full;
+  uint8_t buffer;
+  uint8_t shift;
+  bool shift_data;          // Level of data/command when the byte started
+  sim_time_t done;
+} sim_spi_t;
+
+typedef struct
+{
+  uint8_t command;
+  uint8_t count;            // Parameter bytes received for the command
+  uint8_t args[4];
+  uint16_t x_start;
+  uint16_t x_end;
+  uint16_t y_start;
+  uint16_t y_end;
+  uint16_t x;
+  uint16_t y;
+  uint8_t madctl;
+  uint8_t pixel_high;
+  uint16_t memory[SIM_LCD_MEMORY_SIZE][SIM_LCD_MEMORY_SIZE];
+} sim_lcd_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+static sim_time_t sim_eusci_next_event(void);
+static void sim_eusci_advance(sim_time_t now);
+static sim_uart_t* sim_uart(uint32_t base);
+static sim_time_t sim_uart_character_time(void);
+static void sim_uart_shift(sim_time_t time);
+static void sim_uart_changed(void);
+static sim_spi_t* sim_spi(uint32_t base);
+static void sim_spi_shift(sim_time_t time);
+static void sim_lcd_receive(uint8_t byte, bool data);
+static void sim_lcd_write_pixel(uint16_t pixel);
+
+/*--------------------------------variables-----------------------------------*/
+
+const sim_model_t sim_eusci_model =
+{
+  "eusci", sim_eusci_next_event, sim_eusci_advance
+};
+
+static sim_uart_t sim_uart_a0 = { .rx_next = SIM_NEVER };
+static sim_spi_t sim_spi_b0;
+static sim_lcd_t sim_lcd;
+
+/*----------------------------------public------------------------------------*/
+
+// Queues bytes sent to the UART by the other end of the line
+void sim_uart_receive(const uint8_t* data, uint32_t length)
+{
+  uint32_t i;
+
+  for (i = 0; i < length; i++)
+  {
+    if (sim_uart_a0.rx_count == SIM_UART_RX_SIZE)
+    {
+      sim_error("uart input queue full");
+    }
+
+    sim_uart_a0.rx_queue[(sim_uart_a0.rx_head + sim_uart_a0.rx_count) % SIM_UART_RX_SIZE] = data[i];
+    sim_uart_a0.rx_count++;
+  }
+
+  if ((sim_uart_a0.rx_next == SIM_NEVER) && (sim_uart_a0.enabled == true))
+  {
+    sim_uart_a0.rx_next = sim_time() + sim_uart_character_time();
+  }
+}
+
+// Bytes transmitted by the UART are written to file, NULL discards them
+void sim_uart_log(FILE* file)
+{
+  sim_uart_a0.log = file;
+}
+
+// Writes the panel as a binary PPM, as seen with LCD_ORIENTATION_UP
+bool sim_lcd_snapshot(const char* path)
+{
+  FILE* file;
+  uint16_t pixel;
+  uint8_t rgb[3];
+  uint16_t x;
+  uint16_t y;
+
+  file = fopen(path, "wb");
+  if (file == NULL)
+  {
+    return false;
+  }
+
+  fprintf(file, "P6\n%u %u\n255\n", SIM_LCD_SIZE, SIM_LCD_SIZE);
+
+  for (y = 0; y < SIM_LCD_SIZE; y++)
+  {
+    for (x = 0; x < SIM_LCD_SIZE; x++)
+    {
+      /* The panel is mounted rotated, orientation up mirrors both axes */
+      pixel = sim_lcd.memory[SIM_LCD_ROW_OFFSET + SIM_LCD_SIZE - 1 - y][SIM_LCD_COLUMN_OFFSET + SIM_LCD_SIZE - 1 - x];
+      rgb[0] = ((pixel >> 11) & 0x1F) << 3;
+      rgb[1] = ((pixel >> 5) & 0x3F) << 2;
+      rgb[2] = (pixel & 0x1F) << 3;
+      fwrite(rgb, sizeof(rgb), 1, file);
+    }
+  }
+
+  fclose(file);
+
+  return true;
+}
+
+/*--------------------------------driverlib UART------------------------------*/
+
+bool UART_initModule(uint32_t moduleInstance, const eUSCI_UART_Config* config)
+{
+  sim_uart_t* uart = sim_uart(moduleInstance);
+
+  uart->enabled = false;
+  uart->hz = (config->selectClockSource == EUSCI_A_UART_CLOCKSOURCE_ACLK) ? sim_clock_aclk() : CS_getSMCLK();
+
+  /* Without the UCBRSx modulation, under one clock per bit */
+  if (config->overSampling == EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION)
+  {
+    uart->clocks_per_bit = 16 * config->clockPrescalar + config->firstModReg;
+  }
+  else
+  {
+    uart->clocks_per_bit = config->clockPrescalar;
+  }
+
+  /* Start, data, parity and stop bits */
+  uart->bits = 1 + 8 + ((config->parity != EUSCI_A_UART_NO_PARITY) ? 1 : 0) +
+               ((config->numberofStopBits == EUSCI_A_UART_TWO_STOP_BITS) ? 2 : 1);
+
+  /* A reset stops the transfers and leaves only TXIFG set */
+  uart->ie = 0;
+  uart->ifg = EUSCI_A_UART_TRANSMIT_INTERRUPT_FLAG;
+  uart->tx_shifting = false;
+  uart->tx_full = false;
+  sim_uart_changed();
+
+  return true;
+}
+
+void UART_enableModule(uint32_t moduleInstance)
+{
+  sim_uart_t* uart = sim_uart(moduleInstance);
+
+  uart->enabled = true;
+  if ((uart->rx_count != 0) && (uart->rx_next == SIM_NEVER))
+  {
+    uart->rx_next = sim_time() + sim_uart_character_time();
+  }
+}
+
+void UART_enableInterrupt(uint32_t moduleInstance, uint_fast8_t mask)
+{
+  sim_uart(moduleInstance)->ie |= mask;
+  sim_uart_changed();
+}
+
+void UART_disableInterrupt(uint32_t moduleInstance, uint_fast8_t mask)
+{
+  sim_uart(moduleInstance)->ie &= ~mask;
+  sim_uart_changed();
+}
+
+uint_fast8_t UART_getInterruptStatus(uint32_t moduleInstance, uint8_t mask)
+{
+  return sim_uart(moduleInstance)->ifg & mask;
+}
+
+uint_fast8_t UART_getEnabledInterruptStatus(uint32_t moduleInstance)
+{
+  sim_uart_t* uart = sim_uart(moduleInstance);
+
+  return uart->ifg & uart->ie;
+}
+
+void UART_clearInterruptFlag(uint32_t moduleInstance, uint_fast8_t mask)
+{
+  sim_uart(moduleInstance)->ifg &= ~mask;
+  sim_uart_changed();
+}
+
+// Reading RXBUF clears RXIFG
+uint8_t UART_receiveData(uint32_t moduleInstance)
+{
+  sim_uart_t* uart = sim_uart(moduleInstance);
+
+  uart->ifg &= ~EUSCI_A_UART_RECEIVE_INTERRUPT_FLAG;
+  sim_uart_changed();
+
+  return uart->rx_buffer;
+}
+
+// Without the interrupt enabled, waits for TXBUF as driverlib does
+void UART_transmitData(uint32_t moduleInstance, uint_fast8_t transmitData)
+{
+  sim_uart_t* uart = sim_uart(moduleInstance);
+
+  if (((uart->ie & EUSCI_A_UART_TRANSMIT_INTERRUPT) == 0) && (uart->tx_full == true))
+  {
+    sim_run_until(uart->tx_done);
+  }
+
+  uart->tx_buffer = transmitData;
+  uart->tx_full = true;
+  uart->ifg &= ~EUSCI_A_UART_TRANSMIT_INTERRUPT_FLAG;
+
+  if (uart->tx_shifting == false)
+  {
+    sim_uart_shift(sim_time());
+  }
+
+  sim_uart_changed();
+}
+
+// Polling for the end of a transfer waits for it in virtual time
+uint_fast8_t UART_queryStatusFlags(uint32_t moduleInstance, uint_fast8_t mask)
+{
+  sim_uart_t* uart = sim_uart(moduleInstance);
+
+  if (uart->tx_shifting == true)
+  {
+    sim_run_until(uart->tx_done);
+  }
+
+  return ((uart->tx_shifting == true) ? EUSCI_A_UART_BUSY : 0) & mask;
+}
+
+/*--------------------------------driverlib SPI-------------------------------*/
+
+bool SPI_initMaster(uint32_t moduleInstance, const eUSCI_SPI_MasterConfig* config)
+{
+  sim_spi_t* spi = sim_spi(moduleInstance);
+  uint32_t source = (config->selectClockSource == EUSCI_B_SPI_CLOCKSOURCE_ACLK) ? sim_clock_aclk() : CS_getSMCLK();
+
+  /* UCBRx is computed from the frequency the caller claims */
+  spi->hz = source / (config->clockSourceFrequency / config->desiredSpiClock);
+  spi->shifting = false;
+  spi->full = false;
+
+  return true;
+}
+
+void SPI_enableModule(uint32_t moduleInstance)
+{
+  (void) sim_spi(moduleInstance);
+}
+
+void SPI_transmitData(uint32_t moduleInstance, uint_fast8_t transmitData)
+{
+  sim_spi_t* spi = sim_spi(moduleInstance);
+
+  if (spi->full == true)
+  {
+    sim_run_until(spi->done);
+  }
+
+  spi->buffer = transmitData;
+  spi->full = true;
+
+  if (spi->shifting == false)
+  {
+    sim_spi_shift(sim_time());
+  }
+}
+
+uint_fast8_t SPI_isBusy(uint32_t moduleInstance)
+{
+  sim_spi_t* spi = sim_spi(moduleInstance);
+
+  if (spi->shifting == true)
+  {
+    sim_run_until(spi->done);
+  }
+
+  return (spi->shifting == true) ? EUSCI_B_SPI_BUSY : EUSCI_B_SPI_NOT_BUSY;
+}
+
+/*---------------------------------private------------------------------------*/
+
+static sim_time_t sim_eusci_next_event(void)
+{
+  sim_time_t next = sim_uart_a0.rx_next;
+
+  if ((sim_uart_a0.tx_shifting == true) && (sim_uart_a0.tx_done < next))
+  {
+    next = sim_uart_a0.tx_done;
+  }
+
+  if ((sim_spi_b0.shifting == true) && (sim_spi_b0.done < next))
+  {
+    next = sim_spi_b0.done;
+  }
+
+  return next;
+}
+
+static void sim_eusci_advance(sim_time_t now)
+{
+  sim_uart_t* uart = &sim_uart_a0;
+  sim_spi_t* spi = &sim_spi_b0;
+
+  while ((uart->tx_shifting == true) && (uart->tx_done <= now))
+  {
+    if (uart->log != NULL)
+    {
+      fputc(uart->tx_shift, uart->log);
+    }
+
+    uart->tx_shifting = false;
+    if (uart->tx_full == true)
+    {
+      sim_uart_shift(uart->tx_done);
+    }
+  }
+
+  while (uart->rx_next <= now)
+  {
+    uart->rx_buffer = uart->rx_queue[uart->rx_head];
+    uart->rx_head = (uart->rx_head + 1) % SIM_UART_RX_SIZE;
+    uart->rx_count--;
+    uart->ifg |= EUSCI_A_UART_RECEIVE_INTERRUPT_FLAG;
+
+    uart->rx_next = (uart->rx_count != 0) ? (uart->rx_next + sim_uart_character_time()) : SIM_NEVER;
+  }
+
+  sim_uart_changed();
+
+  while ((spi->shifting == true) && (spi->done <= now))
+  {
+    sim_lcd_receive(spi->shift, spi->shift_data);
+
+    spi->shifting = false;
+    if (spi->full == true)
+    {
+      sim_spi_shift(spi->done);
+    }
+  }
+}
+
+static sim_uart_t* sim_uart(uint32_t base)
+{
+  if (base != SIM_UART_BASE)
+  {
+    sim_error("eUSCI 0x%08lx is not simulated as UART", (unsigned long) base);
+  }
+
+  return &sim_uart_a0;
+}
+
+static sim_time_t sim_uart_character_time(void)
+{
+  return sim_ticks_to_time((uint64_t) sim_uart_a0.bits * sim_uart_a0.clocks_per_bit, sim_uart_a0.hz);
+}
+
+// Moves TXBUF to the shift register at time, TXBUF is free again
+static void sim_uart_shift(sim_time_t time)
+{
+  sim_uart_t* uart = &sim_uart_a0;
+
+  uart->tx_shift = uart->tx_buffer;
+  uart->tx_full = false;
+  uart->tx_shifting = true;
+  uart->tx_done = time + sim_uart_character_time();
+  uart->ifg |= EUSCI_A_UART_TRANSMIT_INTERRUPT_FLAG;
+}
+
+static void sim_uart_changed(void)
+{
+  sim_irq_set(INT_EUSCIA0, (sim_uart_a0.ifg & sim_uart_a0.ie) != 0);
+}
+
+static sim_spi_t* sim_spi(uint32_t base)
+{
+  if (base != SIM_SPI_BASE)
+  {
+    sim_error("eUSCI 0x%08lx is not simulated as SPI", (unsigned long) base);
+  }
+
+  return &sim_spi_b0;
+}
+
+// The HAL keeps data/command stable while a byte is shifted
+static void sim_spi_shift(sim_time_t time)
+{
+  sim_spi_t* spi = &sim_spi_b0;
+
+  spi->shift = spi->buffer;
+  spi->shift_data = (GPIO_getInputPinValue(SIM_LCD_DC_PORT, SIM_LCD_DC_PIN) == GPIO_INPUT_PIN_HIGH);
+  spi->full = false;
+  spi->shifting = true;
+  spi->done = time + sim_ticks_to_time(8, spi->hz);
+}
+
+// Command decoder of the ST7735, only what changes the memory is kept
+static void sim_lcd_receive(uint8_t byte, bool data)
+{
+  sim_lcd_t* lcd = &sim_lcd;
+
+  if (data == false)
+  {
+    lcd->command = byte;
+    lcd->count = 0;
+
+    if (byte == SIM_LCD_RAMWR)
+    {
+      lcd->x = lcd->x_start;
+      lcd->y = lcd->y_start;
+    }
+    return;
+  }
+
+  switch (lcd->command)
+  {
+    case SIM_LCD_CASET:
+    case SIM_LCD_RASET:
+      if (lcd->count < 4)
+      {
+        lcd->args[lcd->count++] = byte;
+      }
+      if (lcd->count == 4)
+      {
+        if (lcd->command == SIM_LCD_CASET)
+        {
+          lcd->x_start = (lcd->args[0] << 8) | lcd->args[1];
+          lcd->x_end = (lcd->args[2] << 8) | lcd->args[3];
+        }
+        else
+        {
+          lcd->y_start = (lcd->args[0] << 8) | lcd->args[1];
+          lcd->y_end = (lcd->args[2] << 8) | lcd->args[3];
+        }
+      }
+      break;
+    case SIM_LCD_RAMWR:
+      /* RGB565, high byte first */
+      if ((lcd->count & 1) == 0)
+      {
+        lcd->pixel_high = byte;
+      }
+      else
+      {
+        sim_lcd_write_pixel((lcd->pixel_high << 8) | byte);
+      }
+      lcd->count ^= 1;
+      break;
+    case SIM_LCD_MADCTL:
+      lcd->madctl = byte;
+      break;
+    default:
+      break;
+  }
+}
+
+// Writes at the address counter then steps it through the window, as the MADCTL maps it
+static void sim_lcd_write_pixel(uint16_t pixel)
+{
+  sim_lcd_t* lcd = &sim_lcd;
+  uint16_t column = lcd->x;
+  uint16_t row = lcd->y;
+  uint16_t swap;
+
+  if ((lcd->madctl & SIM_LCD_MADCTL_MV) != 0)
+  {
+    swap = column;
+    column = row;
+    row = swap;
+  }
+  if ((lcd->madctl & SIM_LCD_MADCTL_MX) != 0)
+  {
+    column = SIM_LCD_MEMORY_SIZE - 1 - column;
+  }
+  if ((lcd->madctl & SIM_LCD_MADCTL_MY) != 0)
+  {
+    row = SIM_LCD_MEMORY_SIZE - 1 - row;
+  }
+
+  if ((column < SIM_LCD_MEMORY_SIZE) && (row < SIM_LCD_MEMORY_SIZE) && (lcd->memory[row][column] != pixel))
+  {
+    lcd->memory[row][column] = pixel;
+    sim_script_display_changed();
+  }
+
+  if (lcd->x < lcd->x_end)
+  {
+    lcd->x++;
+  }
+  else
+  {
+    lcd->x = lcd->x_start;
+    lcd->y = (lcd->y < lcd->y_end) ? (lcd->y + 1) : lcd->y_start;
+  }
+}
@@ -0,0 +1,278 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include "driverlib.h"
+
+#include "sim.h"
+
+/*---------------------------------defines------------------------------------*/
+
+// P1 to P10 and PJ, only P1 to P6 have pin interrupts
+#define SIM_GPIO_PORTS              ( 11 )
+#define SIM_GPIO_IRQ_PORTS          ( 6 )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  uint8_t dir;
+  uint8_t out;
+  uint8_t ren;
+  uint8_t sel;
+  uint8_t ies;
+  uint8_t ie;
+  uint8_t ifg;
+  uint8_t in;
+  uint8_t driven;   // Pins driven from outside, by the script
+  uint8_t external; // Their level
+  uint8_t watched;  // Output pins whose changes are logged
+} sim_gpio_port_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+static sim_gpio_port_t* sim_gpio_port(uint_fast8_t port);
+static void sim_gpio_update(uint_fast8_t port);
+
+/*--------------------------------variables-----------------------------------*/
+
+static sim_gpio_port_t sim_gpio_ports[SIM_GPIO_PORTS];
+
+/*----------------------------------public------------------------------------*/
+
+// Drives pins of port from outside, a pin configured as output wins
+bool sim_gpio_set_input(uint8_t port, uint16_t pins, bool high)
+{
+  sim_gpio_port_t* gpio = sim_gpio_port(port);
+
+  if (gpio == NULL)
+  {
+    return false;
+  }
+
+  gpio->driven |= pins;
+  gpio->external = (high == true) ? (gpio->external | pins) : (gpio->external & ~pins);
+  sim_gpio_update(port);
+
+  return true;
+}
+
+bool sim_gpio_watch(uint8_t port, uint16_t pins)
+{
+  sim_gpio_port_t* gpio = sim_gpio_port(port);
+
+  if (gpio == NULL)
+  {
+    return false;
+  }
+
+  gpio->watched |= pins;
+
+  return true;
+}
+
+/*-------------------------------driverlib API--------------------------------*/
+
+void GPIO_setAsOutputPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+  sim_gpio_port_t* gpio = sim_gpio_port(selectedPort);
+
+  gpio->sel &= ~selectedPins;
+  gpio->dir |= selectedPins;
+  sim_gpio_update(selectedPort);
+}
+
+void GPIO_setAsInputPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+  sim_gpio_port_t* gpio = sim_gpio_port(selectedPort);
+
+  gpio->sel &= ~selectedPins;
+  gpio->dir &= ~selectedPins;
+  gpio->ren &= ~selectedPins;
+  sim_gpio_update(selectedPort);
+}
+
+void GPIO_setAsInputPinWithPullUpResistor(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+  sim_gpio_port_t* gpio = sim_gpio_port(selectedPort);
+
+  gpio->sel &= ~selectedPins;
+  gpio->dir &= ~selectedPins;
+  gpio->ren |= selectedPins;
+  gpio->out |= selectedPins;
+  sim_gpio_update(selectedPort);
+}
+
+void GPIO_setAsInputPinWithPullDownResistor(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+  sim_gpio_port_t* gpio = sim_gpio_port(selectedPort);
+
+  gpio->sel &= ~selectedPins;
+  gpio->dir &= ~selectedPins;
+  gpio->ren |= selectedPins;
+  gpio->out &= ~selectedPins;
+  sim_gpio_update(selectedPort);
+}
+
+// The modules are modeled on their own, the pin only leaves the GPIO
+void GPIO_setAsPeripheralModuleFunctionOutputPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins, uint_fast8_t mode)
+{
+  (void) mode;
+
+  sim_gpio_port(selectedPort)->sel |= selectedPins;
+  sim_gpio_port(selectedPort)->dir |= selectedPins;
+}
+
+void GPIO_setAsPeripheralModuleFunctionInputPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins, uint_fast8_t mode)
+{
+  (void) mode;
+
+  sim_gpio_port(selectedPort)->sel |= selectedPins;
+  sim_gpio_port(selectedPort)->dir &= ~selectedPins;
+}
+
+void GPIO_setOutputHighOnPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+  sim_gpio_port(selectedPort)->out |= selectedPins;
+  sim_gpio_update(selectedPort);
+}
+
+void GPIO_setOutputLowOnPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+  sim_gpio_port(selectedPort)->out &= ~selectedPins;
+  sim_gpio_update(selectedPort);
+}
+
+void GPIO_toggleOutputOnPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+  sim_gpio_port(selectedPort)->out ^= selectedPins;
+  sim_gpio_update(selectedPort);
+}
+
+uint8_t GPIO_getInputPinValue(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+  return ((sim_gpio_port(selectedPort)->in & selectedPins) != 0) ? GPIO_INPUT_PIN_HIGH : GPIO_INPUT_PIN_LOW;
+}
+
+void GPIO_interruptEdgeSelect(uint_fast8_t selectedPort, uint_fast16_t selectedPins, uint_fast8_t edgeSelect)
+{
+  sim_gpio_port_t* gpio = sim_gpio_port(selectedPort);
+
+  if (edgeSelect == GPIO_HIGH_TO_LOW_TRANSITION)
+  {
+    gpio->ies |= selectedPins;
+  }
+  else
+  {
+    gpio->ies &= ~selectedPins;
+  }
+}
+
+void GPIO_enableInterrupt(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+  sim_gpio_port(selectedPort)->ie |= selectedPins;
+  sim_gpio_update(selectedPort);
+}
+
+void GPIO_disableInterrupt(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+  sim_gpio_port(selectedPort)->ie &= ~selectedPins;
+  sim_gpio_update(selectedPort);
+}
+
+void GPIO_clearInterruptFlag(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+  sim_gpio_port(selectedPort)->ifg &= ~selectedPins;
+  sim_gpio_update(selectedPort);
+}
+
+uint_fast16_t GPIO_getInterruptStatus(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+  return sim_gpio_port(selectedPort)->ifg & selectedPins;
+}
+
+uint_fast16_t GPIO_getEnabledInterruptStatus(uint_fast8_t selectedPort)
+{
+  sim_gpio_port_t* gpio = sim_gpio_port(selectedPort);
+
+  return gpio->ifg & gpio->ie;
+}
+
+/*---------------------------------private------------------------------------*/
+
+static sim_gpio_port_t* sim_gpio_port(uint_fast8_t port)
+{
+  if ((port < GPIO_PORT_P1) || (port > GPIO_PORT_PJ))
+  {
+    return NULL;
+  }
+
+  return &sim_gpio_ports[port - GPIO_PORT_P1];
+}
+
+// Recomputes the input levels, the edge flags and the port interrupt line
+static void sim_gpio_update(uint_fast8_t port)
+{
+  sim_gpio_port_t* gpio = sim_gpio_port(port);
+  uint8_t in;
+  uint8_t rising;
+  uint8_t falling;
+  uint8_t changed;
+  uint8_t pin;
+
+  /* Outputs read back, then what drives the pin, then the resistor */
+  in = (gpio->dir & gpio->out) |
+       (~gpio->dir & gpio->driven & gpio->external) |
+       (~gpio->dir & ~gpio->driven & gpio->ren & gpio->out);
+
+  rising = in & ~gpio->in;
+  falling = ~in & gpio->in;
+  changed = (in ^ gpio->in) & gpio->dir & gpio->watched;
+  gpio->in = in;
+
+  if (port <= GPIO_PORT_P6)
+  {
+    gpio->ifg |= (rising & ~gpio->ies) | (falling & gpio->ies);
+    sim_irq_set(INT_PORT1 + port - GPIO_PORT_P1, (gpio->ifg & gpio->ie) != 0);
+  }
+
+  for (pin = 0; changed != 0; pin++, changed >>= 1)
+  {
+    if ((changed & 1) != 0)
+    {
+      sim_log("gpio P%u.%u %u", port, pin, (in >> pin) & 1);
+    }
+  }
+}
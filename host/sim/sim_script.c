@@ -0,0 +1,409 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Input script of the simulation, one event per line:
+ *
+ *   <ms> button S1|S2 press|release   BoosterPack buttons, active low
+ *   <ms> pin P5.1 0|1                 drives an input pin
+ *   <ms> joystick x|y <value>         14-bit position of an axis
+ *   <ms> analog A15 <value>           14-bit level of an analog input
+ *   <ms> uart "text"                  received by the UART, \r and \n escaped
+ *   <ms> uart-log <path>              writes what the UART transmits to path
+ *   <ms> watch P1.0                   logs the changes of an output pin
+ *   <ms> snapshot <path>              writes the display as a PPM image
+ *   <ms> end                          stops, 1 s after the last event if missing
+ *
+ * Times are in milliseconds of virtual time, in order, and '#' starts a
+ * comment. The first display change after an input is logged as its latency.
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "driverlib.h"
+
+#include "sim.h"
+
+/*---------------------------------defines------------------------------------*/
+
+#define SIM_SCRIPT_LINE             ( 256 )
+#define SIM_SCRIPT_END_DELAY        ( 1000 * SIM_NS_PER_MS )
+
+// BoosterPack buttons, pulled up on the board
+#define SIM_SCRIPT_S1_PORT          ( GPIO_PORT_P5 )
+#define SIM_SCRIPT_S1_PIN           ( GPIO_PIN1 )
+#define SIM_SCRIPT_S2_PORT          ( GPIO_PORT_P3 )
+#define SIM_SCRIPT_S2_PIN           ( GPIO_PIN5 )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  sim_time_t time;
+  uint32_t line;
+  char command[16];
+  char args[SIM_SCRIPT_LINE];
+} sim_script_event_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+static void sim_script_run(const sim_script_event_t* event);
+static bool sim_script_pin(const char* name, uint8_t* port, uint16_t* pins);
+static uint32_t sim_script_string(const char* text, uint8_t* data, uint32_t size);
+static void sim_script_input(const sim_script_event_t* event);
+
+/*--------------------------------variables-----------------------------------*/
+
+static sim_script_event_t* sim_script_events = NULL;
+static uint32_t sim_script_count = 0;
+static uint32_t sim_script_next = 0;
+static const char* sim_script_path;
+
+// Input waiting for the display to change
+static bool sim_script_waiting = false;
+static sim_time_t sim_script_input_time;
+static char sim_script_input_name[SIM_SCRIPT_LINE + 16];
+
+static uint32_t sim_script_inputs = 0;
+static uint32_t sim_script_latencies = 0;
+static sim_time_t sim_script_latency_min = SIM_NEVER;
+static sim_time_t sim_script_latency_max = 0;
+static sim_time_t sim_script_latency_sum = 0;
+
+/*----------------------------------public------------------------------------*/
+
+void sim_script_load(const char* path)
+{
+  FILE* file;
+  char line[SIM_SCRIPT_LINE];
+  sim_script_event_t* event;
+  sim_time_t last = 0;
+  uint32_t number = 0;
+  double ms;
+  char* text;
+  int length;
+
+  file = fopen(path, "r");
+  if (file == NULL)
+  {
+    sim_error("cannot open %s", path);
+  }
+  sim_script_path = path;
+
+  while (fgets(line, sizeof(line), file) != NULL)
+  {
+    number++;
+
+    text = strchr(line, '#');
+    if ((text != NULL) && (strchr(line, '"') == NULL))
+    {
+      *text = '\0';
+    }
+    text = line + strspn(line, " \t\r\n");
+    if (*text == '\0')
+    {
+      continue;
+    }
+
+    sim_script_events = realloc(sim_script_events, (sim_script_count + 1) * sizeof(sim_script_event_t));
+    if (sim_script_events == NULL)
+    {
+      sim_error("out of memory");
+    }
+    event = &sim_script_events[sim_script_count];
+    memset(event, 0, sizeof(*event));
+
+    if (sscanf(text, "%lf %15s %n", &ms, event->command, &length) != 2)
+    {
+      sim_error("%s:%u: expected <ms> <command>", path, number);
+    }
+    strncpy(event->args, text + length, sizeof(event->args) - 1);
+    event->args[strcspn(event->args, "\r\n")] = '\0';
+    event->time = (sim_time_t)(ms * SIM_NS_PER_MS);
+    event->line = number;
+
+    if ((ms < 0) || (event->time < last))
+    {
+      sim_error("%s:%u: events must be in order", path, number);
+    }
+    last = event->time;
+    sim_script_count++;
+  }
+
+  fclose(file);
+
+  /* Both buttons start released */
+  sim_gpio_set_input(SIM_SCRIPT_S1_PORT, SIM_SCRIPT_S1_PIN, true);
+  sim_gpio_set_input(SIM_SCRIPT_S2_PORT, SIM_SCRIPT_S2_PIN, true);
+
+  if ((sim_script_count == 0) || (strcmp(sim_script_events[sim_script_count - 1].command, "end") != 0))
+  {
+    sim_script_events = realloc(sim_script_events, (sim_script_count + 1) * sizeof(sim_script_event_t));
+    if (sim_script_events == NULL)
+    {
+      sim_error("out of memory");
+    }
+    memset(&sim_script_events[sim_script_count], 0, sizeof(sim_script_event_t));
+    sim_script_events[sim_script_count].time = last + SIM_SCRIPT_END_DELAY;
+    strcpy(sim_script_events[sim_script_count].command, "end");
+    sim_script_count++;
+  }
+}
+
+sim_time_t sim_script_next_event(void)
+{
+  return (sim_script_next < sim_script_count) ? sim_script_events[sim_script_next].time : SIM_NEVER;
+}
+
+void sim_script_advance(sim_time_t now)
+{
+  while ((sim_script_next < sim_script_count) && (sim_script_events[sim_script_next].time <= now))
+  {
+    sim_script_run(&sim_script_events[sim_script_next++]);
+  }
+}
+
+// Called by the display model on every pixel that changes
+void sim_script_display_changed(void)
+{
+  sim_time_t latency;
+
+  if (sim_script_waiting == false)
+  {
+    return;
+  }
+  sim_script_waiting = false;
+
+  latency = sim_time() - sim_script_input_time;
+  sim_script_latencies++;
+  sim_script_latency_sum += latency;
+  if (latency < sim_script_latency_min)
+  {
+    sim_script_latency_min = latency;
+  }
+  if (latency > sim_script_latency_max)
+  {
+    sim_script_latency_max = latency;
+  }
+
+  sim_log("latency %llu.%06llu %s", latency / SIM_NS_PER_MS, latency % SIM_NS_PER_MS, sim_script_input_name);
+}
+
+void sim_script_report(void)
+{
+  sim_time_t average;
+
+  sim_log("report inputs %u displayed %u", sim_script_inputs, sim_script_latencies);
+
+  if (sim_script_latencies != 0)
+  {
+    average = sim_script_latency_sum / sim_script_latencies;
+    sim_log("report latency min %llu.%06llu avg %llu.%06llu max %llu.%06llu",
+            sim_script_latency_min / SIM_NS_PER_MS, sim_script_latency_min % SIM_NS_PER_MS,
+            average / SIM_NS_PER_MS, average % SIM_NS_PER_MS,
+            sim_script_latency_max / SIM_NS_PER_MS, sim_script_latency_max % SIM_NS_PER_MS);
+  }
+}
+
+/*---------------------------------private------------------------------------*/
+
+static void sim_script_run(const sim_script_event_t* event)
+{
+  uint8_t data[SIM_SCRIPT_LINE];
+  char name[16];
+  char value[16];
+  uint8_t port = 0;
+  uint16_t pins = 0;
+  unsigned int level;
+  FILE* file;
+  bool ok = false;
+
+  if (strcmp(event->command, "button") == 0)
+  {
+    if (sscanf(event->args, "%15s %15s", name, value) == 2)
+    {
+      if (strcmp(name, "S1") == 0)
+      {
+        port = SIM_SCRIPT_S1_PORT;
+        pins = SIM_SCRIPT_S1_PIN;
+        ok = true;
+      }
+      else if (strcmp(name, "S2") == 0)
+      {
+        port = SIM_SCRIPT_S2_PORT;
+        pins = SIM_SCRIPT_S2_PIN;
+        ok = true;
+      }
+      ok = ok && ((strcmp(value, "press") == 0) || (strcmp(value, "release") == 0));
+      ok = ok && sim_gpio_set_input(port, pins, strcmp(value, "release") == 0);
+      sim_script_input(event);
+    }
+  }
+  else if (strcmp(event->command, "pin") == 0)
+  {
+    ok = (sscanf(event->args, "%15s %u", name, &level) == 2) && (sim_script_pin(name, &port, &pins) == true) &&
+         (sim_gpio_set_input(port, pins, level != 0) == true);
+    sim_script_input(event);
+  }
+  else if (strcmp(event->command, "joystick") == 0)
+  {
+    if (sscanf(event->args, "%15s %u", name, &level) == 2)
+    {
+      ok = ((strcmp(name, "x") == 0) && (sim_adc_set_input(15, level) == true)) ||
+           ((strcmp(name, "y") == 0) && (sim_adc_set_input(8, level) == true));
+    }
+    sim_script_input(event);
+  }
+  else if (strcmp(event->command, "analog") == 0)
+  {
+    ok = (sscanf(event->args, "A%hhu %u", &port, &level) == 2) && (sim_adc_set_input(port, level) == true);
+    sim_script_input(event);
+  }
+  else if (strcmp(event->command, "uart") == 0)
+  {
+    level = sim_script_string(event->args, data, sizeof(data));
+    ok = (level != 0);
+    if (ok == true)
+    {
+      sim_uart_receive(data, level);
+    }
+    sim_script_input(event);
+  }
+  else if (strcmp(event->command, "uart-log") == 0)
+  {
+    file = fopen(event->args, "wb");
+    ok = (file != NULL);
+    sim_uart_log(file);
+  }
+  else if (strcmp(event->command, "watch") == 0)
+  {
+    ok = (sim_script_pin(event->args, &port, &pins) == true) && (sim_gpio_watch(port, pins) == true);
+  }
+  else if (strcmp(event->command, "snapshot") == 0)
+  {
+    ok = sim_lcd_snapshot(event->args);
+    sim_log("snapshot %s", event->args);
+  }
+  else if (strcmp(event->command, "end") == 0)
+  {
+    sim_log("end");
+    sim_stop(EXIT_SUCCESS);
+  }
+
+  if (ok == false)
+  {
+    sim_error("%s:%u: invalid %s %s", sim_script_path, event->line, event->command, event->args);
+  }
+}
+
+// Px.y or PJ.y
+static bool sim_script_pin(const char* name, uint8_t* port, uint16_t* pins)
+{
+  unsigned int number;
+  unsigned int pin;
+
+  if ((sscanf(name, "PJ.%u", &pin) == 1) && (pin < 8))
+  {
+    *port = GPIO_PORT_PJ;
+  }
+  else if ((sscanf(name, "P%u.%u", &number, &pin) == 2) && (number >= 1) && (number <= 10) && (pin < 8))
+  {
+    *port = GPIO_PORT_P1 + number - 1;
+  }
+  else
+  {
+    return false;
+  }
+
+  *pins = 1u << pin;
+
+  return true;
+}
+
+// Bytes of a quoted string with \r, \n, \t, \\ and \" escapes, 0 if invalid
+static uint32_t sim_script_string(const char* text, uint8_t* data, uint32_t size)
+{
+  uint32_t length = 0;
+
+  if (*text++ != '"')
+  {
+    return 0;
+  }
+
+  while ((*text != '"') && (*text != '\0') && (length < size))
+  {
+    if (*text == '\\')
+    {
+      text++;
+      switch (*text)
+      {
+        case 'r':
+          data[length++] = '\r';
+          break;
+        case 'n':
+          data[length++] = '\n';
+          break;
+        case 't':
+          data[length++] = '\t';
+          break;
+        case '\0':
+          return 0;
+        default:
+          data[length++] = *text;
+          break;
+      }
+    }
+    else
+    {
+      data[length++] = *text;
+    }
+    text++;
+  }
+
+  return (*text == '"') ? length : 0;
+}
+
+// Latency runs from the last input, an earlier one not displayed yet is dropped
+static void sim_script_input(const sim_script_event_t* event)
+{
+  snprintf(sim_script_input_name, sizeof(sim_script_input_name), "%s %s", event->command, event->args);
+  sim_log("input %s", sim_script_input_name);
+
+  sim_script_inputs++;
+  sim_script_waiting = true;
+  sim_script_input_time = sim_time();
+}
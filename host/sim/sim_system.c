@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include "driverlib.h"
+
+#include "sim.h"
+
+/*---------------------------------defines------------------------------------*/
+
+// Frequencies of the internal oscillators after reset
+#define SIM_CS_DCO_RESET_HZ         ( 3000000 )
+#define SIM_CS_VLO_HZ               ( 9400 )
+#define SIM_CS_REFO_HZ              ( 32768 )
+#define SIM_CS_MODOSC_HZ            ( 25000000 )
+
+#define SIM_CS_DIVIDER_OFS          ( 28 )
+
+#define SIM_CRC32_POLYNOMIAL        ( 0xEDB88320 )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef enum
+{
+  SIM_CS_MCLK = 0,
+  SIM_CS_HSMCLK,
+  SIM_CS_SMCLK,
+  SIM_CS_ACLK,
+  SIM_CS_SIGNALS
+} sim_cs_signal_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+static uint32_t sim_cs_get(sim_cs_signal_t signal);
+
+/*--------------------------------variables-----------------------------------*/
+
+static uint32_t sim_cs_dco_hz = SIM_CS_DCO_RESET_HZ;
+static uint32_t sim_cs_lfxt_hz = 0;
+static uint32_t sim_cs_hfxt_hz = 0;
+
+// CS_xxx_SELECT source and power of two divider of each clock signal
+static uint32_t sim_cs_source[SIM_CS_SIGNALS] =
+{
+  CS_DCOCLK_SELECT, CS_DCOCLK_SELECT, CS_DCOCLK_SELECT, CS_LFXTCLK_SELECT
+};
+static uint8_t sim_cs_divider[SIM_CS_SIGNALS];
+
+// Reflected CRC32 register, fed one byte at a time
+static uint32_t sim_crc32;
+
+/*----------------------------------public------------------------------------*/
+
+uint32_t sim_clock_aclk(void)
+{
+  return sim_cs_get(SIM_CS_ACLK);
+}
+
+/*---------------------------------driverlib CS-------------------------------*/
+
+void CS_setExternalClockSourceFrequency(uint32_t lfxt_XT_CLK_frequency, uint32_t hfxt_XT_CLK_frequency)
+{
+  sim_cs_lfxt_hz = lfxt_XT_CLK_frequency;
+  sim_cs_hfxt_hz = hfxt_XT_CLK_frequency;
+}
+
+// The crystals start at once
+bool CS_startLFXT(uint32_t xtDrive)
+{
+  (void) xtDrive;
+
+  return true;
+}
+
+bool CS_startHFXT(bool bypassMode)
+{
+  (void) bypassMode;
+
+  return true;
+}
+
+void CS_setDCOFrequency(uint32_t dcoFrequency)
+{
+  sim_cs_dco_hz = dcoFrequency;
+}
+
+// SMCLK and HSMCLK share their source
+void CS_initClockSignal(uint32_t selectedClockSignal, uint32_t clockSource, uint32_t clockSourceDivider)
+{
+  uint8_t divider = clockSourceDivider >> SIM_CS_DIVIDER_OFS;
+
+  switch (selectedClockSignal)
+  {
+    case CS_MCLK:
+      sim_cs_source[SIM_CS_MCLK] = clockSource;
+      sim_cs_divider[SIM_CS_MCLK] = divider;
+      break;
+    case CS_HSMCLK:
+    case CS_SMCLK:
+      sim_cs_source[SIM_CS_HSMCLK] = clockSource;
+      sim_cs_source[SIM_CS_SMCLK] = clockSource;
+      sim_cs_divider[(selectedClockSignal == CS_SMCLK) ? SIM_CS_SMCLK : SIM_CS_HSMCLK] = divider;
+      break;
+    case CS_ACLK:
+      sim_cs_source[SIM_CS_ACLK] = clockSource;
+      sim_cs_divider[SIM_CS_ACLK] = divider;
+      break;
+    default:
+      break;
+  }
+}
+
+uint32_t CS_getMCLK(void)
+{
+  return sim_cs_get(SIM_CS_MCLK);
+}
+
+uint32_t CS_getHSMCLK(void)
+{
+  return sim_cs_get(SIM_CS_HSMCLK);
+}
+
+uint32_t CS_getSMCLK(void)
+{
+  return sim_cs_get(SIM_CS_SMCLK);
+}
+
+uint32_t CS_getACLK(void)
+{
+  return sim_cs_get(SIM_CS_ACLK);
+}
+
+uint32_t CS_getDCOFrequency(void)
+{
+  return sim_cs_dco_hz;
+}
+
+/*------------------------------driverlib system------------------------------*/
+
+bool PCM_setCoreVoltageLevel(uint_fast8_t voltageLevel)
+{
+  (void) voltageLevel;
+
+  return true;
+}
+
+void FlashCtl_setWaitState(uint32_t bank, uint32_t waitState)
+{
+  (void) bank;
+  (void) waitState;
+}
+
+void FPU_enableModule(void)
+{
+}
+
+void WDT_A_holdTimer(void)
+{
+}
+
+void PMAP_configurePorts(const uint8_t* portMapping, uint8_t pxMAPy, uint8_t numberOfPorts, uint8_t portMapReconfigure)
+{
+  (void) portMapping;
+  (void) pxMAPy;
+  (void) numberOfPorts;
+  (void) portMapReconfigure;
+}
+
+/*-------------------------------driverlib CRC32------------------------------*/
+
+void CRC32_setSeed(uint32_t seed, uint_fast8_t crcType)
+{
+  (void) crcType;
+
+  sim_crc32 = seed;
+}
+
+void CRC32_set8BitData(uint8_t dataIn, uint_fast8_t crcType)
+{
+  uint8_t i;
+
+  (void) crcType;
+
+  sim_crc32 ^= dataIn;
+  for (i = 0; i < 8; i++)
+  {
+    sim_crc32 = (sim_crc32 >> 1) ^ ((sim_crc32 & 1) ? SIM_CRC32_POLYNOMIAL : 0);
+  }
+}
+
+uint32_t CRC32_getResultReversed(uint_fast8_t crcType)
+{
+  (void) crcType;
+
+  return sim_crc32;
+}
+
+/*
+ * The DMA is not modeled: channels are accepted but never transfer, so the
+ * streaming modes that rely on it produce no blocks.
+ */
+
+void DMA_enableModule(void)
+{
+}
+
+void DMA_setControlBase(void* controlTable)
+{
+  (void) controlTable;
+}
+
+void DMA_assignChannel(uint32_t mapping)
+{
+  (void) mapping;
+}
+
+void DMA_assignInterrupt(uint32_t interruptNumber, uint32_t channel)
+{
+  (void) interruptNumber;
+  (void) channel;
+}
+
+void DMA_enableInterrupt(uint32_t interruptNumber)
+{
+  (void) interruptNumber;
+}
+
+void DMA_disableInterrupt(uint32_t interruptNumber)
+{
+  (void) interruptNumber;
+}
+
+void DMA_clearInterruptFlag(uint32_t intChannel)
+{
+  (void) intChannel;
+}
+
+void DMA_enableChannel(uint32_t channelNum)
+{
+  (void) channelNum;
+}
+
+void DMA_disableChannel(uint32_t channelNum)
+{
+  (void) channelNum;
+}
+
+void DMA_disableChannelAttribute(uint32_t channelNum, uint32_t attr)
+{
+  (void) channelNum;
+  (void) attr;
+}
+
+uint32_t DMA_getChannelAttribute(uint32_t channelNum)
+{
+  (void) channelNum;
+
+  return 0;
+}
+
+void DMA_setChannelControl(uint32_t channelStructIndex, uint32_t control)
+{
+  (void) channelStructIndex;
+  (void) control;
+}
+
+void DMA_setChannelTransfer(uint32_t channelStructIndex, uint32_t mode, void* srcAddr, void* dstAddr, uint32_t transferSize)
+{
+  (void) channelStructIndex;
+  (void) mode;
+  (void) srcAddr;
+  (void) dstAddr;
+  (void) transferSize;
+}
+
+/*---------------------------------private------------------------------------*/
+
+static uint32_t sim_cs_get(sim_cs_signal_t signal)
+{
+  uint32_t hz;
+
+  switch (sim_cs_source[signal])
+  {
+    case CS_LFXTCLK_SELECT:
+      /* A missing crystal falls back to REFO */
+      hz = (sim_cs_lfxt_hz != 0) ? sim_cs_lfxt_hz : SIM_CS_REFO_HZ;
+      break;
+    case CS_HFXTCLK_SELECT:
+      hz = sim_cs_hfxt_hz;
+      break;
+    case CS_VLOCLK_SELECT:
+      hz = SIM_CS_VLO_HZ;
+      break;
+    case CS_REFOCLK_SELECT:
+      hz = SIM_CS_REFO_HZ;
+      break;
+    case CS_MODOSC_SELECT:
+      hz = SIM_CS_MODOSC_HZ;
+      break;
+    default:
+      hz = sim_cs_dco_hz;
+      break;
+  }
+
+  return hz >> sim_cs_divider[signal];
+}
@@ -0,0 +1,698 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#define SIM_REGISTER_ACCESS
+
+#include <stddef.h>
+
+#include "driverlib.h"
+
+#include "sim.h"
+
+/*---------------------------------defines------------------------------------*/
+
+#define SIM_TIMER_A_COUNT           ( 4 )
+#define SIM_TIMER_A_CCRS            ( 5 )
+#define SIM_TIMER_A_SIZE            ( 0x400 )
+
+#define SIM_TIMER32_COUNT           ( 2 )
+#define SIM_TIMER32_SIZE            ( 0x20 )
+
+// Register index of a TIMER_A_CAPTURECOMPARE_REGISTER_x
+#define SIM_TIMER_A_CCR_INDEX(ccr)  ( ((ccr) >> 1) - 1 )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+/*
+ * The counter is not stored, it is derived from the virtual time: it held
+ * count at start, and ticks of it since start have been accounted already.
+ */
+typedef struct
+{
+  uintptr_t base;
+  uint32_t irq_ccr0;
+  uint32_t irq_n;
+  uint32_t hz;
+  sim_time_t start;
+  uint32_t count;
+  uint64_t ticks;
+} sim_timer_a_t;
+
+typedef struct
+{
+  uintptr_t base;
+  uint32_t irq;
+  uint32_t hz;
+  sim_time_t start;
+  uint32_t value;
+  uint64_t ticks;
+} sim_timer32_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+static sim_time_t sim_timer_a_next_event(void);
+static void sim_timer_a_advance(sim_time_t now);
+static void sim_timer_a_hook(uintptr_t address);
+static sim_timer_a_t* sim_timer_a(uint32_t base);
+static uint32_t sim_timer_a_period(sim_timer_a_t* timer);
+static uint32_t sim_timer_a_distance(uint32_t from, uint32_t to, uint32_t period);
+static sim_time_t sim_timer_a_next(sim_timer_a_t* timer);
+static void sim_timer_a_count(sim_timer_a_t* timer, sim_time_t now);
+static void sim_timer_a_changed(sim_timer_a_t* timer);
+static void sim_timer_a_set_divider(sim_timer_a_t* timer, uint32_t divider);
+
+static sim_time_t sim_timer32_next_event(void);
+static void sim_timer32_advance(sim_time_t now);
+static void sim_timer32_hook(uintptr_t address);
+static sim_timer32_t* sim_timer32(uint32_t base);
+static uint32_t sim_timer32_reload(sim_timer32_t* timer);
+static uint64_t sim_timer32_distance(sim_timer32_t* timer);
+static void sim_timer32_count(sim_timer32_t* timer, sim_time_t now);
+static void sim_timer32_changed(sim_timer32_t* timer);
+
+/*--------------------------------variables-----------------------------------*/
+
+const sim_model_t sim_timer_a_model =
+{
+  "timer_a", sim_timer_a_next_event, sim_timer_a_advance
+};
+
+const sim_model_t sim_timer32_model =
+{
+  "timer32", sim_timer32_next_event, sim_timer32_advance
+};
+
+static sim_timer_a_t sim_timers_a[SIM_TIMER_A_COUNT] =
+{
+  { TIMER_A0_BASE, INT_TA0_0, INT_TA0_N },
+  { TIMER_A1_BASE, INT_TA1_0, INT_TA1_N },
+  { TIMER_A2_BASE, INT_TA2_0, INT_TA2_N },
+  { TIMER_A3_BASE, INT_TA3_0, INT_TA3_N }
+};
+
+static sim_timer32_t sim_timers32[SIM_TIMER32_COUNT] =
+{
+  { TIMER32_0_BASE, INT_T32_INT1 },
+  { TIMER32_1_BASE, INT_T32_INT2 }
+};
+
+/*----------------------------------public------------------------------------*/
+
+// ADC14 trigger sources 1 to 7 are the outputs of TA0.1 to TA3.1
+bool sim_timer_a_output_rises(uint8_t source, sim_time_t* time)
+{
+  sim_timer_a_t* timer = &sim_timers_a[(source - 1) / 2];
+  Timer_A_Type* regs = SIM_REGS((Timer_A_Type*) timer->base);
+  uint8_t ccr = 1 + (source - 1) % 2;
+  uint32_t period;
+  uint32_t at;
+
+  if ((timer->hz == 0) || ((regs->CTL & TIMER_A_CTL_MC_MASK) == TIMER_A_STOP_MODE))
+  {
+    return false;
+  }
+
+  /* Only the PWM modes that set the output once per period */
+  switch (regs->CCTL[ccr] & TIMER_A_CCTLN_OUTMOD_MASK)
+  {
+    case TIMER_A_OUTPUTMODE_SET:
+    case TIMER_A_OUTPUTMODE_SET_RESET:
+      at = regs->CCR[ccr];
+      break;
+    case TIMER_A_OUTPUTMODE_TOGGLE_SET:
+    case TIMER_A_OUTPUTMODE_RESET_SET:
+      at = regs->CCR[0];
+      break;
+    default:
+      return false;
+  }
+
+  period = sim_timer_a_period(timer);
+  if (at >= period)
+  {
+    return false;
+  }
+
+  *time = timer->start + sim_ticks_to_time(timer->ticks + sim_timer_a_distance(regs->R, at, period), timer->hz);
+
+  return true;
+}
+
+/*-----------------------------driverlib Timer_A------------------------------*/
+
+void Timer_A_configureContinuousMode(uint32_t timer, const Timer_A_ContinuousModeConfig* config)
+{
+  sim_timer_a_t* sim = sim_timer_a(timer);
+  Timer_A_Type* regs = SIM_REGS(TIMER_A_CMSIS(timer));
+
+  sim_timer_a_set_divider(sim, config->clockSourceDivider);
+  regs->CTL = (regs->CTL & ~(TIMER_A_CLOCKSOURCE_INVERTED_EXTERNAL_TXCLK | TIMER_A_UPDOWN_MODE |
+                             TIMER_A_DO_CLEAR | TIMER_A_TAIE_INTERRUPT_ENABLE)) |
+              config->clockSource | config->timerClear | config->timerInterruptEnable_TAIE;
+  sim_timer_a_changed(sim);
+}
+
+void Timer_A_configureUpMode(uint32_t timer, const Timer_A_UpModeConfig* config)
+{
+  sim_timer_a_t* sim = sim_timer_a(timer);
+  Timer_A_Type* regs = SIM_REGS(TIMER_A_CMSIS(timer));
+
+  sim_timer_a_set_divider(sim, config->clockSourceDivider);
+  regs->CTL = (regs->CTL & ~(TIMER_A_CLOCKSOURCE_INVERTED_EXTERNAL_TXCLK | TIMER_A_UPDOWN_MODE |
+                             TIMER_A_DO_CLEAR | TIMER_A_TAIE_INTERRUPT_ENABLE)) |
+              config->clockSource | config->timerClear | config->timerInterruptEnable_TAIE;
+  if (config->captureCompareInterruptEnable_CCR0_CCIE == TIMER_A_CCIE_CCR0_INTERRUPT_ENABLE)
+  {
+    regs->CCTL[0] |= TIMER_A_CCTLN_CCIE;
+  }
+  else
+  {
+    regs->CCTL[0] &= ~TIMER_A_CCTLN_CCIE;
+  }
+  regs->CCR[0] = config->timerPeriod;
+  sim_timer_a_changed(sim);
+}
+
+void Timer_A_generatePWM(uint32_t timer, const Timer_A_PWMConfig* config)
+{
+  sim_timer_a_t* sim = sim_timer_a(timer);
+  Timer_A_Type* regs = SIM_REGS(TIMER_A_CMSIS(timer));
+  uint8_t index = SIM_TIMER_A_CCR_INDEX(config->compareRegister);
+
+  sim_timer_a_set_divider(sim, config->clockSourceDivider);
+  regs->CTL = (regs->CTL & ~(TIMER_A_CLOCKSOURCE_INVERTED_EXTERNAL_TXCLK | TIMER_A_UPDOWN_MODE | TIMER_A_DO_CLEAR)) |
+              config->clockSource | TIMER_A_UP_MODE | TIMER_A_DO_CLEAR;
+  regs->CCR[0] = config->timerPeriod;
+  regs->CCTL[0] &= ~(TIMER_A_CCTLN_CCIE | TIMER_A_OUTPUTMODE_RESET_SET);
+  regs->CCTL[index] |= config->compareOutputMode;
+  regs->CCR[index] = config->dutyCycle;
+  sim_timer_a_changed(sim);
+}
+
+void Timer_A_startCounter(uint32_t timer, uint_fast16_t timerMode)
+{
+  SIM_REGS(TIMER_A_CMSIS(timer))->CTL |= timerMode;
+  sim_timer_a_changed(sim_timer_a(timer));
+}
+
+void Timer_A_stopTimer(uint32_t timer)
+{
+  SIM_REGS(TIMER_A_CMSIS(timer))->CTL &= ~TIMER_A_CTL_MC_MASK;
+  sim_timer_a_changed(sim_timer_a(timer));
+}
+
+void Timer_A_enableCaptureCompareInterrupt(uint32_t timer, uint_fast16_t captureCompareRegister)
+{
+  SIM_REGS(TIMER_A_CMSIS(timer))->CCTL[SIM_TIMER_A_CCR_INDEX(captureCompareRegister)] |= TIMER_A_CCTLN_CCIE;
+  sim_timer_a_changed(sim_timer_a(timer));
+}
+
+void Timer_A_disableCaptureCompareInterrupt(uint32_t timer, uint_fast16_t captureCompareRegister)
+{
+  SIM_REGS(TIMER_A_CMSIS(timer))->CCTL[SIM_TIMER_A_CCR_INDEX(captureCompareRegister)] &= ~TIMER_A_CCTLN_CCIE;
+  sim_timer_a_changed(sim_timer_a(timer));
+}
+
+void Timer_A_clearCaptureCompareInterrupt(uint32_t timer, uint_fast16_t captureCompareRegister)
+{
+  SIM_REGS(TIMER_A_CMSIS(timer))->CCTL[SIM_TIMER_A_CCR_INDEX(captureCompareRegister)] &= ~(TIMER_A_CCTLN_CCIFG | TIMER_A_CCTLN_COV);
+  sim_timer_a_changed(sim_timer_a(timer));
+}
+
+void Timer_A_clearInterruptFlag(uint32_t timer)
+{
+  SIM_REGS(TIMER_A_CMSIS(timer))->CTL &= ~TIMER_A_CTL_IFG;
+  sim_timer_a_changed(sim_timer_a(timer));
+}
+
+void Timer_A_setCompareValue(uint32_t timer, uint_fast16_t compareRegister, uint_fast16_t compareValue)
+{
+  SIM_REGS(TIMER_A_CMSIS(timer))->CCR[SIM_TIMER_A_CCR_INDEX(compareRegister)] = compareValue;
+  sim_timer_a_changed(sim_timer_a(timer));
+}
+
+uint16_t Timer_A_getCounterValue(uint32_t timer)
+{
+  return TIMER_A_CMSIS(timer)->R;
+}
+
+/*-----------------------------driverlib Timer32------------------------------*/
+
+void Timer32_initModule(uint32_t timer, uint32_t preScaler, uint32_t resolution, uint32_t mode)
+{
+  Timer32_Type* regs = SIM_REGS(TIMER32_CMSIS(timer));
+  uint32_t control = regs->CONTROL & ~(TIMER32_CONTROL_MODE | TIMER32_CONTROL_SIZE | TIMER32_CONTROL_PRESCALE_MASK);
+
+  if (mode == TIMER32_PERIODIC_MODE)
+  {
+    control |= TIMER32_CONTROL_MODE;
+  }
+  if (resolution == TIMER32_32BIT)
+  {
+    control |= TIMER32_CONTROL_SIZE;
+  }
+  regs->CONTROL = control | preScaler;
+  sim_timer32_changed(sim_timer32(timer));
+}
+
+// Writing the load restarts the count from it
+void Timer32_setCount(uint32_t timer, uint32_t count)
+{
+  Timer32_Type* regs = SIM_REGS(TIMER32_CMSIS(timer));
+
+  if (((regs->CONTROL & TIMER32_CONTROL_SIZE) == 0) && (count > UINT16_MAX))
+  {
+    count = UINT16_MAX;
+  }
+  regs->LOAD = count;
+  regs->VALUE = count;
+  sim_timer32_changed(sim_timer32(timer));
+}
+
+void Timer32_startTimer(uint32_t timer, bool oneShot)
+{
+  Timer32_Type* regs = SIM_REGS(TIMER32_CMSIS(timer));
+
+  regs->CONTROL = (regs->CONTROL & ~TIMER32_CONTROL_ONESHOT) |
+                  ((oneShot == true) ? TIMER32_CONTROL_ONESHOT : 0) | TIMER32_CONTROL_ENABLE;
+  sim_timer32_changed(sim_timer32(timer));
+}
+
+void Timer32_haltTimer(uint32_t timer)
+{
+  SIM_REGS(TIMER32_CMSIS(timer))->CONTROL &= ~TIMER32_CONTROL_ENABLE;
+  sim_timer32_changed(sim_timer32(timer));
+}
+
+void Timer32_enableInterrupt(uint32_t timer)
+{
+  SIM_REGS(TIMER32_CMSIS(timer))->CONTROL |= TIMER32_CONTROL_IE;
+  sim_timer32_changed(sim_timer32(timer));
+}
+
+void Timer32_disableInterrupt(uint32_t timer)
+{
+  SIM_REGS(TIMER32_CMSIS(timer))->CONTROL &= ~TIMER32_CONTROL_IE;
+  sim_timer32_changed(sim_timer32(timer));
+}
+
+void Timer32_clearInterruptFlag(uint32_t timer)
+{
+  SIM_REGS(TIMER32_CMSIS(timer))->RIS = 0;
+  sim_timer32_changed(sim_timer32(timer));
+}
+
+uint32_t Timer32_getValue(uint32_t timer)
+{
+  return TIMER32_CMSIS(timer)->VALUE;
+}
+
+/*---------------------------------private------------------------------------*/
+
+// Registers hold their reset values, then every driver write is hooked
+static void __attribute__((constructor)) sim_timer_setup(void)
+{
+  uint8_t i;
+
+  for (i = 0; i < SIM_TIMER_A_COUNT; i++)
+  {
+    sim_bus_hook(sim_timers_a[i].base, SIM_TIMER_A_SIZE, sim_timer_a_hook);
+  }
+
+  for (i = 0; i < SIM_TIMER32_COUNT; i++)
+  {
+    SIM_REGS(TIMER32_CMSIS(sim_timers32[i].base))->VALUE = 0xFFFFFFFF;
+    SIM_REGS(TIMER32_CMSIS(sim_timers32[i].base))->CONTROL = TIMER32_CONTROL_IE;
+    sim_bus_hook(sim_timers32[i].base, SIM_TIMER32_SIZE, sim_timer32_hook);
+  }
+}
+
+static sim_time_t sim_timer_a_next_event(void)
+{
+  sim_time_t next = SIM_NEVER;
+  sim_time_t time;
+  uint8_t i;
+
+  for (i = 0; i < SIM_TIMER_A_COUNT; i++)
+  {
+    time = sim_timer_a_next(&sim_timers_a[i]);
+    if (time < next)
+    {
+      next = time;
+    }
+  }
+
+  return next;
+}
+
+static void sim_timer_a_advance(sim_time_t now)
+{
+  uint8_t i;
+
+  for (i = 0; i < SIM_TIMER_A_COUNT; i++)
+  {
+    sim_timer_a_count(&sim_timers_a[i], now);
+  }
+}
+
+static void sim_timer_a_hook(uintptr_t address)
+{
+  sim_timer_a_changed(sim_timer_a(address & ~(SIM_TIMER_A_SIZE - 1)));
+}
+
+static sim_timer_a_t* sim_timer_a(uint32_t base)
+{
+  return &sim_timers_a[(base - TIMER_A0_BASE) / SIM_TIMER_A_SIZE];
+}
+
+// Counts per period, up mode wraps after CCR0 and continuous mode after 0xFFFF
+static uint32_t sim_timer_a_period(sim_timer_a_t* timer)
+{
+  Timer_A_Type* regs = SIM_REGS((Timer_A_Type*) timer->base);
+
+  if ((regs->CTL & TIMER_A_CTL_MC_MASK) == TIMER_A_CONTINUOUS_MODE)
+  {
+    return 0x10000;
+  }
+
+  return regs->CCR[0] + 1;
+}
+
+// Ticks until the counter goes from from to to, a whole period if equal
+static uint32_t sim_timer_a_distance(uint32_t from, uint32_t to, uint32_t period)
+{
+  return (to > from) ? (to - from) : (to + period - from);
+}
+
+// Time of the next flag that interrupts, or that the ADC14 may be waiting for
+static sim_time_t sim_timer_a_next(sim_timer_a_t* timer)
+{
+  Timer_A_Type* regs = SIM_REGS((Timer_A_Type*) timer->base);
+  uint32_t period;
+  uint32_t distance = UINT32_MAX;
+  uint8_t i;
+
+  if ((timer->hz == 0) || ((regs->CTL & TIMER_A_CTL_MC_MASK) == TIMER_A_STOP_MODE))
+  {
+    return SIM_NEVER;
+  }
+
+  period = sim_timer_a_period(timer);
+
+  for (i = 0; i < SIM_TIMER_A_CCRS; i++)
+  {
+    if ((regs->CCR[i] < period) && (((regs->CCTL[i] & TIMER_A_CCTLN_CCIE) != 0) || (regs->CCTL[i] & TIMER_A_CCTLN_OUTMOD_MASK) != 0))
+    {
+      distance = SIM_MIN(distance, sim_timer_a_distance(regs->R, regs->CCR[i], period));
+    }
+  }
+
+  if ((regs->CTL & TIMER_A_CTL_IE) != 0)
+  {
+    distance = SIM_MIN(distance, sim_timer_a_distance(regs->R, 0, period));
+  }
+
+  if (distance == UINT32_MAX)
+  {
+    return SIM_NEVER;
+  }
+
+  return timer->start + sim_ticks_to_time(timer->ticks + distance, timer->hz);
+}
+
+// Counts the ticks up to now, setting the flags of every value passed
+static void sim_timer_a_count(sim_timer_a_t* timer, sim_time_t now)
+{
+  Timer_A_Type* regs = SIM_REGS((Timer_A_Type*) timer->base);
+  uint64_t ticks;
+  uint64_t elapsed;
+  uint32_t period;
+  uint8_t i;
+
+  if ((timer->hz == 0) || ((regs->CTL & TIMER_A_CTL_MC_MASK) == TIMER_A_STOP_MODE) || (now <= timer->start))
+  {
+    return;
+  }
+
+  ticks = sim_time_to_ticks(now - timer->start, timer->hz);
+  elapsed = ticks - timer->ticks;
+  if (elapsed == 0)
+  {
+    return;
+  }
+
+  period = sim_timer_a_period(timer);
+
+  for (i = 0; i < SIM_TIMER_A_CCRS; i++)
+  {
+    if ((regs->CCR[i] < period) && (sim_timer_a_distance(regs->R, regs->CCR[i], period) <= elapsed))
+    {
+      regs->CCTL[i] |= TIMER_A_CCTLN_CCIFG;
+    }
+  }
+
+  if (sim_timer_a_distance(regs->R, 0, period) <= elapsed)
+  {
+    regs->CTL |= TIMER_A_CTL_IFG;
+  }
+
+  regs->R = (regs->R + elapsed) % period;
+  timer->ticks = ticks;
+
+  sim_timer_a_changed(timer);
+}
+
+/*
+ * After a write: restarts the count from the last tick with the clock now
+ * selected, and updates the interrupt lines.
+ */
+static void sim_timer_a_changed(sim_timer_a_t* timer)
+{
+  Timer_A_Type* regs = SIM_REGS((Timer_A_Type*) timer->base);
+  uint32_t divider;
+  bool irq_n = false;
+  uint8_t i;
+
+  timer->start = (timer->hz != 0) ? (timer->start + sim_ticks_to_time(timer->ticks, timer->hz)) : sim_time();
+  timer->ticks = 0;
+
+  if ((regs->CTL & TIMER_A_CTL_CLR) != 0)
+  {
+    regs->CTL &= ~TIMER_A_CTL_CLR;
+    regs->R = 0;
+    timer->start = sim_time();
+  }
+
+  /* Up mode restarts from zero when the counter is past CCR0 */
+  if (regs->R >= sim_timer_a_period(timer))
+  {
+    regs->R = 0;
+  }
+
+  divider = (1u << ((regs->CTL & TIMER_A_CTL_ID_MASK) >> TIMER_A_CTL_ID_OFS)) * ((regs->EX0 & TIMER_A_EX0_IDEX_MASK) + 1);
+  switch (regs->CTL & TIMER_A_CTL_SSEL_MASK)
+  {
+    case TIMER_A_CTL_SSEL__ACLK:
+      timer->hz = sim_clock_aclk() / divider;
+      break;
+    case TIMER_A_CTL_SSEL__SMCLK:
+      timer->hz = CS_getSMCLK() / divider;
+      break;
+    default:
+      /* TACLK and INCLK pins are not driven */
+      timer->hz = 0;
+      break;
+  }
+
+  for (i = 1; i < SIM_TIMER_A_CCRS; i++)
+  {
+    irq_n |= ((regs->CCTL[i] & TIMER_A_CCTLN_CCIE) != 0) && ((regs->CCTL[i] & TIMER_A_CCTLN_CCIFG) != 0);
+  }
+  irq_n |= ((regs->CTL & TIMER_A_CTL_IE) != 0) && ((regs->CTL & TIMER_A_CTL_IFG) != 0);
+
+  sim_irq_set(timer->irq_ccr0, ((regs->CCTL[0] & TIMER_A_CCTLN_CCIE) != 0) && ((regs->CCTL[0] & TIMER_A_CCTLN_CCIFG) != 0));
+  sim_irq_set(timer->irq_n, irq_n);
+}
+
+// Input divider as ID and IDEX, the way driverlib splits it
+static void sim_timer_a_set_divider(sim_timer_a_t* timer, uint32_t divider)
+{
+  Timer_A_Type* regs = SIM_REGS((Timer_A_Type*) timer->base);
+  int8_t id;
+
+  for (id = 3; id > 0; id--)
+  {
+    if (((divider % (1u << id)) == 0) && ((divider >> id) <= 8))
+    {
+      break;
+    }
+  }
+
+  regs->CTL = (regs->CTL & ~TIMER_A_CTL_ID_MASK) | (id << TIMER_A_CTL_ID_OFS);
+  regs->EX0 = (divider >> id) - 1;
+}
+
+static sim_time_t sim_timer32_next_event(void)
+{
+  sim_time_t next = SIM_NEVER;
+  sim_timer32_t* timer;
+  uint8_t i;
+
+  for (i = 0; i < SIM_TIMER32_COUNT; i++)
+  {
+    timer = &sim_timers32[i];
+    if ((timer->hz != 0) && ((SIM_REGS(TIMER32_CMSIS(timer->base))->CONTROL & TIMER32_CONTROL_IE) != 0))
+    {
+      next = SIM_MIN(next, timer->start + sim_ticks_to_time(timer->ticks + sim_timer32_distance(timer), timer->hz));
+    }
+  }
+
+  return next;
+}
+
+static void sim_timer32_advance(sim_time_t now)
+{
+  uint8_t i;
+
+  for (i = 0; i < SIM_TIMER32_COUNT; i++)
+  {
+    sim_timer32_count(&sim_timers32[i], now);
+  }
+}
+
+static void sim_timer32_hook(uintptr_t address)
+{
+  sim_timer32_t* timer = sim_timer32(address & ~(SIM_TIMER32_SIZE - 1));
+  Timer32_Type* regs = SIM_REGS(TIMER32_CMSIS(timer->base));
+
+  switch (address - timer->base)
+  {
+    case offsetof(Timer32_Type, LOAD):
+      regs->VALUE = regs->LOAD;
+      break;
+    case offsetof(Timer32_Type, INTCLR):
+      regs->RIS = 0;
+      break;
+    default:
+      break;
+  }
+
+  sim_timer32_changed(timer);
+}
+
+static sim_timer32_t* sim_timer32(uint32_t base)
+{
+  return &sim_timers32[(base - TIMER32_0_BASE) / SIM_TIMER32_SIZE];
+}
+
+// Free running mode wraps to the maximum, periodic mode reloads LOAD
+static uint32_t sim_timer32_reload(sim_timer32_t* timer)
+{
+  Timer32_Type* regs = SIM_REGS(TIMER32_CMSIS(timer->base));
+  uint32_t max = ((regs->CONTROL & TIMER32_CONTROL_SIZE) != 0) ? UINT32_MAX : UINT16_MAX;
+
+  return ((regs->CONTROL & TIMER32_CONTROL_MODE) != 0) ? (regs->LOAD & max) : max;
+}
+
+// Ticks until the counter next reaches zero, the tick after it reloads
+static uint64_t sim_timer32_distance(sim_timer32_t* timer)
+{
+  uint32_t value = SIM_REGS(TIMER32_CMSIS(timer->base))->VALUE;
+
+  return (value != 0) ? value : ((uint64_t) sim_timer32_reload(timer) + 1);
+}
+
+static void sim_timer32_count(sim_timer32_t* timer, sim_time_t now)
+{
+  Timer32_Type* regs = SIM_REGS(TIMER32_CMSIS(timer->base));
+  uint64_t ticks;
+  uint64_t elapsed;
+  uint64_t distance;
+  uint64_t period;
+
+  if ((timer->hz == 0) || (now <= timer->start))
+  {
+    return;
+  }
+
+  ticks = sim_time_to_ticks(now - timer->start, timer->hz);
+  elapsed = ticks - timer->ticks;
+  if (elapsed == 0)
+  {
+    return;
+  }
+  timer->ticks = ticks;
+
+  distance = sim_timer32_distance(timer);
+  if (elapsed < distance)
+  {
+    regs->VALUE = (regs->VALUE != 0) ? (regs->VALUE - elapsed) : (sim_timer32_reload(timer) - (elapsed - 1));
+  }
+  else
+  {
+    regs->RIS = TIMER32_RIS_RAW_IFG;
+
+    if ((regs->CONTROL & TIMER32_CONTROL_ONESHOT) != 0)
+    {
+      /* Stops at zero */
+      regs->VALUE = 0;
+      regs->CONTROL &= ~TIMER32_CONTROL_ENABLE;
+    }
+    else
+    {
+      period = (uint64_t) sim_timer32_reload(timer) + 1;
+      elapsed = (elapsed - distance) % period;
+      regs->VALUE = (elapsed == 0) ? 0 : (sim_timer32_reload(timer) - (elapsed - 1));
+    }
+  }
+
+  sim_timer32_changed(timer);
+}
+
+static void sim_timer32_changed(sim_timer32_t* timer)
+{
+  Timer32_Type* regs = SIM_REGS(TIMER32_CMSIS(timer->base));
+  uint32_t prescaler;
+
+  timer->start = (timer->hz != 0) ? (timer->start + sim_ticks_to_time(timer->ticks, timer->hz)) : sim_time();
+  timer->ticks = 0;
+
+  prescaler = 1u << (4 * ((regs->CONTROL & TIMER32_CONTROL_PRESCALE_MASK) >> TIMER32_CONTROL_PRESCALE_OFS));
+  timer->hz = ((regs->CONTROL & TIMER32_CONTROL_ENABLE) != 0) ? (CS_getMCLK() / prescaler) : 0;
+
+  regs->MIS = ((regs->CONTROL & TIMER32_CONTROL_IE) != 0) ? regs->RIS : 0;
+  sim_irq_set(timer->irq, regs->MIS != 0);
+}
@@ -0,0 +1,327 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Checks the computations of stack_profile.c, with the kernel replaced by a
+ * table of task states:
+ *
+ *   stack_check [profiles [seed]]
+ *
+ * stack_profile_suggest() is compared with its definition for every size in
+ * words. Each random profile registers the stack sizes as the kernel hook
+ * does, samples them through a stub of uxTaskGetSystemState() and encodes
+ * the result, which is decoded again following the layout of stack_profile.h.
+ * Sampling must fail above STACK_PROFILE_MAX_TASKS tasks and encoding into a
+ * payload one byte short must write nothing. Prints one JSON object and fails
+ * on the first difference.
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "stack_profile.h"
+
+/*---------------------------------defines------------------------------------*/
+
+#define STACK_CHECK_PROFILES        ( 100000 )
+#define STACK_CHECK_SEED            ( 1 )
+
+// Tasks of a profile, some of them above the table and some numbered beyond it
+#define STACK_CHECK_TASKS_MAX       ( STACK_PROFILE_MAX_TASKS + 2 )
+#define STACK_CHECK_NUMBERS         ( STACK_PROFILE_MAX_TASKS + 4 )
+#define STACK_CHECK_STACK_MAX       ( 4096 )
+#define STACK_CHECK_NAME_MAX        ( 12 )
+
+#define STACK_CHECK_CANARY          ( 0x5A )
+
+/*--------------------------------prototypes----------------------------------*/
+
+static uint32_t stack_check_suggest(void);
+static uint32_t stack_check_profile(void);
+static uint16_t stack_check_get(const uint8_t* payload, uint16_t offset);
+static uint32_t stack_check_random(void);
+
+/*--------------------------------variables-----------------------------------*/
+
+// Task states returned by the stub of the kernel
+static TaskStatus_t stack_check_status[STACK_CHECK_TASKS_MAX];
+static char stack_check_names[STACK_CHECK_TASKS_MAX][STACK_CHECK_NAME_MAX + 1];
+static uint16_t stack_check_sizes[STACK_CHECK_TASKS_MAX];
+static UBaseType_t stack_check_count;
+
+static StackType_t stack_check_stack[STACK_CHECK_STACK_MAX];
+
+static uint32_t stack_check_state;
+
+/*----------------------------------public------------------------------------*/
+
+int main(int argc, char* argv[])
+{
+  uint32_t profiles = STACK_CHECK_PROFILES;
+  uint32_t errors;
+  uint32_t i;
+
+  stack_check_state = STACK_CHECK_SEED;
+  if (argc > 1)
+  {
+    profiles = strtoul(argv[1], NULL, 0);
+  }
+  if (argc > 2)
+  {
+    stack_check_state = strtoul(argv[2], NULL, 0);
+  }
+
+  errors = stack_check_suggest();
+
+  for (i = 0; (i < profiles) && (errors < 10); i++)
+  {
+    errors += stack_check_profile();
+  }
+
+  printf("{\"sizes\":%u,\"profiles\":%u,\"errors\":%u}\n", UINT16_MAX + 1, i, errors);
+
+  return (errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*---------------------------------private------------------------------------*/
+
+// The high water plus a quarter, at least the margin, rounded up, saturated
+static uint32_t stack_check_suggest(void)
+{
+  uint32_t errors = 0;
+  uint32_t margin;
+  uint32_t expected;
+  uint32_t used;
+
+  for (used = 0; used <= UINT16_MAX; used++)
+  {
+    margin = used / (1 << STACK_PROFILE_MARGIN_SHIFT);
+    if (margin < STACK_PROFILE_MARGIN_MIN)
+    {
+      margin = STACK_PROFILE_MARGIN_MIN;
+    }
+    expected = ((used + margin + STACK_PROFILE_ROUND - 1) / STACK_PROFILE_ROUND) * STACK_PROFILE_ROUND;
+    if (expected > UINT16_MAX)
+    {
+      expected = UINT16_MAX;
+    }
+
+    if (stack_profile_suggest(used) != expected)
+    {
+      fprintf(stderr, "%u words used: %u suggested instead of %u\n", used, stack_profile_suggest(used), expected);
+      errors++;
+    }
+  }
+
+  return errors;
+}
+
+// A random set of tasks sampled, encoded and decoded, returns 1 on a difference
+static uint32_t stack_check_profile(void)
+{
+  static stack_profile_t profile;
+  static uint8_t payload[STACK_PROFILE_PAYLOAD_MAX_SIZE + 1];
+  const stack_profile_stack_t* stack;
+  const uint8_t* task;
+  bool numbers[STACK_CHECK_NUMBERS] = { false };
+  char name[STACK_PROFILE_NAME_SIZE + 1];
+  uint16_t length;
+  uint16_t expected;
+  uint16_t size;
+  uint16_t used;
+  uint8_t characters;
+  uint8_t number;
+  UBaseType_t i;
+  uint8_t j;
+
+  /* Tasks with distinct numbers, as the kernel gives them */
+  stack_check_count = 1 + stack_check_random() % STACK_CHECK_TASKS_MAX;
+  for (i = 0; i < stack_check_count; i++)
+  {
+    do
+    {
+      number = stack_check_random() % STACK_CHECK_NUMBERS;
+    } while (numbers[number] == true);
+    numbers[number] = true;
+
+    characters = 1 + stack_check_random() % STACK_CHECK_NAME_MAX;
+    for (j = 0; j < characters; j++)
+    {
+      stack_check_names[i][j] = 'a' + stack_check_random() % 26;
+    }
+    stack_check_names[i][characters] = '\0';
+
+    stack_check_sizes[i] = 64 + stack_check_random() % (STACK_CHECK_STACK_MAX - 64);
+    stack_profile_task_created(number, &stack_check_stack[0], &stack_check_stack[stack_check_sizes[i] - 1]);
+
+    memset(&stack_check_status[i], 0, sizeof(TaskStatus_t));
+    stack_check_status[i].xTaskNumber = number;
+    stack_check_status[i].pcTaskName = stack_check_names[i];
+    stack_check_status[i].usStackHighWaterMark = stack_check_random() % (stack_check_sizes[i] + 1);
+  }
+
+  memset(&profile, STACK_CHECK_CANARY, sizeof(profile));
+  if (stack_profile_sample(&profile) != (stack_check_count <= STACK_PROFILE_MAX_TASKS))
+  {
+    fprintf(stderr, "sampling %u tasks did not return %u\n", (unsigned) stack_check_count,
+            stack_check_count <= STACK_PROFILE_MAX_TASKS);
+    return 1;
+  }
+  if (stack_check_count > STACK_PROFILE_MAX_TASKS)
+  {
+    return 0;
+  }
+
+  if ((profile.count != stack_check_count) || (strcmp(profile.isr.name, "ISR") != 0) ||
+      (profile.isr.size != 0) || (profile.isr.used != 0) || (profile.isr.suggested != 0))
+  {
+    fprintf(stderr, "%u tasks sampled as %u, or the main stack is not empty\n", (unsigned) stack_check_count,
+            profile.count);
+    return 1;
+  }
+
+  for (i = 0; i < stack_check_count; i++)
+  {
+    stack = &profile.tasks[i];
+
+    /* Sizes are only known below the table size */
+    size = 0;
+    used = 0;
+    if (stack_check_status[i].xTaskNumber < STACK_PROFILE_MAX_TASKS)
+    {
+      size = stack_check_sizes[i];
+      used = size - stack_check_status[i].usStackHighWaterMark;
+    }
+
+    strncpy(name, stack_check_names[i], STACK_PROFILE_NAME_SIZE);
+    name[STACK_PROFILE_NAME_SIZE] = '\0';
+
+    if ((stack->number != stack_check_status[i].xTaskNumber) || (stack->size != size) || (stack->used != used) ||
+        (stack->suggested != stack_profile_suggest(used)) || (strcmp(stack->name, name) != 0))
+    {
+      fprintf(stderr, "task %u: %u %u %u \"%s\" instead of %u %u %u \"%s\"\n", stack->number, stack->size,
+              stack->used, stack->suggested, stack->name, size, used, stack_profile_suggest(used), name);
+      return 1;
+    }
+  }
+
+  /* One byte short writes nothing */
+  expected = STACK_PROFILE_HEADER_SIZE + profile.count * STACK_PROFILE_TASK_SIZE;
+  memset(payload, STACK_CHECK_CANARY, sizeof(payload));
+  if (stack_profile_encode(&profile, payload, expected - 1) != 0)
+  {
+    fprintf(stderr, "%u tasks encoded in %u bytes\n", profile.count, expected - 1);
+    return 1;
+  }
+  for (i = 0; i < sizeof(payload); i++)
+  {
+    if (payload[i] != STACK_CHECK_CANARY)
+    {
+      fprintf(stderr, "a payload too short was written at %u\n", (unsigned) i);
+      return 1;
+    }
+  }
+
+  length = stack_profile_encode(&profile, payload, expected);
+  if ((length != expected) || (payload[expected] != STACK_CHECK_CANARY) ||
+      (stack_check_get(payload, 0) != profile.isr.size) || (stack_check_get(payload, 2) != profile.isr.used) ||
+      (stack_check_get(payload, 4) != profile.isr.suggested) || (payload[6] != profile.count))
+  {
+    fprintf(stderr, "header of %u tasks encoded in %u bytes instead of %u\n", profile.count, length, expected);
+    return 1;
+  }
+
+  for (i = 0; i < profile.count; i++)
+  {
+    stack = &profile.tasks[i];
+    task = &payload[STACK_PROFILE_HEADER_SIZE + i * STACK_PROFILE_TASK_SIZE];
+
+    /* The name is padded with zeros, not terminated when it fills the field */
+    memset(name, 0, sizeof(name));
+    memcpy(name, &task[7], STACK_PROFILE_NAME_SIZE);
+
+    if ((task[0] != stack->number) || (stack_check_get(task, 1) != stack->size) ||
+        (stack_check_get(task, 3) != stack->used) || (stack_check_get(task, 5) != stack->suggested) ||
+        (strcmp(name, stack->name) != 0) ||
+        ((strlen(stack->name) < STACK_PROFILE_NAME_SIZE) && (task[7 + STACK_PROFILE_NAME_SIZE - 1] != 0)))
+    {
+      fprintf(stderr, "task %u encoded as %u %u %u %u \"%s\"\n", stack->number, task[0], stack_check_get(task, 1),
+              stack_check_get(task, 3), stack_check_get(task, 5), name);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+// Little endian
+static uint16_t stack_check_get(const uint8_t* payload, uint16_t offset)
+{
+  return payload[offset] | (payload[offset + 1] << 8);
+}
+
+// xorshift32
+static uint32_t stack_check_random(void)
+{
+  stack_check_state ^= stack_check_state << 13;
+  stack_check_state ^= stack_check_state >> 17;
+  stack_check_state ^= stack_check_state << 5;
+
+  return stack_check_state;
+}
+
+/*---------------------------------kernel stubs-------------------------------*/
+
+// Fails as the kernel does when the array is too small
+UBaseType_t uxTaskGetSystemState(TaskStatus_t* const pxTaskStatusArray, const UBaseType_t uxArraySize,
+                                 uint32_t* const pulTotalRunTime)
+{
+  (void) pulTotalRunTime;
+
+  if (uxArraySize < stack_check_count)
+  {
+    return 0;
+  }
+
+  memcpy(pxTaskStatusArray, stack_check_status, stack_check_count * sizeof(TaskStatus_t));
+
+  return stack_check_count;
+}
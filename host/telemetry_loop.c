@@ -0,0 +1,375 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Round trip of the telemetry frames through a pseudo-terminal in raw mode,
+ * which stands for the UART, then a benchmark of the codec:
+ *
+ *   telemetry_loop [frames [seed]]
+ *
+ * telemetry_send() writes frames of random types and lengths to the master
+ * side, and a thread reads the slave side into the decoder. One frame in
+ * TELEMETRY_LOOP_CORRUPT is damaged on the way, by a flipped byte or by a zero
+ * after its first byte, as the UART interrupt used to insert when the TX
+ * buffer drained. Prints one JSON object and fails unless every other frame
+ * arrives intact and in order and every damaged one is rejected and counted
+ * as lost.
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "telemetry.h"
+#include "uart_driver.h"
+
+/*---------------------------------defines------------------------------------*/
+
+#define TELEMETRY_LOOP_FRAMES       ( 20000 )
+#define TELEMETRY_LOOP_SEED         ( 1 )
+#define TELEMETRY_LOOP_CORRUPT      ( 97 )
+
+// Frames encoded and decoded in memory by the benchmark
+#define TELEMETRY_LOOP_BENCH        ( 200000 )
+
+#define TELEMETRY_LOOP_NS           ( 1000000000ull )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  uint8_t type;
+  uint16_t length;
+  uint8_t payload[TELEMETRY_PAYLOAD_MAX_SIZE];
+} telemetry_loop_frame_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+static void* telemetry_loop_reader(void* parameters);
+static void telemetry_loop_make(uint32_t index, telemetry_loop_frame_t* frame);
+static bool telemetry_loop_damaged(uint32_t index);
+static uint64_t telemetry_loop_now(void);
+static uint32_t telemetry_loop_random(uint32_t* state);
+
+/*--------------------------------variables-----------------------------------*/
+
+static int telemetry_loop_master;
+static int telemetry_loop_slave;
+
+static uint32_t telemetry_loop_frames = TELEMETRY_LOOP_FRAMES;
+static uint32_t telemetry_loop_seed = TELEMETRY_LOOP_SEED;
+static uint32_t telemetry_loop_sending;
+static uint64_t telemetry_loop_bytes = 0;
+
+// Results of the reader
+static uint32_t telemetry_loop_received = 0;
+static uint32_t telemetry_loop_mismatches = 0;
+static telemetry_decoder_t telemetry_loop_decoder;
+
+/*----------------------------------public------------------------------------*/
+
+int main(int argc, char* argv[])
+{
+  telemetry_loop_frame_t frame;
+  telemetry_decoder_t decoder;
+  telemetry_frame_t decoded;
+  struct termios settings;
+  pthread_t reader;
+  uint8_t encoded[TELEMETRY_ENCODED_MAX_SIZE];
+  uint16_t length;
+  uint32_t damaged = 0;
+  uint32_t i;
+  uint32_t j;
+  uint64_t start;
+  uint64_t loop_ns;
+  uint64_t encode_ns;
+  uint64_t decode_ns;
+  uint64_t bench_bytes = 0;
+  bool passed;
+
+  if (argc > 1)
+  {
+    telemetry_loop_frames = strtoul(argv[1], NULL, 0);
+  }
+  if (argc > 2)
+  {
+    telemetry_loop_seed = strtoul(argv[2], NULL, 0);
+  }
+
+  telemetry_loop_master = posix_openpt(O_RDWR | O_NOCTTY);
+  if ((telemetry_loop_master < 0) || (grantpt(telemetry_loop_master) != 0) || (unlockpt(telemetry_loop_master) != 0))
+  {
+    perror("posix_openpt");
+    return EXIT_FAILURE;
+  }
+  telemetry_loop_slave = open(ptsname(telemetry_loop_master), O_RDWR | O_NOCTTY);
+  if (telemetry_loop_slave < 0)
+  {
+    perror("ptsname");
+    return EXIT_FAILURE;
+  }
+
+  /* Raw mode both ways, no echo and no line discipline on the zeros */
+  tcgetattr(telemetry_loop_slave, &settings);
+  cfmakeraw(&settings);
+  tcsetattr(telemetry_loop_slave, TCSANOW, &settings);
+  tcgetattr(telemetry_loop_master, &settings);
+  cfmakeraw(&settings);
+  tcsetattr(telemetry_loop_master, TCSANOW, &settings);
+
+  if (pthread_create(&reader, NULL, telemetry_loop_reader, NULL) != 0)
+  {
+    perror("pthread_create");
+    return EXIT_FAILURE;
+  }
+
+  /* Round trip */
+  start = telemetry_loop_now();
+  telemetry_init();
+  passed = (telemetry_send(0, encoded, TELEMETRY_PAYLOAD_MAX_SIZE + 1) != 0);
+  for (i = 0; i < telemetry_loop_frames; i++)
+  {
+    telemetry_loop_make(i, &frame);
+    telemetry_loop_sending = i;
+    if (telemetry_send(frame.type, frame.payload, frame.length) != 0)
+    {
+      passed = false;
+    }
+    if (telemetry_loop_damaged(i) == true)
+    {
+      damaged++;
+    }
+  }
+
+  // An empty frame after the others ends the stream, it does not count
+  encoded[0] = 0;
+  length = telemetry_encode((uint8_t) telemetry_loop_frames, 0, NULL, 0, encoded + 1);
+  if (write(telemetry_loop_master, encoded, length + 1) != length + 1)
+  {
+    passed = false;
+  }
+  pthread_join(reader, NULL);
+  loop_ns = telemetry_loop_now() - start;
+
+  /* The codec alone */
+  telemetry_loop_make(0, &frame);
+  start = telemetry_loop_now();
+  for (i = 0; i < TELEMETRY_LOOP_BENCH; i++)
+  {
+    frame.payload[0] = (uint8_t) i;
+    length = telemetry_encode((uint8_t) i, frame.type, frame.payload, frame.length, encoded);
+    bench_bytes += length;
+  }
+  encode_ns = telemetry_loop_now() - start;
+
+  telemetry_decoder_init(&decoder);
+  start = telemetry_loop_now();
+  for (i = 0; i < TELEMETRY_LOOP_BENCH; i++)
+  {
+    for (j = 0; j < length; j++)
+    {
+      telemetry_decoder_push(&decoder, encoded[j], &decoded);
+    }
+  }
+  decode_ns = telemetry_loop_now() - start;
+  passed = passed && (decoder.frames_ok == TELEMETRY_LOOP_BENCH) && (decoded.length == frame.length);
+
+  passed = passed && (telemetry_loop_mismatches == 0) &&
+           (telemetry_loop_received == telemetry_loop_frames - damaged) &&
+           (telemetry_loop_decoder.frames_ok == telemetry_loop_frames - damaged + 1) &&
+           (telemetry_loop_decoder.frames_lost == damaged) &&
+           (telemetry_loop_decoder.frames_error >= damaged);
+
+  printf("{\"frames\":%u,\"damaged\":%u,\"received\":%u,\"mismatches\":%u,\"decoder_ok\":%u,\"decoder_error\":%u,"
+         "\"decoder_lost\":%u,\"loop_mbyte_s\":%.2f,\"encode_ns_frame\":%.1f,\"encode_mbyte_s\":%.1f,"
+         "\"decode_ns_frame\":%.1f,\"decode_mbyte_s\":%.1f,\"passed\":%s}\n",
+         telemetry_loop_frames, damaged, telemetry_loop_received, telemetry_loop_mismatches,
+         telemetry_loop_decoder.frames_ok, telemetry_loop_decoder.frames_error, telemetry_loop_decoder.frames_lost,
+         (double) telemetry_loop_bytes * 1000.0 / (double) loop_ns,
+         (double) encode_ns / TELEMETRY_LOOP_BENCH, (double) bench_bytes * 1000.0 / (double) encode_ns,
+         (double) decode_ns / TELEMETRY_LOOP_BENCH, (double) bench_bytes * 1000.0 / (double) decode_ns,
+         (passed == true) ? "true" : "false");
+
+  return (passed == true) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// The UART of telemetry_send(), which damages the frames chosen on the way
+uint8_t uart_write(const uint8_t* data, uint16_t length)
+{
+  uint8_t line[TELEMETRY_ENCODED_MAX_SIZE + 1];
+  uint32_t state = telemetry_loop_sending;
+  uint16_t size = length;
+  uint16_t offset;
+  ssize_t written;
+
+  memcpy(line, data, length);
+
+  if (telemetry_loop_damaged(telemetry_loop_sending) == true)
+  {
+    if ((telemetry_loop_random(&state) & 1) != 0)
+    {
+      memmove(line + 2, line + 1, length - 1);
+      line[1] = 0;
+      size++;
+    }
+    else
+    {
+      offset = telemetry_loop_random(&state) % (length - 1);
+      line[offset] ^= 0x5A;
+      if (line[offset] == 0)
+      {
+        line[offset] = 0xA5;
+      }
+    }
+  }
+
+  for (offset = 0; offset < size; offset += written)
+  {
+    written = write(telemetry_loop_master, line + offset, size - offset);
+    if (written <= 0)
+    {
+      return 1;
+    }
+  }
+  telemetry_loop_bytes += size;
+
+  return 0;
+}
+
+/*---------------------------------private------------------------------------*/
+
+// Checks the frames in order until the empty one that ends the stream
+static void* telemetry_loop_reader(void* parameters)
+{
+  telemetry_loop_frame_t expected;
+  telemetry_frame_t frame;
+  uint8_t data[4096];
+  uint32_t index = 0;
+  ssize_t length;
+  ssize_t i;
+
+  (void) parameters;
+
+  telemetry_decoder_init(&telemetry_loop_decoder);
+
+  for (;;)
+  {
+    length = read(telemetry_loop_slave, data, sizeof(data));
+    if (length <= 0)
+    {
+      return NULL;
+    }
+
+    for (i = 0; i < length; i++)
+    {
+      if (telemetry_decoder_push(&telemetry_loop_decoder, data[i], &frame) != TELEMETRY_FRAME_OK)
+      {
+        continue;
+      }
+
+      /* Damaged frames only show as a gap in the sequence */
+      while ((index < telemetry_loop_frames) && (telemetry_loop_damaged(index) == true))
+      {
+        index++;
+      }
+      if ((index >= telemetry_loop_frames) && (frame.type == 0) && (frame.length == 0))
+      {
+        return NULL;
+      }
+      telemetry_loop_make(index, &expected);
+      if ((index >= telemetry_loop_frames) || (frame.sequence != (uint8_t) index) || (frame.type != expected.type) ||
+          (frame.length != expected.length) || (memcmp(frame.payload, expected.payload, frame.length) != 0))
+      {
+        telemetry_loop_mismatches++;
+      }
+      telemetry_loop_received++;
+      index++;
+    }
+  }
+}
+
+// Frame index, the same for the sender and the reader
+static void telemetry_loop_make(uint32_t index, telemetry_loop_frame_t* frame)
+{
+  uint32_t state = telemetry_loop_seed * 2654435761u + index + 1;
+  uint16_t i;
+
+  frame->type = (uint8_t) telemetry_loop_random(&state);
+  frame->length = telemetry_loop_random(&state) % (TELEMETRY_PAYLOAD_MAX_SIZE + 1);
+  for (i = 0; i < frame->length; i++)
+  {
+    // Zeros are frequent in the telemetry, as in the counters
+    frame->payload[i] = ((telemetry_loop_random(&state) & 3) == 0) ? 0 : (uint8_t) telemetry_loop_random(&state);
+  }
+}
+
+// Not the first frame, whose sequence the reader synchronizes on
+static bool telemetry_loop_damaged(uint32_t index)
+{
+  return (index % TELEMETRY_LOOP_CORRUPT) == (TELEMETRY_LOOP_CORRUPT - 1);
+}
+
+static uint64_t telemetry_loop_now(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (uint64_t) now.tv_sec * TELEMETRY_LOOP_NS + (uint64_t) now.tv_nsec;
+}
+
+// xorshift32
+static uint32_t telemetry_loop_random(uint32_t* state)
+{
+  if (*state == 0)
+  {
+    *state = 1;
+  }
+
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+
+  return *state;
+}
@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Checks the tick accounting of tickless.c in simulated time, on a model of
+ * SysTick counting MCLK and of TA1 counting ACLK:
+ *
+ *   tickless_check [sleeps [seed]]
+ *
+ * The idle task sleeps for a random number of ticks, woken by the compare,
+ * by the overflow of TA1 or at a random time by another interrupt, and runs
+ * for a random time in between. The kernel tick count is compared with the
+ * ticks of the true time and the tick that ends each sleep with the one that
+ * was due. Prints one JSON object and fails if a tick is added early, comes
+ * TICKLESS_CHECK_LATE_MAX after it was due or the kernel time drifts from
+ * the true time by more than TICKLESS_CHECK_DRIFT_PPM. Reading ACLK costs up
+ * to a count on every sleep, so the drift walks at random, but it must not
+ * build up.
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+
+#include "tickless.h"
+
+/*---------------------------------defines------------------------------------*/
+
+#define TICKLESS_CHECK_SLEEPS       ( 100000 )
+#define TICKLESS_CHECK_SEED         ( 1 )
+
+#define TICKLESS_CHECK_MCLK_HZ      ( 48000000ull )
+#define TICKLESS_CHECK_CYCLES       ( TICKLESS_CHECK_MCLK_HZ / configTICK_RATE_HZ )
+#define TICKLESS_CHECK_MAX_TICKS    ( (TICKLESS_MAX_COUNTS * configTICK_RATE_HZ) / TICKLESS_TIMER_HZ )
+
+// One sleep in TICKLESS_CHECK_EARLY is ended by another interrupt
+#define TICKLESS_CHECK_EARLY        ( 3 )
+
+// An ACLK count and the shortest reload, far below the 20 ppm of the crystal
+#define TICKLESS_CHECK_LATE_MAX     ( TICKLESS_CHECK_MCLK_HZ / TICKLESS_TIMER_HZ + TICKLESS_RELOAD_MIN )
+#define TICKLESS_CHECK_DRIFT_PPM    ( 1 )
+
+/*--------------------------------prototypes----------------------------------*/
+
+static uint64_t tickless_check_aclk(uint64_t time);
+static uint64_t tickless_check_edge(uint64_t count);
+static uint32_t tickless_check_random(void);
+
+/*--------------------------------variables-----------------------------------*/
+
+static uint32_t tickless_check_state;
+
+/*----------------------------------public------------------------------------*/
+
+int main(int argc, char* argv[])
+{
+  tickless_account_t account;
+  uint32_t sleeps = TICKLESS_CHECK_SLEEPS;
+  uint64_t time = 0;                          // MCLK cycles of true time
+  uint64_t next_tick = TICKLESS_CHECK_CYCLES; // when SysTick raises the next tick
+  uint64_t ticks = 0;                         // kernel tick count
+  uint64_t interrupts = 0;                    // SysTick interrupts
+  uint64_t due;
+  uint64_t wake;
+  uint64_t overflow;
+  uint32_t expected;
+  uint32_t cycles_to_tick;
+  uint32_t counts;
+  uint32_t slept;
+  bool timer_woke;
+  bool on_edge;
+  int64_t drift;
+  int64_t drift_max = 0;
+  int64_t late;
+  int64_t late_max = 0;
+  uint32_t timer_wakeups = 0;
+  uint32_t early_wakeups = 0;
+  uint32_t errors = 0;
+  uint32_t i;
+
+  tickless_check_state = TICKLESS_CHECK_SEED;
+  if (argc > 1)
+  {
+    sleeps = strtoul(argv[1], NULL, 0);
+  }
+  if (argc > 2)
+  {
+    tickless_check_state = strtoul(argv[2], NULL, 0);
+  }
+
+  for (i = 0; i < sleeps; i++)
+  {
+    /* Tasks run with the tick */
+    time += tickless_check_random() % (3 * TICKLESS_CHECK_CYCLES);
+    while (next_tick <= time)
+    {
+      ticks++;
+      interrupts++;
+      next_tick += TICKLESS_CHECK_CYCLES;
+    }
+
+    /* The next task is due on the expected tick from now */
+    expected = 2 + tickless_check_random() % (TICKLESS_CHECK_MAX_TICKS - 1);
+    cycles_to_tick = (uint32_t)(next_tick - time);
+    due = next_tick + (uint64_t)(expected - 1) * TICKLESS_CHECK_CYCLES;
+
+    counts = tickless_sleep_counts(cycles_to_tick, TICKLESS_CHECK_CYCLES, expected, TICKLESS_CHECK_MCLK_HZ);
+    wake = tickless_check_edge(tickless_check_aclk(time) + counts);
+    timer_woke = true;
+    on_edge = true;
+
+    overflow = tickless_check_edge((tickless_check_aclk(time) | 0xFFFF) + 1);
+    if (overflow < wake)
+    {
+      wake = overflow;
+      timer_woke = false;
+    }
+    if ((tickless_check_random() % TICKLESS_CHECK_EARLY) == 0)
+    {
+      overflow = time + 1 + tickless_check_random() % (wake - time);
+      if (overflow < wake)
+      {
+        wake = overflow;
+        timer_woke = false;
+        on_edge = false;
+      }
+    }
+
+    slept = (uint32_t)((tickless_check_aclk(wake) - tickless_check_aclk(time)) & 0xFFFF);
+    tickless_account(cycles_to_tick, TICKLESS_CHECK_CYCLES,
+                     tickless_elapsed(slept, on_edge, TICKLESS_CHECK_MCLK_HZ), expected, &account);
+
+    if ((account.steps > expected - 1) || (account.reload > TICKLESS_CHECK_CYCLES))
+    {
+      errors++;
+    }
+
+    time = wake;
+    ticks += account.steps;
+    next_tick = wake + account.reload;
+
+    if (timer_woke == true)
+    {
+      timer_wakeups++;
+
+      // The tick that unblocks the task, raised by SysTick after the compare
+      late = (int64_t)(next_tick - due);
+      if (llabs(late) > llabs(late_max))
+      {
+        late_max = late;
+      }
+    }
+    else
+    {
+      early_wakeups++;
+    }
+
+    /* The next tick of the kernel against the next one of the true time */
+    drift = (int64_t)next_tick - (int64_t)((ticks + 1) * TICKLESS_CHECK_CYCLES);
+    if (llabs(drift) > llabs(drift_max))
+    {
+      drift_max = drift;
+    }
+  }
+
+  drift = (int64_t)next_tick - (int64_t)((ticks + 1) * TICKLESS_CHECK_CYCLES);
+
+  printf("{\"sleeps\":%u,\"timer_wakeups\":%u,\"early_wakeups\":%u,\"ticks\":%llu,\"systick_interrupts\":%llu,"
+         "\"ticks_suppressed\":%llu,\"seconds\":%llu,\"drift_us\":%lld,\"drift_max_us\":%lld,\"late_max_us\":%lld,"
+         "\"errors\":%u}\n",
+         sleeps, timer_wakeups, early_wakeups, (unsigned long long) ticks, (unsigned long long) interrupts,
+         (unsigned long long) (ticks - interrupts), (unsigned long long) (time / TICKLESS_CHECK_MCLK_HZ),
+         (long long) (drift * 1000000 / (int64_t) TICKLESS_CHECK_MCLK_HZ),
+         (long long) (drift_max * 1000000 / (int64_t) TICKLESS_CHECK_MCLK_HZ),
+         (long long) (late_max * 1000000 / (int64_t) TICKLESS_CHECK_MCLK_HZ), errors);
+
+  return ((errors == 0) && (llabs(late_max) <= (int64_t) TICKLESS_CHECK_LATE_MAX) &&
+          ((uint64_t) llabs(drift) * 1000000 <= time * TICKLESS_CHECK_DRIFT_PPM)) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// tickless.c starts TA1 through the debouncer, not modeled here
+void debounce_init(void)
+{
+}
+
+/*---------------------------------private------------------------------------*/
+
+// ACLK counts since time 0, the 16-bit counter is its low half
+static uint64_t tickless_check_aclk(uint64_t time)
+{
+  return (time * TICKLESS_TIMER_HZ) / TICKLESS_CHECK_MCLK_HZ;
+}
+
+// First MCLK cycle at which ACLK has counted count
+static uint64_t tickless_check_edge(uint64_t count)
+{
+  return (count * TICKLESS_CHECK_MCLK_HZ + TICKLESS_TIMER_HZ - 1) / TICKLESS_TIMER_HZ;
+}
+
+// xorshift32
+static uint32_t tickless_check_random(void)
+{
+  tickless_check_state ^= tickless_check_state << 13;
+  tickless_check_state ^= tickless_check_state >> 17;
+  tickless_check_state ^= tickless_check_state << 5;
+
+  return tickless_check_state;
+}
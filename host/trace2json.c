@@ -0,0 +1,456 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Converts the kernel trace dumped by the "trace" UART command (see
+ * kernel_trace.h) to the Chrome trace event format, which chrome://tracing
+ * and ui.perfetto.dev open:
+ *
+ *   trace2json capture.bin > trace.json
+ *
+ * The capture holds the bytes received from the UART, other telemetry frames
+ * are skipped. Each dump becomes a process with one thread per task, where
+ * the task runs between its switches, and one for the interrupt handlers.
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "telemetry.h"
+#include "kernel_trace.h"
+
+/*---------------------------------defines------------------------------------*/
+
+// Type of the trace frames, TELEMETRY_KERNEL_TRACE in PRAC/main.c
+#define TRACE_TELEMETRY_TYPE        ( 0x03 )
+
+#define TRACE_TASKS                 ( 256 )
+#define TRACE_IRQS                  ( 64 )
+
+// Thread of the interrupt handlers, the tasks are their number plus one
+#define TRACE_TID_IRQ               ( 0 )
+
+#define TRACE_GET16(p)              ( (uint16_t)((p)[0] | ((p)[1] << 8)) )
+#define TRACE_GET32(p)              ( (uint32_t)TRACE_GET16(p) | ((uint32_t)TRACE_GET16((p) + 2) << 16) )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  uint32_t clock_hz;
+  uint32_t recorded;
+  uint32_t expected;
+  uint32_t received;
+  uint8_t queues;
+  uint8_t queue_types[KERNEL_TRACE_MAX_QUEUES];
+  char names[TRACE_TASKS][KERNEL_TRACE_NAME_SIZE + 1];
+
+  // Conversion state
+  bool started;
+  uint32_t last;
+  uint64_t cycles;
+  uint64_t first;
+  int running;
+  uint64_t running_since;
+  uint8_t irq_depth;
+} trace_dump_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+static void trace_info(const uint8_t* payload, uint16_t length);
+static void trace_records(const uint8_t* payload, uint16_t length);
+static void trace_record(uint32_t timestamp, uint8_t event, uint8_t task, uint16_t object);
+static void trace_finish(void);
+
+static void trace_event(const char* format, ...) __attribute__((format(printf, 1, 2)));
+static double trace_us(uint64_t cycles);
+static const char* trace_task(int number);
+static const char* trace_irq(uint16_t irq, char* buffer);
+static const char* trace_queue(uint16_t queue, char* buffer);
+
+/*--------------------------------variables-----------------------------------*/
+
+// Interrupt numbers of lib_PRAC/msp432/interrupt.h
+static const char* const trace_irq_names[TRACE_IRQS] =
+{
+  [24] = "TA0_0", [25] = "TA0_N", [26] = "TA1_0", [27] = "TA1_N",
+  [28] = "TA2_0", [29] = "TA2_N", [30] = "TA3_0", [31] = "TA3_N",
+  [32] = "EUSCIA0", [40] = "ADC14", [41] = "T32_INT1", [42] = "T32_INT2",
+  [46] = "DMA_ERR", [47] = "DMA_INT3", [48] = "DMA_INT2", [49] = "DMA_INT1",
+  [51] = "PORT1", [52] = "PORT2", [53] = "PORT3", [54] = "PORT4",
+  [55] = "PORT5", [56] = "PORT6"
+};
+
+// By queueQUEUE_TYPE_xxx
+static const char* const trace_queue_types[] =
+{
+  "queue", "mutex", "counting semaphore", "binary semaphore", "recursive mutex"
+};
+
+static const char* const trace_queue_events[] =
+{
+  [KERNEL_TRACE_QUEUE_SEND] = "send",
+  [KERNEL_TRACE_QUEUE_SEND_FAILED] = "send failed",
+  [KERNEL_TRACE_QUEUE_SEND_BLOCK] = "send blocks",
+  [KERNEL_TRACE_QUEUE_RECEIVE] = "receive",
+  [KERNEL_TRACE_QUEUE_RECEIVE_FAILED] = "receive failed",
+  [KERNEL_TRACE_QUEUE_RECEIVE_BLOCK] = "receive blocks",
+  [KERNEL_TRACE_QUEUE_SEND_FROM_ISR] = "send from ISR",
+  [KERNEL_TRACE_QUEUE_RECEIVE_FROM_ISR] = "receive from ISR"
+};
+
+static trace_dump_t trace_dump;
+static uint32_t trace_dumps = 0;
+static bool trace_first_event = true;
+
+/*----------------------------------public------------------------------------*/
+
+// Never linked in the target build, telemetry.c sends through it
+uint8_t uart_write(const uint8_t* data, uint16_t length)
+{
+  (void) data;
+  (void) length;
+
+  return 1;
+}
+
+int main(int argc, char** argv)
+{
+  telemetry_decoder_t decoder;
+  telemetry_frame_t frame;
+  FILE* file;
+  int data;
+
+  if (argc != 2)
+  {
+    fprintf(stderr, "usage: %s capture\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  file = fopen(argv[1], "rb");
+  if (file == NULL)
+  {
+    fprintf(stderr, "cannot open %s\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  telemetry_decoder_init(&decoder);
+  printf("{\"traceEvents\":[\n");
+
+  while ((data = fgetc(file)) != EOF)
+  {
+    if ((telemetry_decoder_push(&decoder, (uint8_t)data, &frame) == TELEMETRY_FRAME_OK) &&
+        (frame.type == TRACE_TELEMETRY_TYPE) && (frame.length > 0))
+    {
+      if (frame.payload[0] == KERNEL_TRACE_PAYLOAD_INFO)
+      {
+        trace_info(frame.payload, frame.length);
+      }
+      else if (frame.payload[0] == KERNEL_TRACE_PAYLOAD_RECORDS)
+      {
+        trace_records(frame.payload, frame.length);
+      }
+    }
+  }
+
+  trace_finish();
+  printf("\n],\"displayTimeUnit\":\"ns\"}\n");
+  fclose(file);
+
+  if (decoder.frames_error + decoder.frames_lost != 0)
+  {
+    fprintf(stderr, "%u frames with errors, %u lost\n", decoder.frames_error, decoder.frames_lost);
+  }
+  if (trace_dumps == 0)
+  {
+    fprintf(stderr, "no trace in %s\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/*---------------------------------private------------------------------------*/
+
+// Starts a dump, named after its tasks
+static void trace_info(const uint8_t* payload, uint16_t length)
+{
+  const uint8_t* task;
+  uint8_t tasks;
+  uint8_t i;
+
+  if (length < KERNEL_TRACE_INFO_HEADER_SIZE)
+  {
+    return;
+  }
+
+  tasks = payload[11];
+  if (length < KERNEL_TRACE_INFO_HEADER_SIZE + tasks * KERNEL_TRACE_INFO_TASK_SIZE + payload[12])
+  {
+    return;
+  }
+
+  trace_finish();
+  memset(&trace_dump, 0, sizeof(trace_dump));
+  trace_dumps++;
+
+  trace_dump.clock_hz = TRACE_GET32(&payload[1]);
+  trace_dump.recorded = TRACE_GET32(&payload[5]);
+  trace_dump.expected = (trace_dump.recorded < TRACE_GET16(&payload[9])) ? trace_dump.recorded : TRACE_GET16(&payload[9]);
+  trace_dump.queues = (payload[12] < KERNEL_TRACE_MAX_QUEUES) ? payload[12] : KERNEL_TRACE_MAX_QUEUES;
+  trace_dump.running = -1;
+
+  trace_event("{\"ph\":\"M\",\"pid\":%u,\"name\":\"process_name\",\"args\":{\"name\":\"dump %u\"}}",
+              trace_dumps, trace_dumps);
+  trace_event("{\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":\"Interrupts\"}}",
+              trace_dumps, TRACE_TID_IRQ);
+
+  task = &payload[KERNEL_TRACE_INFO_HEADER_SIZE];
+  for (i = 0; i < tasks; i++, task += KERNEL_TRACE_INFO_TASK_SIZE)
+  {
+    memcpy(trace_dump.names[task[0]], &task[1], KERNEL_TRACE_NAME_SIZE);
+    trace_event("{\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":\"%s\"}}",
+                trace_dumps, task[0] + 1, trace_task(task[0]));
+  }
+
+  memcpy(trace_dump.queue_types, task, trace_dump.queues);
+}
+
+static void trace_records(const uint8_t* payload, uint16_t length)
+{
+  uint16_t index;
+  uint16_t offset;
+
+  if ((trace_dumps == 0) || (length < KERNEL_TRACE_RECORDS_HEADER_SIZE))
+  {
+    return;
+  }
+
+  // A lost frame leaves a gap, the slices across it are wrong
+  index = TRACE_GET16(&payload[1]);
+  if (index != trace_dump.received)
+  {
+    fprintf(stderr, "dump %u: records %u to %u lost\n", trace_dumps, trace_dump.received, index - 1);
+    trace_dump.received = index;
+  }
+
+  for (offset = KERNEL_TRACE_RECORDS_HEADER_SIZE; offset + KERNEL_TRACE_RECORD_SIZE <= length; offset += KERNEL_TRACE_RECORD_SIZE)
+  {
+    trace_record(TRACE_GET32(&payload[offset]), payload[offset + 4], payload[offset + 5], TRACE_GET16(&payload[offset + 6]));
+    trace_dump.received++;
+  }
+}
+
+static void trace_record(uint32_t timestamp, uint8_t event, uint8_t task, uint16_t object)
+{
+  char name[48];
+  double us;
+  int tid;
+
+  // The counter wraps, the records are less than a wrap apart
+  if (trace_dump.started == false)
+  {
+    trace_dump.started = true;
+    trace_dump.cycles = timestamp;
+    trace_dump.first = timestamp;
+    trace_dump.running = task;
+    trace_dump.running_since = timestamp;
+  }
+  else
+  {
+    trace_dump.cycles += (uint32_t)(timestamp - trace_dump.last);
+  }
+  trace_dump.last = timestamp;
+
+  us = trace_us(trace_dump.cycles);
+  tid = (trace_dump.irq_depth > 0) ? TRACE_TID_IRQ : task + 1;
+
+  switch (event)
+  {
+    case KERNEL_TRACE_SWITCHED_IN:
+      if ((trace_dump.running >= 0) && (trace_dump.running != object))
+      {
+        trace_event("{\"ph\":\"X\",\"pid\":%u,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"name\":\"%s\"}",
+                    trace_dumps, trace_dump.running + 1, trace_us(trace_dump.running_since),
+                    us - trace_us(trace_dump.running_since), trace_task(trace_dump.running));
+        trace_dump.running_since = trace_dump.cycles;
+      }
+      trace_dump.running = object;
+      break;
+
+    case KERNEL_TRACE_READY:
+      trace_event("{\"ph\":\"i\",\"s\":\"t\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"name\":\"ready\",\"args\":{\"by\":\"%s\"}}",
+                  trace_dumps, object + 1, us, (tid == TRACE_TID_IRQ) ? "interrupt" : trace_task(task));
+      break;
+
+    case KERNEL_TRACE_DELAY:
+      trace_event("{\"ph\":\"i\",\"s\":\"t\",\"pid\":%u,\"tid\":%d,\"ts\":%.3f,\"name\":\"delay\"}",
+                  trace_dumps, tid, us);
+      break;
+
+    case KERNEL_TRACE_NOTIFY:
+    case KERNEL_TRACE_NOTIFY_FROM_ISR:
+      trace_event("{\"ph\":\"i\",\"s\":\"t\",\"pid\":%u,\"tid\":%d,\"ts\":%.3f,\"name\":\"notify %s\"}",
+                  trace_dumps, tid, us, trace_task(object));
+      break;
+
+    case KERNEL_TRACE_NOTIFY_WAIT_BLOCK:
+    case KERNEL_TRACE_NOTIFY_WAIT:
+      trace_event("{\"ph\":\"i\",\"s\":\"t\",\"pid\":%u,\"tid\":%d,\"ts\":%.3f,\"name\":\"%s\"}",
+                  trace_dumps, tid, us, (event == KERNEL_TRACE_NOTIFY_WAIT) ? "notified" : "wait notification");
+      break;
+
+    case KERNEL_TRACE_ISR_ENTER:
+      trace_dump.irq_depth++;
+      trace_event("{\"ph\":\"B\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"name\":\"%s\"}",
+                  trace_dumps, TRACE_TID_IRQ, us, trace_irq(object, name));
+      break;
+
+    case KERNEL_TRACE_ISR_EXIT:
+      // The oldest records may start inside a handler
+      if (trace_dump.irq_depth > 0)
+      {
+        trace_dump.irq_depth--;
+        trace_event("{\"ph\":\"E\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f}", trace_dumps, TRACE_TID_IRQ, us);
+      }
+      break;
+
+    default:
+      if ((event >= KERNEL_TRACE_QUEUE_SEND) && (event <= KERNEL_TRACE_QUEUE_RECEIVE_FROM_ISR))
+      {
+        trace_event("{\"ph\":\"i\",\"s\":\"t\",\"pid\":%u,\"tid\":%d,\"ts\":%.3f,\"name\":\"%s %s\"}",
+                    trace_dumps, tid, us, trace_queue_events[event], trace_queue(object, name));
+      }
+      break;
+  }
+}
+
+// Closes the slices still open at the end of a dump
+static void trace_finish(void)
+{
+  double us;
+
+  if ((trace_dumps == 0) || (trace_dump.started == false))
+  {
+    return;
+  }
+
+  us = trace_us(trace_dump.cycles);
+
+  if (trace_dump.running >= 0)
+  {
+    trace_event("{\"ph\":\"X\",\"pid\":%u,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"name\":\"%s\"}",
+                trace_dumps, trace_dump.running + 1, trace_us(trace_dump.running_since),
+                us - trace_us(trace_dump.running_since), trace_task(trace_dump.running));
+  }
+
+  for (; trace_dump.irq_depth > 0; trace_dump.irq_depth--)
+  {
+    trace_event("{\"ph\":\"E\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f}", trace_dumps, TRACE_TID_IRQ, us);
+  }
+
+  if (trace_dump.received != trace_dump.expected)
+  {
+    fprintf(stderr, "dump %u: %u of %u records\n", trace_dumps, trace_dump.received, trace_dump.expected);
+  }
+
+  trace_dump.started = false;
+}
+
+static void trace_event(const char* format, ...)
+{
+  va_list args;
+
+  if (trace_first_event == false)
+  {
+    printf(",\n");
+  }
+  trace_first_event = false;
+
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+}
+
+// From the first record of the dump
+static double trace_us(uint64_t cycles)
+{
+  return (trace_dump.clock_hz != 0) ? (double)(cycles - trace_dump.first) * 1e6 / trace_dump.clock_hz : 0;
+}
+
+static const char* trace_task(int number)
+{
+  static char buffer[16];
+
+  if ((number >= 0) && (number < TRACE_TASKS) && (trace_dump.names[number][0] != '\0'))
+  {
+    return trace_dump.names[number];
+  }
+
+  snprintf(buffer, sizeof(buffer), "task %d", number);
+  return buffer;
+}
+
+static const char* trace_irq(uint16_t irq, char* buffer)
+{
+  if ((irq < TRACE_IRQS) && (trace_irq_names[irq] != NULL))
+  {
+    return trace_irq_names[irq];
+  }
+
+  sprintf(buffer, "IRQ %u", irq);
+  return buffer;
+}
+
+static const char* trace_queue(uint16_t queue, char* buffer)
+{
+  uint8_t type;
+
+  if ((queue >= 1) && (queue <= trace_dump.queues))
+  {
+    type = trace_dump.queue_types[queue - 1];
+    if (type < sizeof(trace_queue_types) / sizeof(trace_queue_types[0]))
+    {
+      sprintf(buffer, "%s %u", trace_queue_types[type], queue);
+      return buffer;
+    }
+  }
+
+  sprintf(buffer, "queue %u", queue);
+  return buffer;
+}
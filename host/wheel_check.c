@@ -0,0 +1,715 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Checks the timing wheel of timer_driver.c in simulated time, on a model of
+ * Timer32 counting MCLK mapped at its real address. As in the simulation the
+ * registers are read-only for the driver and every write traps into the model:
+ *
+ *   wheel_check [timers [seed]]
+ *
+ * Timers are started with delays of every magnitude up to TIMER_MAX_DELAY_US
+ * while the time advances, a part of them is cancelled, and every callback
+ * must come in the order of the deadlines, none early and none later than
+ * WHEEL_CHECK_LATE_US. A one-shot timer chained from its callback, with an
+ * interrupt latency added to each step, must keep its schedule when it is
+ * restarted with timer_restart(); the drift of timer_start() is reported.
+ * Then the host time of timer_start(), timer_cancel() and of the expiries is
+ * measured on as many timers, less the time of the traps, the expiries in
+ * one interrupt with their cascades. Prints one JSON
+ * object per part and fails if any part had an error, or if the time of the
+ * driver is not the time of the model. Needs Linux on x86-64.
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#define _GNU_SOURCE
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include "driverlib.h"
+
+#include "timer_driver.h"
+#include "interrupts.h"
+#include "kernel_trace.h"
+
+/*---------------------------------defines------------------------------------*/
+
+#define WHEEL_CHECK_TIMERS          ( 10000 )
+#define WHEEL_CHECK_SEED            ( 1 )
+
+#define WHEEL_CHECK_MCLK_HZ         ( 40000000 )
+#define WHEEL_CHECK_TICKS_PER_US    ( WHEEL_CHECK_MCLK_HZ / 1000000 )
+
+#define WHEEL_CHECK_PAGE            ( 0x1000 )
+#define WHEEL_CHECK_EFLAGS_TF       ( 0x100 )
+
+// Writes timed to take the cost of a trap out of the benchmark
+#define WHEEL_CHECK_TRAPS           ( 10000 )
+
+// One timer in WHEEL_CHECK_CANCEL is cancelled before it expires
+#define WHEEL_CHECK_CANCEL          ( 10 )
+
+// The shortest reload of the driver rounds a deadline up by one microsecond
+#define WHEEL_CHECK_LATE_US         ( 1 )
+
+// The chained timer blinks as the board heartbeat does, each step entered late
+#define WHEEL_CHECK_CHAIN_STEPS     ( 1000 )
+#define WHEEL_CHECK_CHAIN_LATENCY   ( 25 )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+/* Timer32 registers as the model writes them */
+typedef struct
+{
+  volatile uint32_t LOAD;
+  volatile uint32_t VALUE;
+  volatile uint32_t CONTROL;
+  volatile uint32_t INTCLR;
+  volatile uint32_t RIS;
+  volatile uint32_t MIS;
+  volatile uint32_t BGLOAD;
+} wheel_check_regs_t;
+
+/* Min-heap of deadlines in microseconds */
+typedef struct
+{
+  uint64_t* items;
+  uint32_t count;
+} wheel_check_heap_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+static void wheel_check_order(uint32_t timers);
+static void wheel_check_chain(bool restart);
+static void wheel_check_cost(uint32_t timers);
+
+static bool wheel_check_bus_setup(void);
+static void wheel_check_bus_fault(int signal, siginfo_t* info, void* context);
+static void wheel_check_bus_trap(int signal, siginfo_t* info, void* context);
+static void wheel_check_clock(const char* part);
+
+static void wheel_check_sync(void);
+static void wheel_check_run_until(uint64_t ticks);
+static void wheel_check_elapse(uint32_t us);
+static uint64_t wheel_check_now_us(void);
+
+static void wheel_check_fired(void);
+static void wheel_check_chain_step(void);
+static void wheel_check_count(void);
+
+static void wheel_check_push(wheel_check_heap_t* heap, uint64_t value);
+static uint64_t wheel_check_pop(wheel_check_heap_t* heap);
+static uint64_t wheel_check_host_ns(void);
+static uint32_t wheel_check_random(void);
+
+// Entered by the model when Timer32 reloads
+void T32_INT1_IRQHandler(void);
+
+/*--------------------------------variables-----------------------------------*/
+
+static const uint16_t wheel_check_pattern_ms[] = { 50, 250, 50, 650 };
+
+// Writable view of Timer32, the driver sees the read-only one
+static wheel_check_regs_t* wheel_check_regs;
+static bool wheel_check_bus_open = false;
+static uint32_t wheel_check_writes = 0;
+
+// Model of Timer32: MCLK cycles of true time, the load and when it started
+static uint64_t wheel_check_ticks = 0;
+static uint64_t wheel_check_load_start = 0;
+static uint32_t wheel_check_load;
+static uint32_t wheel_check_interrupts = 0;
+
+static timer_entry_t* wheel_check_timers;
+static uint64_t* wheel_check_timers_due;
+static wheel_check_heap_t wheel_check_due;
+static wheel_check_heap_t wheel_check_cancelled;
+
+static uint32_t wheel_check_fired_count;
+static uint64_t wheel_check_late_max;
+static uint32_t wheel_check_errors = 0;
+
+static timer_entry_t wheel_check_chain_timer;
+static bool wheel_check_chain_restart;
+static uint8_t wheel_check_chain_index;
+static uint32_t wheel_check_chain_count;
+static uint64_t wheel_check_chain_due;
+static uint64_t wheel_check_chain_drift;
+
+static uint32_t wheel_check_state;
+
+/*----------------------------------public------------------------------------*/
+
+int main(int argc, char* argv[])
+{
+  uint32_t timers = WHEEL_CHECK_TIMERS;
+
+  wheel_check_state = WHEEL_CHECK_SEED;
+  if (argc > 1)
+  {
+    timers = strtoul(argv[1], NULL, 0);
+  }
+  if (argc > 2)
+  {
+    wheel_check_state = strtoul(argv[2], NULL, 0);
+  }
+
+  if (wheel_check_bus_setup() == false)
+  {
+    fprintf(stderr, "cannot map Timer32 at 0x%08X\n", (unsigned) TIMER32_BASE);
+    return EXIT_FAILURE;
+  }
+
+  wheel_check_timers = calloc(timers, sizeof(timer_entry_t));
+  wheel_check_timers_due = malloc(timers * sizeof(uint64_t));
+  wheel_check_due.items = malloc(timers * sizeof(uint64_t));
+  wheel_check_cancelled.items = malloc(timers * sizeof(uint64_t));
+  if ((wheel_check_timers == NULL) || (wheel_check_timers_due == NULL) ||
+      (wheel_check_due.items == NULL) || (wheel_check_cancelled.items == NULL))
+  {
+    return EXIT_FAILURE;
+  }
+
+  timer_driver_init();
+
+  wheel_check_order(timers);
+  wheel_check_chain(true);
+  wheel_check_chain(false);
+  wheel_check_cost(timers);
+
+  return (wheel_check_errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*---------------------------------private------------------------------------*/
+
+// Timers of every magnitude started as the time goes on, some of them cancelled
+static void wheel_check_order(uint32_t timers)
+{
+  uint32_t errors = wheel_check_errors;
+  uint32_t interrupts = wheel_check_interrupts;
+  uint32_t cancelled = 0;
+  uint32_t delay;
+  uint32_t i;
+  uint32_t j;
+
+  wheel_check_fired_count = 0;
+  wheel_check_late_max = 0;
+
+  for (i = 0; i < timers; i++)
+  {
+    wheel_check_run_until(wheel_check_ticks + (wheel_check_random() % 100) * WHEEL_CHECK_TICKS_PER_US);
+
+    delay = (wheel_check_random() >> (wheel_check_random() % 32)) & TIMER_MAX_DELAY_US;
+    timer_start(&wheel_check_timers[i], delay, 0, wheel_check_fired);
+    wheel_check_timers_due[i] = wheel_check_now_us() + delay;
+    wheel_check_push(&wheel_check_due, wheel_check_timers_due[i]);
+
+    /* Any timer started so far, the driver ignores those that already fired */
+    j = wheel_check_random() % (i + 1);
+    if (((wheel_check_random() % WHEEL_CHECK_CANCEL) == 0) && (timer_is_active(&wheel_check_timers[j]) == true))
+    {
+      wheel_check_push(&wheel_check_cancelled, wheel_check_timers_due[j]);
+      timer_cancel(&wheel_check_timers[j]);
+      cancelled++;
+    }
+  }
+
+  /* Past the longest delay, every timer left must have fired */
+  wheel_check_run_until(wheel_check_ticks + ((uint64_t) TIMER_MAX_DELAY_US + 1) * WHEEL_CHECK_TICKS_PER_US);
+
+  for (i = 0; i < timers; i++)
+  {
+    if (timer_is_active(&wheel_check_timers[i]) == true)
+    {
+      wheel_check_errors++;
+    }
+  }
+  if ((wheel_check_due.count != 0) || (wheel_check_fired_count + cancelled != timers))
+  {
+    fprintf(stderr, "%u timers fired and %u cancelled of %u\n", wheel_check_fired_count, cancelled, timers);
+    wheel_check_errors++;
+  }
+
+  wheel_check_clock("order");
+
+  printf("{\"part\":\"order\",\"timers\":%u,\"cancelled\":%u,\"fired\":%u,\"interrupts\":%u,"
+         "\"late_max_us\":%u,\"errors\":%u}\n", timers, cancelled, wheel_check_fired_count,
+         wheel_check_interrupts - interrupts, (unsigned) wheel_check_late_max, wheel_check_errors - errors);
+}
+
+// A one-shot timer restarted from its callback, as the board heartbeat is
+static void wheel_check_chain(bool restart)
+{
+  uint32_t errors = wheel_check_errors;
+
+  wheel_check_chain_restart = restart;
+  wheel_check_chain_index = 0;
+  wheel_check_chain_count = 0;
+  wheel_check_chain_drift = 0;
+  wheel_check_chain_due = wheel_check_now_us() + wheel_check_pattern_ms[0] * 1000;
+
+  timer_start(&wheel_check_chain_timer, wheel_check_pattern_ms[0] * 1000, 0, wheel_check_chain_step);
+
+  while (wheel_check_chain_count < WHEEL_CHECK_CHAIN_STEPS)
+  {
+    wheel_check_run_until(wheel_check_ticks + 1000 * 1000 * WHEEL_CHECK_TICKS_PER_US);
+  }
+  timer_cancel(&wheel_check_chain_timer);
+
+  /* Restarted from the deadline the latency must not add up */
+  if ((restart == true) && (wheel_check_chain_drift > WHEEL_CHECK_LATE_US))
+  {
+    wheel_check_errors++;
+  }
+
+  wheel_check_clock("chain");
+
+  printf("{\"part\":\"chain\",\"restart\":%s,\"steps\":%u,\"latency_us\":%u,\"drift_us\":%u,\"errors\":%u}\n",
+         (restart == true) ? "true" : "false", wheel_check_chain_count, WHEEL_CHECK_CHAIN_LATENCY,
+         (unsigned) wheel_check_chain_drift, wheel_check_errors - errors);
+}
+
+// Host time per insert, cancel and expiry, every timer inserted at once
+static void wheel_check_cost(uint32_t timers)
+{
+  uint32_t errors = wheel_check_errors;
+  double trap_ns;
+  double insert_ns;
+  double cancel_ns;
+  double expire_ns;
+  uint64_t start;
+  uint32_t interrupts;
+  uint32_t writes;
+  uint32_t i;
+
+  /* A write the model ignores, only the trap */
+  start = wheel_check_host_ns();
+  for (i = 0; i < WHEEL_CHECK_TRAPS; i++)
+  {
+    TIMER32_1->BGLOAD = 0;
+  }
+  trap_ns = (double)(wheel_check_host_ns() - start) / WHEEL_CHECK_TRAPS;
+
+  for (i = 0; i < timers; i++)
+  {
+    wheel_check_timers_due[i] = wheel_check_random() % (60 * 1000 * 1000);
+  }
+
+  writes = wheel_check_writes;
+  start = wheel_check_host_ns();
+  for (i = 0; i < timers; i++)
+  {
+    timer_start(&wheel_check_timers[i], wheel_check_timers_due[i], 0, wheel_check_count);
+  }
+  insert_ns = (double)(wheel_check_host_ns() - start) - (wheel_check_writes - writes) * trap_ns;
+
+  start = wheel_check_host_ns();
+  for (i = 0; i < timers; i++)
+  {
+    timer_cancel(&wheel_check_timers[i]);
+  }
+  cancel_ns = (double)(wheel_check_host_ns() - start);
+
+  /*
+   * All of them due within a second after a minute, and the interrupt entered
+   * after the last one, so they cascade and expire in one go and its traps
+   * weigh nothing. Timer32 reloads only once meanwhile, no tick is lost,
+   * once the deadline the cancelled timers left behind went by.
+   */
+  wheel_check_run_until(wheel_check_ticks + 1000ull * 1000 * WHEEL_CHECK_TICKS_PER_US);
+  for (i = 0; i < timers; i++)
+  {
+    timer_start(&wheel_check_timers[i], 60 * 1000 * 1000 + wheel_check_random() % (1000 * 1000), 0,
+                wheel_check_count);
+  }
+
+  wheel_check_fired_count = 0;
+  interrupts = wheel_check_interrupts;
+  wheel_check_elapse(61 * 1000 * 1000);
+  writes = wheel_check_writes;
+  start = wheel_check_host_ns();
+  wheel_check_run_until(wheel_check_ticks);
+  expire_ns = (double)(wheel_check_host_ns() - start) - (wheel_check_writes - writes) * trap_ns;
+
+  if (wheel_check_fired_count != timers)
+  {
+    wheel_check_errors++;
+  }
+  wheel_check_clock("cost");
+
+  printf("{\"part\":\"cost\",\"timers\":%u,\"insert_ns\":%.1f,\"cancel_ns\":%.1f,\"expire_ns\":%.1f,"
+         "\"interrupts\":%u,\"trap_ns\":%.0f,\"errors\":%u}\n", timers, insert_ns / timers, cancel_ns / timers,
+         expire_ns / timers, wheel_check_interrupts - interrupts, trap_ns, wheel_check_errors - errors);
+}
+
+/*
+ * Two views of a memory file: Timer32 at its address, read-only, and the
+ * writable one of the model. A write of the driver faults, the page is opened
+ * for that single instruction, and the trap that follows closes it again and
+ * lets the model take the write, as sim_bus_setup() does for the simulation.
+ */
+static bool wheel_check_bus_setup(void)
+{
+  struct sigaction action;
+  void* view;
+  int fd;
+
+  fd = memfd_create("timer32", 0);
+  if ((fd < 0) || (ftruncate(fd, WHEEL_CHECK_PAGE) != 0))
+  {
+    return false;
+  }
+
+  view = mmap((void*) TIMER32_BASE, WHEEL_CHECK_PAGE, PROT_READ, MAP_SHARED | MAP_FIXED_NOREPLACE, fd, 0);
+  wheel_check_regs = mmap(NULL, WHEEL_CHECK_PAGE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if ((view != (void*) TIMER32_BASE) || (wheel_check_regs == MAP_FAILED))
+  {
+    return false;
+  }
+
+  memset(&action, 0, sizeof(action));
+  action.sa_flags = SA_SIGINFO | SA_NODEFER;
+  action.sa_sigaction = wheel_check_bus_fault;
+  sigaction(SIGSEGV, &action, NULL);
+  action.sa_sigaction = wheel_check_bus_trap;
+  sigaction(SIGTRAP, &action, NULL);
+
+  return true;
+}
+
+static void wheel_check_bus_fault(int signal, siginfo_t* info, void* context)
+{
+  ucontext_t* ucontext = (ucontext_t*) context;
+  uintptr_t address = (uintptr_t) info->si_addr;
+
+  if ((address < TIMER32_BASE) || (address >= TIMER32_BASE + WHEEL_CHECK_PAGE) || (wheel_check_bus_open == true))
+  {
+    /* A real fault, it happens again without the handler */
+    sigaction(signal, &(struct sigaction) { .sa_handler = SIG_DFL }, NULL);
+    return;
+  }
+
+  wheel_check_bus_open = true;
+  mprotect((void*) TIMER32_BASE, WHEEL_CHECK_PAGE, PROT_READ | PROT_WRITE);
+
+  ucontext->uc_mcontext.gregs[REG_EFL] |= WHEEL_CHECK_EFLAGS_TF;
+}
+
+static void wheel_check_bus_trap(int signal, siginfo_t* info, void* context)
+{
+  ucontext_t* ucontext = (ucontext_t*) context;
+
+  (void) info;
+
+  if (wheel_check_bus_open == false)
+  {
+    sigaction(signal, &(struct sigaction) { .sa_handler = SIG_DFL }, NULL);
+    raise(signal);
+    return;
+  }
+
+  ucontext->uc_mcontext.gregs[REG_EFL] &= ~WHEEL_CHECK_EFLAGS_TF;
+  mprotect((void*) TIMER32_BASE, WHEEL_CHECK_PAGE, PROT_READ);
+  wheel_check_bus_open = false;
+
+  wheel_check_writes++;
+  wheel_check_sync();
+}
+
+// The driver must count the ticks of the model, none lost and none added
+static void wheel_check_clock(const char* part)
+{
+  if (timer_now_ticks() != wheel_check_ticks)
+  {
+    fprintf(stderr, "%s: the driver is at %llu ticks, the model at %llu\n", part,
+            (unsigned long long) timer_now_ticks(), (unsigned long long) wheel_check_ticks);
+    wheel_check_errors++;
+  }
+}
+
+// Takes a load written by the driver and sets the count for the current time
+static void wheel_check_sync(void)
+{
+  uint64_t elapsed;
+
+  /* Cleared after each write, so that writing the same load is seen */
+  if (wheel_check_regs->LOAD != 0)
+  {
+    wheel_check_load = wheel_check_regs->LOAD;
+    wheel_check_load_start = wheel_check_ticks;
+    wheel_check_regs->LOAD = 0;
+  }
+
+  elapsed = wheel_check_ticks - wheel_check_load_start;
+  if (elapsed >= wheel_check_load)
+  {
+    /* Reloaded, maybe more than once, the interrupt is pending */
+    wheel_check_regs->RIS = TIMER32_RIS_RAW_IFG;
+    wheel_check_regs->VALUE = wheel_check_load - (uint32_t)(elapsed % wheel_check_load);
+  }
+  else
+  {
+    wheel_check_regs->RIS = 0;
+    wheel_check_regs->VALUE = wheel_check_load - (uint32_t) elapsed;
+  }
+}
+
+// Advances the time to ticks, entering the interrupt at every reload. Reloads
+// missed while a callback ran raise it only once, as the flag does
+static void wheel_check_run_until(uint64_t ticks)
+{
+  while (wheel_check_load_start + wheel_check_load <= ticks)
+  {
+    if (wheel_check_ticks < wheel_check_load_start + wheel_check_load)
+    {
+      wheel_check_ticks = wheel_check_load_start + wheel_check_load;
+    }
+    wheel_check_load_start += (wheel_check_ticks - wheel_check_load_start) / wheel_check_load * wheel_check_load;
+    wheel_check_sync();
+
+    /* The handler clears the flag before it reads the count */
+    wheel_check_regs->RIS = 0;
+    wheel_check_interrupts++;
+    T32_INT1_IRQHandler();
+    wheel_check_sync();
+  }
+
+  if (wheel_check_ticks < ticks)
+  {
+    wheel_check_ticks = ticks;
+  }
+  wheel_check_sync();
+}
+
+// Time spent in a callback, the interrupt of a reload waits until it returns
+static void wheel_check_elapse(uint32_t us)
+{
+  wheel_check_sync();
+  wheel_check_ticks += (uint64_t) us * WHEEL_CHECK_TICKS_PER_US;
+  wheel_check_sync();
+}
+
+static uint64_t wheel_check_now_us(void)
+{
+  return wheel_check_ticks / WHEEL_CHECK_TICKS_PER_US;
+}
+
+// Callback of the ordered timers: the earliest deadline left must be now
+static void wheel_check_fired(void)
+{
+  uint64_t now = wheel_check_now_us();
+  uint64_t due;
+
+  do
+  {
+    due = wheel_check_pop(&wheel_check_due);
+    if ((wheel_check_cancelled.count == 0) || (wheel_check_cancelled.items[0] != due))
+    {
+      break;
+    }
+    wheel_check_pop(&wheel_check_cancelled);
+  } while (wheel_check_due.count != 0);
+
+  if ((now < due) || (now - due > WHEEL_CHECK_LATE_US))
+  {
+    if (wheel_check_errors < 10)
+    {
+      fprintf(stderr, "timer due at %llu us fired at %llu us\n", (unsigned long long) due, (unsigned long long) now);
+    }
+    wheel_check_errors++;
+  }
+  else if (now - due > wheel_check_late_max)
+  {
+    wheel_check_late_max = now - due;
+  }
+
+  wheel_check_fired_count++;
+}
+
+static void wheel_check_chain_step(void)
+{
+  uint64_t now = wheel_check_now_us();
+  uint64_t drift = (now > wheel_check_chain_due) ? now - wheel_check_chain_due : wheel_check_chain_due - now;
+  uint16_t step_ms;
+
+  if (drift > wheel_check_chain_drift)
+  {
+    wheel_check_chain_drift = drift;
+  }
+  if (now < wheel_check_chain_due)
+  {
+    wheel_check_errors++;
+  }
+
+  wheel_check_elapse(WHEEL_CHECK_CHAIN_LATENCY);
+
+  wheel_check_chain_count++;
+  wheel_check_chain_index = (wheel_check_chain_index + 1) % (sizeof(wheel_check_pattern_ms) / sizeof(uint16_t));
+  step_ms = wheel_check_pattern_ms[wheel_check_chain_index];
+  wheel_check_chain_due += step_ms * 1000;
+
+  if (wheel_check_chain_restart == true)
+  {
+    timer_restart(&wheel_check_chain_timer, step_ms * 1000);
+  }
+  else
+  {
+    timer_start(&wheel_check_chain_timer, step_ms * 1000, 0, wheel_check_chain_step);
+  }
+}
+
+static void wheel_check_count(void)
+{
+  wheel_check_fired_count++;
+}
+
+static void wheel_check_push(wheel_check_heap_t* heap, uint64_t value)
+{
+  uint32_t i = heap->count++;
+
+  while ((i > 0) && (heap->items[(i - 1) / 2] > value))
+  {
+    heap->items[i] = heap->items[(i - 1) / 2];
+    i = (i - 1) / 2;
+  }
+  heap->items[i] = value;
+}
+
+static uint64_t wheel_check_pop(wheel_check_heap_t* heap)
+{
+  uint64_t top = heap->items[0];
+  uint64_t last = heap->items[--heap->count];
+  uint32_t i = 0;
+  uint32_t child;
+
+  while ((child = 2 * i + 1) < heap->count)
+  {
+    if ((child + 1 < heap->count) && (heap->items[child + 1] < heap->items[child]))
+    {
+      child++;
+    }
+    if (last <= heap->items[child])
+    {
+      break;
+    }
+    heap->items[i] = heap->items[child];
+    i = child;
+  }
+  heap->items[i] = last;
+
+  return top;
+}
+
+static uint64_t wheel_check_host_ns(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (uint64_t) now.tv_sec * 1000000000ull + (uint64_t) now.tv_nsec;
+}
+
+// xorshift32
+static uint32_t wheel_check_random(void)
+{
+  wheel_check_state ^= wheel_check_state << 13;
+  wheel_check_state ^= wheel_check_state >> 17;
+  wheel_check_state ^= wheel_check_state << 5;
+
+  return wheel_check_state;
+}
+
+/*---------------------------------driverlib stubs----------------------------*/
+
+uint32_t CS_getMCLK(void)
+{
+  return WHEEL_CHECK_MCLK_HZ;
+}
+
+void Timer32_initModule(uint32_t timer, uint32_t preScaler, uint32_t resolution, uint32_t mode)
+{
+}
+
+void Timer32_setCount(uint32_t timer, uint32_t count)
+{
+  wheel_check_regs->LOAD = count;
+  wheel_check_sync();
+}
+
+void Timer32_clearInterruptFlag(uint32_t timer)
+{
+}
+
+void Timer32_enableInterrupt(uint32_t timer)
+{
+}
+
+void Timer32_startTimer(uint32_t timer, bool oneShot)
+{
+}
+
+void Interrupt_setPriority(uint32_t interruptNumber, uint8_t priority)
+{
+}
+
+void Interrupt_enableInterrupt(uint32_t interruptNumber)
+{
+}
+
+void sim_set_primask(uint32_t primask)
+{
+}
+
+uint32_t interrupts_disable(void)
+{
+  return 0;
+}
+
+void interrupts_restore(uint32_t irq_status)
+{
+}
+
+void kernel_trace_record(uint8_t event, uint16_t object)
+{
+}
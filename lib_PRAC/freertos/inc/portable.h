@@ -174,6 +174,25 @@ void vPortInitialiseBlocks( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetMinimumEverFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * Statistics of the heap, as HeapStats_t of later FreeRTOS versions, and a
+ * walk of every block that returns pdFAIL if the heap is corrupted.  Only
+ * heap_tlsf.c implements them, both take time in the number of blocks.
+ */
+typedef struct xHeapStats
+{
+	size_t xAvailableHeapSpaceInBytes;		/*< Free bytes, block headers included. */
+	size_t xSizeOfLargestFreeBlockInBytes;
+	size_t xSizeOfSmallestFreeBlockInBytes;
+	size_t xNumberOfFreeBlocks;
+	size_t xMinimumEverFreeBytesRemaining;
+	size_t xNumberOfSuccessfulAllocations;
+	size_t xNumberOfSuccessfulFrees;
+} HeapStats_t;
+
+void vPortGetHeapStats( HeapStats_t *pxHeapStats ) PRIVILEGED_FUNCTION;
+BaseType_t xPortCheckHeap( void ) PRIVILEGED_FUNCTION;
+
 /*
  * Setup the hardware ready for the scheduler to take control.  This generally
  * sets up a tick interrupt and sets timers for the correct tick frequency.
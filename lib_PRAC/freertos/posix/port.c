@@ -0,0 +1,485 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for running the kernel
+ * as a Linux process, see portmacro.h.
+ *
+ * A task switch resumes the thread of the new task and suspends the thread
+ * of the old one, so exactly one task thread executes at any time. Switches
+ * requested inside a critical section or an interrupt are held pending until
+ * it ends, as the PendSV exception does on the Cortex-M4.
+ *
+ * xPortRunInterrupt() runs any function as an interrupt handler, so a
+ * simulation of the peripherals can call the real ISRs. It then replaces the
+ * SIGALRM tick with its own by defining vPortSetupTimerInterrupt().
+ *
+ * C library calls that take locks (stdio, malloc) can deadlock if the tick
+ * preempts a task inside them, so tasks make them inside critical sections.
+ *-----------------------------------------------------------*/
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*-----------------------------------------------------------*/
+
+/* The signal that plays the tick interrupt. */
+#define portTICK_SIGNAL				SIGALRM
+
+typedef struct THREAD
+{
+	pthread_t xThread;
+	pthread_mutex_t xMutex;
+	pthread_cond_t xCond;
+	BaseType_t xResume;
+	BaseType_t xDying;
+	TaskFunction_t pxCode;
+	void *pvParameters;
+	struct THREAD *pxNextDead;
+} Thread_t;
+
+/*-----------------------------------------------------------*/
+
+/* The first item in a TCB is the task top of stack, where the thread of the
+task is stored. */
+#define prvGetThreadFromTask( pxTCB )	( ( Thread_t * ) **( ( StackType_t ** ) ( pxTCB ) ) )
+
+static void *prvThreadStart( void *pvParameters );
+static void prvTickSignal( int iSignal );
+static void prvRunInterrupt( void ( *pxHandler )( void ) );
+static void prvSwitchContext( void );
+static void prvResume( Thread_t *pxThread );
+static void prvSuspend( Thread_t *pxThread );
+static void prvTaskExitError( void );
+
+/*-----------------------------------------------------------*/
+
+extern void * volatile pxCurrentTCB;
+
+/* Switches only happen outside critical sections, so a single nesting count
+serves every task. */
+static volatile UBaseType_t uxCriticalNesting = 0;
+
+/* Set while the tick handler runs, a yield then waits for it to return. */
+static volatile BaseType_t xInInterrupt = pdFALSE;
+static volatile BaseType_t xSwitchPending = pdFALSE;
+
+/* Interrupts run before the scheduler starts leave their switch pending. */
+static volatile BaseType_t xSchedulerStarted = pdFALSE;
+
+static sigset_t xInterruptSignals;
+
+/* Threads of deleted tasks, joined and reused by the next task created. */
+static Thread_t *pxDeadThreads = NULL;
+
+/* The thread that started the scheduler waits here for vPortEndScheduler(). */
+static pthread_mutex_t xEndMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t xEndCond = PTHREAD_COND_INITIALIZER;
+static BaseType_t xSchedulerEnded = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * See header file for description.
+ */
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+Thread_t *pxThread;
+pthread_attr_t xAttr;
+sigset_t xOldMask;
+
+	/* The thread inherits the blocked signals, and a tick must not preempt
+	malloc(). */
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, &xOldMask );
+
+	if( pxDeadThreads != NULL )
+	{
+		pxThread = pxDeadThreads;
+		pxDeadThreads = pxThread->pxNextDead;
+		pthread_join( pxThread->xThread, NULL );
+	}
+	else
+	{
+		pxThread = malloc( sizeof( Thread_t ) );
+		configASSERT( pxThread != NULL );
+		pthread_mutex_init( &( pxThread->xMutex ), NULL );
+		pthread_cond_init( &( pxThread->xCond ), NULL );
+	}
+
+	pxThread->xResume = pdFALSE;
+	pxThread->xDying = pdFALSE;
+	pxThread->pxCode = pxCode;
+	pxThread->pvParameters = pvParameters;
+	pxThread->pxNextDead = NULL;
+
+	pthread_attr_init( &xAttr );
+	configASSERT( pthread_create( &( pxThread->xThread ), &xAttr, prvThreadStart, pxThread ) == 0 );
+	pthread_attr_destroy( &xAttr );
+
+	pthread_sigmask( SIG_SETMASK, &xOldMask, NULL );
+
+	/* The task runs on the stack of its thread, the FreeRTOS one only holds
+	the thread. */
+	*pxTopOfStack = ( StackType_t ) pxThread;
+
+	return pxTopOfStack;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * See header file for description.
+ */
+BaseType_t xPortStartScheduler( void )
+{
+	/* Interrupts stay disabled in this thread, it only waits for the end. */
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, NULL );
+
+	vPortSetupTimerInterrupt();
+
+	/* Start the first task. */
+	uxCriticalNesting = 0;
+	xSchedulerStarted = pdTRUE;
+	prvResume( prvGetThreadFromTask( pxCurrentTCB ) );
+
+	pthread_mutex_lock( &xEndMutex );
+	while( xSchedulerEnded == pdFALSE )
+	{
+		pthread_cond_wait( &xEndCond, &xEndMutex );
+	}
+	pthread_mutex_unlock( &xEndMutex );
+
+	return 0;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Returns from vTaskStartScheduler() in the thread that called it. The task
+ * that ends the scheduler never runs again.
+ */
+void vPortEndScheduler( void )
+{
+struct itimerval xTimer;
+Thread_t *pxThread;
+
+	vPortDisableInterrupts();
+
+	memset( &xTimer, 0, sizeof( xTimer ) );
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+
+	pxThread = prvGetThreadFromTask( pxCurrentTCB );
+
+	pthread_mutex_lock( &xEndMutex );
+	xSchedulerEnded = pdTRUE;
+	pthread_cond_signal( &xEndCond );
+	pthread_mutex_unlock( &xEndMutex );
+
+	for( ;; )
+	{
+		prvSuspend( pxThread );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+	if( ( uxCriticalNesting != 0 ) || ( xInInterrupt != pdFALSE ) )
+	{
+		/* Switch when the critical section or the interrupt ends. */
+		xSwitchPending = pdTRUE;
+	}
+	else
+	{
+		vPortDisableInterrupts();
+		prvSwitchContext();
+		vPortEnableInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	vPortDisableInterrupts();
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	configASSERT( uxCriticalNesting );
+	uxCriticalNesting--;
+	if( uxCriticalNesting == 0 )
+	{
+		if( ( xSwitchPending != pdFALSE ) && ( xInInterrupt == pdFALSE ) && ( xSchedulerStarted != pdFALSE ) )
+		{
+			prvSwitchContext();
+		}
+
+		vPortEnableInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortDisableInterrupts( void )
+{
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnableInterrupts( void )
+{
+	/* The interrupt handler returns with the mask it interrupted. */
+	if( xInInterrupt == pdFALSE )
+	{
+		pthread_sigmask( SIG_UNBLOCK, &xInterruptSignals, NULL );
+	}
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxPortSetInterruptMask( void )
+{
+sigset_t xOldMask;
+
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, &xOldMask );
+
+	return ( UBaseType_t ) sigismember( &xOldMask, portTICK_SIGNAL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortClearInterruptMask( UBaseType_t uxMask )
+{
+	if( uxMask == 0 )
+	{
+		pthread_sigmask( SIG_UNBLOCK, &xInterruptSignals, NULL );
+	}
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Runs pxHandler as an interrupt of the running task, or of the thread that
+ * calls main() before the scheduler starts. Returns pdFALSE without running it
+ * if the interrupts are disabled or another handler is running, the caller
+ * then keeps the interrupt pending.
+ */
+BaseType_t xPortRunInterrupt( void ( *pxHandler )( void ) )
+{
+sigset_t xOldMask;
+BaseType_t xReturn = pdFALSE;
+
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, &xOldMask );
+
+	if( ( xInInterrupt == pdFALSE ) && ( sigismember( &xOldMask, portTICK_SIGNAL ) == 0 ) )
+	{
+		prvRunInterrupt( pxHandler );
+		xReturn = pdTRUE;
+	}
+
+	pthread_sigmask( SIG_SETMASK, &xOldMask, NULL );
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+void xPortSysTickHandler( void )
+{
+	if( xTaskIncrementTick() != pdFALSE )
+	{
+		xSwitchPending = pdTRUE;
+	}
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * The default tick is SIGALRM at configTICK_RATE_HZ of real time.
+ */
+void __attribute__( ( weak ) ) vPortSetupTimerInterrupt( void )
+{
+struct sigaction xAction;
+struct itimerval xTimer;
+
+	memset( &xAction, 0, sizeof( xAction ) );
+	xAction.sa_handler = prvTickSignal;
+	xAction.sa_flags = SA_RESTART;
+	xAction.sa_mask = xInterruptSignals;
+	sigaction( portTICK_SIGNAL, &xAction, NULL );
+
+	xTimer.it_interval.tv_sec = 0;
+	xTimer.it_interval.tv_usec = 1000000 / configTICK_RATE_HZ;
+	xTimer.it_value = xTimer.it_interval;
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Called by the idle task when it frees the TCB of a deleted task, whose
+ * thread is suspended: it ends and waits to be joined.
+ */
+void vPortCleanUpTCB( void *pxTCB )
+{
+Thread_t *pxThread;
+UBaseType_t uxMask;
+
+	uxMask = uxPortSetInterruptMask();
+
+	pxThread = prvGetThreadFromTask( pxTCB );
+	pxThread->xDying = pdTRUE;
+	prvResume( pxThread );
+
+	pxThread->pxNextDead = pxDeadThreads;
+	pxDeadThreads = pxThread;
+
+	vPortClearInterruptMask( uxMask );
+}
+/*-----------------------------------------------------------*/
+
+/* The signals are set up before main() so tasks can be created first. */
+static void __attribute__( ( constructor ) ) prvPortSetup( void )
+{
+	sigemptyset( &xInterruptSignals );
+	sigaddset( &xInterruptSignals, portTICK_SIGNAL );
+}
+/*-----------------------------------------------------------*/
+
+static void *prvThreadStart( void *pvParameters )
+{
+Thread_t *pxThread = ( Thread_t * ) pvParameters;
+
+	prvSuspend( pxThread );
+
+	/* Started by a task switch, so outside any critical section. */
+	vPortEnableInterrupts();
+
+	pxThread->pxCode( pxThread->pvParameters );
+
+	prvTaskExitError();
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+/* The signal is only delivered while the interrupts are enabled. */
+static void prvTickSignal( int iSignal )
+{
+	( void ) iSignal;
+
+	prvRunInterrupt( xPortSysTickHandler );
+}
+/*-----------------------------------------------------------*/
+
+/* Called with the interrupts disabled. */
+static void prvRunInterrupt( void ( *pxHandler )( void ) )
+{
+	xInInterrupt = pdTRUE;
+	pxHandler();
+	xInInterrupt = pdFALSE;
+
+	/* Switching here only suspends the interrupted task until it is resumed
+	again, and it then returns from the interrupt. */
+	if( ( xSwitchPending != pdFALSE ) && ( xSchedulerStarted != pdFALSE ) )
+	{
+		prvSwitchContext();
+	}
+}
+/*-----------------------------------------------------------*/
+
+/* Called with the interrupts disabled and outside any critical section. */
+static void prvSwitchContext( void )
+{
+Thread_t *pxOld;
+Thread_t *pxNew;
+
+	xSwitchPending = pdFALSE;
+
+	pxOld = prvGetThreadFromTask( pxCurrentTCB );
+	vTaskSwitchContext();
+	pxNew = prvGetThreadFromTask( pxCurrentTCB );
+
+	if( pxNew != pxOld )
+	{
+		prvResume( pxNew );
+		prvSuspend( pxOld );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvResume( Thread_t *pxThread )
+{
+	pthread_mutex_lock( &( pxThread->xMutex ) );
+	pxThread->xResume = pdTRUE;
+	pthread_cond_signal( &( pxThread->xCond ) );
+	pthread_mutex_unlock( &( pxThread->xMutex ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSuspend( Thread_t *pxThread )
+{
+BaseType_t xDying;
+
+	pthread_mutex_lock( &( pxThread->xMutex ) );
+	while( pxThread->xResume == pdFALSE )
+	{
+		pthread_cond_wait( &( pxThread->xCond ), &( pxThread->xMutex ) );
+	}
+	pxThread->xResume = pdFALSE;
+	xDying = pxThread->xDying;
+	pthread_mutex_unlock( &( pxThread->xMutex ) );
+
+	if( xDying != pdFALSE )
+	{
+		pthread_exit( NULL );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvTaskExitError( void )
+{
+	/* A function that implements a task must not exit or attempt to return to
+	its caller as there is nothing to return to.  If a task wants to exit it
+	should instead call vTaskDelete( NULL ). */
+	configASSERT( uxCriticalNesting == ~0UL );
+	vPortDisableInterrupts();
+	for( ;; )
+	{
+		prvSuspend( prvGetThreadFromTask( pxCurrentTCB ) );
+	}
+}
+/*-----------------------------------------------------------*/
@@ -87,6 +87,9 @@ task.h is included from an application file. */
 
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
+/* heap_tlsf.c replaces this file when configUSE_HEAP_TLSF is 1. */
+#if( configUSE_HEAP_TLSF == 0 )
+
 #if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
 	#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
 #endif
@@ -184,5 +187,5 @@ size_t xPortGetFreeHeapSize( void )
 	return ( configADJUSTED_HEAP_SIZE - xNextFreeByte );
 }
 
-
+#endif /* configUSE_HEAP_TLSF */
 
@@ -0,0 +1,593 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*-----------------------------------------------------------
+ * pvPortMalloc() and vPortFree() on a two-level segregated fit (TLSF)
+ * allocator, used instead of heap_1.c when configUSE_HEAP_TLSF is 1.
+ *
+ * Free blocks are kept in lists by size class.  The first level is the power
+ * of two of the size and the second level splits it in heapSL_COUNT equal
+ * ranges.  A bitmap per level finds the first list that is not empty with a
+ * count leading zeros instruction, so both functions take a bounded time
+ * whatever the number of blocks.  Requests are rounded up to the next class
+ * before the search, so the head of the list found always fits (good fit),
+ * and the rest of the block is split off.  Freed blocks are merged with the
+ * free blocks next to them in memory at once, so no two free blocks touch.
+ *
+ * Every block starts with a header holding its size and the block before it
+ * in memory, heapHEADER_SIZE bytes of each allocation.  The lists go through
+ * the data of the free blocks.
+ *-----------------------------------------------------------*/
+
+#include <stddef.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configUSE_HEAP_TLSF == 1 )
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+	#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+#if( portBYTE_ALIGNMENT != 8 )
+	#error heapALIGNMENT_LOG2 must match portBYTE_ALIGNMENT
+#endif
+
+/*-----------------------------------------------------------*/
+
+#define heapALIGNMENT_LOG2			( 3 )
+
+/* Second level lists per power of two, their sizes are at most 1/8 apart. */
+#define heapSL_COUNT_LOG2			( 3 )
+#define heapSL_COUNT				( 1UL << heapSL_COUNT_LOG2 )
+
+/* Blocks smaller than heapSMALL_SIZE share the first row of lists, one per
+portBYTE_ALIGNMENT step, and row n holds the blocks from
+heapSMALL_SIZE << ( n - 1 ). */
+#define heapFL_SHIFT				( heapSL_COUNT_LOG2 + heapALIGNMENT_LOG2 )
+#define heapSMALL_SIZE				( ( size_t ) 1 << heapFL_SHIFT )
+
+/* Blocks are smaller than 1 MB, 120 lists. */
+#define heapMAX_SIZE_LOG2			( 20 )
+#define heapFL_COUNT				( heapMAX_SIZE_LOG2 - heapFL_SHIFT + 1 )
+
+/* The low bit of the size, always a multiple of portBYTE_ALIGNMENT, marks the
+free blocks. */
+#define heapBLOCK_FREE				( ( size_t ) 1 )
+#define heapBLOCK_SIZE( pxBlock )	( ( pxBlock )->xSize & ~heapBLOCK_FREE )
+#define heapBLOCK_IS_FREE( pxBlock )	( ( ( pxBlock )->xSize & heapBLOCK_FREE ) != 0 )
+
+#define heapALIGN_UP( x )			( ( ( x ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+#if defined( __TI_COMPILER_VERSION__ )
+	#define heapCLZ( x )			__clz( x )
+#else
+	#define heapCLZ( x )			__builtin_clz( x )
+#endif
+
+typedef struct BLOCK_HEADER
+{
+	struct BLOCK_HEADER *pxPrevPhysical;	/*< The block before this one in memory, NULL for the first. */
+	size_t xSize;							/*< Bytes of the block, header included, and heapBLOCK_FREE. */
+	struct BLOCK_HEADER *pxNextFree;		/*< Only while free, in the first bytes of the data. */
+	struct BLOCK_HEADER *pxPrevFree;
+} BlockHeader_t;
+
+#define heapHEADER_SIZE				heapALIGN_UP( offsetof( BlockHeader_t, pxNextFree ) )
+#define heapMIN_BLOCK_SIZE			heapALIGN_UP( sizeof( BlockHeader_t ) )
+
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void );
+static UBaseType_t prvFls( size_t xValue );
+static void prvMapping( size_t xSize, UBaseType_t *puxFl, UBaseType_t *puxSl );
+static BlockHeader_t *prvFindSuitable( size_t xSize );
+static void prvInsertFreeBlock( BlockHeader_t *pxBlock );
+static void prvRemoveFreeBlock( BlockHeader_t *pxBlock );
+static BlockHeader_t *prvNextPhysical( BlockHeader_t *pxBlock );
+
+/*-----------------------------------------------------------*/
+
+/* Allocate the memory for the heap. */
+#if( configAPPLICATION_ALLOCATED_HEAP == 1 )
+	/* The application writer has already defined the array used for the RTOS
+	heap - probably so it can be placed in a special segment or address. */
+	extern uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#else
+	static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#endif /* configAPPLICATION_ALLOCATED_HEAP */
+
+/* Heads of the free lists and the bitmaps of those that are not empty. */
+static BlockHeader_t *pxFreeLists[ heapFL_COUNT ][ heapSL_COUNT ];
+static uint32_t ulFlBitmap = 0;
+static uint32_t ulSlBitmaps[ heapFL_COUNT ];
+
+/* The first block and the empty block that ends the heap, NULL until the
+first allocation. */
+static BlockHeader_t *pxHeapStart = NULL;
+static BlockHeader_t *pxHeapEnd = NULL;
+
+static size_t xFreeBytesRemaining = 0;
+static size_t xMinimumEverFreeBytesRemaining = 0;
+static size_t xNumberOfSuccessfulAllocations = 0;
+static size_t xNumberOfSuccessfulFrees = 0;
+
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+void *pvReturn = NULL;
+BlockHeader_t *pxBlock;
+BlockHeader_t *pxRemainder;
+size_t xBlockSize;
+size_t xSearchSize;
+
+	vTaskSuspendAll();
+	{
+		if( pxHeapEnd == NULL )
+		{
+			prvHeapInit();
+		}
+
+		if( ( xWantedSize > 0 ) && ( xWantedSize < ( ( size_t ) 1 << ( heapMAX_SIZE_LOG2 - 1 ) ) ) )
+		{
+			xBlockSize = heapALIGN_UP( xWantedSize + heapHEADER_SIZE );
+			if( xBlockSize < heapMIN_BLOCK_SIZE )
+			{
+				xBlockSize = heapMIN_BLOCK_SIZE;
+			}
+
+			/* Up to the next class, where every block is large enough. */
+			xSearchSize = xBlockSize;
+			if( xSearchSize >= heapSMALL_SIZE )
+			{
+				xSearchSize += ( ( size_t ) 1 << ( prvFls( xSearchSize ) - heapSL_COUNT_LOG2 ) ) - 1;
+			}
+
+			pxBlock = prvFindSuitable( xSearchSize );
+			if( pxBlock != NULL )
+			{
+				prvRemoveFreeBlock( pxBlock );
+
+				/* The rest becomes a free block if it can hold the list
+				pointers.  Its next block is not free, the whole was. */
+				if( ( pxBlock->xSize - xBlockSize ) >= heapMIN_BLOCK_SIZE )
+				{
+					pxRemainder = ( BlockHeader_t * ) ( ( uint8_t * ) pxBlock + xBlockSize );
+					pxRemainder->pxPrevPhysical = pxBlock;
+					pxRemainder->xSize = pxBlock->xSize - xBlockSize;
+					prvNextPhysical( pxRemainder )->pxPrevPhysical = pxRemainder;
+					pxBlock->xSize = xBlockSize;
+					prvInsertFreeBlock( pxRemainder );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+
+				xNumberOfSuccessfulAllocations++;
+				pvReturn = ( uint8_t * ) pxBlock + heapHEADER_SIZE;
+			}
+		}
+
+		traceMALLOC( pvReturn, xWantedSize );
+	}
+	( void ) xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+BlockHeader_t *pxBlock;
+BlockHeader_t *pxNeighbour;
+
+	if( pv == NULL )
+	{
+		return;
+	}
+
+	pxBlock = ( BlockHeader_t * ) ( ( uint8_t * ) pv - heapHEADER_SIZE );
+
+	/* Not allocated by pvPortMalloc(), or freed twice. */
+	configASSERT( ( pxHeapEnd != NULL ) && ( heapBLOCK_IS_FREE( pxBlock ) == pdFALSE ) );
+
+	vTaskSuspendAll();
+	{
+		traceFREE( pv, pxBlock->xSize );
+		xNumberOfSuccessfulFrees++;
+
+		pxNeighbour = prvNextPhysical( pxBlock );
+		if( heapBLOCK_IS_FREE( pxNeighbour ) )
+		{
+			prvRemoveFreeBlock( pxNeighbour );
+			pxBlock->xSize += pxNeighbour->xSize;
+			prvNextPhysical( pxBlock )->pxPrevPhysical = pxBlock;
+		}
+
+		pxNeighbour = pxBlock->pxPrevPhysical;
+		if( ( pxNeighbour != NULL ) && heapBLOCK_IS_FREE( pxNeighbour ) )
+		{
+			prvRemoveFreeBlock( pxNeighbour );
+			pxNeighbour->xSize += pxBlock->xSize;
+			prvNextPhysical( pxNeighbour )->pxPrevPhysical = pxNeighbour;
+			pxBlock = pxNeighbour;
+		}
+
+		prvInsertFreeBlock( pxBlock );
+	}
+	( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+UBaseType_t uxFl;
+UBaseType_t uxSl;
+
+	/* As in heap_1.c, frees everything, the next allocation builds the heap
+	again. */
+	for( uxFl = 0; uxFl < heapFL_COUNT; uxFl++ )
+	{
+		for( uxSl = 0; uxSl < heapSL_COUNT; uxSl++ )
+		{
+			pxFreeLists[ uxFl ][ uxSl ] = NULL;
+		}
+		ulSlBitmaps[ uxFl ] = 0;
+	}
+
+	ulFlBitmap = 0;
+	pxHeapStart = NULL;
+	pxHeapEnd = NULL;
+	xFreeBytesRemaining = 0;
+	xMinimumEverFreeBytesRemaining = 0;
+	xNumberOfSuccessfulAllocations = 0;
+	xNumberOfSuccessfulFrees = 0;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( HeapStats_t *pxHeapStats )
+{
+BlockHeader_t *pxBlock;
+UBaseType_t uxFl;
+UBaseType_t uxSl;
+
+	pxHeapStats->xSizeOfLargestFreeBlockInBytes = 0;
+	pxHeapStats->xSizeOfSmallestFreeBlockInBytes = 0;
+	pxHeapStats->xNumberOfFreeBlocks = 0;
+
+	vTaskSuspendAll();
+	{
+		for( uxFl = 0; uxFl < heapFL_COUNT; uxFl++ )
+		{
+			for( uxSl = 0; uxSl < heapSL_COUNT; uxSl++ )
+			{
+				for( pxBlock = pxFreeLists[ uxFl ][ uxSl ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFree )
+				{
+					if( heapBLOCK_SIZE( pxBlock ) > pxHeapStats->xSizeOfLargestFreeBlockInBytes )
+					{
+						pxHeapStats->xSizeOfLargestFreeBlockInBytes = heapBLOCK_SIZE( pxBlock );
+					}
+
+					if( ( pxHeapStats->xNumberOfFreeBlocks == 0 ) || ( heapBLOCK_SIZE( pxBlock ) < pxHeapStats->xSizeOfSmallestFreeBlockInBytes ) )
+					{
+						pxHeapStats->xSizeOfSmallestFreeBlockInBytes = heapBLOCK_SIZE( pxBlock );
+					}
+
+					pxHeapStats->xNumberOfFreeBlocks++;
+				}
+			}
+		}
+
+		pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+		pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+		pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+	}
+	( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortCheckHeap( void )
+{
+BlockHeader_t *pxBlock;
+BlockHeader_t *pxPrevious = NULL;
+BaseType_t xReturn = pdPASS;
+BaseType_t xPreviousFree = pdFALSE;
+size_t xFreeBytes = 0;
+size_t xFreeBlocks = 0;
+size_t xListedBlocks = 0;
+UBaseType_t uxFl;
+UBaseType_t uxSl;
+UBaseType_t uxBlockFl;
+UBaseType_t uxBlockSl;
+
+	vTaskSuspendAll();
+	{
+		if( pxHeapEnd != NULL )
+		{
+			/* In memory order, the blocks must link back and tile the heap
+			without two free blocks in a row. */
+			for( pxBlock = pxHeapStart; ( pxBlock != pxHeapEnd ) && ( xReturn == pdPASS ); pxBlock = prvNextPhysical( pxBlock ) )
+			{
+				if( ( pxBlock->pxPrevPhysical != pxPrevious ) ||
+					( heapBLOCK_SIZE( pxBlock ) < heapMIN_BLOCK_SIZE ) ||
+					( ( heapBLOCK_SIZE( pxBlock ) & portBYTE_ALIGNMENT_MASK ) != 0 ) ||
+					( ( uint8_t * ) prvNextPhysical( pxBlock ) > ( uint8_t * ) pxHeapEnd ) ||
+					( xPreviousFree && heapBLOCK_IS_FREE( pxBlock ) ) )
+				{
+					xReturn = pdFAIL;
+				}
+
+				xPreviousFree = heapBLOCK_IS_FREE( pxBlock );
+				if( xPreviousFree != pdFALSE )
+				{
+					xFreeBytes += heapBLOCK_SIZE( pxBlock );
+					xFreeBlocks++;
+				}
+				pxPrevious = pxBlock;
+			}
+
+			if( ( pxHeapEnd->pxPrevPhysical != pxPrevious ) || ( xFreeBytes != xFreeBytesRemaining ) )
+			{
+				xReturn = pdFAIL;
+			}
+
+			/* Every free block in the list of its class, and the bitmaps set
+			for the lists that are not empty. */
+			for( uxFl = 0; ( uxFl < heapFL_COUNT ) && ( xReturn == pdPASS ); uxFl++ )
+			{
+				for( uxSl = 0; uxSl < heapSL_COUNT; uxSl++ )
+				{
+					if( ( pxFreeLists[ uxFl ][ uxSl ] != NULL ) != ( ( ( ulSlBitmaps[ uxFl ] >> uxSl ) & 1UL ) != 0 ) )
+					{
+						xReturn = pdFAIL;
+					}
+
+					for( pxBlock = pxFreeLists[ uxFl ][ uxSl ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFree )
+					{
+						prvMapping( heapBLOCK_SIZE( pxBlock ), &uxBlockFl, &uxBlockSl );
+						if( ( heapBLOCK_IS_FREE( pxBlock ) == pdFALSE ) || ( uxBlockFl != uxFl ) || ( uxBlockSl != uxSl ) ||
+							( ( pxBlock->pxNextFree != NULL ) && ( pxBlock->pxNextFree->pxPrevFree != pxBlock ) ) ||
+							( ++xListedBlocks > xFreeBlocks ) )
+						{
+							xReturn = pdFAIL;
+							break;
+						}
+					}
+				}
+
+				if( ( ulSlBitmaps[ uxFl ] != 0 ) != ( ( ( ulFlBitmap >> uxFl ) & 1UL ) != 0 ) )
+				{
+					xReturn = pdFAIL;
+				}
+			}
+
+			if( xListedBlocks != xFreeBlocks )
+			{
+				xReturn = pdFAIL;
+			}
+		}
+	}
+	( void ) xTaskResumeAll();
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void )
+{
+uint8_t *pucStart;
+size_t xTotalSize;
+
+	/* Ensure the heap starts on a correctly aligned boundary. */
+	pucStart = ( uint8_t * ) heapALIGN_UP( ( portPOINTER_SIZE_TYPE ) ucHeap );
+	xTotalSize = ( configTOTAL_HEAP_SIZE - ( size_t ) ( pucStart - ucHeap ) ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+	/* One free block and the header of an empty allocated one at the end, so
+	the last block has a next block. */
+	pxHeapStart = ( BlockHeader_t * ) pucStart;
+	pxHeapEnd = ( BlockHeader_t * ) ( pucStart + xTotalSize - heapHEADER_SIZE );
+
+	pxHeapStart->pxPrevPhysical = NULL;
+	pxHeapStart->xSize = xTotalSize - heapHEADER_SIZE;
+	pxHeapEnd->pxPrevPhysical = pxHeapStart;
+	pxHeapEnd->xSize = 0;
+
+	configASSERT( pxHeapStart->xSize < ( ( size_t ) 1 << heapMAX_SIZE_LOG2 ) );
+
+	prvInsertFreeBlock( pxHeapStart );
+	xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+/* Index of the highest bit set, xValue is not 0. */
+static UBaseType_t prvFls( size_t xValue )
+{
+	return ( UBaseType_t ) ( 31 - heapCLZ( ( uint32_t ) xValue ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvMapping( size_t xSize, UBaseType_t *puxFl, UBaseType_t *puxSl )
+{
+UBaseType_t uxFls;
+
+	if( xSize < heapSMALL_SIZE )
+	{
+		*puxFl = 0;
+		*puxSl = ( UBaseType_t ) ( xSize >> heapALIGNMENT_LOG2 );
+	}
+	else
+	{
+		uxFls = prvFls( xSize );
+		*puxFl = uxFls - heapFL_SHIFT + 1;
+		*puxSl = ( UBaseType_t ) ( xSize >> ( uxFls - heapSL_COUNT_LOG2 ) ) & ( heapSL_COUNT - 1 );
+	}
+}
+/*-----------------------------------------------------------*/
+
+/* Head of the first list from the class of xSize on that is not empty. */
+static BlockHeader_t *prvFindSuitable( size_t xSize )
+{
+UBaseType_t uxFl;
+UBaseType_t uxSl;
+uint32_t ulMap;
+
+	prvMapping( xSize, &uxFl, &uxSl );
+	if( uxFl >= heapFL_COUNT )
+	{
+		return NULL;
+	}
+
+	ulMap = ulSlBitmaps[ uxFl ] & ( 0xFFFFFFFFUL << uxSl );
+	if( ulMap == 0 )
+	{
+		/* Any list of a larger power of two. */
+		ulMap = ulFlBitmap & ( 0xFFFFFFFFUL << ( uxFl + 1 ) );
+		if( ulMap == 0 )
+		{
+			return NULL;
+		}
+
+		uxFl = prvFls( ulMap & ( ~ulMap + 1 ) );
+		ulMap = ulSlBitmaps[ uxFl ];
+	}
+
+	uxSl = prvFls( ulMap & ( ~ulMap + 1 ) );
+
+	return pxFreeLists[ uxFl ][ uxSl ];
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertFreeBlock( BlockHeader_t *pxBlock )
+{
+UBaseType_t uxFl;
+UBaseType_t uxSl;
+
+	prvMapping( pxBlock->xSize, &uxFl, &uxSl );
+
+	pxBlock->pxPrevFree = NULL;
+	pxBlock->pxNextFree = pxFreeLists[ uxFl ][ uxSl ];
+	if( pxBlock->pxNextFree != NULL )
+	{
+		pxBlock->pxNextFree->pxPrevFree = pxBlock;
+	}
+	pxFreeLists[ uxFl ][ uxSl ] = pxBlock;
+
+	ulFlBitmap |= 1UL << uxFl;
+	ulSlBitmaps[ uxFl ] |= 1UL << uxSl;
+
+	xFreeBytesRemaining += pxBlock->xSize;
+	pxBlock->xSize |= heapBLOCK_FREE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFreeBlock( BlockHeader_t *pxBlock )
+{
+UBaseType_t uxFl;
+UBaseType_t uxSl;
+
+	pxBlock->xSize &= ~heapBLOCK_FREE;
+	xFreeBytesRemaining -= pxBlock->xSize;
+
+	if( pxBlock->pxNextFree != NULL )
+	{
+		pxBlock->pxNextFree->pxPrevFree = pxBlock->pxPrevFree;
+	}
+
+	if( pxBlock->pxPrevFree != NULL )
+	{
+		pxBlock->pxPrevFree->pxNextFree = pxBlock->pxNextFree;
+	}
+	else
+	{
+		/* The head of its list, which may become empty. */
+		prvMapping( pxBlock->xSize, &uxFl, &uxSl );
+		pxFreeLists[ uxFl ][ uxSl ] = pxBlock->pxNextFree;
+
+		if( pxBlock->pxNextFree == NULL )
+		{
+			ulSlBitmaps[ uxFl ] &= ~( 1UL << uxSl );
+			if( ulSlBitmaps[ uxFl ] == 0 )
+			{
+				ulFlBitmap &= ~( 1UL << uxFl );
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static BlockHeader_t *prvNextPhysical( BlockHeader_t *pxBlock )
+{
+	return ( BlockHeader_t * ) ( ( uint8_t * ) pxBlock + heapBLOCK_SIZE( pxBlock ) );
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_HEAP_TLSF */
@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stddef.h>
+
+#include "driverlib.h"
+
+#include "adc_driver.h"
+#include "interrupts.h"
+#include "kernel_trace.h"
+
+#include "FreeRTOSConfig.h"
+
+/*---------------------------------defines------------------------------------*/
+/*---------------------------------typedefs-----------------------------------*/
+/*--------------------------------prototypes----------------------------------*/
+
+static void adc_driver_start_next(void);
+static void adc_driver_stop(void);
+
+/*--------------------------------variables-----------------------------------*/
+
+static const adc_driver_sequence_t* adc_queue[ADC_DRIVER_QUEUE_SIZE];
+static uint8_t adc_queue_head = 0;
+static uint8_t adc_queue_count = 0;
+
+// Sequence being converted, NULL when the ADC14 is idle
+static const adc_driver_sequence_t* adc_active = NULL;
+
+// Owner of the ADC14 while acquired
+static adc_driver_irq_t adc_owner = NULL;
+static bool adc_acquired = false;
+
+static uint16_t adc_results[ADC_DRIVER_SEQUENCE_MAX];
+
+static bool adc_initialized = false;
+
+/*----------------------------------public------------------------------------*/
+
+void adc_driver_init(void)
+{
+  /* Several drivers share the ADC14, initialize it only once */
+  if (adc_initialized == true)
+  {
+    return;
+  }
+
+  MAP_ADC14_enableModule();
+  adc_driver_stop();
+
+  MAP_Interrupt_setPriority(INT_ADC14, configMAX_SYSCALL_INTERRUPT_PRIORITY);
+  MAP_Interrupt_enableInterrupt(INT_ADC14);
+
+  adc_initialized = true;
+}
+
+// Queues one conversion of sequence. Returns false if the queue is full
+// or the sequence is invalid. Can be called from tasks and interrupts
+bool adc_driver_request(const adc_driver_sequence_t* sequence)
+{
+  uint32_t irq_status;
+  uint8_t pending;
+
+  if ((sequence->length == 0) || (sequence->length > ADC_DRIVER_SEQUENCE_MAX))
+  {
+    return false;
+  }
+
+  irq_status = interrupts_disable();
+
+  /* Keep room for a sequence pushed back by adc_driver_acquire() */
+  pending = adc_queue_count + ((adc_active != NULL) ? 1 : 0);
+  if (pending >= ADC_DRIVER_QUEUE_SIZE)
+  {
+    interrupts_restore(irq_status);
+    return false;
+  }
+
+  adc_queue[(adc_queue_head + adc_queue_count) % ADC_DRIVER_QUEUE_SIZE] = sequence;
+  adc_queue_count++;
+
+  if ((adc_active == NULL) && (adc_acquired == false))
+  {
+    adc_driver_start_next();
+  }
+
+  interrupts_restore(irq_status);
+
+  return true;
+}
+
+// Takes the ADC14 for a continuous mode. A sequence being converted is
+// aborted and converted again after adc_driver_release(). While acquired the
+// owner configures the ADC14 itself and handler gets every interrupt
+bool adc_driver_acquire(adc_driver_irq_t handler)
+{
+  uint32_t irq_status;
+
+  irq_status = interrupts_disable();
+
+  if (adc_acquired == true)
+  {
+    interrupts_restore(irq_status);
+    return false;
+  }
+
+  if (adc_active != NULL)
+  {
+    adc_queue_head = (adc_queue_head + ADC_DRIVER_QUEUE_SIZE - 1) % ADC_DRIVER_QUEUE_SIZE;
+    adc_queue[adc_queue_head] = adc_active;
+    adc_queue_count++;
+    adc_active = NULL;
+  }
+
+  adc_driver_stop();
+
+  adc_acquired = true;
+  adc_owner = handler;
+
+  interrupts_restore(irq_status);
+
+  return true;
+}
+
+// Gives the ADC14 back to the queued sequences
+void adc_driver_release(void)
+{
+  uint32_t irq_status;
+
+  irq_status = interrupts_disable();
+
+  if (adc_acquired == true)
+  {
+    adc_driver_stop();
+
+    adc_acquired = false;
+    adc_owner = NULL;
+
+    adc_driver_start_next();
+  }
+
+  interrupts_restore(irq_status);
+}
+
+/*---------------------------------private------------------------------------*/
+
+// Programs and triggers the oldest queued sequence. Interrupts must be disabled
+static void adc_driver_start_next(void)
+{
+  const adc_driver_sequence_t* sequence;
+  uint8_t i;
+
+  if (adc_queue_count == 0)
+  {
+    return;
+  }
+
+  sequence = adc_queue[adc_queue_head];
+  adc_queue_head = (adc_queue_head + 1) % ADC_DRIVER_QUEUE_SIZE;
+  adc_queue_count--;
+  adc_active = sequence;
+
+  MAP_ADC14_initModule(sequence->clock_source, ADC_PREDIVIDER_1, ADC_DIVIDER_1, sequence->internal_channels);
+  MAP_ADC14_setSampleHoldTime(sequence->sample_time, sequence->sample_time);
+  MAP_ADC14_setSampleHoldTrigger(ADC_TRIGGER_ADCSC, false);
+
+  /* One pass over ADC_MEM0 - ADC_MEMn, stepping automatically */
+  MAP_ADC14_configureMultiSequenceMode(ADC_MEM0, ADC_MEM0 << (sequence->length - 1), false);
+  for (i = 0; i < sequence->length; i++)
+  {
+    MAP_ADC14_configureConversionMemory(ADC_MEM0 << i, sequence->reference, sequence->inputs[i], false);
+  }
+  MAP_ADC14_enableSampleTimer(ADC_AUTOMATIC_ITERATION);
+
+  /* Interrupt at the end of the sequence */
+  MAP_ADC14_enableInterrupt(ADC_INT0 << (sequence->length - 1));
+
+  MAP_ADC14_enableConversion();
+  MAP_ADC14_toggleConversionTrigger();
+}
+
+// Stops any conversion and leaves no ADC14 interrupt enabled
+static void adc_driver_stop(void)
+{
+  MAP_ADC14_disableConversion();
+  while (MAP_ADC14_isBusy())
+    ;
+
+  ADC14->IER0 = 0;
+  ADC14->IER1 = 0;
+  ADC14->CLRIFGR0 = 0xFFFFFFFF;
+  ADC14->CLRIFGR1 = 0xFFFFFFFF;
+}
+
+/*--------------------------------interrupts----------------------------------*/
+
+void ADC_Handler(void)
+{
+  const adc_driver_sequence_t* sequence;
+  uint64_t status;
+  uint32_t irq_status;
+  uint8_t i;
+
+  KERNEL_TRACE_ISR_ENTER(INT_ADC14);
+
+  status = MAP_ADC14_getEnabledInterruptStatus();
+  MAP_ADC14_clearInterruptFlag(status);
+
+  if (adc_acquired == true)
+  {
+    if (adc_owner != NULL)
+    {
+      adc_owner(status);
+    }
+    KERNEL_TRACE_ISR_EXIT(INT_ADC14);
+    return;
+  }
+
+  if (adc_active == NULL)
+  {
+    KERNEL_TRACE_ISR_EXIT(INT_ADC14);
+    return;
+  }
+
+  sequence = adc_active;
+
+  for (i = 0; i < sequence->length; i++)
+  {
+    adc_results[i] = ADC14->MEM[i];
+  }
+
+  MAP_ADC14_disableConversion();
+  MAP_ADC14_disableInterrupt(ADC_INT0 << (sequence->length - 1));
+  adc_active = NULL;
+
+  /* The callback may queue its next sequence right away */
+  if (sequence->callback != NULL)
+  {
+    sequence->callback(adc_results, sequence->length);
+  }
+
+  /* Higher priority interrupts may be queueing sequences too */
+  irq_status = interrupts_disable();
+
+  if ((adc_active == NULL) && (adc_acquired == false))
+  {
+    adc_driver_start_next();
+  }
+
+  interrupts_restore(irq_status);
+
+  KERNEL_TRACE_ISR_EXIT(INT_ADC14);
+}
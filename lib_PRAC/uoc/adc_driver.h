@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef ADC_DRIVER_H_
+#define ADC_DRIVER_H_
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*---------------------------------defines------------------------------------*/
+
+/*
+ * ADC14 arbitration. Clients queue one-shot conversion sequences and get the
+ * results back from the ADC interrupt, one sequence at a time in request
+ * order. Every sequence fully reprograms the ADC14 before it starts, so
+ * clients with different inputs, references or clocks do not interfere.
+ * Continuous modes (timer or DMA driven) take the ADC14 exclusively with
+ * adc_driver_acquire(); queued sequences wait until it is released.
+ */
+
+#define ADC_DRIVER_SEQUENCE_MAX     ( 32 )
+#define ADC_DRIVER_QUEUE_SIZE       ( 4 )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+/* Results are only valid until the callback returns; called from the ADC interrupt */
+typedef void (*adc_driver_callback_t)(const uint16_t* results, uint8_t length);
+/* Receives the ADC14 interrupt status while the ADC14 is acquired */
+typedef void (*adc_driver_irq_t)(uint64_t status);
+
+typedef struct
+{
+  const uint32_t* inputs;         // ADC_INPUT_Ax, converted into ADC_MEM0 onwards
+  uint8_t length;                 // 1 to ADC_DRIVER_SEQUENCE_MAX
+  uint32_t reference;             // ADC_VREFPOS_*
+  uint32_t clock_source;          // ADC_CLOCKSOURCE_*
+  uint32_t sample_time;           // ADC_PULSE_WIDTH_*
+  uint32_t internal_channels;     // ADC_TEMPSENSEMAP, ADC_NOROUTE, ...
+  adc_driver_callback_t callback;
+} adc_driver_sequence_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+void adc_driver_init(void);
+bool adc_driver_request(const adc_driver_sequence_t* sequence);
+bool adc_driver_acquire(adc_driver_irq_t handler);
+void adc_driver_release(void);
+
+/*--------------------------------variables-----------------------------------*/
+/*----------------------------------public------------------------------------*/
+/*---------------------------------private------------------------------------*/
+/*--------------------------------interrupts----------------------------------*/
+
+#endif /* ADC_DRIVER_H_ */
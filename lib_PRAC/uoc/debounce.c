@@ -0,0 +1,328 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stddef.h>
+
+#include "driverlib.h"
+
+#include "debounce.h"
+#include "interrupts.h"
+#include "kernel_trace.h"
+
+#include "FreeRTOSConfig.h"
+
+/*---------------------------------defines------------------------------------*/
+
+// TA1 counts ACLK continuously, CCR0 paces the samples and the overflow
+// extends the counter to a 48 bit time base
+#define DEBOUNCE_TIMER              ( TIMER_A1_BASE )
+#define DEBOUNCE_TIMER_REGS         ( TIMER_A1 )
+#define DEBOUNCE_TIMER_HZ           ( 32768 )
+#define DEBOUNCE_SAMPLE_INTERRUPT   ( INT_TA1_0 )
+#define DEBOUNCE_OVERFLOW_INTERRUPT ( INT_TA1_N )
+
+#define DEBOUNCE_SAMPLE_TICKS       ( (DEBOUNCE_SAMPLE_MS * DEBOUNCE_TIMER_HZ) / 1000 )
+
+/*---------------------------------typedefs-----------------------------------*/
+/*--------------------------------prototypes----------------------------------*/
+
+static uint16_t debounce_read_counter(void);
+static void debounce_sample(debounce_input_t* input, uint32_t now);
+static void debounce_press(debounce_input_t* input, uint32_t now);
+static void debounce_release(debounce_input_t* input, uint32_t now);
+static void debounce_rearm(debounce_input_t* input);
+static void debounce_notify(debounce_input_t* input, uint8_t event, uint32_t now);
+
+/*--------------------------------variables-----------------------------------*/
+
+static const Timer_A_ContinuousModeConfig debounce_timer_config =
+{
+  TIMER_A_CLOCKSOURCE_ACLK,
+  TIMER_A_CLOCKSOURCE_DIVIDER_1,
+  TIMER_A_TAIE_INTERRUPT_ENABLE,
+  TIMER_A_DO_CLEAR
+};
+
+static debounce_input_t* debounce_inputs[DEBOUNCE_INPUTS_MAX];
+static uint8_t debounce_inputs_count = 0;
+
+// One bit per input being sampled, its pin interrupt is masked meanwhile
+static volatile uint32_t debounce_active = 0;
+
+static volatile uint32_t debounce_overflows = 0;
+
+static bool debounce_initialized = false;
+
+/*----------------------------------public------------------------------------*/
+
+void debounce_init(void)
+{
+  /* Both button drivers use the debouncer, initialize it only once */
+  if (debounce_initialized == true)
+  {
+    return;
+  }
+
+  MAP_Timer_A_configureContinuousMode(DEBOUNCE_TIMER, &debounce_timer_config);
+
+  /* Compare mode on CCR0, its interrupt is only enabled while sampling */
+  DEBOUNCE_TIMER_REGS->CCTL[0] = 0;
+
+  MAP_Interrupt_setPriority(DEBOUNCE_SAMPLE_INTERRUPT, configMAX_SYSCALL_INTERRUPT_PRIORITY);
+  MAP_Interrupt_setPriority(DEBOUNCE_OVERFLOW_INTERRUPT, configMAX_SYSCALL_INTERRUPT_PRIORITY);
+  MAP_Interrupt_enableInterrupt(DEBOUNCE_SAMPLE_INTERRUPT);
+  MAP_Interrupt_enableInterrupt(DEBOUNCE_OVERFLOW_INTERRUPT);
+
+  MAP_Timer_A_startCounter(DEBOUNCE_TIMER, TIMER_A_CONTINUOUS_MODE);
+
+  debounce_initialized = true;
+}
+
+// Adds an input, released, to the debouncer. Its pin is configured by the caller
+bool debounce_register(debounce_input_t* input)
+{
+  if (debounce_inputs_count >= DEBOUNCE_INPUTS_MAX)
+  {
+    return false;
+  }
+
+  input->index = debounce_inputs_count;
+  input->count = 0;
+  input->pressed = false;
+  input->long_press = false;
+  input->double_click = false;
+  input->click_pending = false;
+
+  debounce_inputs[debounce_inputs_count++] = input;
+
+  return true;
+}
+
+/*
+ * Called from the port interrupt on an edge of input. The pin interrupt stays
+ * masked while the timer samples it, so a bounce costs nothing, and it is
+ * enabled again once the input has settled released.
+ */
+void debounce_edge(debounce_input_t* input)
+{
+  uint32_t irq_status;
+
+  MAP_GPIO_disableInterrupt(input->port, input->pin);
+
+  irq_status = interrupts_disable();
+
+  if (debounce_active == 0)
+  {
+    DEBOUNCE_TIMER_REGS->CCR[0] = debounce_read_counter() + DEBOUNCE_SAMPLE_TICKS;
+    DEBOUNCE_TIMER_REGS->CCTL[0] &= ~TIMER_A_CCTLN_CCIFG;
+    DEBOUNCE_TIMER_REGS->CCTL[0] |= TIMER_A_CCTLN_CCIE;
+  }
+
+  debounce_active |= (1u << input->index);
+
+  interrupts_restore(irq_status);
+}
+
+// Milliseconds since debounce_init(), the time base of the event timestamps
+uint32_t debounce_get_time_ms(void)
+{
+  uint32_t irq_status;
+  uint32_t overflows;
+  uint16_t counter;
+
+  irq_status = interrupts_disable();
+
+  counter = debounce_read_counter();
+  overflows = debounce_overflows;
+
+  /* An overflow not handled yet belongs to a counter that already wrapped */
+  if (((DEBOUNCE_TIMER_REGS->CTL & TIMER_A_CTL_IFG) != 0) && (counter < 0x8000))
+  {
+    overflows++;
+  }
+
+  interrupts_restore(irq_status);
+
+  return (((((uint64_t)overflows) << 16) | counter) * 1000) / DEBOUNCE_TIMER_HZ;
+}
+
+/*---------------------------------private------------------------------------*/
+
+// ACLK is asynchronous to MCLK, read until two values agree
+static uint16_t debounce_read_counter(void)
+{
+  uint16_t counter;
+
+  do
+  {
+    counter = DEBOUNCE_TIMER_REGS->R;
+  } while (counter != DEBOUNCE_TIMER_REGS->R);
+
+  return counter;
+}
+
+static void debounce_sample(debounce_input_t* input, uint32_t now)
+{
+  bool level;
+
+  level = (MAP_GPIO_getInputPinValue(input->port, input->pin) == GPIO_INPUT_PIN_LOW);
+
+  if (level != input->pressed)
+  {
+    if (++input->count >= DEBOUNCE_SAMPLES)
+    {
+      input->count = 0;
+      input->pressed = level;
+
+      if (level == true)
+      {
+        debounce_press(input, now);
+      }
+      else
+      {
+        debounce_release(input, now);
+      }
+    }
+    return;
+  }
+
+  input->count = 0;
+
+  if (input->pressed == false)
+  {
+    /* The edge was only noise */
+    debounce_rearm(input);
+  }
+  else if ((input->long_press == false) && ((now - input->press_time) >= DEBOUNCE_LONG_PRESS_MS))
+  {
+    input->long_press = true;
+    debounce_notify(input, DEBOUNCE_EVENT_LONG_PRESS, now);
+  }
+}
+
+static void debounce_press(debounce_input_t* input, uint32_t now)
+{
+  input->press_time = now;
+  input->long_press = false;
+  input->double_click = (input->click_pending == true) &&
+                        ((now - input->release_time) <= DEBOUNCE_DOUBLE_CLICK_MS);
+  input->click_pending = false;
+
+  debounce_notify(input, DEBOUNCE_EVENT_PRESS, now);
+
+  if (input->double_click == true)
+  {
+    debounce_notify(input, DEBOUNCE_EVENT_DOUBLE_CLICK, now);
+  }
+}
+
+static void debounce_release(debounce_input_t* input, uint32_t now)
+{
+  /* Only a short first click can start a double click */
+  input->click_pending = (input->long_press == false) && (input->double_click == false);
+  input->release_time = now;
+
+  debounce_notify(input, DEBOUNCE_EVENT_RELEASE, now);
+
+  debounce_rearm(input);
+}
+
+// Stops sampling input and waits for its next edge
+static void debounce_rearm(debounce_input_t* input)
+{
+  MAP_GPIO_clearInterruptFlag(input->port, input->pin);
+
+  /* A press right before the flag was cleared is still sampled */
+  if (MAP_GPIO_getInputPinValue(input->port, input->pin) == GPIO_INPUT_PIN_LOW)
+  {
+    return;
+  }
+
+  debounce_active &= ~(1u << input->index);
+  MAP_GPIO_enableInterrupt(input->port, input->pin);
+}
+
+static void debounce_notify(debounce_input_t* input, uint8_t event, uint32_t now)
+{
+  if (input->callback != NULL)
+  {
+    input->callback(input->id, event, now);
+  }
+}
+
+/*--------------------------------interrupts----------------------------------*/
+
+void TA1_0_IRQHandler(void)
+{
+  uint32_t now;
+  uint8_t i;
+
+  KERNEL_TRACE_ISR_ENTER(INT_TA1_0);
+
+  DEBOUNCE_TIMER_REGS->CCTL[0] &= ~TIMER_A_CCTLN_CCIFG;
+  DEBOUNCE_TIMER_REGS->CCR[0] += DEBOUNCE_SAMPLE_TICKS;
+
+  now = debounce_get_time_ms();
+
+  for (i = 0; i < debounce_inputs_count; i++)
+  {
+    if ((debounce_active & (1u << i)) != 0)
+    {
+      debounce_sample(debounce_inputs[i], now);
+    }
+  }
+
+  /* Every input settled, no more samples until the next edge */
+  if (debounce_active == 0)
+  {
+    DEBOUNCE_TIMER_REGS->CCTL[0] &= ~TIMER_A_CCTLN_CCIE;
+  }
+
+  KERNEL_TRACE_ISR_EXIT(INT_TA1_0);
+}
+
+void TA1_N_IRQHandler(void)
+{
+  KERNEL_TRACE_ISR_ENTER(INT_TA1_N);
+
+  if ((DEBOUNCE_TIMER_REGS->CTL & TIMER_A_CTL_IFG) != 0)
+  {
+    DEBOUNCE_TIMER_REGS->CTL &= ~TIMER_A_CTL_IFG;
+    debounce_overflows++;
+  }
+
+  KERNEL_TRACE_ISR_EXIT(INT_TA1_N);
+}
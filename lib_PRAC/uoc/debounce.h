@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef DEBOUNCE_H_
+#define DEBOUNCE_H_
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*---------------------------------defines------------------------------------*/
+
+#define DEBOUNCE_INPUTS_MAX         ( 8 )
+
+/* A level must be read DEBOUNCE_SAMPLES times in a row to be accepted */
+#define DEBOUNCE_SAMPLE_MS          ( 5 )
+#define DEBOUNCE_SAMPLES            ( 4 )
+
+#define DEBOUNCE_LONG_PRESS_MS      ( 800 )
+#define DEBOUNCE_DOUBLE_CLICK_MS    ( 300 )
+
+enum
+{
+  DEBOUNCE_EVENT_PRESS = 0,
+  DEBOUNCE_EVENT_RELEASE,
+  DEBOUNCE_EVENT_LONG_PRESS,
+  DEBOUNCE_EVENT_DOUBLE_CLICK
+};
+
+/*---------------------------------typedefs-----------------------------------*/
+
+/* Receives the input id, a DEBOUNCE_EVENT_* and its time; called from an interrupt */
+typedef void (*debounce_callback_t)(uint8_t id, uint8_t event, uint32_t timestamp_ms);
+
+typedef struct
+{
+  uint16_t port;          // active low input, interrupt on the falling edge
+  uint16_t pin;
+  uint8_t id;
+  debounce_callback_t callback;
+
+  /* Owned by the debouncer */
+  uint8_t index;
+  uint8_t count;
+  bool pressed;
+  bool long_press;
+  bool double_click;
+  bool click_pending;
+  uint32_t press_time;
+  uint32_t release_time;
+} debounce_input_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+void debounce_init(void);
+bool debounce_register(debounce_input_t* input);
+void debounce_edge(debounce_input_t* input);
+uint32_t debounce_get_time_ms(void);
+
+/*--------------------------------variables-----------------------------------*/
+/*----------------------------------public------------------------------------*/
+/*---------------------------------private------------------------------------*/
+/*--------------------------------interrupts----------------------------------*/
+
+#endif /* DEBOUNCE_H_ */
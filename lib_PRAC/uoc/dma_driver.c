@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stddef.h>
+
+#include "driverlib.h"
+
+#include "dma_driver.h"
+#include "kernel_trace.h"
+
+#include "FreeRTOSConfig.h"
+
+/*---------------------------------defines------------------------------------*/
+
+#define DMA_CONTROL_TABLE_SIZE      ( 32 )
+#define DMA_CHANNEL_MASK            ( 0x0F )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  uint32_t irq;
+  uint32_t channel;
+  callback_t callback;
+} dma_int_cfg_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+static void dma_irq_handler(uint8_t interrupt);
+
+/*--------------------------------variables-----------------------------------*/
+
+// The uDMA control table is shared by all channels and must be aligned
+#if defined(__TI_COMPILER_VERSION__)
+#pragma DATA_ALIGN(dma_control_table, 1024)
+static DMA_ControlTable dma_control_table[DMA_CONTROL_TABLE_SIZE];
+#elif defined(__GNUC__)
+static DMA_ControlTable dma_control_table[DMA_CONTROL_TABLE_SIZE] __attribute__ ((aligned (1024)));
+#endif
+
+static dma_int_cfg_t dma_interrupts[] =
+{
+  {DMA_INT1, 0, NULL},
+  {DMA_INT2, 0, NULL},
+  {DMA_INT3, 0, NULL},
+};
+
+static bool dma_initialized = false;
+
+/*----------------------------------public------------------------------------*/
+
+void dma_init(void)
+{
+  /* Several drivers share the DMA, initialize it only once */
+  if (dma_initialized == true)
+  {
+    return;
+  }
+
+  MAP_DMA_enableModule();
+  MAP_DMA_setControlBase(dma_control_table);
+
+  dma_initialized = true;
+}
+
+void dma_set_callback(uint8_t interrupt, uint32_t channel, callback_t callback)
+{
+  if (interrupt < DMA_DRIVER_INT_ELEMENTS)
+  {
+    /* Accept both channel numbers and DMA_CHx_* mappings */
+    dma_interrupts[interrupt].channel = channel & DMA_CHANNEL_MASK;
+    dma_interrupts[interrupt].callback = callback;
+
+    /* Route the channel completion to this interrupt line */
+    MAP_DMA_assignInterrupt(dma_interrupts[interrupt].irq, dma_interrupts[interrupt].channel);
+    MAP_DMA_clearInterruptFlag(dma_interrupts[interrupt].channel);
+
+    MAP_Interrupt_setPriority(dma_interrupts[interrupt].irq, configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    MAP_Interrupt_enableInterrupt(dma_interrupts[interrupt].irq);
+  }
+}
+
+void dma_clear_callback(uint8_t interrupt)
+{
+  if (interrupt < DMA_DRIVER_INT_ELEMENTS)
+  {
+    MAP_Interrupt_disableInterrupt(dma_interrupts[interrupt].irq);
+    MAP_DMA_disableInterrupt(dma_interrupts[interrupt].irq);
+
+    dma_interrupts[interrupt].callback = NULL;
+  }
+}
+
+/*---------------------------------private------------------------------------*/
+
+static void dma_irq_handler(uint8_t interrupt)
+{
+  /* Clear channel completion flag */
+  MAP_DMA_clearInterruptFlag(dma_interrupts[interrupt].channel);
+
+  /* Execute DMA callback */
+  if (dma_interrupts[interrupt].callback != NULL)
+  {
+    dma_interrupts[interrupt].callback();
+  }
+}
+
+/*--------------------------------interrupts----------------------------------*/
+
+void DMA_INT1_IRQHandler(void)
+{
+  KERNEL_TRACE_ISR_ENTER(INT_DMA_INT1);
+  dma_irq_handler(DMA_DRIVER_INT1);
+  KERNEL_TRACE_ISR_EXIT(INT_DMA_INT1);
+}
+
+void DMA_INT2_IRQHandler(void)
+{
+  KERNEL_TRACE_ISR_ENTER(INT_DMA_INT2);
+  dma_irq_handler(DMA_DRIVER_INT2);
+  KERNEL_TRACE_ISR_EXIT(INT_DMA_INT2);
+}
+
+void DMA_INT3_IRQHandler(void)
+{
+  KERNEL_TRACE_ISR_ENTER(INT_DMA_INT3);
+  dma_irq_handler(DMA_DRIVER_INT3);
+  KERNEL_TRACE_ISR_EXIT(INT_DMA_INT3);
+}
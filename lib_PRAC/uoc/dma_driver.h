@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef DMA_DRIVER_H_
+#define DMA_DRIVER_H_
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "callback.h"
+
+/*---------------------------------defines------------------------------------*/
+
+enum
+{
+  DMA_DRIVER_INT1 = 0,
+  DMA_DRIVER_INT2,
+  DMA_DRIVER_INT3,
+  DMA_DRIVER_INT_ELEMENTS
+};
+
+/*---------------------------------typedefs-----------------------------------*/
+/*--------------------------------prototypes----------------------------------*/
+
+void dma_init(void);
+void dma_set_callback(uint8_t interrupt, uint32_t channel, callback_t callback);
+void dma_clear_callback(uint8_t interrupt);
+
+/*--------------------------------variables-----------------------------------*/
+/*----------------------------------public------------------------------------*/
+/*---------------------------------private------------------------------------*/
+/*--------------------------------interrupts----------------------------------*/
+
+#endif /* DMA_DRIVER_H_ */
@@ -0,0 +1,368 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "driverlib.h"
+
+#include "edu_boosterpack_accelerometer.h"
+#include "adc_driver.h"
+#include "interrupts.h"
+#include "kernel_trace.h"
+
+#include "FreeRTOSConfig.h"
+
+/*---------------------------------defines------------------------------------*/
+
+#define ACCELEROMETER_X_INPUT       ( ADC_INPUT_A14 )
+#define ACCELEROMETER_Y_INPUT       ( ADC_INPUT_A13 )
+#define ACCELEROMETER_Z_INPUT       ( ADC_INPUT_A11 )
+
+#define ACCELEROMETER_TIMER         ( TIMER32_1_BASE )
+#define ACCELEROMETER_INTERRUPT     ( INT_T32_INT2 )
+
+/* atan() in tenths of a degree for a Q15 ratio in [0, 1] */
+#define ACCELEROMETER_Q15_ONE       ( 32768 )
+#define ACCELEROMETER_DDEG_45       ( 450 )
+#define ACCELEROMETER_DDEG_ATAN_K   ( 156 )
+
+/*---------------------------------typedefs-----------------------------------*/
+/*--------------------------------prototypes----------------------------------*/
+
+static void edu_boosterpack_accelerometer_done(const uint16_t* results, uint8_t length);
+static void edu_boosterpack_accelerometer_events(const accelerometer_sample_t* sample);
+static uint16_t edu_boosterpack_accelerometer_sqrt(uint32_t value);
+static int16_t edu_boosterpack_accelerometer_atan2(int32_t y, int32_t x);
+
+/*--------------------------------variables-----------------------------------*/
+
+static const uint32_t accelerometer_inputs[ACCELEROMETER_AXIS] =
+{
+  ACCELEROMETER_X_INPUT,
+  ACCELEROMETER_Y_INPUT,
+  ACCELEROMETER_Z_INPUT
+};
+
+static const adc_driver_sequence_t accelerometer_sequence =
+{
+  accelerometer_inputs,
+  ACCELEROMETER_AXIS,
+  ADC_VREFPOS_AVCC_VREFNEG_VSS,
+  ADC_CLOCKSOURCE_MCLK,
+  ADC_PULSE_WIDTH_16,
+  ADC_NOROUTE,
+  edu_boosterpack_accelerometer_done
+};
+
+// Samples waiting for a task, the oldest one is dropped when full
+static accelerometer_sample_t accelerometer_fifo[ACCELEROMETER_FIFO_SIZE];
+static uint16_t fifo_begin = 0;
+static uint16_t fifo_count = 0;
+static volatile uint32_t fifo_overruns = 0;
+
+static accelerometer_event_callback_t accelerometer_event_callback_func;
+static bool sampling = false;
+static uint8_t shake_holdoff;
+static uint8_t tilt_state;
+
+/*----------------------------------public------------------------------------*/
+
+void edu_boosterpack_accelerometer_init(void)
+{
+  adc_driver_init();
+
+  /* X on P6.1 (A14), Y on P4.0 (A13), Z on P4.2 (A11) */
+  MAP_GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P6, GPIO_PIN1, GPIO_TERTIARY_MODULE_FUNCTION);
+  MAP_GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P4, GPIO_PIN0 | GPIO_PIN2, GPIO_TERTIARY_MODULE_FUNCTION);
+
+  MAP_Interrupt_setPriority(ACCELEROMETER_INTERRUPT, configMAX_SYSCALL_INTERRUPT_PRIORITY);
+}
+
+/*
+ * Samples the three axes at rate_hz. Timer32 queues one ADC sequence per
+ * period and every result is stored in the FIFO from the ADC interrupt, along
+ * with its magnitude and tilt. The callback is only called when a shake or a
+ * tilt change is detected, so tasks are not woken up for every sample.
+ */
+bool edu_boosterpack_accelerometer_start(uint32_t rate_hz, accelerometer_event_callback_t callback)
+{
+  uint32_t period;
+
+  if (rate_hz == 0)
+  {
+    return false;
+  }
+
+  period = MAP_CS_getMCLK() / rate_hz;
+  if (period == 0)
+  {
+    return false;
+  }
+
+  edu_boosterpack_accelerometer_stop();
+
+  accelerometer_event_callback_func = callback;
+  shake_holdoff = 0;
+  tilt_state = ACCELEROMETER_EVENT_TILT_CENTER;
+  fifo_begin = 0;
+  fifo_count = 0;
+  fifo_overruns = 0;
+  sampling = true;
+
+  MAP_Timer32_initModule(ACCELEROMETER_TIMER, TIMER32_PRESCALER_1, TIMER32_32BIT, TIMER32_PERIODIC_MODE);
+  MAP_Timer32_setCount(ACCELEROMETER_TIMER, period);
+  MAP_Timer32_clearInterruptFlag(ACCELEROMETER_TIMER);
+  MAP_Timer32_enableInterrupt(ACCELEROMETER_TIMER);
+  MAP_Interrupt_enableInterrupt(ACCELEROMETER_INTERRUPT);
+  MAP_Timer32_startTimer(ACCELEROMETER_TIMER, false);
+
+  return true;
+}
+
+void edu_boosterpack_accelerometer_stop(void)
+{
+  if (sampling == false)
+  {
+    return;
+  }
+
+  MAP_Timer32_haltTimer(ACCELEROMETER_TIMER);
+  MAP_Timer32_disableInterrupt(ACCELEROMETER_TIMER);
+  MAP_Interrupt_disableInterrupt(ACCELEROMETER_INTERRUPT);
+
+  /* A sequence still queued is discarded when it completes */
+  sampling = false;
+  accelerometer_event_callback_func = NULL;
+}
+
+// Moves up to length samples, oldest first, out of the FIFO
+uint16_t edu_boosterpack_accelerometer_read(accelerometer_sample_t* samples, uint16_t length)
+{
+  uint32_t irq_status;
+  uint16_t i;
+
+  irq_status = interrupts_disable();
+
+  for (i = 0; (i < length) && (fifo_count > 0); i++)
+  {
+    samples[i] = accelerometer_fifo[fifo_begin];
+    fifo_begin = (fifo_begin + 1) % ACCELEROMETER_FIFO_SIZE;
+    fifo_count--;
+  }
+
+  interrupts_restore(irq_status);
+
+  return i;
+}
+
+// Samples dropped because the FIFO was full
+uint32_t edu_boosterpack_accelerometer_get_overruns(void)
+{
+  return fifo_overruns;
+}
+
+/*---------------------------------private------------------------------------*/
+
+static void edu_boosterpack_accelerometer_done(const uint16_t* results, uint8_t length)
+{
+  accelerometer_sample_t* sample;
+  uint32_t irq_status;
+  int32_t x, y, z;
+
+  (void)length;
+
+  if (sampling == false)
+  {
+    return;
+  }
+
+  x = (int32_t)results[0] - ACCELEROMETER_ZERO_G;
+  y = (int32_t)results[1] - ACCELEROMETER_ZERO_G;
+  z = (int32_t)results[2] - ACCELEROMETER_ZERO_G;
+
+  irq_status = interrupts_disable();
+
+  /* Make room by dropping the oldest sample */
+  if (fifo_count == ACCELEROMETER_FIFO_SIZE)
+  {
+    fifo_begin = (fifo_begin + 1) % ACCELEROMETER_FIFO_SIZE;
+    fifo_count--;
+    fifo_overruns++;
+  }
+
+  sample = &accelerometer_fifo[(fifo_begin + fifo_count) % ACCELEROMETER_FIFO_SIZE];
+  fifo_count++;
+
+  sample->x = x;
+  sample->y = y;
+  sample->z = z;
+  sample->magnitude = ((uint32_t)edu_boosterpack_accelerometer_sqrt(x * x + y * y + z * z) * 1000) / ACCELEROMETER_COUNTS_PER_G;
+  sample->pitch = edu_boosterpack_accelerometer_atan2(-x, edu_boosterpack_accelerometer_sqrt(y * y + z * z));
+  sample->roll = edu_boosterpack_accelerometer_atan2(y, z);
+
+  interrupts_restore(irq_status);
+
+  edu_boosterpack_accelerometer_events(sample);
+}
+
+static void edu_boosterpack_accelerometer_events(const accelerometer_sample_t* sample)
+{
+  uint8_t state = tilt_state;
+
+  if (accelerometer_event_callback_func == NULL)
+  {
+    return;
+  }
+
+  /* Shake: far from 1 g, reported once per holdoff period */
+  if (shake_holdoff > 0)
+  {
+    shake_holdoff--;
+  }
+  else if (abs((int32_t)sample->magnitude - 1000) > ACCELEROMETER_SHAKE_MG)
+  {
+    shake_holdoff = ACCELEROMETER_SHAKE_HOLDOFF;
+    accelerometer_event_callback_func(ACCELEROMETER_EVENT_SHAKE);
+  }
+
+  /* Tilt: leaving the center needs ACCELEROMETER_TILT_DDEG, coming back needs hysteresis margin */
+  if (sample->roll <= -ACCELEROMETER_TILT_DDEG)
+  {
+    state = ACCELEROMETER_EVENT_TILT_LEFT;
+  }
+  else if (sample->roll >= ACCELEROMETER_TILT_DDEG)
+  {
+    state = ACCELEROMETER_EVENT_TILT_RIGHT;
+  }
+  else if (abs(sample->roll) < (ACCELEROMETER_TILT_DDEG - ACCELEROMETER_TILT_HYSTERESIS))
+  {
+    state = ACCELEROMETER_EVENT_TILT_CENTER;
+  }
+
+  if (state != tilt_state)
+  {
+    tilt_state = state;
+    accelerometer_event_callback_func(state);
+  }
+}
+
+// Integer square root, bit by bit
+static uint16_t edu_boosterpack_accelerometer_sqrt(uint32_t value)
+{
+  uint32_t root = 0;
+  uint32_t bit = (uint32_t)1 << 30;
+
+  while (bit > value)
+  {
+    bit >>= 2;
+  }
+
+  while (bit != 0)
+  {
+    if (value >= root + bit)
+    {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else
+    {
+      root >>= 1;
+    }
+
+    bit >>= 2;
+  }
+
+  return root;
+}
+
+/*
+ * atan2 in tenths of a degree. The ratio of the smaller to the larger
+ * component r (Q15) goes through atan(r) ~ 45 r + 15.6 r (1 - r) degrees,
+ * which is within 0.4 degrees, and is then mapped to its octant.
+ */
+static int16_t edu_boosterpack_accelerometer_atan2(int32_t y, int32_t x)
+{
+  uint32_t ax = abs(x);
+  uint32_t ay = abs(y);
+  uint32_t r;
+  int32_t angle;
+
+  if ((ax == 0) && (ay == 0))
+  {
+    return 0;
+  }
+
+  if (ay <= ax)
+  {
+    r = (ay << 15) / ax;
+  }
+  else
+  {
+    r = (ax << 15) / ay;
+  }
+
+  angle = (r * ACCELEROMETER_DDEG_45 + ((r * (ACCELEROMETER_Q15_ONE - r)) >> 15) * ACCELEROMETER_DDEG_ATAN_K) >> 15;
+
+  if (ay > ax)
+  {
+    angle = 900 - angle;
+  }
+  if (x < 0)
+  {
+    angle = 1800 - angle;
+  }
+  if (y < 0)
+  {
+    angle = -angle;
+  }
+
+  return angle;
+}
+
+/*--------------------------------interrupts----------------------------------*/
+
+void T32_INT2_IRQHandler(void)
+{
+  KERNEL_TRACE_ISR_ENTER(INT_T32_INT2);
+
+  MAP_Timer32_clearInterruptFlag(ACCELEROMETER_TIMER);
+
+  /* A full queue only skips this sample */
+  adc_driver_request(&accelerometer_sequence);
+
+  KERNEL_TRACE_ISR_EXIT(INT_T32_INT2);
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef EDU_BOOSTERPACK_ACCELEROMETER_H_
+#define EDU_BOOSTERPACK_ACCELEROMETER_H_
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*---------------------------------defines------------------------------------*/
+
+#define ACCELEROMETER_AXIS              ( 3 )
+#define ACCELEROMETER_FIFO_SIZE         ( 32 )
+
+/* ADXL335 on AVCC: 0 g at mid scale, about 330 mV/g at 3.3 V */
+#define ACCELEROMETER_ZERO_G            ( 8192 )
+#define ACCELEROMETER_COUNTS_PER_G      ( 1638 )
+
+/* Event thresholds (milli-g and tenths of a degree) */
+#define ACCELEROMETER_SHAKE_MG          ( 800 )
+#define ACCELEROMETER_SHAKE_HOLDOFF     ( 8 )
+#define ACCELEROMETER_TILT_DDEG         ( 300 )
+#define ACCELEROMETER_TILT_HYSTERESIS   ( 100 )
+
+enum
+{
+  ACCELEROMETER_EVENT_SHAKE = 0,
+  ACCELEROMETER_EVENT_TILT_CENTER,
+  ACCELEROMETER_EVENT_TILT_LEFT,
+  ACCELEROMETER_EVENT_TILT_RIGHT
+};
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  int16_t x;              // ADC counts around ACCELEROMETER_ZERO_G
+  int16_t y;
+  int16_t z;
+  uint16_t magnitude;     // milli-g
+  int16_t pitch;          // tenths of a degree, -900 to 900
+  int16_t roll;           // tenths of a degree, -1800 to 1800
+} accelerometer_sample_t;
+
+/* Receives ACCELEROMETER_EVENT_*; called from the ADC interrupt */
+typedef void (*accelerometer_event_callback_t)(uint8_t event);
+
+/*--------------------------------prototypes----------------------------------*/
+
+void edu_boosterpack_accelerometer_init(void);
+bool edu_boosterpack_accelerometer_start(uint32_t rate_hz, accelerometer_event_callback_t callback);
+void edu_boosterpack_accelerometer_stop(void);
+uint16_t edu_boosterpack_accelerometer_read(accelerometer_sample_t* samples, uint16_t length);
+uint32_t edu_boosterpack_accelerometer_get_overruns(void);
+
+/*--------------------------------variables-----------------------------------*/
+/*----------------------------------public------------------------------------*/
+/*---------------------------------private------------------------------------*/
+/*--------------------------------interrupts----------------------------------*/
+
+#endif /* EDU_BOOSTERPACK_ACCELEROMETER_H_ */
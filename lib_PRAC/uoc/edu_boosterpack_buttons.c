@@ -38,19 +38,17 @@
 
 #include "driverlib.h"
 
+#include "gpio_driver.h"
+
 /*---------------------------------defines------------------------------------*/
 
 #define BUTTON_S1_PORT          ( GPIO_PORT_P5 )
 #define BUTTON_S1_PIN           ( GPIO_PIN1 )
 #define BUTTON_S1_EDGE          ( GPIO_HIGH_TO_LOW_TRANSITION )
-#define BUTTON_S1_IRQ           ( INT_PORT3 )
-#define BUTTON_S1_IRQ_PRIO      ( 0xFF )
 
 #define BUTTON_S2_PORT          ( GPIO_PORT_P3 )
 #define BUTTON_S2_PIN           ( GPIO_PIN5 )
 #define BUTTON_S2_EDGE          ( GPIO_HIGH_TO_LOW_TRANSITION )
-#define BUTTON_S2_IRQ           ( INT_PORT5 )
-#define BUTTON_S2_IRQ_PRIO      ( 0xFF )
 
 /*---------------------------------typedefs-----------------------------------*/
 
@@ -59,19 +57,24 @@ typedef struct
   uint16_t port;
   uint16_t pin;
   uint8_t edge;
-  uint8_t irq;
-  uint8_t irq_prio;
   callback_t callback;
+  debounce_callback_t event_callback;
+  debounce_input_t debounce;
 } button_cfg_t;
 
 /*--------------------------------prototypes----------------------------------*/
 
+static void edu_boosterpack_buttons_edge(uint8_t port, uint16_t pin);
+static void edu_boosterpack_buttons_event(uint8_t button, uint8_t event, uint32_t timestamp_ms);
+
 /*--------------------------------variables-----------------------------------*/
 
 static button_cfg_t buttons[] =
 {
-  {BUTTON_S1_PORT, BUTTON_S1_PIN, BUTTON_S1_EDGE, BUTTON_S1_IRQ, BUTTON_S1_IRQ_PRIO, NULL},
-  {BUTTON_S2_PORT, BUTTON_S2_PIN, BUTTON_S2_EDGE, BUTTON_S2_IRQ, BUTTON_S2_IRQ_PRIO, NULL},
+  {BUTTON_S1_PORT, BUTTON_S1_PIN, BUTTON_S1_EDGE, NULL, NULL,
+   {BUTTON_S1_PORT, BUTTON_S1_PIN, MSP432_EDU_BOOSTERPACK_BUTTON_S1, edu_boosterpack_buttons_event}},
+  {BUTTON_S2_PORT, BUTTON_S2_PIN, BUTTON_S2_EDGE, NULL, NULL,
+   {BUTTON_S2_PORT, BUTTON_S2_PIN, MSP432_EDU_BOOSTERPACK_BUTTON_S2, edu_boosterpack_buttons_event}},
 };
 
 /*----------------------------------public------------------------------------*/
@@ -79,15 +82,16 @@ static button_cfg_t buttons[] =
 void edu_boosterpack_buttons_init(void)
 {
   uint16_t i;
+
+  gpio_driver_init();
+  debounce_init();
+
   for (i = 0; i < MSP432_EDU_BOOSTERPACK_BUTTON_ELEMENTS; i++)
   {
-    MAP_GPIO_setAsInputPin(buttons[i].port, buttons[i].pin);
-    MAP_GPIO_clearInterruptFlag(buttons[i].port, buttons[i].pin);
-    MAP_GPIO_interruptEdgeSelect(buttons[i].port, buttons[i].pin, buttons[i].edge);
-    MAP_GPIO_enableInterrupt(buttons[i].port, buttons[i].pin);
+    debounce_register(&buttons[i].debounce);
 
-    MAP_Interrupt_setPriority(buttons[i].irq, buttons[i].irq_prio);
-    MAP_Interrupt_enableInterrupt(buttons[i].irq);
+    MAP_GPIO_setAsInputPin(buttons[i].port, buttons[i].pin);
+    gpio_driver_register(buttons[i].port, buttons[i].pin, buttons[i].edge, edu_boosterpack_buttons_edge, false);
   }
 }
 
@@ -101,34 +105,39 @@ void edu_boosterpack_buttons_clear_callback(uint8_t button)
   buttons[button].callback = NULL;
 }
 
-/*---------------------------------private------------------------------------*/
+// Press, release, long press and double click events, see debounce.h
+void edu_boosterpack_buttons_set_event_callback(uint8_t button, debounce_callback_t callback)
+{
+  buttons[button].event_callback = callback;
+}
 
-/*--------------------------------interrupts----------------------------------*/
+/*---------------------------------private------------------------------------*/
 
-void PORT5_IRQHandler(void)
+static void edu_boosterpack_buttons_edge(uint8_t port, uint16_t pin)
 {
-  uint_fast16_t status;
-
-  status = MAP_GPIO_getEnabledInterruptStatus(BUTTON_S1_PORT);
-  MAP_GPIO_clearInterruptFlag(BUTTON_S1_PORT, status);
+  uint8_t i;
 
-  if (((status & BUTTON_S1_PIN) == BUTTON_S1_PIN) &&
-      (buttons[MSP432_EDU_BOOSTERPACK_BUTTON_S1].callback != NULL))
+  for (i = 0; i < MSP432_EDU_BOOSTERPACK_BUTTON_ELEMENTS; i++)
   {
-    buttons[MSP432_EDU_BOOSTERPACK_BUTTON_S1].callback();
+    if ((buttons[i].port == port) && (buttons[i].pin == pin))
+    {
+      debounce_edge(&buttons[i].debounce);
+    }
   }
 }
 
-void PORT3_Handler(void)
+// The plain callback keeps its meaning: one call per debounced press
+static void edu_boosterpack_buttons_event(uint8_t button, uint8_t event, uint32_t timestamp_ms)
 {
-  uint_fast16_t status;
-
-  status = MAP_GPIO_getEnabledInterruptStatus(BUTTON_S2_PORT);
-  MAP_GPIO_clearInterruptFlag(BUTTON_S2_PORT, status);
+  if ((event == DEBOUNCE_EVENT_PRESS) && (buttons[button].callback != NULL))
+  {
+    buttons[button].callback();
+  }
 
-  if (((status & BUTTON_S2_PIN) == BUTTON_S2_PIN) &&
-      (buttons[MSP432_EDU_BOOSTERPACK_BUTTON_S2].callback != NULL))
+  if (buttons[button].event_callback != NULL)
   {
-    buttons[MSP432_EDU_BOOSTERPACK_BUTTON_S2].callback();
+    buttons[button].event_callback(button, event, timestamp_ms);
   }
 }
+
+/*--------------------------------interrupts----------------------------------*/
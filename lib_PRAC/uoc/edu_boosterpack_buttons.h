@@ -42,6 +42,7 @@
 #include <stdint.h>
 
 #include "callback.h"
+#include "debounce.h"
 
 /*---------------------------------defines------------------------------------*/
 
@@ -58,6 +59,7 @@ enum
 void edu_boosterpack_buttons_init(void);
 void edu_boosterpack_buttons_set_callback(uint8_t button, callback_t callback);
 void edu_boosterpack_buttons_clear_callback(uint8_t button);
+void edu_boosterpack_buttons_set_event_callback(uint8_t button, debounce_callback_t callback);
 
 /*--------------------------------variables-----------------------------------*/
 /*----------------------------------public------------------------------------*/
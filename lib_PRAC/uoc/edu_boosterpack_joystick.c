@@ -37,57 +37,130 @@
 #include <edu_boosterpack_joystick.h>
 #include <string.h>
 #include "driverlib.h"
+#include "dma_driver.h"
+#include "adc_driver.h"
 
 /*---------------------------------defines------------------------------------*/
 
+#define JOYSTICK_X_INPUT            ( ADC_INPUT_A15 )
+#define JOYSTICK_Y_INPUT            ( ADC_INPUT_A8 )
+
+#define JOYSTICK_DMA_CHANNEL        ( DMA_CH7_ADC14 )
+#define JOYSTICK_DMA_INTERRUPT      ( DMA_DRIVER_INT1 )
+// One DMA request moves the whole ADC14 sequence (must match the block size)
+#define JOYSTICK_DMA_ARBITRATION    ( UDMA_ARB_32 )
+
+// TA3.1 is routed internally to the ADC14 sample-and-hold input (SHS = 7)
+#define JOYSTICK_TIMER              ( TIMER_A3_BASE )
+#define JOYSTICK_TIMER_TRIGGER      ( ADC_TRIGGER_SOURCE7 )
+#define JOYSTICK_TIMER_MIN_PERIOD   ( 64 )
+#define JOYSTICK_TIMER_MAX_PERIOD   ( 65535 )
+
+// Oversampled reads convert up to this many X/Y pairs per ADC14 sequence
+#define JOYSTICK_OVERSAMPLING_PAIRS ( JOYSTICK_STREAM_BLOCK_SAMPLES )
+
 /*---------------------------------typedefs-----------------------------------*/
 /*--------------------------------prototypes----------------------------------*/
+
+static bool edu_boosterpack_joystick_stream_configure(uint32_t clock_source, uint32_t sample_time, uint32_t trigger, adc_block_callback_t callback);
+static uint32_t edu_boosterpack_joystick_timer_setup(uint32_t trigger_hz);
+static void edu_boosterpack_joystick_timer_start(void);
+static void edu_boosterpack_joystick_timer_stop(void);
+static void edu_boosterpack_joystick_threshold_arm(uint8_t state);
+static void edu_boosterpack_joystick_threshold_event(uint64_t status);
+static void edu_boosterpack_joystick_stream_arm(uint32_t select, uint16_t* buffer);
+static void edu_boosterpack_joystick_stream_dma(void);
+static void edu_boosterpack_joystick_read_done(const uint16_t* results, uint8_t length);
+static void edu_boosterpack_joystick_adc_irq(uint64_t status);
+
 /*--------------------------------variables-----------------------------------*/
 adc_callback_t adc_callback_func;
 adc_result results_buffer;
+
+static adc_block_callback_t adc_block_callback_func;
+static uint16_t stream_buffers[2][JOYSTICK_STREAM_BLOCK_SIZE];
+static bool streaming = false;
+static bool timed = false;
+
+static Timer_A_PWMConfig timer_pwm_cfg =
+{
+  TIMER_A_CLOCKSOURCE_SMCLK,
+  TIMER_A_CLOCKSOURCE_DIVIDER_1,
+  JOYSTICK_TIMER_MAX_PERIOD,
+  TIMER_A_CAPTURECOMPARE_REGISTER_1,
+  TIMER_A_OUTPUTMODE_RESET_SET,
+  0
+};
+
+static uint32_t stream_rate;
+
+static joystick_event_callback_t joystick_event_callback_func;
+static bool thresholds = false;
+static uint16_t threshold_low;
+static uint16_t threshold_high;
+static uint16_t threshold_hysteresis;
+static volatile uint32_t stream_adc_overflows;
+static volatile uint32_t stream_trigger_overruns;
+static filter_pipeline_t* stream_filter;
+
+/* Interleaved X/Y inputs, one pair for plain reads and up to
+ * JOYSTICK_OVERSAMPLING_PAIRS for oversampled ones */
+static uint32_t read_inputs[JOYSTICK_OVERSAMPLING_PAIRS * JOYSTICK_AXIS];
+static adc_driver_sequence_t read_sequence =
+{
+  read_inputs,
+  JOYSTICK_AXIS,
+  ADC_VREFPOS_AVCC_VREFNEG_VSS,
+  ADC_CLOCKSOURCE_MCLK,
+  ADC_PULSE_WIDTH_4,
+  ADC_NOROUTE,
+  edu_boosterpack_joystick_read_done
+};
+
+static adc_oversampled_callback_t adc_oversampled_callback_func;
+static uint8_t oversampling_bits = 0;
+static uint8_t oversampling_pairs;
+static uint8_t oversampling_passes;
+static uint8_t oversampling_pass;
+static uint32_t oversampling_sum[JOYSTICK_AXIS];
 /*----------------------------------public------------------------------------*/
 
 void edu_boosterpack_joystick_init(void){
+    uint16_t i;
+
     /* Zero-filling results buffer */
     memset(results_buffer, 0x00, ACCEL_AXIS);
-    /* Setting reference voltage to 2.5  and enabling reference */
-    MAP_REF_A_setReferenceVoltage(REF_A_VREF2_5V);
-    MAP_REF_A_enableReferenceVoltage();
-    /* Initialize ADC and configure clock to MCLK/1/1 */
-    MAP_ADC14_enableModule();
-    MAP_ADC14_initModule(ADC_CLOCKSOURCE_MCLK,  ADC_PREDIVIDER_1,  ADC_DIVIDER_1, 0);
+    /* Initialize ADC (conversions use AVCC, the internal reference is left to other clients) */
+    adc_driver_init();
+    for (i = 0; i < JOYSTICK_OVERSAMPLING_PAIRS * JOYSTICK_AXIS; i += JOYSTICK_AXIS)
+    {
+        read_inputs[i] = JOYSTICK_X_INPUT;
+        read_inputs[i + 1] = JOYSTICK_Y_INPUT;
+    }
     /* Configuring GPIOs for Analog In */
     MAP_GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P4, GPIO_PIN5, GPIO_TERTIARY_MODULE_FUNCTION);
     MAP_GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P4, GPIO_PIN4, GPIO_TERTIARY_MODULE_FUNCTION);
-    /* Configuring ADC conversion mode and ADC Memory (ADC_MEM0 - ADC_MEM2 (A14, A13, A11) */
-    MAP_ADC14_configureMultiSequenceMode(ADC_MEM0, ADC_MEM2, false);
-    MAP_ADC14_configureConversionMemory(ADC_MEM0, ADC_VREFPOS_AVCC_VREFNEG_VSS, ADC_INPUT_A15, false);
-    MAP_ADC14_configureConversionMemory(ADC_MEM1, ADC_VREFPOS_AVCC_VREFNEG_VSS, ADC_INPUT_A8, false);
-
-    /* Enabling the interrupt when a conversion on channel 2 (end of sequence) is complete and enabling conversions */
-    MAP_ADC14_enableInterrupt(ADC_INT2);
-    // Set up priority in ADC14 interrupt
-    MAP_Interrupt_setPriority(INT_ADC14, 0xA0);
-    /* Enabling Interrupts */
-    MAP_Interrupt_enableInterrupt(INT_ADC14);
-    /* Setting up the sample timer to automatically step through the sequence to convert.*/
-    MAP_ADC14_enableSampleTimer(ADC_AUTOMATIC_ITERATION);
 }
 
 void edu_boosterpack_joystick_read(void){
-    /* Trigger the start of the sample */
-    MAP_ADC14_enableConversion();
-    MAP_ADC14_toggleConversionTrigger();
+    /* Start a new accumulation */
+    if (oversampling_bits > 0)
+    {
+        oversampling_sum[0] = 0;
+        oversampling_sum[1] = 0;
+        oversampling_pass = 0;
+    }
+    /* Queue the sequence, the callback runs once it has been converted */
+    adc_driver_request(&read_sequence);
 }
 
 void edu_boosterpack_joystick_disable(void){
-    /* Disable conversion */
-    ADC14_disableConversion ();
-    /* Disable interrupts */
-    MAP_ADC14_disableInterrupt(ADC_INT2);
-    MAP_Interrupt_disableInterrupt(INT_ADC14);
-    /* Disable module */
-    MAP_ADC14_disableModule();
+    /* Release the DMA and timer if streaming or watching thresholds */
+    edu_boosterpack_joystick_stream_stop();
+    edu_boosterpack_joystick_threshold_stop();
+    /* Drop the results of any read still queued */
+    adc_callback_func = NULL;
+    adc_oversampled_callback_func = NULL;
 }
 
 void edu_boosterpack_joystick_set_callback(adc_callback_t callback){
@@ -98,17 +171,433 @@ void edu_boosterpack_joystick_clear_callback(void){
     adc_callback_func = NULL;
 }
 
+/*
+ * Oversampled reads: every edu_boosterpack_joystick_read() converts
+ * 4^extra_bits X/Y pairs (up to JOYSTICK_OVERSAMPLING_PAIRS per ADC14
+ * sequence, queued again from the ADC interrupt), accumulates them there and
+ * decimates the sums to 14 + extra_bits bits for callback. 0 goes back to
+ * plain reads reported through the adc_callback_t.
+ */
+bool edu_boosterpack_joystick_set_oversampling(uint8_t extra_bits, adc_oversampled_callback_t callback){
+    uint32_t samples;
+
+    if (extra_bits > JOYSTICK_OVERSAMPLING_MAX_BITS)
+    {
+        return false;
+    }
+
+    samples = (uint32_t)1 << (2 * extra_bits);
+    oversampling_pairs = (samples < JOYSTICK_OVERSAMPLING_PAIRS) ? samples : JOYSTICK_OVERSAMPLING_PAIRS;
+    oversampling_passes = samples / oversampling_pairs;
+    oversampling_bits = extra_bits;
+    adc_oversampled_callback_func = callback;
+    read_sequence.length = (extra_bits > 0) ? (oversampling_pairs * JOYSTICK_AXIS) : JOYSTICK_AXIS;
+
+    return true;
+}
+
+/*
+ * Streaming mode: ADC14 repeats a sequence of JOYSTICK_STREAM_BLOCK_SAMPLES
+ * X/Y pairs from ACLK (~200 pairs/s) and the DMA copies every finished
+ * sequence into one of two ping-pong buffers. The callback runs once per
+ * block from the DMA interrupt and the block stays valid until the next one.
+ * Returns false if the ADC14 is taken by another continuous mode.
+ */
+bool edu_boosterpack_joystick_stream_start(adc_block_callback_t callback){
+    /* ACLK keeps sampling slow and running in low power modes */
+    if (edu_boosterpack_joystick_stream_configure(ADC_CLOCKSOURCE_ACLK, ADC_PULSE_WIDTH_64, ADC_TRIGGER_ADCSC, callback) == false)
+    {
+        return false;
+    }
+
+    /* Start the free running conversions */
+    MAP_ADC14_enableSampleTimer(ADC_AUTOMATIC_ITERATION);
+    MAP_ADC14_enableConversion();
+    MAP_ADC14_toggleConversionTrigger();
+
+    return true;
+}
+
+/*
+ * Timed streaming mode: same blocks as above, but every conversion is started
+ * by the JOYSTICK_TIMER CCR1 output, so X and Y are each sampled at exactly
+ * rate_hz (half a period apart) whatever the CPU is doing. Returns false if
+ * the rate can not be generated from SMCLK.
+ */
+bool edu_boosterpack_joystick_stream_start_timed(uint32_t rate_hz, adc_block_callback_t callback){
+    uint32_t trigger_rate;
+
+    /* Two conversions (X and Y) per sample */
+    trigger_rate = edu_boosterpack_joystick_timer_setup(rate_hz * JOYSTICK_AXIS);
+    if (trigger_rate == 0)
+    {
+        return false;
+    }
+
+    /* MCLK conversions are short compared to the sampling period */
+    if (edu_boosterpack_joystick_stream_configure(ADC_CLOCKSOURCE_MCLK, ADC_PULSE_WIDTH_16, JOYSTICK_TIMER_TRIGGER, callback) == false)
+    {
+        return false;
+    }
+
+    /* One conversion per trigger edge, count the ones we can not keep up with */
+    MAP_ADC14_enableSampleTimer(ADC_MANUAL_ITERATION);
+    MAP_ADC14_clearInterruptFlag(ADC_OV_INT | ADC_TOV_INT);
+    MAP_ADC14_enableInterrupt(ADC_OV_INT | ADC_TOV_INT);
+    MAP_ADC14_enableConversion();
+
+    edu_boosterpack_joystick_timer_start();
+    stream_rate = trigger_rate / JOYSTICK_AXIS;
+
+    return true;
+}
+
+uint32_t edu_boosterpack_joystick_stream_get_rate(void){
+    return (timed == true) ? stream_rate : 0;
+}
+
+void edu_boosterpack_joystick_stream_get_overruns(uint32_t* adc_overflows, uint32_t* trigger_overruns){
+    *adc_overflows = stream_adc_overflows;
+    *trigger_overruns = stream_trigger_overruns;
+}
+
+/*
+ * Runs every streamed block through pipeline (2 channels, X/Y) in the DMA
+ * interrupt before the block callback sees it. A decimating pipeline hands
+ * fewer samples to the callback. NULL removes the filter.
+ */
+void edu_boosterpack_joystick_stream_set_filter(filter_pipeline_t* pipeline){
+    stream_filter = pipeline;
+}
+
+void edu_boosterpack_joystick_stream_stop(void){
+    if (streaming == false)
+    {
+        return;
+    }
+
+    streaming = false;
+
+    /* Stop conversions and DMA */
+    edu_boosterpack_joystick_timer_stop();
+    MAP_ADC14_disableInterrupt(ADC_OV_INT | ADC_TOV_INT);
+    MAP_ADC14_disableConversion();
+    MAP_DMA_disableChannel(JOYSTICK_DMA_CHANNEL);
+    dma_clear_callback(JOYSTICK_DMA_INTERRUPT);
+
+    adc_block_callback_func = NULL;
+
+    /* Let queued reads run again */
+    adc_driver_release();
+}
+
+/*
+ * Threshold mode: X is converted at rate_hz by the timer and checked by the
+ * ADC14 window comparator, so the CPU is only interrupted when the stick
+ * leaves the dead zone [low, high] or comes back into it. Coming back needs
+ * hysteresis counts of margin, which filters noise around the thresholds.
+ */
+bool edu_boosterpack_joystick_threshold_start(uint16_t low, uint16_t high, uint16_t hysteresis,
+                                              uint32_t rate_hz, joystick_event_callback_t callback){
+    if ((low + hysteresis) >= (high - hysteresis))
+    {
+        return false;
+    }
+
+    edu_boosterpack_joystick_stream_stop();
+    edu_boosterpack_joystick_threshold_stop();
+
+    if (edu_boosterpack_joystick_timer_setup(rate_hz) == 0)
+    {
+        return false;
+    }
+
+    /* Hold the ADC14 until threshold_stop() */
+    if (adc_driver_acquire(edu_boosterpack_joystick_adc_irq) == false)
+    {
+        return false;
+    }
+
+    threshold_low = low;
+    threshold_high = high;
+    threshold_hysteresis = hysteresis;
+    joystick_event_callback_func = callback;
+
+    /* Only X, converted once per timer edge into ADC_MEM0 */
+    MAP_ADC14_initModule(ADC_CLOCKSOURCE_MCLK, ADC_PREDIVIDER_1, ADC_DIVIDER_1, 0);
+    MAP_ADC14_setSampleHoldTime(ADC_PULSE_WIDTH_16, ADC_PULSE_WIDTH_16);
+    MAP_ADC14_setSampleHoldTrigger(JOYSTICK_TIMER_TRIGGER, false);
+    MAP_ADC14_configureSingleSampleMode(ADC_MEM0, true);
+    MAP_ADC14_configureConversionMemory(ADC_MEM0, ADC_VREFPOS_AVCC_VREFNEG_VSS, JOYSTICK_X_INPUT, false);
+    MAP_ADC14_enableComparatorWindow(ADC_MEM0, ADC_COMP_WINDOW0);
+    MAP_ADC14_enableSampleTimer(ADC_MANUAL_ITERATION);
+
+    thresholds = true;
+
+    /* Start centered, waiting for the stick to leave the dead zone */
+    edu_boosterpack_joystick_threshold_arm(JOYSTICK_EVENT_CENTER);
+    MAP_ADC14_enableConversion();
+    edu_boosterpack_joystick_timer_start();
+
+    return true;
+}
+
+void edu_boosterpack_joystick_threshold_stop(void){
+    if (thresholds == false)
+    {
+        return;
+    }
+
+    thresholds = false;
+
+    /* Stop conversions and the window comparator */
+    edu_boosterpack_joystick_timer_stop();
+    MAP_ADC14_disableInterrupt(ADC_LO_INT | ADC_HI_INT | ADC_IN_INT);
+    MAP_ADC14_disableConversion();
+    while (MAP_ADC14_isBusy())
+        ;
+    MAP_ADC14_disableComparatorWindow(ADC_MEM0);
+
+    joystick_event_callback_func = NULL;
+
+    /* Let queued reads run again */
+    adc_driver_release();
+}
+
 /*---------------------------------private------------------------------------*/
 
-/*--------------------------------interrupts----------------------------------*/
+static bool edu_boosterpack_joystick_stream_configure(uint32_t clock_source, uint32_t sample_time, uint32_t trigger, adc_block_callback_t callback){
+    uint16_t i;
 
-void ADC_Handler(void)
-{
-    uint64_t status = MAP_ADC14_getEnabledInterruptStatus();
-    MAP_ADC14_clearInterruptFlag(status);
-    if (ADC_INT2 & status){
-        MAP_ADC14_getMultiSequenceResult(results_buffer);
+    edu_boosterpack_joystick_stream_stop();
+    edu_boosterpack_joystick_threshold_stop();
+
+    /* Hold the ADC14 until stream_stop() */
+    if (adc_driver_acquire(edu_boosterpack_joystick_adc_irq) == false)
+    {
+        return false;
+    }
+
+    adc_block_callback_func = callback;
+    stream_adc_overflows = 0;
+    stream_trigger_overruns = 0;
+
+    MAP_ADC14_initModule(clock_source, ADC_PREDIVIDER_1, ADC_DIVIDER_1, 0);
+    MAP_ADC14_setSampleHoldTime(sample_time, sample_time);
+    MAP_ADC14_setSampleHoldTrigger(trigger, false);
+
+    /* Interleave X and Y over ADC_MEM0 - ADC_MEM31 and repeat forever */
+    MAP_ADC14_configureMultiSequenceMode(ADC_MEM0, ADC_MEM0 << (JOYSTICK_STREAM_BLOCK_SIZE - 1), true);
+    for (i = 0; i < JOYSTICK_STREAM_BLOCK_SIZE; i += JOYSTICK_AXIS)
+    {
+        MAP_ADC14_configureConversionMemory(ADC_MEM0 << i, ADC_VREFPOS_AVCC_VREFNEG_VSS, JOYSTICK_X_INPUT, false);
+        MAP_ADC14_configureConversionMemory(ADC_MEM0 << (i + 1), ADC_VREFPOS_AVCC_VREFNEG_VSS, JOYSTICK_Y_INPUT, false);
+    }
+
+    /* Configure DMA in ping-pong mode, triggered at the end of every sequence */
+    dma_init();
+    MAP_DMA_assignChannel(JOYSTICK_DMA_CHANNEL);
+    MAP_DMA_disableChannelAttribute(JOYSTICK_DMA_CHANNEL,
+                                    UDMA_ATTR_ALTSELECT | UDMA_ATTR_USEBURST |
+                                    UDMA_ATTR_HIGH_PRIORITY | UDMA_ATTR_REQMASK);
+    edu_boosterpack_joystick_stream_arm(UDMA_PRI_SELECT, stream_buffers[0]);
+    edu_boosterpack_joystick_stream_arm(UDMA_ALT_SELECT, stream_buffers[1]);
+    dma_set_callback(JOYSTICK_DMA_INTERRUPT, JOYSTICK_DMA_CHANNEL, edu_boosterpack_joystick_stream_dma);
+    MAP_DMA_enableChannel(JOYSTICK_DMA_CHANNEL);
+
+    streaming = true;
+
+    return true;
+}
+
+static uint32_t edu_boosterpack_joystick_timer_setup(uint32_t trigger_hz){
+    uint32_t smclk = MAP_CS_getSMCLK();
+    uint32_t divider = TIMER_A_CLOCKSOURCE_DIVIDER_1;
+    uint32_t period;
+
+    if ((trigger_hz == 0) || (trigger_hz > smclk / JOYSTICK_TIMER_MIN_PERIOD))
+    {
+        return 0;
+    }
+
+    /* Smallest prescaler that fits the period in 16 bits, for best resolution */
+    period = smclk / trigger_hz;
+    while (period > JOYSTICK_TIMER_MAX_PERIOD)
+    {
+        divider <<= 1;
+        if (divider > TIMER_A_CLOCKSOURCE_DIVIDER_64)
+        {
+            return 0;
+        }
+        period = smclk / (divider * trigger_hz);
+    }
+
+    timer_pwm_cfg.clockSourceDivider = divider;
+    timer_pwm_cfg.timerPeriod = period - 1;
+    timer_pwm_cfg.dutyCycle = period / 2;
+
+    /* Return the trigger rate actually achieved */
+    return smclk / (divider * period);
+}
+
+static void edu_boosterpack_joystick_timer_start(void){
+    /* The rising edge of CCR1 output starts each conversion */
+    MAP_Timer_A_generatePWM(JOYSTICK_TIMER, &timer_pwm_cfg);
+    timed = true;
+}
+
+static void edu_boosterpack_joystick_timer_stop(void){
+    if (timed == true)
+    {
+        MAP_Timer_A_stopTimer(JOYSTICK_TIMER);
+        timed = false;
+    }
+}
+
+static void edu_boosterpack_joystick_threshold_arm(uint8_t state){
+    uint64_t interrupts;
+
+    /*
+     * Centered: interrupt below low or above high.
+     * Left/right: interrupt when back inside the window shrunk by the
+     * hysteresis on that side, or when jumping straight to the other side.
+     */
+    if (state == JOYSTICK_EVENT_LEFT)
+    {
+        MAP_ADC14_setComparatorWindowValue(ADC_COMP_WINDOW0, threshold_low + threshold_hysteresis, threshold_high);
+        interrupts = ADC_IN_INT | ADC_HI_INT;
+    }
+    else if (state == JOYSTICK_EVENT_RIGHT)
+    {
+        MAP_ADC14_setComparatorWindowValue(ADC_COMP_WINDOW0, threshold_low, threshold_high - threshold_hysteresis);
+        interrupts = ADC_IN_INT | ADC_LO_INT;
+    }
+    else
+    {
+        MAP_ADC14_setComparatorWindowValue(ADC_COMP_WINDOW0, threshold_low, threshold_high);
+        interrupts = ADC_LO_INT | ADC_HI_INT;
+    }
+
+    MAP_ADC14_disableInterrupt(ADC_LO_INT | ADC_HI_INT | ADC_IN_INT);
+    MAP_ADC14_clearInterruptFlag(ADC_LO_INT | ADC_HI_INT | ADC_IN_INT);
+    MAP_ADC14_enableInterrupt(interrupts);
+}
+
+static void edu_boosterpack_joystick_threshold_event(uint64_t status){
+    uint8_t event;
+
+    if (status & ADC_LO_INT)
+    {
+        event = JOYSTICK_EVENT_LEFT;
+    }
+    else if (status & ADC_HI_INT)
+    {
+        event = JOYSTICK_EVENT_RIGHT;
+    }
+    else
+    {
+        event = JOYSTICK_EVENT_CENTER;
+    }
+
+    /* The conversion is done and the next one waits for the timer */
+    edu_boosterpack_joystick_threshold_arm(event);
+
+    /* call event callback routine */
+    if (joystick_event_callback_func != NULL)
+    {
+        joystick_event_callback_func(event);
+    }
+}
+
+static void edu_boosterpack_joystick_stream_arm(uint32_t select, uint16_t* buffer){
+    MAP_DMA_setChannelControl(select | JOYSTICK_DMA_CHANNEL,
+                              UDMA_SIZE_16 | UDMA_SRC_INC_16 | UDMA_DST_INC_16 | JOYSTICK_DMA_ARBITRATION);
+    MAP_DMA_setChannelTransfer(select | JOYSTICK_DMA_CHANNEL, UDMA_MODE_PINGPONG,
+                               (void*) &ADC14->MEM[0], buffer, JOYSTICK_STREAM_BLOCK_SIZE);
+}
+
+static void edu_boosterpack_joystick_stream_dma(void){
+    uint16_t* block;
+    uint16_t samples = JOYSTICK_STREAM_BLOCK_SAMPLES;
+
+    /* The DMA has moved on to the other buffer, re-arm the one just filled */
+    if (MAP_DMA_getChannelAttribute(JOYSTICK_DMA_CHANNEL) & UDMA_ATTR_ALTSELECT)
+    {
+        block = stream_buffers[0];
+        edu_boosterpack_joystick_stream_arm(UDMA_PRI_SELECT, block);
+    }
+    else
+    {
+        block = stream_buffers[1];
+        edu_boosterpack_joystick_stream_arm(UDMA_ALT_SELECT, block);
+    }
+
+    /* Condition the block in place, it is not touched again until re-filled */
+    if (stream_filter != NULL)
+    {
+        samples = filter_pipeline_process(stream_filter, block, samples);
+    }
+
+    /* call block callback routine */
+    if ((adc_block_callback_func != NULL) && (samples > 0))
+    {
+        adc_block_callback_func(block, samples);
+    }
+}
+
+static void edu_boosterpack_joystick_read_done(const uint16_t* results, uint8_t length){
+    uint8_t i;
+
+    if (oversampling_bits == 0)
+    {
+        results_buffer[0] = results[0];
+        results_buffer[1] = results[1];
         /* call callback routine */
-        adc_callback_func(results_buffer);
+        if (adc_callback_func != NULL)
+        {
+            adc_callback_func(results_buffer);
+        }
+        return;
+    }
+
+    /* Accumulate the pass */
+    for (i = 0; i < length; i += JOYSTICK_AXIS)
+    {
+        oversampling_sum[0] += results[i];
+        oversampling_sum[1] += results[i + 1];
+    }
+
+    /* Next pass of the same read */
+    if (++oversampling_pass < oversampling_passes)
+    {
+        adc_driver_request(&read_sequence);
+        return;
+    }
+
+    /* Decimate 4^bits samples to 14 + bits bits */
+    oversampling_sum[0] >>= oversampling_bits;
+    oversampling_sum[1] >>= oversampling_bits;
+
+    if (adc_oversampled_callback_func != NULL)
+    {
+        adc_oversampled_callback_func(oversampling_sum);
     }
 }
+
+// ADC14 interrupts while streaming or watching thresholds
+static void edu_boosterpack_joystick_adc_irq(uint64_t status){
+    /* A result was overwritten before the DMA read it */
+    if (ADC_OV_INT & status){
+        stream_adc_overflows++;
+    }
+    /* A trigger arrived while the previous conversion was still running */
+    if (ADC_TOV_INT & status){
+        stream_trigger_overruns++;
+    }
+    /* The stick crossed a threshold */
+    if ((ADC_LO_INT | ADC_HI_INT | ADC_IN_INT) & status){
+        edu_boosterpack_joystick_threshold_event(status);
+    }
+}
+
+/*--------------------------------interrupts----------------------------------*/
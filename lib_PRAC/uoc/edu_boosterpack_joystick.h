@@ -42,12 +42,34 @@
 #include <stdint.h>
 
 #include "callback.h"
+#include "filter.h"
 
 /*---------------------------------defines------------------------------------*/
 #define ACCEL_AXIS      3
+#define JOYSTICK_AXIS   2
+
+/* X/Y pairs per streaming block (one ADC14 sequence over ADC_MEM0 - ADC_MEM31) */
+#define JOYSTICK_STREAM_BLOCK_SAMPLES   16
+#define JOYSTICK_STREAM_BLOCK_SIZE      ( JOYSTICK_AXIS * JOYSTICK_STREAM_BLOCK_SAMPLES )
+
+/* Extra bits of resolution from oversampling (4^bits samples per read) */
+#define JOYSTICK_OVERSAMPLING_MAX_BITS  4
+
+enum
+{
+  JOYSTICK_EVENT_CENTER = 0,
+  JOYSTICK_EVENT_LEFT,
+  JOYSTICK_EVENT_RIGHT
+};
 /*---------------------------------typedefs-----------------------------------*/
 typedef void (*adc_callback_t)(uint16_t*);
 typedef uint16_t adc_result[ACCEL_AXIS];
+/* Receives interleaved X, Y samples; called from the DMA interrupt */
+typedef void (*adc_block_callback_t)(const uint16_t* block, uint16_t samples);
+/* Receives JOYSTICK_EVENT_*; called from the ADC interrupt */
+typedef void (*joystick_event_callback_t)(uint8_t event);
+/* Receives X, Y with 14 + extra_bits bits; called from the ADC interrupt */
+typedef void (*adc_oversampled_callback_t)(const uint32_t* results);
 
 /*--------------------------------prototypes----------------------------------*/
 
@@ -56,6 +78,16 @@ void edu_boosterpack_joystick_set_callback(adc_callback_t callback);
 void edu_boosterpack_joystick_read(void);
 void edu_boosterpack_joystick_clear_callback(void);
 void edu_boosterpack_joystick_disable(void);
+bool edu_boosterpack_joystick_set_oversampling(uint8_t extra_bits, adc_oversampled_callback_t callback);
+bool edu_boosterpack_joystick_stream_start(adc_block_callback_t callback);
+void edu_boosterpack_joystick_stream_stop(void);
+bool edu_boosterpack_joystick_stream_start_timed(uint32_t rate_hz, adc_block_callback_t callback);
+uint32_t edu_boosterpack_joystick_stream_get_rate(void);
+void edu_boosterpack_joystick_stream_get_overruns(uint32_t* adc_overflows, uint32_t* trigger_overruns);
+void edu_boosterpack_joystick_stream_set_filter(filter_pipeline_t* pipeline);
+bool edu_boosterpack_joystick_threshold_start(uint16_t low, uint16_t high, uint16_t hysteresis,
+                                              uint32_t rate_hz, joystick_event_callback_t callback);
+void edu_boosterpack_joystick_threshold_stop(void);
 
 /*--------------------------------variables-----------------------------------*/
 /*----------------------------------public------------------------------------*/
@@ -34,11 +34,16 @@
 
 /*--------------------------------includes------------------------------------*/
 
+#include <stddef.h>
+
 #include "edu_boosterpack_rgb.h"
+#include "kernel_trace.h"
 
 #include "msp432.h"
 #include "driverlib.h"
 
+#include "FreeRTOSConfig.h"
+
 /*---------------------------------defines------------------------------------*/
 
 #define LED_RED_PORT            ( GPIO_PORT_P2 )
@@ -46,18 +51,30 @@
 #define LED_RED_MODE            ( GPIO_PRIMARY_MODULE_FUNCTION )
 #define LED_RED_TIMER           ( TIMER_A0_BASE )
 #define LED_RED_TIMER_CCR       ( PM_TA0CCR3A )
+#define LED_RED_CCR             ( 3 )
 
 #define LED_GREEN_PORT          ( GPIO_PORT_P2 )
 #define LED_GREEN_PIN           ( GPIO_PIN4 )
 #define LED_GREEN_MODE          ( GPIO_PRIMARY_MODULE_FUNCTION )
 #define LED_GREEN_TIMER         ( TIMER_A0_BASE )
 #define LED_GREEN_TIMER_CCR     ( PM_TA0CCR1A )
+#define LED_GREEN_CCR           ( 1 )
 
+// P5.6 is not port mapped, its primary function is TA2.1
 #define LED_BLUE_PORT           ( GPIO_PORT_P5 )
 #define LED_BLUE_PIN            ( GPIO_PIN6 )
 #define LED_BLUE_MODE           ( GPIO_PRIMARY_MODULE_FUNCTION )
 #define LED_BLUE_TIMER          ( TIMER_A2_BASE )
-#define LED_BLUE_TIMER_CCR      ( PM_TA1CCR1A )
+#define LED_BLUE_CCR            ( 1 )
+
+// 8 bit levels are shifted into the compare registers, a level of 255 is
+// above the period and keeps the output always on
+#define LED_PWM_PERIOD          ( (255 << 8) - 1 )
+#define LED_PWM_LEVEL_SHIFT     ( 8 )
+
+// Animations advance one frame per PWM period of TA0
+#define LED_FRAME_TIMER         ( TIMER_A0_BASE )
+#define LED_FRAME_INTERRUPT     ( INT_TA0_0 )
 
 /*---------------------------------typedefs-----------------------------------*/
 
@@ -67,6 +84,7 @@ typedef struct
   uint16_t pin;
   uint8_t mode;
   uint32_t timer;
+  uint8_t ccr;
   Timer_A_PWMConfig* pwm_cfg;
 } gpio_cfg_t;
 
@@ -74,6 +92,8 @@ typedef struct
 
 static void edu_boosterpack_rgb_gpio_init(void);
 static void edu_boosterpack_rgb_set_pwm(uint8_t led, uint8_t duty_cycle);
+static void edu_boosterpack_rgb_set_level(uint8_t led, uint8_t level);
+static void edu_boosterpack_rgb_load_keyframe(void);
 
 /*--------------------------------variables-----------------------------------*/
 
@@ -82,16 +102,11 @@ static const uint8_t port2_remapping[] =
   PM_NONE, PM_NONE, PM_NONE, PM_NONE, LED_GREEN_TIMER_CCR, PM_NONE, LED_RED_TIMER_CCR, PM_NONE
 };
 
-static const uint8_t port5_remapping[] =
-{
-  PM_NONE, PM_NONE, PM_NONE, PM_NONE, PM_NONE, PM_NONE, LED_BLUE_TIMER_CCR, PM_NONE
-};
-
 static Timer_A_PWMConfig led_red_pwm_cfg =
 {
   TIMER_A_CLOCKSOURCE_SMCLK,
   TIMER_A_CLOCKSOURCE_DIVIDER_1,
-  65535,
+  LED_PWM_PERIOD,
   TIMER_A_CAPTURECOMPARE_REGISTER_3,
   TIMER_A_OUTPUTMODE_RESET_SET,
   0
@@ -101,7 +116,7 @@ static Timer_A_PWMConfig led_green_pwm_cfg =
 {
   TIMER_A_CLOCKSOURCE_SMCLK,
   TIMER_A_CLOCKSOURCE_DIVIDER_1,
-  65535,
+  LED_PWM_PERIOD,
   TIMER_A_CAPTURECOMPARE_REGISTER_1,
   TIMER_A_OUTPUTMODE_RESET_SET,
   0
@@ -111,7 +126,7 @@ static Timer_A_PWMConfig led_blue_pwm_cfg =
 {
   TIMER_A_CLOCKSOURCE_SMCLK,
   TIMER_A_CLOCKSOURCE_DIVIDER_1,
-  65535,
+  LED_PWM_PERIOD,
   TIMER_A_CAPTURECOMPARE_REGISTER_1,
   TIMER_A_OUTPUTMODE_RESET_SET,
   0
@@ -119,49 +134,120 @@ static Timer_A_PWMConfig led_blue_pwm_cfg =
 
 static const gpio_cfg_t leds[] =
 {
-  {LED_RED_PORT, LED_RED_PIN, LED_RED_MODE, LED_RED_TIMER, &led_red_pwm_cfg},
-  {LED_GREEN_PORT, LED_GREEN_PIN, LED_GREEN_MODE, LED_GREEN_TIMER, &led_green_pwm_cfg},
-  {LED_BLUE_PORT, LED_BLUE_PIN, LED_BLUE_MODE, LED_BLUE_TIMER, &led_blue_pwm_cfg}
+  {LED_RED_PORT, LED_RED_PIN, LED_RED_MODE, LED_RED_TIMER, LED_RED_CCR, &led_red_pwm_cfg},
+  {LED_GREEN_PORT, LED_GREEN_PIN, LED_GREEN_MODE, LED_GREEN_TIMER, LED_GREEN_CCR, &led_green_pwm_cfg},
+  {LED_BLUE_PORT, LED_BLUE_PIN, LED_BLUE_MODE, LED_BLUE_TIMER, LED_BLUE_CCR, &led_blue_pwm_cfg}
 };
 
+static uint32_t frame_hz;
+
+// Animation being played, levels are kept in 16.16 fixed point
+static const rgb_animation_t* animation = NULL;
+static callback_t animation_done;
+static uint8_t animation_index;
+static uint8_t animation_loops;
+static uint32_t animation_frames;
+static int32_t animation_level[EDU_BOOSTERPACK_LED_ELEMENTS];
+static int32_t animation_step[EDU_BOOSTERPACK_LED_ELEMENTS];
+
 /*----------------------------------public------------------------------------*/
 
 void edu_boosterpack_rgb_init(void)
 {
+  uint16_t i;
+
   edu_boosterpack_rgb_gpio_init();
+
+  /* The timers are set up once, afterwards only the compare registers change */
+  for (i = 0; i < EDU_BOOSTERPACK_LED_ELEMENTS; i++)
+  {
+    MAP_Timer_A_generatePWM(leds[i].timer, leds[i].pwm_cfg);
+  }
+
+  frame_hz = MAP_CS_getSMCLK() / (LED_PWM_PERIOD + 1);
+
+  MAP_Interrupt_setPriority(LED_FRAME_INTERRUPT, configMAX_SYSCALL_INTERRUPT_PRIORITY);
 }
 
 void edu_boosterpack_rgb_on(uint8_t led)
 {
+  edu_boosterpack_rgb_stop();
   edu_boosterpack_rgb_set_pwm(led, 100);
 }
 
 void edu_boosterpack_rgb_off(uint8_t led)
 {
+  edu_boosterpack_rgb_stop();
   edu_boosterpack_rgb_set_pwm(led, 0);
 }
 
 void edu_boosterpack_rgb_pwm(uint8_t led, uint8_t duty_cycle)
 {
+  edu_boosterpack_rgb_stop();
   edu_boosterpack_rgb_set_pwm(led, duty_cycle);
 }
 
 void edu_boosterpack_rgb_pwm_all(uint8_t r, uint8_t g, uint8_t b)
 {
-  uint16_t r_ = 100 * r / 255;
-  uint16_t g_ = 100 * g / 255;
-  uint16_t b_ = 100 * b / 255;
+  edu_boosterpack_rgb_stop();
+  edu_boosterpack_rgb_set_level(EDU_BOOSTERPACK_LED_RED, r);
+  edu_boosterpack_rgb_set_level(EDU_BOOSTERPACK_LED_GREEN, g);
+  edu_boosterpack_rgb_set_level(EDU_BOOSTERPACK_LED_BLUE, b);
+}
+
+/*
+ * Plays an animation from the frame interrupt, no task is involved. Each
+ * keyframe fades linearly from the current color to its own in duration_ms
+ * (0 jumps to it) and the whole table repeats loops times, or forever if
+ * loops is 0. done, if any, is called from the interrupt at the end.
+ */
+void edu_boosterpack_rgb_play(const rgb_animation_t* anim, callback_t done)
+{
+  uint8_t i;
+
+  edu_boosterpack_rgb_stop();
+
+  if ((anim == NULL) || (anim->length == 0))
+  {
+    return;
+  }
 
-  edu_boosterpack_rgb_set_pwm(EDU_BOOSTERPACK_LED_RED, r_);
-  edu_boosterpack_rgb_set_pwm(EDU_BOOSTERPACK_LED_GREEN, g_);
-  edu_boosterpack_rgb_set_pwm(EDU_BOOSTERPACK_LED_BLUE, b_);
+  /* Fade from whatever is shown now, back from compare units to 8.16 levels */
+  for (i = 0; i < EDU_BOOSTERPACK_LED_ELEMENTS; i++)
+  {
+    animation_level[i] = (int32_t)TIMER_A_CMSIS(leds[i].timer)->CCR[leds[i].ccr] << (16 - LED_PWM_LEVEL_SHIFT);
+  }
+
+  animation = anim;
+  animation_done = done;
+  animation_index = 0;
+  animation_loops = anim->loops;
+  edu_boosterpack_rgb_load_keyframe();
+
+  MAP_Timer_A_clearCaptureCompareInterrupt(LED_FRAME_TIMER, TIMER_A_CAPTURECOMPARE_REGISTER_0);
+  MAP_Timer_A_enableCaptureCompareInterrupt(LED_FRAME_TIMER, TIMER_A_CAPTURECOMPARE_REGISTER_0);
+  MAP_Interrupt_enableInterrupt(LED_FRAME_INTERRUPT);
+}
+
+// Stops the animation and leaves the LEDs as they are
+void edu_boosterpack_rgb_stop(void)
+{
+  MAP_Interrupt_disableInterrupt(LED_FRAME_INTERRUPT);
+  MAP_Timer_A_disableCaptureCompareInterrupt(LED_FRAME_TIMER, TIMER_A_CAPTURECOMPARE_REGISTER_0);
+
+  animation = NULL;
+}
+
+bool edu_boosterpack_rgb_is_playing(void)
+{
+  return (animation != NULL);
 }
+
 /*---------------------------------private------------------------------------*/
 
 static void edu_boosterpack_rgb_gpio_init(void)
 {
   MAP_PMAP_configurePorts((const uint8_t *) port2_remapping, PMAP_P2MAP, 1, PMAP_DISABLE_RECONFIGURATION);
-  MAP_PMAP_configurePorts((const uint8_t *) port5_remapping, PMAP_P5MAP, 1, PMAP_DISABLE_RECONFIGURATION);
 
   uint16_t i;
   for (i = 0; i < EDU_BOOSTERPACK_LED_ELEMENTS; i++)
@@ -177,9 +263,87 @@ static void edu_boosterpack_rgb_set_pwm(uint8_t led, uint8_t duty_cycle)
     duty_cycle = 100;
   }
 
-  leds[led].pwm_cfg->dutyCycle = leds[led].pwm_cfg->timerPeriod * duty_cycle / 100;
+  TIMER_A_CMSIS(leds[led].timer)->CCR[leds[led].ccr] = ((uint32_t)(LED_PWM_PERIOD + 1) * duty_cycle) / 100;
+}
 
-  Timer_A_generatePWM(leds[led].timer, leds[led].pwm_cfg);
+static void edu_boosterpack_rgb_set_level(uint8_t led, uint8_t level)
+{
+  TIMER_A_CMSIS(leds[led].timer)->CCR[leds[led].ccr] = (uint16_t)level << LED_PWM_LEVEL_SHIFT;
+}
+
+// Computes the per frame steps from the current levels to the keyframe
+static void edu_boosterpack_rgb_load_keyframe(void)
+{
+  const rgb_keyframe_t* keyframe = &animation->keyframes[animation_index];
+  int32_t target[EDU_BOOSTERPACK_LED_ELEMENTS];
+  uint8_t i;
+
+  target[EDU_BOOSTERPACK_LED_RED] = (int32_t)keyframe->r << 16;
+  target[EDU_BOOSTERPACK_LED_GREEN] = (int32_t)keyframe->g << 16;
+  target[EDU_BOOSTERPACK_LED_BLUE] = (int32_t)keyframe->b << 16;
+
+  animation_frames = ((uint32_t)keyframe->duration_ms * frame_hz) / 1000;
+  if (animation_frames == 0)
+  {
+    animation_frames = 1;
+  }
+
+  for (i = 0; i < EDU_BOOSTERPACK_LED_ELEMENTS; i++)
+  {
+    animation_step[i] = (target[i] - animation_level[i]) / (int32_t)animation_frames;
+
+    /* Start less than a step off so the last frame lands on the target */
+    animation_level[i] = target[i] - animation_step[i] * (int32_t)animation_frames;
+  }
 }
 
 /*--------------------------------interrupts----------------------------------*/
+
+void TA0_0_IRQHandler(void)
+{
+  uint8_t i;
+
+  KERNEL_TRACE_ISR_ENTER(INT_TA0_0);
+
+  MAP_Timer_A_clearCaptureCompareInterrupt(LED_FRAME_TIMER, TIMER_A_CAPTURECOMPARE_REGISTER_0);
+
+  if (animation == NULL)
+  {
+    KERNEL_TRACE_ISR_EXIT(INT_TA0_0);
+    return;
+  }
+
+  for (i = 0; i < EDU_BOOSTERPACK_LED_ELEMENTS; i++)
+  {
+    animation_level[i] += animation_step[i];
+    TIMER_A_CMSIS(leds[i].timer)->CCR[leds[i].ccr] = animation_level[i] >> (16 - LED_PWM_LEVEL_SHIFT);
+  }
+
+  if (--animation_frames > 0)
+  {
+    KERNEL_TRACE_ISR_EXIT(INT_TA0_0);
+    return;
+  }
+
+  /* Next keyframe, wrapping around while there are loops left */
+  if (++animation_index >= animation->length)
+  {
+    animation_index = 0;
+
+    if ((animation_loops != 0) && (--animation_loops == 0))
+    {
+      edu_boosterpack_rgb_stop();
+
+      if (animation_done != NULL)
+      {
+        animation_done();
+      }
+      KERNEL_TRACE_ISR_EXIT(INT_TA0_0);
+      return;
+    }
+  }
+
+  edu_boosterpack_rgb_load_keyframe();
+
+  KERNEL_TRACE_ISR_EXIT(INT_TA0_0);
+}
@@ -41,6 +41,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "callback.h"
+
 /*---------------------------------defines------------------------------------*/
 
 enum {
@@ -51,6 +53,23 @@ enum {
 };
 
 /*---------------------------------typedefs-----------------------------------*/
+
+/* Fade to r, g, b (0 to 255) in duration_ms, 0 jumps to the color */
+typedef struct
+{
+  uint8_t r;
+  uint8_t g;
+  uint8_t b;
+  uint16_t duration_ms;
+} rgb_keyframe_t;
+
+typedef struct
+{
+  const rgb_keyframe_t* keyframes;
+  uint8_t length;
+  uint8_t loops;          // 0 repeats forever
+} rgb_animation_t;
+
 /*--------------------------------prototypes----------------------------------*/
 
 void edu_boosterpack_rgb_init(void);
@@ -58,6 +77,9 @@ void edu_boosterpack_rgb_on(uint8_t led);
 void edu_boosterpack_rgb_off(uint8_t led);
 void edu_boosterpack_rgb_pwm(uint8_t led, uint8_t duty_cycle);
 void edu_boosterpack_rgb_pwm_all(uint8_t r, uint8_t g, uint8_t b);
+void edu_boosterpack_rgb_play(const rgb_animation_t* anim, callback_t done);
+void edu_boosterpack_rgb_stop(void);
+bool edu_boosterpack_rgb_is_playing(void);
 
 /*--------------------------------variables-----------------------------------*/
 /*----------------------------------public------------------------------------*/
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "event_groups.h"
+
+#include "event_dispatch.h"
+
+/*---------------------------------defines------------------------------------*/
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  TaskHandle_t task;
+  event_dispatch_set_t events;
+} event_dispatch_consumer_t;
+
+/*--------------------------------prototypes----------------------------------*/
+/*--------------------------------variables-----------------------------------*/
+
+// Entries are only added, before count covers them, so signals read them unlocked
+static event_dispatch_consumer_t event_dispatch_consumers[EVENT_DISPATCH_CONSUMERS];
+static volatile uint8_t event_dispatch_count = 0;
+
+static EventGroupHandle_t event_dispatch_states = NULL;
+static event_dispatch_stats_t event_dispatch_stats;
+
+/*----------------------------------public------------------------------------*/
+
+bool event_dispatch_init(void)
+{
+  event_dispatch_count = 0;
+  event_dispatch_stats.signals = 0;
+  event_dispatch_stats.unconsumed = 0;
+
+  // Created once and only cleared after, a task may still wait on it in event_dispatch_state_wait()
+  if (event_dispatch_states == NULL)
+  {
+    event_dispatch_states = xEventGroupCreate();
+  }
+  else
+  {
+    xEventGroupClearBits(event_dispatch_states, EVENT_DISPATCH_ALL);
+  }
+
+  return (event_dispatch_states != NULL);
+}
+
+bool event_dispatch_subscribe(event_dispatch_set_t events)
+{
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  bool subscribed = false;
+  uint8_t i;
+
+  taskENTER_CRITICAL();
+  for (i = 0; i < event_dispatch_count; i++)
+  {
+    if (event_dispatch_consumers[i].task == task)
+    {
+      event_dispatch_consumers[i].events |= events;
+      subscribed = true;
+    }
+  }
+  if ((subscribed == false) && (event_dispatch_count < EVENT_DISPATCH_CONSUMERS))
+  {
+    event_dispatch_consumers[event_dispatch_count].task = task;
+    event_dispatch_consumers[event_dispatch_count].events = events;
+    event_dispatch_count++;
+    subscribed = true;
+  }
+  taskEXIT_CRITICAL();
+
+  return subscribed;
+}
+
+void event_dispatch_signal(uint8_t event)
+{
+  event_dispatch_set_t bit = EVENT_DISPATCH_BIT(event);
+  bool consumed = false;
+  uint8_t i;
+
+  for (i = 0; i < event_dispatch_count; i++)
+  {
+    if (event_dispatch_consumers[i].events & bit)
+    {
+      xTaskNotify(event_dispatch_consumers[i].task, bit, eSetBits);
+      consumed = true;
+    }
+  }
+
+  taskENTER_CRITICAL();
+  event_dispatch_stats.signals++;
+  if (consumed == false)
+  {
+    event_dispatch_stats.unconsumed++;
+  }
+  taskEXIT_CRITICAL();
+}
+
+void event_dispatch_signal_from_isr(uint8_t event, BaseType_t* woken)
+{
+  event_dispatch_set_t bit = EVENT_DISPATCH_BIT(event);
+  bool consumed = false;
+  UBaseType_t state;
+  uint8_t i;
+
+  for (i = 0; i < event_dispatch_count; i++)
+  {
+    if (event_dispatch_consumers[i].events & bit)
+    {
+      xTaskNotifyFromISR(event_dispatch_consumers[i].task, bit, eSetBits, woken);
+      consumed = true;
+    }
+  }
+
+  state = taskENTER_CRITICAL_FROM_ISR();
+  event_dispatch_stats.signals++;
+  if (consumed == false)
+  {
+    event_dispatch_stats.unconsumed++;
+  }
+  taskEXIT_CRITICAL_FROM_ISR(state);
+}
+
+event_dispatch_set_t event_dispatch_wait(TickType_t timeout)
+{
+  uint32_t events = 0;
+
+  if (xTaskNotifyWait(0, UINT32_MAX, &events, timeout) != pdPASS)
+  {
+    events = 0;
+  }
+
+  return (event_dispatch_set_t) events;
+}
+
+void event_dispatch_state_set(event_dispatch_set_t states)
+{
+  xEventGroupSetBits(event_dispatch_states, states & EVENT_DISPATCH_ALL);
+}
+
+void event_dispatch_state_clear(event_dispatch_set_t states)
+{
+  xEventGroupClearBits(event_dispatch_states, states & EVENT_DISPATCH_ALL);
+}
+
+event_dispatch_set_t event_dispatch_state_get(void)
+{
+  return (event_dispatch_set_t) xEventGroupGetBits(event_dispatch_states);
+}
+
+event_dispatch_set_t event_dispatch_state_wait(event_dispatch_set_t states, bool all, TickType_t timeout)
+{
+  event_dispatch_set_t current;
+
+  current = xEventGroupWaitBits(event_dispatch_states, states & EVENT_DISPATCH_ALL, pdFALSE,
+                                (all == true) ? pdTRUE : pdFALSE, timeout);
+
+  if (all == true)
+  {
+    return ((current & states) == states) ? current : 0;
+  }
+
+  return ((current & states) != 0) ? current : 0;
+}
+
+void event_dispatch_get_stats(event_dispatch_stats_t* stats)
+{
+  taskENTER_CRITICAL();
+  *stats = event_dispatch_stats;
+  taskEXIT_CRITICAL();
+}
+
+/*---------------------------------private------------------------------------*/
+/*--------------------------------interrupts----------------------------------*/
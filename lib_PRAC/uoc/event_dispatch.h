@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef EVENT_DISPATCH_H_
+#define EVENT_DISPATCH_H_
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*---------------------------------defines------------------------------------*/
+
+/* Events and states share the bits an event group holds with 32-bit ticks */
+#define EVENT_DISPATCH_EVENTS       ( 24 )
+#define EVENT_DISPATCH_CONSUMERS    ( 8 )
+
+#define EVENT_DISPATCH_BIT(event)   ( (event_dispatch_set_t) 1 << (event) )
+#define EVENT_DISPATCH_ALL          ( EVENT_DISPATCH_BIT(EVENT_DISPATCH_EVENTS) - 1 )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+/*
+ * Events wake the tasks that consume them through their notification value,
+ * which accumulates them until the task waits again: a producer never blocks
+ * and an event signalled twice before it is consumed is seen once. States stay
+ * set until cleared, in an event group that the tasks can test or wait for.
+ * Both are sets of one bit per number, from 0 to EVENT_DISPATCH_EVENTS - 1.
+ */
+typedef uint32_t event_dispatch_set_t;
+
+typedef struct
+{
+  uint32_t signals;         // events signalled
+  uint32_t unconsumed;      // events no task had subscribed to
+} event_dispatch_stats_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+/* Before the scheduler starts. Returns false if the event group cannot be created */
+bool event_dispatch_init(void);
+
+/*
+ * The calling task consumes the events of the set, which must not share its
+ * notification value with anything else. Returns false if the table is full.
+ */
+bool event_dispatch_subscribe(event_dispatch_set_t events);
+
+/* Wakes every task that consumes the event */
+void event_dispatch_signal(uint8_t event);
+
+/*
+ * The same from the interrupt handlers, whose priority must not be above
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY. woken is set to pdTRUE when a task
+ * woken has to run, see portYIELD_FROM_ISR().
+ */
+void event_dispatch_signal_from_isr(uint8_t event, BaseType_t* woken);
+
+/*
+ * Waits up to timeout ticks for the calling task to have events, and returns
+ * and forgets all of them, 0 if there were none.
+ */
+event_dispatch_set_t event_dispatch_wait(TickType_t timeout);
+
+/*
+ * States, only from tasks: the event group cannot be set from the interrupts
+ * without the timer task. wait returns the states when any (or all) of the
+ * set are, 0 after timeout ticks.
+ */
+void event_dispatch_state_set(event_dispatch_set_t states);
+void event_dispatch_state_clear(event_dispatch_set_t states);
+event_dispatch_set_t event_dispatch_state_get(void);
+event_dispatch_set_t event_dispatch_state_wait(event_dispatch_set_t states, bool all, TickType_t timeout);
+
+void event_dispatch_get_stats(event_dispatch_stats_t* stats);
+
+/*--------------------------------variables-----------------------------------*/
+/*----------------------------------public------------------------------------*/
+/*---------------------------------private------------------------------------*/
+/*--------------------------------interrupts----------------------------------*/
+
+#endif /* EVENT_DISPATCH_H_ */
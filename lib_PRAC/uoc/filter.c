@@ -0,0 +1,659 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <string.h>
+
+#if defined(__MSP432P401R__)
+#include "driverlib.h"
+#endif
+
+#include "filter.h"
+
+/*---------------------------------defines------------------------------------*/
+
+/* Two channels (e.g. joystick X/Y) fill exactly one 32-bit word per frame */
+#define FILTER_PACKED_CHANNELS      ( 2 )
+
+/* Largest moving average window whose sum still fits a 16-bit lane */
+#define FILTER_PACKED_WINDOW_MAX    ( 1 << (16 - FILTER_SAMPLE_BITS) )
+
+/* IIR state keeps the spare lane bits as fraction to reduce the dead band */
+#define FILTER_IIR_FRACTION_BITS    ( 16 - FILTER_SAMPLE_BITS )
+#define FILTER_IIR_SHIFT_MAX        ( 8 )
+
+#define FILTER_LANE_MASK(shift)     ( (uint32_t)(0xFFFFu >> (shift)) * 0x00010001u )
+
+/*---------------------------------typedefs-----------------------------------*/
+/*--------------------------------prototypes----------------------------------*/
+
+static bool filter_setup(filter_stage_t* stage, uint8_t type, uint8_t channels);
+
+static uint16_t filter_moving_average(filter_stage_t* stage, uint16_t* samples, uint16_t frames);
+static uint16_t filter_moving_average_packed(filter_stage_t* stage, uint16_t* samples, uint16_t frames);
+static uint16_t filter_median(filter_stage_t* stage, uint16_t* samples, uint16_t frames);
+static uint16_t filter_median_packed(filter_stage_t* stage, uint16_t* samples, uint16_t frames);
+static uint16_t filter_iir(filter_stage_t* stage, uint16_t* samples, uint16_t frames);
+static uint16_t filter_iir_packed(filter_stage_t* stage, uint16_t* samples, uint16_t frames);
+static uint16_t filter_dead_zone(filter_stage_t* stage, uint16_t* samples, uint16_t frames);
+static uint16_t filter_decimate(filter_stage_t* stage, uint16_t* samples, uint16_t frames);
+
+static void filter_prime(filter_stage_t* stage, const uint16_t* frame);
+
+/*--------------------------------variables-----------------------------------*/
+/*----------------------------------public------------------------------------*/
+
+// Averages the last length frames, length must be a power of two
+bool filter_moving_average_init(filter_stage_t* stage, uint8_t channels, uint8_t length)
+{
+  uint8_t shift = 0;
+
+  if ((length < 2) || (length > FILTER_WINDOW_MAX) || ((length & (length - 1)) != 0))
+  {
+    return false;
+  }
+
+  while ((1 << shift) < length)
+  {
+    shift++;
+  }
+
+  stage->length = length;
+  stage->shift = shift;
+
+  return filter_setup(stage, FILTER_MOVING_AVERAGE, channels);
+}
+
+// Median of the last length frames, length must be 3 or 5
+bool filter_median_init(filter_stage_t* stage, uint8_t channels, uint8_t length)
+{
+  if ((length != 3) && (length != 5))
+  {
+    return false;
+  }
+
+  stage->length = length;
+
+  return filter_setup(stage, FILTER_MEDIAN, channels);
+}
+
+// First order low pass, y += (x - y) / 2^shift
+bool filter_iir_init(filter_stage_t* stage, uint8_t channels, uint8_t shift)
+{
+  if ((shift == 0) || (shift > FILTER_IIR_SHIFT_MAX))
+  {
+    return false;
+  }
+
+  stage->shift = shift;
+
+  return filter_setup(stage, FILTER_IIR, channels);
+}
+
+// Snaps samples closer than width to center. A channel only returns to center
+// once it gets closer than width - hysteresis, so it does not chatter at the edge
+bool filter_dead_zone_init(filter_stage_t* stage, uint8_t channels, uint16_t center, uint16_t width, uint16_t hysteresis)
+{
+  if (hysteresis > width)
+  {
+    return false;
+  }
+
+  stage->center = center;
+  stage->width = width;
+  stage->hysteresis = hysteresis;
+
+  return filter_setup(stage, FILTER_DEAD_ZONE, channels);
+}
+
+// Keeps one frame out of every factor frames, across block boundaries
+bool filter_decimate_init(filter_stage_t* stage, uint8_t channels, uint8_t factor)
+{
+  if (factor == 0)
+  {
+    return false;
+  }
+
+  stage->length = factor;
+
+  return filter_setup(stage, FILTER_DECIMATE, channels);
+}
+
+void filter_reset(filter_stage_t* stage)
+{
+  stage->index = 0;
+  stage->primed = false;
+
+  memset(stage->history, 0, sizeof(stage->history));
+  memset(stage->sum, 0, sizeof(stage->sum));
+  memset(stage->state, 0, sizeof(stage->state));
+}
+
+// Filters frames in place and returns the number of frames left in samples,
+// which is only smaller than frames for a decimation stage
+uint16_t filter_process(filter_stage_t* stage, uint16_t* samples, uint16_t frames)
+{
+  if (stage->channels == FILTER_PACKED_CHANNELS)
+  {
+    switch (stage->type)
+    {
+      case FILTER_MOVING_AVERAGE:
+        if (stage->length <= FILTER_PACKED_WINDOW_MAX)
+        {
+          return filter_moving_average_packed(stage, samples, frames);
+        }
+        break;
+      case FILTER_MEDIAN:
+        return filter_median_packed(stage, samples, frames);
+      case FILTER_IIR:
+        return filter_iir_packed(stage, samples, frames);
+      default:
+        break;
+    }
+  }
+
+  return filter_process_reference(stage, samples, frames);
+}
+
+// Plain C implementation of every stage, bit exact with filter_process
+uint16_t filter_process_reference(filter_stage_t* stage, uint16_t* samples, uint16_t frames)
+{
+  switch (stage->type)
+  {
+    case FILTER_MOVING_AVERAGE:
+      return filter_moving_average(stage, samples, frames);
+    case FILTER_MEDIAN:
+      return filter_median(stage, samples, frames);
+    case FILTER_IIR:
+      return filter_iir(stage, samples, frames);
+    case FILTER_DEAD_ZONE:
+      return filter_dead_zone(stage, samples, frames);
+    case FILTER_DECIMATE:
+      return filter_decimate(stage, samples, frames);
+    default:
+      return frames;
+  }
+}
+
+void filter_pipeline_init(filter_pipeline_t* pipeline)
+{
+  pipeline->length = 0;
+}
+
+// Stages run in the order they are added and must all use the same channels
+bool filter_pipeline_add(filter_pipeline_t* pipeline, filter_stage_t* stage)
+{
+  if (pipeline->length >= FILTER_PIPELINE_STAGES_MAX)
+  {
+    return false;
+  }
+
+  if ((pipeline->length > 0) && (pipeline->stages[0]->channels != stage->channels))
+  {
+    return false;
+  }
+
+  pipeline->stages[pipeline->length++] = stage;
+
+  return true;
+}
+
+uint16_t filter_pipeline_process(filter_pipeline_t* pipeline, uint16_t* samples, uint16_t frames)
+{
+  uint8_t i;
+
+  for (i = 0; (i < pipeline->length) && (frames > 0); i++)
+  {
+    frames = filter_process(pipeline->stages[i], samples, frames);
+  }
+
+  return frames;
+}
+
+/*---------------------------------private------------------------------------*/
+
+/*
+ * Dual 16-bit helpers. On the Cortex-M4 these are single DSP instructions, on
+ * the host they are emulated lane by lane so the packed paths can be checked
+ * against filter_process_reference.
+ */
+
+static inline uint32_t filter_load(const uint16_t* frame)
+{
+  uint32_t value;
+
+  memcpy(&value, frame, sizeof(value));
+
+  return value;
+}
+
+static inline void filter_store(uint16_t* frame, uint32_t value)
+{
+  memcpy(frame, &value, sizeof(value));
+}
+
+#if defined(__MSP432P401R__)
+
+static inline uint32_t filter_add16(uint32_t a, uint32_t b)
+{
+  return __SADD16(a, b);
+}
+
+static inline uint32_t filter_sub16(uint32_t a, uint32_t b)
+{
+  return __SSUB16(a, b);
+}
+
+static inline uint32_t filter_halving_add16(uint32_t a, uint32_t b)
+{
+  return __UHADD16(a, b);
+}
+
+static inline uint32_t filter_min16(uint32_t a, uint32_t b)
+{
+  /* USUB16 sets a GE flag per lane where a >= b, SEL picks lanes by GE */
+  (void)__USUB16(a, b);
+  return __SEL(b, a);
+}
+
+static inline uint32_t filter_max16(uint32_t a, uint32_t b)
+{
+  (void)__USUB16(a, b);
+  return __SEL(a, b);
+}
+
+#else
+
+static inline uint32_t filter_lanes(uint32_t low, uint32_t high)
+{
+  return (low & 0xFFFF) | (high << 16);
+}
+
+static inline uint32_t filter_add16(uint32_t a, uint32_t b)
+{
+  return filter_lanes(a + b, (a >> 16) + (b >> 16));
+}
+
+static inline uint32_t filter_sub16(uint32_t a, uint32_t b)
+{
+  return filter_lanes(a - b, (a >> 16) - (b >> 16));
+}
+
+static inline uint32_t filter_halving_add16(uint32_t a, uint32_t b)
+{
+  return filter_lanes(((a & 0xFFFF) + (b & 0xFFFF)) >> 1, ((a >> 16) + (b >> 16)) >> 1);
+}
+
+static inline uint32_t filter_min16(uint32_t a, uint32_t b)
+{
+  return filter_lanes(((a & 0xFFFF) < (b & 0xFFFF)) ? a : b, ((a >> 16) < (b >> 16)) ? (a >> 16) : (b >> 16));
+}
+
+static inline uint32_t filter_max16(uint32_t a, uint32_t b)
+{
+  return filter_lanes(((a & 0xFFFF) >= (b & 0xFFFF)) ? a : b, ((a >> 16) >= (b >> 16)) ? (a >> 16) : (b >> 16));
+}
+
+#endif
+
+static bool filter_setup(filter_stage_t* stage, uint8_t type, uint8_t channels)
+{
+  if ((channels == 0) || (channels > FILTER_CHANNELS_MAX))
+  {
+    return false;
+  }
+
+  stage->type = type;
+  stage->channels = channels;
+
+  filter_reset(stage);
+
+  return true;
+}
+
+// Fills the window with the first frame so the output does not ramp up from 0
+static void filter_prime(filter_stage_t* stage, const uint16_t* frame)
+{
+  uint8_t i, c;
+
+  for (c = 0; c < stage->channels; c++)
+  {
+    for (i = 0; i < stage->length; i++)
+    {
+      stage->history[i][c] = frame[c];
+    }
+  }
+
+  stage->primed = true;
+}
+
+static uint16_t filter_moving_average(filter_stage_t* stage, uint16_t* samples, uint16_t frames)
+{
+  uint16_t* frame;
+  uint16_t f;
+  uint8_t c;
+
+  if (stage->primed == false)
+  {
+    filter_prime(stage, samples);
+
+    for (c = 0; c < stage->channels; c++)
+    {
+      stage->sum[c] = (uint32_t)samples[c] << stage->shift;
+    }
+  }
+
+  for (f = 0; f < frames; f++)
+  {
+    frame = &samples[f * stage->channels];
+
+    for (c = 0; c < stage->channels; c++)
+    {
+      stage->sum[c] += frame[c];
+      stage->sum[c] -= stage->history[stage->index][c];
+      stage->history[stage->index][c] = frame[c];
+      frame[c] = (uint16_t)(stage->sum[c] >> stage->shift);
+    }
+
+    stage->index = (stage->index + 1) & (stage->length - 1);
+  }
+
+  return frames;
+}
+
+static uint16_t filter_moving_average_packed(filter_stage_t* stage, uint16_t* samples, uint16_t frames)
+{
+  const uint32_t mask = FILTER_LANE_MASK(stage->shift);
+  uint32_t sum, sample, oldest;
+  uint16_t f;
+
+  if (stage->primed == false)
+  {
+    filter_prime(stage, samples);
+
+    /* Packed running sums live in sum[0], one per lane */
+    sample = filter_load(samples);
+    stage->sum[0] = ((sample & 0xFFFF) << stage->shift) | ((sample >> 16) << (16 + stage->shift));
+  }
+
+  sum = stage->sum[0];
+
+  for (f = 0; f < frames; f++)
+  {
+    sample = filter_load(&samples[f * FILTER_PACKED_CHANNELS]);
+    oldest = filter_load(stage->history[stage->index]);
+
+    /* Lane sums wrap modulo 2^16 but always end up within 16 bits */
+    sum = filter_add16(sum, filter_sub16(sample, oldest));
+
+    filter_store(stage->history[stage->index], sample);
+    filter_store(&samples[f * FILTER_PACKED_CHANNELS], (sum >> stage->shift) & mask);
+
+    stage->index = (stage->index + 1) & (stage->length - 1);
+  }
+
+  stage->sum[0] = sum;
+
+  return frames;
+}
+
+static uint16_t filter_median(filter_stage_t* stage, uint16_t* samples, uint16_t frames)
+{
+  uint16_t window[FILTER_WINDOW_MAX];
+  uint16_t* frame;
+  uint16_t f;
+  uint8_t c, i, j;
+  uint16_t value;
+
+  if (stage->primed == false)
+  {
+    filter_prime(stage, samples);
+  }
+
+  for (f = 0; f < frames; f++)
+  {
+    frame = &samples[f * stage->channels];
+
+    for (c = 0; c < stage->channels; c++)
+    {
+      stage->history[stage->index][c] = frame[c];
+
+      /* Insertion sort of the window, the median is its middle element */
+      for (i = 0; i < stage->length; i++)
+      {
+        value = stage->history[i][c];
+
+        for (j = i; (j > 0) && (window[j - 1] > value); j--)
+        {
+          window[j] = window[j - 1];
+        }
+
+        window[j] = value;
+      }
+
+      frame[c] = window[stage->length / 2];
+    }
+
+    stage->index = (stage->index + 1) % stage->length;
+  }
+
+  return frames;
+}
+
+static uint16_t filter_median_packed(filter_stage_t* stage, uint16_t* samples, uint16_t frames)
+{
+  uint32_t p[5];
+  uint32_t low;
+  uint16_t f;
+  uint8_t i;
+
+  if (stage->primed == false)
+  {
+    filter_prime(stage, samples);
+  }
+
+  for (f = 0; f < frames; f++)
+  {
+    filter_store(stage->history[stage->index], filter_load(&samples[f * FILTER_PACKED_CHANNELS]));
+
+    for (i = 0; i < stage->length; i++)
+    {
+      p[i] = filter_load(stage->history[i]);
+    }
+
+    /* Sorting networks, both lanes at once (median ends up in p[1] / p[2]) */
+#define FILTER_SORT(a, b)   { low = filter_min16(p[a], p[b]); p[b] = filter_max16(p[a], p[b]); p[a] = low; }
+    if (stage->length == 3)
+    {
+      FILTER_SORT(0, 1); FILTER_SORT(1, 2); FILTER_SORT(0, 1);
+    }
+    else
+    {
+      FILTER_SORT(0, 1); FILTER_SORT(3, 4); FILTER_SORT(0, 3);
+      FILTER_SORT(1, 4); FILTER_SORT(1, 2); FILTER_SORT(2, 3);
+      FILTER_SORT(1, 2);
+    }
+#undef FILTER_SORT
+
+    filter_store(&samples[f * FILTER_PACKED_CHANNELS], p[stage->length / 2]);
+
+    stage->index = (stage->index + 1) % stage->length;
+  }
+
+  return frames;
+}
+
+/*
+ * The IIR is evaluated as shift successive halving adds, t = (t + y) / 2
+ * starting from t = x, which is y + (x - y) / 2^shift rounded down at every
+ * step. This maps to one UHADD16 per step on the packed path.
+ */
+static uint16_t filter_iir(filter_stage_t* stage, uint16_t* samples, uint16_t frames)
+{
+  uint16_t* frame;
+  uint16_t f;
+  uint8_t c, i;
+  uint16_t t;
+
+  if (stage->primed == false)
+  {
+    for (c = 0; c < stage->channels; c++)
+    {
+      stage->state[c] = (uint16_t)(samples[c] << FILTER_IIR_FRACTION_BITS);
+    }
+
+    stage->primed = true;
+  }
+
+  for (f = 0; f < frames; f++)
+  {
+    frame = &samples[f * stage->channels];
+
+    for (c = 0; c < stage->channels; c++)
+    {
+      t = (uint16_t)(frame[c] << FILTER_IIR_FRACTION_BITS);
+
+      for (i = 0; i < stage->shift; i++)
+      {
+        t = (uint16_t)(((uint32_t)t + stage->state[c]) >> 1);
+      }
+
+      stage->state[c] = t;
+      frame[c] = t >> FILTER_IIR_FRACTION_BITS;
+    }
+  }
+
+  return frames;
+}
+
+static uint16_t filter_iir_packed(filter_stage_t* stage, uint16_t* samples, uint16_t frames)
+{
+  const uint32_t scale_mask = ~FILTER_LANE_MASK(16 - FILTER_IIR_FRACTION_BITS);
+  const uint32_t output_mask = FILTER_LANE_MASK(FILTER_IIR_FRACTION_BITS);
+  uint32_t state, t;
+  uint16_t f;
+  uint8_t i;
+
+  if (stage->primed == false)
+  {
+    stage->state[0] = (uint16_t)(samples[0] << FILTER_IIR_FRACTION_BITS);
+    stage->state[1] = (uint16_t)(samples[1] << FILTER_IIR_FRACTION_BITS);
+    stage->primed = true;
+  }
+
+  state = (uint32_t)stage->state[0] | ((uint32_t)stage->state[1] << 16);
+
+  for (f = 0; f < frames; f++)
+  {
+    /* Scale both lanes, dropping bits that would spill into the next lane */
+    t = (filter_load(&samples[f * FILTER_PACKED_CHANNELS]) << FILTER_IIR_FRACTION_BITS) & scale_mask;
+
+    for (i = 0; i < stage->shift; i++)
+    {
+      t = filter_halving_add16(t, state);
+    }
+
+    state = t;
+    filter_store(&samples[f * FILTER_PACKED_CHANNELS], (state >> FILTER_IIR_FRACTION_BITS) & output_mask);
+  }
+
+  stage->state[0] = (uint16_t)state;
+  stage->state[1] = (uint16_t)(state >> 16);
+
+  return frames;
+}
+
+static uint16_t filter_dead_zone(filter_stage_t* stage, uint16_t* samples, uint16_t frames)
+{
+  uint16_t* frame;
+  uint16_t distance;
+  uint16_t f;
+  uint8_t c;
+
+  for (f = 0; f < frames; f++)
+  {
+    frame = &samples[f * stage->channels];
+
+    for (c = 0; c < stage->channels; c++)
+    {
+      distance = (frame[c] > stage->center) ? (frame[c] - stage->center) : (stage->center - frame[c]);
+
+      /* state holds whether the channel is currently outside the dead zone */
+      if (stage->state[c] != 0)
+      {
+        if (distance < (stage->width - stage->hysteresis))
+        {
+          stage->state[c] = 0;
+        }
+      }
+      else if (distance >= stage->width)
+      {
+        stage->state[c] = 1;
+      }
+
+      if (stage->state[c] == 0)
+      {
+        frame[c] = stage->center;
+      }
+    }
+  }
+
+  return frames;
+}
+
+static uint16_t filter_decimate(filter_stage_t* stage, uint16_t* samples, uint16_t frames)
+{
+  uint16_t kept = 0;
+  uint16_t f;
+
+  for (f = 0; f < frames; f++)
+  {
+    if (stage->index == 0)
+    {
+      if (kept != f)
+      {
+        memmove(&samples[kept * stage->channels], &samples[f * stage->channels], stage->channels * sizeof(uint16_t));
+      }
+
+      kept++;
+    }
+
+    stage->index = (stage->index + 1) % stage->length;
+  }
+
+  return kept;
+}
+
+/*--------------------------------interrupts----------------------------------*/
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef FILTER_H_
+#define FILTER_H_
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*---------------------------------defines------------------------------------*/
+
+/*
+ * Fixed-point filters working in place on blocks of interleaved uint16_t
+ * samples (frame = one sample per channel). Inputs are expected to be ADC14
+ * results, i.e. at most FILTER_SAMPLE_BITS wide: the spare bits are used as
+ * headroom and fraction bits by the packed (dual 16-bit SIMD) code paths.
+ */
+
+#define FILTER_SAMPLE_BITS          ( 14 )
+#define FILTER_CHANNELS_MAX         ( 3 )
+#define FILTER_WINDOW_MAX           ( 16 )
+#define FILTER_PIPELINE_STAGES_MAX  ( 6 )
+
+enum
+{
+  FILTER_MOVING_AVERAGE = 0,
+  FILTER_MEDIAN,
+  FILTER_IIR,
+  FILTER_DEAD_ZONE,
+  FILTER_DECIMATE
+};
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  uint8_t type;
+  uint8_t channels;
+  uint8_t length;
+  uint8_t shift;
+  uint8_t index;
+  bool primed;
+  uint16_t center;
+  uint16_t width;
+  uint16_t hysteresis;
+  uint16_t history[FILTER_WINDOW_MAX][FILTER_CHANNELS_MAX];
+  uint32_t sum[FILTER_CHANNELS_MAX];
+  uint16_t state[FILTER_CHANNELS_MAX];
+} filter_stage_t;
+
+typedef struct
+{
+  filter_stage_t* stages[FILTER_PIPELINE_STAGES_MAX];
+  uint8_t length;
+} filter_pipeline_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+bool filter_moving_average_init(filter_stage_t* stage, uint8_t channels, uint8_t length);
+bool filter_median_init(filter_stage_t* stage, uint8_t channels, uint8_t length);
+bool filter_iir_init(filter_stage_t* stage, uint8_t channels, uint8_t shift);
+bool filter_dead_zone_init(filter_stage_t* stage, uint8_t channels, uint16_t center, uint16_t width, uint16_t hysteresis);
+bool filter_decimate_init(filter_stage_t* stage, uint8_t channels, uint8_t factor);
+void filter_reset(filter_stage_t* stage);
+
+uint16_t filter_process(filter_stage_t* stage, uint16_t* samples, uint16_t frames);
+uint16_t filter_process_reference(filter_stage_t* stage, uint16_t* samples, uint16_t frames);
+
+void filter_pipeline_init(filter_pipeline_t* pipeline);
+bool filter_pipeline_add(filter_pipeline_t* pipeline, filter_stage_t* stage);
+uint16_t filter_pipeline_process(filter_pipeline_t* pipeline, uint16_t* samples, uint16_t frames);
+
+/*--------------------------------variables-----------------------------------*/
+/*----------------------------------public------------------------------------*/
+/*---------------------------------private------------------------------------*/
+/*--------------------------------interrupts----------------------------------*/
+
+#endif /* FILTER_H_ */
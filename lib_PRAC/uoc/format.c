@@ -0,0 +1,373 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <string.h>
+
+#include "format.h"
+
+/*---------------------------------defines------------------------------------*/
+
+#define FORMAT_UINT_MAX_DIGITS      ( 10 )
+#define FORMAT_HEX_MAX_DIGITS       ( 8 )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  char* str;
+  uint16_t size;
+  uint16_t length;
+} format_output_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+static void format_put(format_output_t* output, char c);
+static void format_put_field(format_output_t* output, const char* text, uint16_t length, uint8_t width, bool left, bool zero);
+
+/*--------------------------------variables-----------------------------------*/
+
+// "00" to "99", so integers are converted two digits per division
+static const char format_digit_pairs[201] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+static const uint32_t format_powers_of_ten[FORMAT_FIXED_MAX_DECIMALS + 1] =
+{
+  1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+/*----------------------------------public------------------------------------*/
+
+// Writes value in decimal followed by '\0' and returns its length
+uint8_t format_uint(char* str, uint32_t value)
+{
+  char buffer[FORMAT_UINT_MAX_DIGITS];
+  char* digits = buffer + FORMAT_UINT_MAX_DIGITS;
+  const char* pair;
+  uint8_t length;
+
+  /* Fill the buffer from the end, two digits at a time */
+  while (value >= 100)
+  {
+    pair = &format_digit_pairs[(value % 100) * 2];
+    value /= 100;
+    *--digits = pair[1];
+    *--digits = pair[0];
+  }
+
+  if (value >= 10)
+  {
+    pair = &format_digit_pairs[value * 2];
+    *--digits = pair[1];
+    *--digits = pair[0];
+  }
+  else
+  {
+    *--digits = '0' + value;
+  }
+
+  length = buffer + FORMAT_UINT_MAX_DIGITS - digits;
+  memcpy(str, digits, length);
+  str[length] = '\0';
+
+  return length;
+}
+
+uint8_t format_int(char* str, int32_t value)
+{
+  if (value < 0)
+  {
+    /* Negate as unsigned so INT32_MIN works too */
+    str[0] = '-';
+    return format_uint(str + 1, 0u - (uint32_t)value) + 1;
+  }
+
+  return format_uint(str, value);
+}
+
+uint8_t format_hex(char* str, uint32_t value, bool upper)
+{
+  const char* hex = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+  char buffer[FORMAT_HEX_MAX_DIGITS];
+  char* digits = buffer + FORMAT_HEX_MAX_DIGITS;
+  uint8_t length;
+
+  do
+  {
+    *--digits = hex[value & 0x0F];
+    value >>= 4;
+  } while (value != 0);
+
+  length = buffer + FORMAT_HEX_MAX_DIGITS - digits;
+  memcpy(str, digits, length);
+  str[length] = '\0';
+
+  return length;
+}
+
+// Writes a fixed point number that holds value / 10^decimals, e.g. 2345 with
+// 2 decimals is "23.45" and -5 with 2 decimals is "-0.05"
+uint8_t format_fixed(char* str, int32_t value, uint8_t decimals)
+{
+  uint32_t magnitude;
+  uint32_t scale;
+  uint8_t length = 0;
+  uint8_t fraction;
+
+  if (decimals > FORMAT_FIXED_MAX_DECIMALS)
+  {
+    decimals = FORMAT_FIXED_MAX_DECIMALS;
+  }
+
+  magnitude = (value < 0) ? (0u - (uint32_t)value) : (uint32_t)value;
+  scale = format_powers_of_ten[decimals];
+
+  if (value < 0)
+  {
+    str[length++] = '-';
+  }
+
+  length += format_uint(str + length, magnitude / scale);
+
+  if (decimals > 0)
+  {
+    str[length++] = '.';
+
+    /* Leading zeros of the fractional part */
+    fraction = format_uint(str + length, magnitude % scale);
+    length += format_pad(str + length, fraction, decimals, '0');
+  }
+
+  return length;
+}
+
+// Right-aligns the length characters of str in a field of width characters.
+// With '0' padding a leading sign stays in front of the zeros
+uint8_t format_pad(char* str, uint8_t length, uint8_t width, char pad)
+{
+  uint8_t fill;
+  uint8_t start = 0;
+
+  if (length >= width)
+  {
+    return length;
+  }
+
+  fill = width - length;
+
+  if ((pad == '0') && ((str[0] == '-') || (str[0] == '+')))
+  {
+    start = 1;
+  }
+
+  memmove(str + start + fill, str + start, length - start + 1);
+  memset(str + start, pad, fill);
+
+  return width;
+}
+
+/*
+ * snprintf subset: %d %i %u %x %X %c %s %%, the '-' and '0' flags, a field
+ * width and an ignored 'l' length modifier (int and long are both 32 bits).
+ * The output is always terminated and the return value is the length it
+ * would have had without truncation.
+ */
+int format_snprintf(char* str, uint16_t size, const char* format, ...)
+{
+  va_list args;
+  int length;
+
+  va_start(args, format);
+  length = format_vsnprintf(str, size, format, args);
+  va_end(args);
+
+  return length;
+}
+
+int format_vsnprintf(char* str, uint16_t size, const char* format, va_list args)
+{
+  format_output_t output = {str, size, 0};
+  char buffer[FORMAT_INT_MAX_SIZE];
+  const char* text;
+  uint16_t length;
+  uint8_t width;
+  bool left;
+  bool zero;
+  char c;
+
+  while ((c = *format++) != '\0')
+  {
+    if (c != '%')
+    {
+      format_put(&output, c);
+      continue;
+    }
+
+    /* Flags */
+    left = false;
+    zero = false;
+    for (;; format++)
+    {
+      if (*format == '-')
+      {
+        left = true;
+      }
+      else if (*format == '0')
+      {
+        zero = true;
+      }
+      else
+      {
+        break;
+      }
+    }
+
+    /* Width */
+    width = 0;
+    while ((*format >= '0') && (*format <= '9'))
+    {
+      width = width * 10 + (*format++ - '0');
+    }
+
+    if (*format == 'l')
+    {
+      format++;
+    }
+
+    text = buffer;
+
+    switch (c = *format++)
+    {
+      case 'd':
+      case 'i':
+        length = format_int(buffer, va_arg(args, int32_t));
+        break;
+      case 'u':
+        length = format_uint(buffer, va_arg(args, uint32_t));
+        break;
+      case 'x':
+      case 'X':
+        length = format_hex(buffer, va_arg(args, uint32_t), (c == 'X'));
+        break;
+      case 'c':
+        buffer[0] = (char)va_arg(args, int);
+        length = 1;
+        zero = false;
+        break;
+      case 's':
+        text = va_arg(args, const char*);
+        length = strlen(text);
+        zero = false;
+        break;
+      case '%':
+        buffer[0] = '%';
+        length = 1;
+        width = 0;
+        break;
+      default:
+        /* Unknown conversion or end of string, stop here */
+        format = (c == '\0') ? (format - 1) : format;
+        length = 0;
+        width = 0;
+        break;
+    }
+
+    format_put_field(&output, text, length, width, left, zero && !left);
+  }
+
+  if (output.size > 0)
+  {
+    output.str[(output.length < output.size) ? output.length : (output.size - 1)] = '\0';
+  }
+
+  return output.length;
+}
+
+/*---------------------------------private------------------------------------*/
+
+static void format_put(format_output_t* output, char c)
+{
+  /* Keep room for the terminator, but count everything */
+  if ((output->length + 1) < output->size)
+  {
+    output->str[output->length] = c;
+  }
+
+  output->length++;
+}
+
+static void format_put_field(format_output_t* output, const char* text, uint16_t length, uint8_t width, bool left, bool zero)
+{
+  uint16_t fill = (length < width) ? (width - length) : 0;
+
+  if (left == false)
+  {
+    /* Zero padding goes after the sign */
+    if (zero && (length > 0) && (text[0] == '-'))
+    {
+      format_put(output, *text++);
+      length--;
+    }
+
+    while (fill-- > 0)
+    {
+      format_put(output, zero ? '0' : ' ');
+    }
+  }
+
+  while (length-- > 0)
+  {
+    format_put(output, *text++);
+  }
+
+  if (left == true)
+  {
+    while (fill-- > 0)
+    {
+      format_put(output, ' ');
+    }
+  }
+}
+
+/*--------------------------------interrupts----------------------------------*/
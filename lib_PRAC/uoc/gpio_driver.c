@@ -0,0 +1,278 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stddef.h>
+
+#include "driverlib.h"
+
+#include "gpio_driver.h"
+#include "interrupts.h"
+#include "kernel_trace.h"
+
+/*---------------------------------defines------------------------------------*/
+
+// Index of the highest bit set in a non zero mask
+#define GPIO_DRIVER_BIT_INDEX(mask) ( 31 - __CLZ(mask) )
+
+/*---------------------------------typedefs-----------------------------------*/
+/*--------------------------------prototypes----------------------------------*/
+
+static void gpio_driver_dispatch(uint8_t port);
+
+/*--------------------------------variables-----------------------------------*/
+
+static const uint8_t gpio_irqs[GPIO_DRIVER_PORTS] =
+{
+  INT_PORT1, INT_PORT2, INT_PORT3, INT_PORT4, INT_PORT5, INT_PORT6
+};
+
+static gpio_driver_callback_t gpio_callbacks[GPIO_DRIVER_PORTS][GPIO_DRIVER_PINS];
+
+// Pins whose callback runs from gpio_driver_process() instead of the interrupt
+static uint8_t gpio_deferred[GPIO_DRIVER_PORTS];
+static volatile uint8_t gpio_pending[GPIO_DRIVER_PORTS];
+static callback_t gpio_deferred_notify = NULL;
+
+static bool gpio_initialized = false;
+
+/*----------------------------------public------------------------------------*/
+
+void gpio_driver_init(void)
+{
+  uint8_t i;
+
+  /* Several drivers register pins, initialize it only once */
+  if (gpio_initialized == true)
+  {
+    return;
+  }
+
+  for (i = 0; i < GPIO_DRIVER_PORTS; i++)
+  {
+    MAP_Interrupt_setPriority(gpio_irqs[i], GPIO_DRIVER_IRQ_PRIO);
+  }
+
+  gpio_initialized = true;
+}
+
+/*
+ * Calls callback on the given edge of one pin of P1 to P6. The pin direction
+ * and resistors are left to the caller. A deferred callback is not called
+ * from the interrupt: the pin is marked pending, the notify callback is
+ * called and gpio_driver_process() runs it later, typically from a task.
+ */
+bool gpio_driver_register(uint8_t port, uint16_t pin, uint8_t edge, gpio_driver_callback_t callback, bool deferred)
+{
+  uint32_t irq_status;
+  uint8_t index;
+  uint8_t bit;
+
+  if ((port < GPIO_PORT_P1) || (port > GPIO_PORT_P6) ||
+      (pin == 0) || (pin > GPIO_PIN7) || ((pin & (pin - 1)) != 0) ||
+      (callback == NULL))
+  {
+    return false;
+  }
+
+  index = port - GPIO_PORT_P1;
+  bit = GPIO_DRIVER_BIT_INDEX(pin);
+
+  MAP_GPIO_disableInterrupt(port, pin);
+
+  irq_status = interrupts_disable();
+
+  gpio_callbacks[index][bit] = callback;
+  if (deferred == true)
+  {
+    gpio_deferred[index] |= pin;
+  }
+  else
+  {
+    gpio_deferred[index] &= ~pin;
+  }
+  gpio_pending[index] &= ~pin;
+
+  interrupts_restore(irq_status);
+
+  MAP_GPIO_interruptEdgeSelect(port, pin, edge);
+  MAP_GPIO_clearInterruptFlag(port, pin);
+  MAP_GPIO_enableInterrupt(port, pin);
+  MAP_Interrupt_enableInterrupt(gpio_irqs[index]);
+
+  return true;
+}
+
+void gpio_driver_unregister(uint8_t port, uint16_t pin)
+{
+  uint32_t irq_status;
+  uint8_t index;
+
+  if ((port < GPIO_PORT_P1) || (port > GPIO_PORT_P6) || (pin == 0) || (pin > GPIO_PIN7))
+  {
+    return;
+  }
+
+  index = port - GPIO_PORT_P1;
+
+  MAP_GPIO_disableInterrupt(port, pin);
+
+  irq_status = interrupts_disable();
+
+  gpio_callbacks[index][GPIO_DRIVER_BIT_INDEX(pin)] = NULL;
+  gpio_deferred[index] &= ~pin;
+  gpio_pending[index] &= ~pin;
+
+  interrupts_restore(irq_status);
+}
+
+// Called from the interrupt when deferred callbacks are pending
+void gpio_driver_set_deferred_notify(callback_t notify)
+{
+  gpio_deferred_notify = notify;
+}
+
+// Runs the pending deferred callbacks, at most one per pin and edge burst
+void gpio_driver_process(void)
+{
+  gpio_driver_callback_t callback;
+  uint32_t irq_status;
+  uint32_t pending;
+  uint8_t index;
+  uint8_t bit;
+
+  for (index = 0; index < GPIO_DRIVER_PORTS; index++)
+  {
+    irq_status = interrupts_disable();
+    pending = gpio_pending[index];
+    gpio_pending[index] = 0;
+    interrupts_restore(irq_status);
+
+    while (pending != 0)
+    {
+      bit = GPIO_DRIVER_BIT_INDEX(pending);
+      pending &= ~(1u << bit);
+
+      callback = gpio_callbacks[index][bit];
+      if (callback != NULL)
+      {
+        callback(index + GPIO_PORT_P1, 1u << bit);
+      }
+    }
+  }
+}
+
+/*---------------------------------private------------------------------------*/
+
+// Costs one table lookup per pending pin, whatever the number of registered pins
+static void gpio_driver_dispatch(uint8_t port)
+{
+  gpio_driver_callback_t callback;
+  uint32_t status;
+  uint32_t deferred;
+  uint8_t index = port - GPIO_PORT_P1;
+  uint8_t bit;
+
+  status = MAP_GPIO_getEnabledInterruptStatus(port);
+  MAP_GPIO_clearInterruptFlag(port, status);
+
+  deferred = status & gpio_deferred[index];
+  if (deferred != 0)
+  {
+    gpio_pending[index] |= deferred;
+    status &= ~deferred;
+
+    if (gpio_deferred_notify != NULL)
+    {
+      gpio_deferred_notify();
+    }
+  }
+
+  while (status != 0)
+  {
+    bit = GPIO_DRIVER_BIT_INDEX(status);
+    status &= ~(1u << bit);
+
+    callback = gpio_callbacks[index][bit];
+    if (callback != NULL)
+    {
+      callback(port, 1u << bit);
+    }
+  }
+}
+
+/*--------------------------------interrupts----------------------------------*/
+
+void PORT1_IRQHandler(void)
+{
+  KERNEL_TRACE_ISR_ENTER(INT_PORT1);
+  gpio_driver_dispatch(GPIO_PORT_P1);
+  KERNEL_TRACE_ISR_EXIT(INT_PORT1);
+}
+
+void PORT2_IRQHandler(void)
+{
+  KERNEL_TRACE_ISR_ENTER(INT_PORT2);
+  gpio_driver_dispatch(GPIO_PORT_P2);
+  KERNEL_TRACE_ISR_EXIT(INT_PORT2);
+}
+
+void PORT3_IRQHandler(void)
+{
+  KERNEL_TRACE_ISR_ENTER(INT_PORT3);
+  gpio_driver_dispatch(GPIO_PORT_P3);
+  KERNEL_TRACE_ISR_EXIT(INT_PORT3);
+}
+
+void PORT4_IRQHandler(void)
+{
+  KERNEL_TRACE_ISR_ENTER(INT_PORT4);
+  gpio_driver_dispatch(GPIO_PORT_P4);
+  KERNEL_TRACE_ISR_EXIT(INT_PORT4);
+}
+
+void PORT5_IRQHandler(void)
+{
+  KERNEL_TRACE_ISR_ENTER(INT_PORT5);
+  gpio_driver_dispatch(GPIO_PORT_P5);
+  KERNEL_TRACE_ISR_EXIT(INT_PORT5);
+}
+
+void PORT6_IRQHandler(void)
+{
+  KERNEL_TRACE_ISR_ENTER(INT_PORT6);
+  gpio_driver_dispatch(GPIO_PORT_P6);
+  KERNEL_TRACE_ISR_EXIT(INT_PORT6);
+}
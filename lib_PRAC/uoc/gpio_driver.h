@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef GPIO_DRIVER_H_
+#define GPIO_DRIVER_H_
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "callback.h"
+
+/*---------------------------------defines------------------------------------*/
+
+/* P1 to P6 have pin interrupts */
+#define GPIO_DRIVER_PORTS           ( 6 )
+#define GPIO_DRIVER_PINS            ( 8 )
+
+#define GPIO_DRIVER_IRQ_PRIO        ( 0xFF )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+/* Receives the GPIO_PORT_Px and GPIO_PINx that raised the interrupt */
+typedef void (*gpio_driver_callback_t)(uint8_t port, uint16_t pin);
+
+/*--------------------------------prototypes----------------------------------*/
+
+void gpio_driver_init(void);
+bool gpio_driver_register(uint8_t port, uint16_t pin, uint8_t edge, gpio_driver_callback_t callback, bool deferred);
+void gpio_driver_unregister(uint8_t port, uint16_t pin);
+void gpio_driver_set_deferred_notify(callback_t notify);
+void gpio_driver_process(void);
+
+/*--------------------------------variables-----------------------------------*/
+/*----------------------------------public------------------------------------*/
+/*---------------------------------private------------------------------------*/
+/*--------------------------------interrupts----------------------------------*/
+
+#endif /* GPIO_DRIVER_H_ */
@@ -34,11 +34,10 @@
 
 /*--------------------------------includes------------------------------------*/
 
-#include <math.h>
-
 #include "driverlib.h"
 
 #include "helper.h"
+#include "format.h"
 
 /*---------------------------------defines------------------------------------*/
 /*---------------------------------typedefs-----------------------------------*/
@@ -59,43 +58,65 @@ void reverse_string(char *str, int len)
   }
 }
 
+// Writes x with at least d digits, padded with zeros after the sign
 int int_to_string(int x, char str[], int d)
 {
-  int i = 0;
+  uint8_t length;
 
-  while (x)
-  {
-    str[i++] = (x%10) + '0';
-    x = x/10;
-  }
+  length = format_int(str, x);
 
-  while (i < d)
+  if (x < 0)
   {
-    str[i++] = '0';
+    d++;
   }
 
-  reverse_string(str, i);
-
-  str[i] = '\0';
-
-  return i;
+  return format_pad(str, length, d, '0');
 }
 
+// Writes n with afterpoint decimals (up to FORMAT_FIXED_MAX_DECIMALS), both
+// parts truncated. The integer part and the fraction are converted apart, so
+// no libm is needed and nothing overflows: magnitudes from 2^32 and NaN are
+// written as 4294967295
 void ftoa(float n, char *res, int afterpoint)
 {
-  int ipart = (int)n;
+  float magnitude = (n < 0.0f) ? -n : n;
+  float scale = 1.0f;
+  uint32_t ipart = UINT32_MAX;
+  uint32_t fpart = 0;
+  uint8_t length = 0;
+  uint8_t digits;
+  int i;
+
+  if (afterpoint > FORMAT_FIXED_MAX_DECIMALS)
+  {
+    afterpoint = FORMAT_FIXED_MAX_DECIMALS;
+  }
 
-  float fpart = n - (float)ipart;
+  for (i = 0; i < afterpoint; i++)
+  {
+    scale *= 10.0f;
+  }
 
-  int i = int_to_string(ipart, res, 0);
+  if (magnitude < 4294967296.0f)
+  {
+    ipart = (uint32_t)magnitude;
 
-  if (afterpoint != 0)
+    /* Below one, so below 10^9 once scaled */
+    fpart = (uint32_t)((magnitude - (float)ipart) * scale);
+  }
+
+  if ((n < 0.0f) && ((ipart != 0) || (fpart != 0)))
   {
-    res[i] = '.';
+    res[length++] = '-';
+  }
 
-    fpart = fpart * pow(10, afterpoint);
+  length += format_uint(res + length, ipart);
 
-    int_to_string((int)fpart, res + i + 1, afterpoint);
+  if (afterpoint > 0)
+  {
+    res[length++] = '.';
+    digits = format_uint(res + length, fpart);
+    format_pad(res + length, digits, afterpoint, '0');
   }
 }
 
@@ -0,0 +1,644 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#if defined(__MSP432P401R__) && !defined(HOST_SIMULATION)
+#include "driverlib.h"
+#else
+#include <time.h>
+#endif
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+#include "kernel_bench.h"
+#include "format.h"
+#include "mem_pool.h"
+
+/*---------------------------------defines------------------------------------*/
+
+// The target times with the DWT cycle counter, the host with CLOCK_MONOTONIC
+#if defined(__MSP432P401R__) && !defined(HOST_SIMULATION)
+#define KERNEL_BENCH_DWT
+#define KERNEL_BENCH_UNIT           "cycles"
+#else
+#define KERNEL_BENCH_UNIT           "ns"
+#define KERNEL_BENCH_NS_PER_S       ( 1000000000 )
+#endif
+
+// Unused by the application, raised from software by kernel_bench_raise()
+#define KERNEL_BENCH_INTERRUPT      ( INT_AES256 )
+
+#define KERNEL_BENCH_RUNS           ( KERNEL_BENCH_WARMUP + KERNEL_BENCH_ITERATIONS )
+
+// The runner and the yield peer share a priority, the server preempts them
+#define KERNEL_BENCH_PRIORITY       ( configMAX_PRIORITIES - 2 )
+#define KERNEL_BENCH_SERVER_PRIORITY ( configMAX_PRIORITIES - 1 )
+#define KERNEL_BENCH_STACK_SIZE     ( 2 * configMINIMAL_STACK_SIZE )
+
+#define KERNEL_BENCH_SIZES          ( sizeof(kernel_bench_sizes) / sizeof(kernel_bench_sizes[0]) )
+#define KERNEL_BENCH_ITEM_MAX_SIZE  ( 256 )
+
+#define KERNEL_BENCH_POOL_BLOCKS    ( 4 )
+#define KERNEL_BENCH_BLOCK_SIZE     ( 32 )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef enum
+{
+  KERNEL_BENCH_SERVE_QUEUE = 0,
+  KERNEL_BENCH_SERVE_NOTIFY,
+  KERNEL_BENCH_SERVE_ISR,
+  KERNEL_BENCH_SERVE_POOL
+} kernel_bench_serve_t;
+
+typedef struct
+{
+  uint32_t warmup;
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t sum;
+} kernel_bench_stats_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+static bool kernel_bench_init(void);
+static void kernel_bench_clock_init(void);
+static uint32_t kernel_bench_now(void);
+static uint32_t kernel_bench_elapsed(uint32_t start);
+static void kernel_bench_raise(void);
+
+static void kernel_bench_begin(void);
+static void kernel_bench_record(uint32_t value);
+static void kernel_bench_report(const char* name, uint16_t size);
+static void kernel_bench_serve(kernel_bench_serve_t serve, uint8_t index);
+
+static void kernel_bench_clock_overhead(void);
+static void kernel_bench_context_switch(void);
+static void kernel_bench_queue(uint8_t index);
+static void kernel_bench_queue_round_trip(uint8_t index);
+static void kernel_bench_semaphore(void);
+static void kernel_bench_mutex(void);
+static void kernel_bench_notify_round_trip(void);
+static void kernel_bench_isr_wake(void);
+static void kernel_bench_pool_alloc_free(void);
+static void kernel_bench_heap_alloc_free(void);
+static void kernel_bench_pool_wake(void);
+
+static void kernel_bench_peer_task(void* parameters);
+static void kernel_bench_server_task(void* parameters);
+
+void AES256_IRQHandler(void);
+
+/*--------------------------------variables-----------------------------------*/
+
+static const uint16_t kernel_bench_sizes[] = { 4, 16, 64, KERNEL_BENCH_ITEM_MAX_SIZE };
+
+static bool kernel_bench_ready = false;
+static kernel_bench_print_t kernel_bench_print;
+static char kernel_bench_line[KERNEL_BENCH_LINE_SIZE];
+
+static TaskHandle_t kernel_bench_runner = NULL;
+static TaskHandle_t kernel_bench_peer = NULL;
+static TaskHandle_t kernel_bench_server = NULL;
+
+// One request and one reply queue of a single item per size
+static QueueHandle_t kernel_bench_requests[KERNEL_BENCH_SIZES];
+static QueueHandle_t kernel_bench_replies[KERNEL_BENCH_SIZES];
+static SemaphoreHandle_t kernel_bench_semaphore_handle = NULL;
+static SemaphoreHandle_t kernel_bench_mutex_handle = NULL;
+
+static uint8_t kernel_bench_item[KERNEL_BENCH_ITEM_MAX_SIZE];
+static uint8_t kernel_bench_echo[KERNEL_BENCH_ITEM_MAX_SIZE];
+
+// What the server answers and the queue size it uses
+static volatile kernel_bench_serve_t kernel_bench_serving;
+static volatile uint8_t kernel_bench_index;
+
+static volatile bool kernel_bench_yielding = false;
+
+// Set by the runner right before it raises the interrupt
+static volatile uint32_t kernel_bench_stamp;
+
+// Cost of reading the clock, subtracted from every sample
+static uint32_t kernel_bench_overhead = 0;
+
+static kernel_bench_stats_t kernel_bench_stats;
+
+MEM_POOL_DEFINE(kernel_bench_blocks, KERNEL_BENCH_POOL_BLOCKS, KERNEL_BENCH_BLOCK_SIZE);
+
+// Block the server got from the pool, handed back to the runner
+static void* volatile kernel_bench_taken;
+
+/*----------------------------------public------------------------------------*/
+
+bool kernel_bench_run(kernel_bench_print_t print)
+{
+  UBaseType_t priority;
+  uint8_t i;
+
+  if (kernel_bench_init() == false)
+  {
+    return false;
+  }
+
+  kernel_bench_print = print;
+  kernel_bench_runner = xTaskGetCurrentTaskHandle();
+
+  priority = uxTaskPriorityGet(NULL);
+  vTaskPrioritySet(NULL, KERNEL_BENCH_PRIORITY);
+
+  // Drops a notification left from elsewhere
+  ulTaskNotifyTake(pdTRUE, 0);
+
+  format_snprintf(kernel_bench_line, sizeof(kernel_bench_line),
+                  "{\"type\":\"config\",\"unit\":\"%s\",\"clock_hz\":%u,\"tick_hz\":%u,\"priorities\":%u,"
+                  "\"port_optimised_task_selection\":%u,\"preemption\":%u,\"time_slicing\":%u,\"iterations\":%u}",
+                  KERNEL_BENCH_UNIT,
+#if defined(KERNEL_BENCH_DWT)
+                  MAP_CS_getMCLK(),
+#else
+                  (uint32_t) KERNEL_BENCH_NS_PER_S,
+#endif
+                  (uint32_t) configTICK_RATE_HZ, (uint32_t) configMAX_PRIORITIES,
+                  (uint32_t) configUSE_PORT_OPTIMISED_TASK_SELECTION, (uint32_t) configUSE_PREEMPTION,
+                  (uint32_t) configUSE_TIME_SLICING, (uint32_t) KERNEL_BENCH_ITERATIONS);
+  kernel_bench_print(kernel_bench_line);
+
+  kernel_bench_clock_overhead();
+  kernel_bench_context_switch();
+
+  for (i = 0; i < KERNEL_BENCH_SIZES; i++)
+  {
+    kernel_bench_queue(i);
+  }
+  for (i = 0; i < KERNEL_BENCH_SIZES; i++)
+  {
+    kernel_bench_queue_round_trip(i);
+  }
+
+  kernel_bench_semaphore();
+  kernel_bench_mutex();
+  kernel_bench_notify_round_trip();
+  kernel_bench_isr_wake();
+  kernel_bench_pool_alloc_free();
+  kernel_bench_heap_alloc_free();
+  kernel_bench_pool_wake();
+
+  vTaskPrioritySet(NULL, priority);
+
+  return true;
+}
+
+/*---------------------------------private------------------------------------*/
+
+static bool kernel_bench_init(void)
+{
+  uint8_t i;
+
+  if (kernel_bench_ready == true)
+  {
+    return true;
+  }
+
+  for (i = 0; i < KERNEL_BENCH_SIZES; i++)
+  {
+    kernel_bench_requests[i] = xQueueCreate(1, kernel_bench_sizes[i]);
+    kernel_bench_replies[i] = xQueueCreate(1, kernel_bench_sizes[i]);
+    if ((kernel_bench_requests[i] == NULL) || (kernel_bench_replies[i] == NULL))
+    {
+      return false;
+    }
+  }
+
+  kernel_bench_semaphore_handle = xSemaphoreCreateBinary();
+  kernel_bench_mutex_handle = xSemaphoreCreateMutex();
+  if ((kernel_bench_semaphore_handle == NULL) || (kernel_bench_mutex_handle == NULL) ||
+      (mem_pool_init(&kernel_bench_blocks) == false))
+  {
+    return false;
+  }
+
+  if ((xTaskCreate(kernel_bench_peer_task, "BenchPeer", KERNEL_BENCH_STACK_SIZE, NULL,
+                   KERNEL_BENCH_PRIORITY, &kernel_bench_peer) != pdPASS) ||
+      (xTaskCreate(kernel_bench_server_task, "BenchServer", KERNEL_BENCH_STACK_SIZE, NULL,
+                   KERNEL_BENCH_SERVER_PRIORITY, &kernel_bench_server) != pdPASS))
+  {
+    return false;
+  }
+
+  kernel_bench_clock_init();
+
+  kernel_bench_ready = true;
+
+  return true;
+}
+
+static void kernel_bench_clock_init(void)
+{
+#if defined(KERNEL_BENCH_DWT)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  MAP_Interrupt_setPriority(KERNEL_BENCH_INTERRUPT, configMAX_SYSCALL_INTERRUPT_PRIORITY);
+  MAP_Interrupt_enableInterrupt(KERNEL_BENCH_INTERRUPT);
+#endif
+}
+
+// Wraps around, so only differences of close readings are meaningful
+static uint32_t kernel_bench_now(void)
+{
+#if defined(KERNEL_BENCH_DWT)
+  return DWT->CYCCNT;
+#else
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (uint32_t)now.tv_sec * KERNEL_BENCH_NS_PER_S + (uint32_t)now.tv_nsec;
+#endif
+}
+
+static uint32_t kernel_bench_elapsed(uint32_t start)
+{
+  uint32_t elapsed = kernel_bench_now() - start;
+
+  return (elapsed > kernel_bench_overhead) ? (elapsed - kernel_bench_overhead) : 0;
+}
+
+static void kernel_bench_raise(void)
+{
+#if defined(KERNEL_BENCH_DWT)
+  MAP_Interrupt_pendInterrupt(KERNEL_BENCH_INTERRUPT);
+#else
+  xPortRunInterrupt(AES256_IRQHandler);
+#endif
+}
+
+static void kernel_bench_begin(void)
+{
+  kernel_bench_stats.warmup = KERNEL_BENCH_WARMUP;
+  kernel_bench_stats.count = 0;
+  kernel_bench_stats.min = UINT32_MAX;
+  kernel_bench_stats.max = 0;
+  kernel_bench_stats.sum = 0;
+}
+
+// The first KERNEL_BENCH_WARMUP samples only fill the caches and pipelines
+static void kernel_bench_record(uint32_t value)
+{
+  if (kernel_bench_stats.warmup != 0)
+  {
+    kernel_bench_stats.warmup--;
+    return;
+  }
+
+  kernel_bench_stats.count++;
+  kernel_bench_stats.sum += value;
+  if (value < kernel_bench_stats.min)
+  {
+    kernel_bench_stats.min = value;
+  }
+  if (value > kernel_bench_stats.max)
+  {
+    kernel_bench_stats.max = value;
+  }
+}
+
+static void kernel_bench_report(const char* name, uint16_t size)
+{
+  uint32_t average = 0;
+
+  if (kernel_bench_stats.count == 0)
+  {
+    kernel_bench_stats.min = 0;
+  }
+  else
+  {
+    average = (uint32_t)(kernel_bench_stats.sum / kernel_bench_stats.count);
+  }
+
+  format_snprintf(kernel_bench_line, sizeof(kernel_bench_line),
+                  "{\"type\":\"result\",\"name\":\"%s\",\"size\":%u,\"samples\":%u,\"min\":%u,\"avg\":%u,\"max\":%u}",
+                  name, (uint32_t) size, kernel_bench_stats.count,
+                  kernel_bench_stats.min, average, kernel_bench_stats.max);
+  kernel_bench_print(kernel_bench_line);
+}
+
+// The server preempts the runner at once and blocks on its first request
+static void kernel_bench_serve(kernel_bench_serve_t serve, uint8_t index)
+{
+  kernel_bench_serving = serve;
+  kernel_bench_index = index;
+  xTaskNotifyGive(kernel_bench_server);
+}
+
+/*--------------------------------benchmarks----------------------------------*/
+
+static void kernel_bench_clock_overhead(void)
+{
+  uint32_t start;
+  uint32_t i;
+
+  kernel_bench_overhead = 0;
+
+  kernel_bench_begin();
+  for (i = 0; i < KERNEL_BENCH_RUNS; i++)
+  {
+    start = kernel_bench_now();
+    kernel_bench_record(kernel_bench_now() - start);
+  }
+  kernel_bench_report("clock_overhead", 0);
+
+  kernel_bench_overhead = kernel_bench_stats.min;
+}
+
+// Half of a yield to the peer and its yield back
+static void kernel_bench_context_switch(void)
+{
+  uint32_t start;
+  uint32_t i;
+
+  kernel_bench_begin();
+  kernel_bench_yielding = true;
+  xTaskNotifyGive(kernel_bench_peer);
+
+  for (i = 0; i < KERNEL_BENCH_RUNS; i++)
+  {
+    start = kernel_bench_now();
+    taskYIELD();
+    kernel_bench_record(kernel_bench_elapsed(start) / 2);
+  }
+
+  kernel_bench_yielding = false;
+  taskYIELD();
+
+  kernel_bench_report("context_switch", 0);
+}
+
+// Send and receive on one queue, without blocking or switching
+static void kernel_bench_queue(uint8_t index)
+{
+  uint32_t start;
+  uint32_t i;
+
+  kernel_bench_begin();
+  for (i = 0; i < KERNEL_BENCH_RUNS; i++)
+  {
+    start = kernel_bench_now();
+    xQueueSend(kernel_bench_requests[index], kernel_bench_item, 0);
+    xQueueReceive(kernel_bench_requests[index], kernel_bench_item, 0);
+    kernel_bench_record(kernel_bench_elapsed(start));
+  }
+  kernel_bench_report("queue_send_receive", kernel_bench_sizes[index]);
+}
+
+static void kernel_bench_queue_round_trip(uint8_t index)
+{
+  uint32_t start;
+  uint32_t i;
+
+  kernel_bench_begin();
+  kernel_bench_serve(KERNEL_BENCH_SERVE_QUEUE, index);
+
+  for (i = 0; i < KERNEL_BENCH_RUNS; i++)
+  {
+    start = kernel_bench_now();
+    xQueueSend(kernel_bench_requests[index], kernel_bench_item, portMAX_DELAY);
+    xQueueReceive(kernel_bench_replies[index], kernel_bench_item, portMAX_DELAY);
+    kernel_bench_record(kernel_bench_elapsed(start));
+  }
+  kernel_bench_report("queue_round_trip", kernel_bench_sizes[index]);
+}
+
+static void kernel_bench_semaphore(void)
+{
+  uint32_t start;
+  uint32_t i;
+
+  kernel_bench_begin();
+  for (i = 0; i < KERNEL_BENCH_RUNS; i++)
+  {
+    start = kernel_bench_now();
+    xSemaphoreGive(kernel_bench_semaphore_handle);
+    xSemaphoreTake(kernel_bench_semaphore_handle, 0);
+    kernel_bench_record(kernel_bench_elapsed(start));
+  }
+  kernel_bench_report("semaphore_give_take", 0);
+}
+
+static void kernel_bench_mutex(void)
+{
+  uint32_t start;
+  uint32_t i;
+
+  kernel_bench_begin();
+  for (i = 0; i < KERNEL_BENCH_RUNS; i++)
+  {
+    start = kernel_bench_now();
+    xSemaphoreTake(kernel_bench_mutex_handle, 0);
+    xSemaphoreGive(kernel_bench_mutex_handle);
+    kernel_bench_record(kernel_bench_elapsed(start));
+  }
+  kernel_bench_report("mutex_take_give", 0);
+}
+
+static void kernel_bench_notify_round_trip(void)
+{
+  uint32_t start;
+  uint32_t i;
+
+  kernel_bench_begin();
+  kernel_bench_serve(KERNEL_BENCH_SERVE_NOTIFY, 0);
+
+  for (i = 0; i < KERNEL_BENCH_RUNS; i++)
+  {
+    start = kernel_bench_now();
+    xTaskNotifyGive(kernel_bench_server);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    kernel_bench_record(kernel_bench_elapsed(start));
+  }
+  kernel_bench_report("notify_round_trip", 0);
+}
+
+// The server records the samples, the runner only runs once it blocks again
+static void kernel_bench_isr_wake(void)
+{
+  uint32_t i;
+
+  kernel_bench_begin();
+  kernel_bench_serve(KERNEL_BENCH_SERVE_ISR, 0);
+
+  for (i = 0; i < KERNEL_BENCH_RUNS; i++)
+  {
+    kernel_bench_stamp = kernel_bench_now();
+    kernel_bench_raise();
+  }
+  kernel_bench_report("isr_wake", 0);
+}
+
+static void kernel_bench_pool_alloc_free(void)
+{
+  uint32_t start;
+  uint32_t i;
+
+  kernel_bench_begin();
+  for (i = 0; i < KERNEL_BENCH_RUNS; i++)
+  {
+    start = kernel_bench_now();
+    mem_pool_free(&kernel_bench_blocks, mem_pool_alloc(&kernel_bench_blocks, 0));
+    kernel_bench_record(kernel_bench_elapsed(start));
+  }
+  kernel_bench_report("pool_alloc_free", KERNEL_BENCH_BLOCK_SIZE);
+}
+
+// heap_1 cannot free, there is nothing to compare with
+static void kernel_bench_heap_alloc_free(void)
+{
+#if (configUSE_HEAP_TLSF == 1)
+  uint32_t start;
+  uint32_t i;
+
+  kernel_bench_begin();
+  for (i = 0; i < KERNEL_BENCH_RUNS; i++)
+  {
+    start = kernel_bench_now();
+    vPortFree(pvPortMalloc(KERNEL_BENCH_BLOCK_SIZE));
+    kernel_bench_record(kernel_bench_elapsed(start));
+  }
+  kernel_bench_report("heap_alloc_free", KERNEL_BENCH_BLOCK_SIZE);
+#endif
+}
+
+/*
+ * The runner holds every block and the server waits for one. Each free wakes
+ * the server, which records the time and hands the block back before it
+ * waits again.
+ */
+static void kernel_bench_pool_wake(void)
+{
+  void* blocks[KERNEL_BENCH_POOL_BLOCKS];
+  uint32_t i;
+
+  for (i = 0; i < KERNEL_BENCH_POOL_BLOCKS; i++)
+  {
+    blocks[i] = mem_pool_alloc(&kernel_bench_blocks, 0);
+  }
+
+  kernel_bench_begin();
+  kernel_bench_serve(KERNEL_BENCH_SERVE_POOL, 0);
+
+  for (i = 0; i < KERNEL_BENCH_RUNS; i++)
+  {
+    kernel_bench_stamp = kernel_bench_now();
+    mem_pool_free(&kernel_bench_blocks, blocks[0]);
+    blocks[0] = kernel_bench_taken;
+  }
+  kernel_bench_report("pool_wake", KERNEL_BENCH_BLOCK_SIZE);
+
+  for (i = 0; i < KERNEL_BENCH_POOL_BLOCKS; i++)
+  {
+    mem_pool_free(&kernel_bench_blocks, blocks[i]);
+  }
+}
+
+/*----------------------------------tasks-------------------------------------*/
+
+static void kernel_bench_peer_task(void* parameters)
+{
+  (void) parameters;
+
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    while (kernel_bench_yielding == true)
+    {
+      taskYIELD();
+    }
+  }
+}
+
+// Answers KERNEL_BENCH_RUNS requests each time kernel_bench_serve() wakes it
+static void kernel_bench_server_task(void* parameters)
+{
+  uint32_t i;
+
+  (void) parameters;
+
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    for (i = 0; i < KERNEL_BENCH_RUNS; i++)
+    {
+      switch (kernel_bench_serving)
+      {
+        case KERNEL_BENCH_SERVE_QUEUE:
+          xQueueReceive(kernel_bench_requests[kernel_bench_index], kernel_bench_echo, portMAX_DELAY);
+          xQueueSend(kernel_bench_replies[kernel_bench_index], kernel_bench_echo, portMAX_DELAY);
+          break;
+        case KERNEL_BENCH_SERVE_NOTIFY:
+          ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+          xTaskNotifyGive(kernel_bench_runner);
+          break;
+        case KERNEL_BENCH_SERVE_ISR:
+          ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+          kernel_bench_record(kernel_bench_elapsed(kernel_bench_stamp));
+          break;
+        case KERNEL_BENCH_SERVE_POOL:
+          kernel_bench_taken = mem_pool_alloc(&kernel_bench_blocks, portMAX_DELAY);
+          kernel_bench_record(kernel_bench_elapsed(kernel_bench_stamp));
+          break;
+        default:
+          break;
+      }
+    }
+  }
+}
+
+/*--------------------------------interrupts----------------------------------*/
+
+void AES256_IRQHandler(void)
+{
+  BaseType_t woken = pdFALSE;
+
+  vTaskNotifyGiveFromISR(kernel_bench_server, &woken);
+  portYIELD_FROM_ISR(woken);
+}
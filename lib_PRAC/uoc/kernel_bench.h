@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef KERNEL_BENCH_H_
+#define KERNEL_BENCH_H_
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*---------------------------------defines------------------------------------*/
+
+/*
+ * Microbenchmarks of the kernel primitives, one JSON object per line:
+ *
+ *   {"type":"config","unit":"cycles","clock_hz":48000000,"tick_hz":100,...}
+ *   {"type":"result","name":"queue_round_trip","size":16,"samples":1000,
+ *    "min":...,"avg":...,"max":...}
+ *
+ * Times are DWT cycles on the target and nanoseconds on the host, with the
+ * cost of reading the clock already subtracted. context_switch is half of a
+ * taskYIELD() ping-pong, the round trips wake a higher priority task and
+ * wait for its answer, and isr_wake runs from an interrupt being raised to
+ * the task it notifies running. pool_alloc_free and heap_alloc_free take a
+ * block of size bytes and give it back (see mem_pool.h), and pool_wake runs
+ * from a block of an empty pool being freed to the task waiting for it
+ * getting it.
+ */
+
+#define KERNEL_BENCH_ITERATIONS     ( 1000 )
+#define KERNEL_BENCH_WARMUP         ( 16 )
+#define KERNEL_BENCH_LINE_SIZE      ( 192 )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+/* Same signature as uart_print(), called once per line without the newline */
+typedef uint8_t (*kernel_bench_print_t)(char* line);
+
+/*--------------------------------prototypes----------------------------------*/
+
+/*
+ * Runs every benchmark from the calling task, which is raised above the
+ * application tasks meanwhile. The helper tasks and queues are created on the
+ * first run and kept, so runs can repeat with heap_1. Returns false if they
+ * cannot be created.
+ */
+bool kernel_bench_run(kernel_bench_print_t print);
+
+/*--------------------------------variables-----------------------------------*/
+/*----------------------------------public------------------------------------*/
+/*---------------------------------private------------------------------------*/
+/*--------------------------------interrupts----------------------------------*/
+
+#endif /* KERNEL_BENCH_H_ */
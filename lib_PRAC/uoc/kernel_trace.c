@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <string.h>
+
+#include "driverlib.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "kernel_trace.h"
+#include "interrupts.h"
+
+#if defined(HOST_SIMULATION)
+#include "timer_driver.h"
+#endif
+
+/*---------------------------------defines------------------------------------*/
+
+#define KERNEL_TRACE_MASK           ( KERNEL_TRACE_RECORDS - 1 )
+
+// The simulation has no cycle counter, its Timer32 counts the same cycles
+#if defined(HOST_SIMULATION)
+#define KERNEL_TRACE_NOW()          ( (uint32_t) timer_now_ticks() )
+#else
+#define KERNEL_TRACE_NOW()          ( DWT->CYCCNT )
+#endif
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  uint32_t timestamp;
+  uint8_t event;
+  uint8_t task;
+  uint16_t object;
+} kernel_trace_record_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+static void kernel_trace_put(uint8_t* payload, uint16_t offset, uint32_t value, uint8_t size);
+
+/*--------------------------------variables-----------------------------------*/
+
+static kernel_trace_record_t kernel_trace_buffer[KERNEL_TRACE_RECORDS];
+
+// Records written since kernel_trace_start(), the next goes at its low bits
+static uint32_t kernel_trace_recorded = 0;
+static volatile bool kernel_trace_running = false;
+
+// Number of the task running, followed even while stopped
+static uint8_t kernel_trace_task = 0;
+
+// queueQUEUE_TYPE_xxx of each queue by number, from 1
+static uint8_t kernel_trace_queue_types[KERNEL_TRACE_MAX_QUEUES];
+static uint8_t kernel_trace_queues = 0;
+
+static TaskStatus_t kernel_trace_status[KERNEL_TRACE_MAX_TASKS];
+
+/*----------------------------------public------------------------------------*/
+
+// Starts the cycle counter and the recording, call it before the scheduler
+void kernel_trace_init(void)
+{
+#if !defined(HOST_SIMULATION)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+  kernel_trace_start();
+}
+
+// Records from an empty buffer
+void kernel_trace_start(void)
+{
+  uint32_t irq_status;
+
+  irq_status = interrupts_disable();
+  kernel_trace_recorded = 0;
+  kernel_trace_running = true;
+  interrupts_restore(irq_status);
+}
+
+// Freezes the buffer so that it can be encoded
+void kernel_trace_stop(void)
+{
+  kernel_trace_running = false;
+}
+
+// Task names and queue types, to be sent before the records. Returns the
+// length or 0 if it does not fit
+uint16_t kernel_trace_encode_info(uint8_t* payload, uint16_t size)
+{
+  UBaseType_t count;
+  UBaseType_t i;
+  uint8_t queues;
+  uint16_t length;
+
+  count = uxTaskGetSystemState(kernel_trace_status, KERNEL_TRACE_MAX_TASKS, NULL);
+  queues = (kernel_trace_queues < KERNEL_TRACE_MAX_QUEUES) ? kernel_trace_queues : KERNEL_TRACE_MAX_QUEUES;
+
+  length = KERNEL_TRACE_INFO_HEADER_SIZE + count * KERNEL_TRACE_INFO_TASK_SIZE + queues;
+  if (length > size)
+  {
+    return 0;
+  }
+
+  payload[0] = KERNEL_TRACE_PAYLOAD_INFO;
+  kernel_trace_put(payload, 1, MAP_CS_getMCLK(), 4);
+  kernel_trace_put(payload, 5, kernel_trace_recorded, 4);
+  kernel_trace_put(payload, 9, KERNEL_TRACE_RECORDS, 2);
+  payload[11] = count;
+  payload[12] = queues;
+  payload += KERNEL_TRACE_INFO_HEADER_SIZE;
+
+  for (i = 0; i < count; i++)
+  {
+    payload[0] = kernel_trace_status[i].xTaskNumber;
+    strncpy((char*)&payload[1], kernel_trace_status[i].pcTaskName, KERNEL_TRACE_NAME_SIZE);
+    payload += KERNEL_TRACE_INFO_TASK_SIZE;
+  }
+
+  memcpy(payload, kernel_trace_queue_types, queues);
+
+  return length;
+}
+
+// Records from index *next on (0 is the oldest kept) that fit in size, and
+// advances *next past them. Returns the length, 0 once all were encoded
+uint16_t kernel_trace_encode_records(uint16_t* next, uint8_t* payload, uint16_t size)
+{
+  const kernel_trace_record_t* record;
+  uint32_t kept;
+  uint32_t first;
+  uint16_t count;
+  uint16_t offset;
+  uint16_t i;
+
+  kept = (kernel_trace_recorded < KERNEL_TRACE_RECORDS) ? kernel_trace_recorded : KERNEL_TRACE_RECORDS;
+  first = kernel_trace_recorded - kept;
+
+  if ((*next >= kept) || (size < KERNEL_TRACE_RECORDS_HEADER_SIZE + KERNEL_TRACE_RECORD_SIZE))
+  {
+    return 0;
+  }
+
+  count = (size - KERNEL_TRACE_RECORDS_HEADER_SIZE) / KERNEL_TRACE_RECORD_SIZE;
+  if (count > kept - *next)
+  {
+    count = kept - *next;
+  }
+
+  payload[0] = KERNEL_TRACE_PAYLOAD_RECORDS;
+  kernel_trace_put(payload, 1, *next, 2);
+  offset = KERNEL_TRACE_RECORDS_HEADER_SIZE;
+
+  for (i = 0; i < count; i++)
+  {
+    record = &kernel_trace_buffer[(first + *next + i) & KERNEL_TRACE_MASK];
+    kernel_trace_put(payload, offset, record->timestamp, 4);
+    payload[offset + 4] = record->event;
+    payload[offset + 5] = record->task;
+    kernel_trace_put(payload, offset + 6, record->object, 2);
+    offset += KERNEL_TRACE_RECORD_SIZE;
+  }
+
+  *next += count;
+
+  return offset;
+}
+
+// Called by the hooks from tasks and interrupts, a few dozen cycles
+void kernel_trace_record(uint8_t event, uint16_t object)
+{
+  kernel_trace_record_t* record;
+  uint32_t irq_status;
+
+  irq_status = interrupts_disable();
+
+  if (event == KERNEL_TRACE_SWITCHED_IN)
+  {
+    kernel_trace_task = object;
+  }
+
+  if (kernel_trace_running == true)
+  {
+    record = &kernel_trace_buffer[kernel_trace_recorded & KERNEL_TRACE_MASK];
+    kernel_trace_recorded++;
+
+    record->timestamp = KERNEL_TRACE_NOW();
+    record->event = event;
+    record->task = kernel_trace_task;
+    record->object = object;
+  }
+
+  interrupts_restore(irq_status);
+}
+
+// traceQUEUE_CREATE(), numbers the queues from 1 in creation order
+uint8_t kernel_trace_queue_created(uint8_t type)
+{
+  if (kernel_trace_queues < KERNEL_TRACE_MAX_QUEUES)
+  {
+    kernel_trace_queue_types[kernel_trace_queues] = type;
+  }
+
+  return ++kernel_trace_queues;
+}
+
+/*---------------------------------private------------------------------------*/
+
+// Little endian
+static void kernel_trace_put(uint8_t* payload, uint16_t offset, uint32_t value, uint8_t size)
+{
+  uint8_t i;
+
+  for (i = 0; i < size; i++)
+  {
+    payload[offset + i] = (uint8_t)(value >> (8 * i));
+  }
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef KERNEL_TRACE_H_
+#define KERNEL_TRACE_H_
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOSConfig.h"
+
+/*---------------------------------defines------------------------------------*/
+
+/* Records kept in RAM, the oldest are overwritten (a power of two) */
+#define KERNEL_TRACE_RECORDS        ( 512 )
+#define KERNEL_TRACE_RECORD_SIZE    ( 8 )
+
+#define KERNEL_TRACE_MAX_TASKS      ( 12 )
+#define KERNEL_TRACE_MAX_QUEUES     ( 32 )
+#define KERNEL_TRACE_NAME_SIZE      ( 8 )
+
+/*
+ * Events and the object of their record. Records also hold the number of the
+ * task running, which the interrupt handlers interrupted.
+ */
+enum
+{
+  KERNEL_TRACE_NONE = 0,
+  KERNEL_TRACE_SWITCHED_IN,               // task switched in
+  KERNEL_TRACE_READY,                     // task made ready
+  KERNEL_TRACE_DELAY,                     // -, blocks in vTaskDelay(Until)
+  KERNEL_TRACE_QUEUE_SEND,                // queue number
+  KERNEL_TRACE_QUEUE_SEND_FAILED,
+  KERNEL_TRACE_QUEUE_SEND_BLOCK,
+  KERNEL_TRACE_QUEUE_RECEIVE,
+  KERNEL_TRACE_QUEUE_RECEIVE_FAILED,
+  KERNEL_TRACE_QUEUE_RECEIVE_BLOCK,
+  KERNEL_TRACE_QUEUE_SEND_FROM_ISR,
+  KERNEL_TRACE_QUEUE_RECEIVE_FROM_ISR,
+  KERNEL_TRACE_NOTIFY,                    // task notified
+  KERNEL_TRACE_NOTIFY_FROM_ISR,
+  KERNEL_TRACE_NOTIFY_WAIT_BLOCK,         // -, ulTaskNotifyTake() or xTaskNotifyWait()
+  KERNEL_TRACE_NOTIFY_WAIT,
+  KERNEL_TRACE_ISR_ENTER,                 // interrupt number (INT_xxx)
+  KERNEL_TRACE_ISR_EXIT,
+  KERNEL_TRACE_EVENTS
+};
+
+/*
+ * Payloads of the dump, each starting with its kind (all fields little
+ * endian). The info comes first:
+ *
+ *   | kind (1) | clock_hz (4) | recorded (4) | records (2) | tasks (1) | queues (1) |
+ *
+ * followed by tasks times | number (1) | name (8) | and queues times the
+ * queueQUEUE_TYPE_xxx of queue 1, 2... Then the records, oldest first:
+ *
+ *   | kind (1) | index (2) | count times | timestamp (4) | event (1) | task (1) | object (2) |
+ *
+ * Timestamps are MCLK cycles (DWT CYCCNT) and wrap every 107 s at 40 MHz.
+ */
+#define KERNEL_TRACE_PAYLOAD_INFO       ( 0 )
+#define KERNEL_TRACE_PAYLOAD_RECORDS    ( 1 )
+
+#define KERNEL_TRACE_INFO_HEADER_SIZE   ( 13 )
+#define KERNEL_TRACE_INFO_TASK_SIZE     ( 1 + KERNEL_TRACE_NAME_SIZE )
+#define KERNEL_TRACE_RECORDS_HEADER_SIZE ( 3 )
+
+/*
+ * Hooks of the kernel and the interrupt handlers, empty without the trace.
+ * The UART handler, entered once per byte sent, is left out so that printing
+ * does not flood the buffer, and so is the tick.
+ */
+#if (configUSE_KERNEL_TRACE == 1)
+
+#define KERNEL_TRACE_ISR_ENTER(irq)         kernel_trace_record(KERNEL_TRACE_ISR_ENTER, (irq))
+#define KERNEL_TRACE_ISR_EXIT(irq)          kernel_trace_record(KERNEL_TRACE_ISR_EXIT, (irq))
+
+/* Expanded in tasks.c and queue.c, where the TCB and queue fields are visible */
+#define kernel_trace_switched_in(number)          kernel_trace_record(KERNEL_TRACE_SWITCHED_IN, (number))
+
+#define traceMOVED_TASK_TO_READY_STATE(pxTCB)     kernel_trace_record(KERNEL_TRACE_READY, (pxTCB)->uxTCBNumber)
+#define traceTASK_DELAY()                         kernel_trace_record(KERNEL_TRACE_DELAY, 0)
+#define traceTASK_DELAY_UNTIL(xTimeToWake)        kernel_trace_record(KERNEL_TRACE_DELAY, 0)
+#define traceTASK_NOTIFY()                        kernel_trace_record(KERNEL_TRACE_NOTIFY, pxTCB->uxTCBNumber)
+#define traceTASK_NOTIFY_FROM_ISR()               kernel_trace_record(KERNEL_TRACE_NOTIFY_FROM_ISR, pxTCB->uxTCBNumber)
+#define traceTASK_NOTIFY_GIVE_FROM_ISR()          kernel_trace_record(KERNEL_TRACE_NOTIFY_FROM_ISR, pxTCB->uxTCBNumber)
+#define traceTASK_NOTIFY_TAKE_BLOCK()             kernel_trace_record(KERNEL_TRACE_NOTIFY_WAIT_BLOCK, 0)
+#define traceTASK_NOTIFY_WAIT_BLOCK()             kernel_trace_record(KERNEL_TRACE_NOTIFY_WAIT_BLOCK, 0)
+#define traceTASK_NOTIFY_TAKE()                   kernel_trace_record(KERNEL_TRACE_NOTIFY_WAIT, 0)
+#define traceTASK_NOTIFY_WAIT()                   kernel_trace_record(KERNEL_TRACE_NOTIFY_WAIT, 0)
+
+#define traceQUEUE_CREATE(pxNewQueue)             ( pxNewQueue )->uxQueueNumber = kernel_trace_queue_created(( pxNewQueue )->ucQueueType)
+#define traceQUEUE_SEND(pxQueue)                  kernel_trace_record(KERNEL_TRACE_QUEUE_SEND, (pxQueue)->uxQueueNumber)
+#define traceQUEUE_SEND_FAILED(pxQueue)           kernel_trace_record(KERNEL_TRACE_QUEUE_SEND_FAILED, (pxQueue)->uxQueueNumber)
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue)      kernel_trace_record(KERNEL_TRACE_QUEUE_SEND_BLOCK, (pxQueue)->uxQueueNumber)
+#define traceQUEUE_RECEIVE(pxQueue)               kernel_trace_record(KERNEL_TRACE_QUEUE_RECEIVE, (pxQueue)->uxQueueNumber)
+#define traceQUEUE_RECEIVE_FAILED(pxQueue)        kernel_trace_record(KERNEL_TRACE_QUEUE_RECEIVE_FAILED, (pxQueue)->uxQueueNumber)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue)   kernel_trace_record(KERNEL_TRACE_QUEUE_RECEIVE_BLOCK, (pxQueue)->uxQueueNumber)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)         kernel_trace_record(KERNEL_TRACE_QUEUE_SEND_FROM_ISR, (pxQueue)->uxQueueNumber)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)      kernel_trace_record(KERNEL_TRACE_QUEUE_RECEIVE_FROM_ISR, (pxQueue)->uxQueueNumber)
+
+#else
+
+#define KERNEL_TRACE_ISR_ENTER(irq)
+#define KERNEL_TRACE_ISR_EXIT(irq)
+
+#define kernel_trace_switched_in(number)
+
+#endif
+
+/*---------------------------------typedefs-----------------------------------*/
+/*--------------------------------prototypes----------------------------------*/
+
+void kernel_trace_init(void);
+void kernel_trace_start(void);
+void kernel_trace_stop(void);
+
+uint16_t kernel_trace_encode_info(uint8_t* payload, uint16_t size);
+uint16_t kernel_trace_encode_records(uint16_t* next, uint8_t* payload, uint16_t size);
+
+void kernel_trace_record(uint8_t event, uint16_t object);
+uint8_t kernel_trace_queue_created(uint8_t type);
+
+/*--------------------------------variables-----------------------------------*/
+/*----------------------------------public------------------------------------*/
+/*---------------------------------private------------------------------------*/
+/*--------------------------------interrupts----------------------------------*/
+
+#endif /* KERNEL_TRACE_H_ */
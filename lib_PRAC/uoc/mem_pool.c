@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include "mem_pool.h"
+
+/*---------------------------------defines------------------------------------*/
+/*---------------------------------typedefs-----------------------------------*/
+/*--------------------------------prototypes----------------------------------*/
+
+static void* mem_pool_pop(mem_pool_t* pool, void* owner);
+static bool mem_pool_push(mem_pool_t* pool, void* block);
+static int32_t mem_pool_index(const mem_pool_t* pool, const void* block);
+
+/*--------------------------------variables-----------------------------------*/
+/*----------------------------------public------------------------------------*/
+
+bool mem_pool_init(mem_pool_t* pool)
+{
+  uint16_t i;
+
+  pool->free_list = NULL;
+  for (i = pool->count; i > 0; i--)
+  {
+    *(void**)&pool->storage[(i - 1) * pool->size] = pool->free_list;
+    pool->free_list = &pool->storage[(i - 1) * pool->size];
+    pool->owners[i - 1] = NULL;
+  }
+
+  pool->used = 0;
+  pool->max_used = 0;
+  pool->failures = 0;
+  pool->errors = 0;
+
+  // Created once and only refilled after, a task may still wait on it in mem_pool_alloc()
+  if (pool->available == NULL)
+  {
+    pool->available = xSemaphoreCreateCounting(pool->count, pool->count);
+  }
+  else
+  {
+    while (xSemaphoreTake(pool->available, 0) == pdPASS)
+    {
+    }
+    for (i = 0; i < pool->count; i++)
+    {
+      xSemaphoreGive(pool->available);
+    }
+  }
+
+  return (pool->available != NULL);
+}
+
+void* mem_pool_alloc(mem_pool_t* pool, TickType_t timeout)
+{
+  void* block = NULL;
+
+  if (xSemaphoreTake(pool->available, timeout) == pdPASS)
+  {
+    taskENTER_CRITICAL();
+    block = mem_pool_pop(pool, xTaskGetCurrentTaskHandle());
+    taskEXIT_CRITICAL();
+  }
+  else
+  {
+    taskENTER_CRITICAL();
+    pool->failures++;
+    taskEXIT_CRITICAL();
+  }
+
+  return block;
+}
+
+bool mem_pool_free(mem_pool_t* pool, void* block)
+{
+  bool freed;
+
+  taskENTER_CRITICAL();
+  freed = mem_pool_push(pool, block);
+  taskEXIT_CRITICAL();
+
+  if (freed == true)
+  {
+    xSemaphoreGive(pool->available);
+  }
+
+  return freed;
+}
+
+void* mem_pool_alloc_from_isr(mem_pool_t* pool)
+{
+  UBaseType_t mask;
+  void* block = NULL;
+
+  // Counting semaphores have no task waiting to give, no switch is needed
+  if (xSemaphoreTakeFromISR(pool->available, NULL) == pdPASS)
+  {
+    mask = taskENTER_CRITICAL_FROM_ISR();
+    block = mem_pool_pop(pool, MEM_POOL_OWNER_ISR);
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+  }
+  else
+  {
+    mask = taskENTER_CRITICAL_FROM_ISR();
+    pool->failures++;
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+  }
+
+  return block;
+}
+
+bool mem_pool_free_from_isr(mem_pool_t* pool, void* block, BaseType_t* woken)
+{
+  UBaseType_t mask;
+  bool freed;
+
+  mask = taskENTER_CRITICAL_FROM_ISR();
+  freed = mem_pool_push(pool, block);
+  taskEXIT_CRITICAL_FROM_ISR(mask);
+
+  if (freed == true)
+  {
+    xSemaphoreGiveFromISR(pool->available, woken);
+  }
+
+  return freed;
+}
+
+void* mem_pool_owner(const mem_pool_t* pool, const void* block)
+{
+  int32_t index = mem_pool_index(pool, block);
+
+  return (index < 0) ? NULL : pool->owners[index];
+}
+
+uint16_t mem_pool_owned(const mem_pool_t* pool, const void* owner)
+{
+  uint16_t owned = 0;
+  uint16_t i;
+
+  for (i = 0; i < pool->count; i++)
+  {
+    if ((pool->owners[i] != NULL) && ((owner == NULL) || (pool->owners[i] == owner)))
+    {
+      owned++;
+    }
+  }
+
+  return owned;
+}
+
+void mem_pool_get_stats(const mem_pool_t* pool, mem_pool_stats_t* stats)
+{
+  taskENTER_CRITICAL();
+  stats->size = pool->size;
+  stats->count = pool->count;
+  stats->used = pool->used;
+  stats->max_used = pool->max_used;
+  stats->failures = pool->failures;
+  stats->errors = pool->errors;
+  taskEXIT_CRITICAL();
+}
+
+/*---------------------------------private------------------------------------*/
+
+// The semaphore was taken, so the list holds a block
+static void* mem_pool_pop(mem_pool_t* pool, void* owner)
+{
+  void* block = pool->free_list;
+
+  configASSERT(block != NULL);
+
+  pool->free_list = *(void**)block;
+  pool->owners[mem_pool_index(pool, block)] = owner;
+
+  pool->used++;
+  if (pool->used > pool->max_used)
+  {
+    pool->max_used = pool->used;
+  }
+
+  return block;
+}
+
+static bool mem_pool_push(mem_pool_t* pool, void* block)
+{
+  int32_t index = mem_pool_index(pool, block);
+
+  if ((index < 0) || (pool->owners[index] == NULL))
+  {
+    pool->errors++;
+    return false;
+  }
+
+  pool->owners[index] = NULL;
+  *(void**)block = pool->free_list;
+  pool->free_list = block;
+  pool->used--;
+
+  return true;
+}
+
+// Index of the block starting at block, -1 for any other address
+static int32_t mem_pool_index(const mem_pool_t* pool, const void* block)
+{
+  const uint8_t* address = block;
+  uint32_t offset;
+
+  if ((address < pool->storage) || (address >= pool->storage + (uint32_t) pool->count * pool->size))
+  {
+    return -1;
+  }
+
+  offset = (uint32_t)(address - pool->storage);
+
+  return ((offset % pool->size) == 0) ? (int32_t)(offset / pool->size) : -1;
+}
+
+/*--------------------------------interrupts----------------------------------*/
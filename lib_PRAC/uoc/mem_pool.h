@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MEM_POOL_H_
+#define MEM_POOL_H_
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/*---------------------------------defines------------------------------------*/
+
+/* Blocks are rounded up to hold any type */
+#define MEM_POOL_ALIGNMENT          ( 8 )
+#define MEM_POOL_WORDS(size)        ( ((size) + MEM_POOL_ALIGNMENT - 1) / MEM_POOL_ALIGNMENT )
+
+/* Owner of the blocks taken by the _from_isr() functions */
+#define MEM_POOL_OWNER_ISR          ( (void*) 1 )
+
+/*
+ * Defines pool, a mem_pool_t of count blocks of size bytes, with its storage
+ * in static RAM, ready after mem_pool_init(). Other files declare it with
+ * extern mem_pool_t pool.
+ */
+#define MEM_POOL_DEFINE(pool, count, size)                                  \
+  static uint64_t pool##_storage[(count) * MEM_POOL_WORDS(size)];           \
+  static void* pool##_owners[(count)];                                      \
+  mem_pool_t pool = { (uint8_t*) pool##_storage, pool##_owners,             \
+                      MEM_POOL_WORDS(size) * MEM_POOL_ALIGNMENT, (count) }
+
+/*---------------------------------typedefs-----------------------------------*/
+
+/*
+ * Blocks not in use are linked through their first bytes, and the semaphore
+ * counts them, so that a task can wait for one. Only the list is changed with
+ * the interrupts masked, allocations and frees take a constant time.
+ */
+typedef struct
+{
+  uint8_t* storage;
+  void** owners;            // task that took each block, NULL while free
+  uint16_t size;
+  uint16_t count;
+  void* free_list;
+  uint16_t used;
+  uint16_t max_used;        // watermark since mem_pool_init()
+  uint32_t failures;        // allocations that found no block
+  uint32_t errors;          // frees of blocks not from the pool or not in use
+  SemaphoreHandle_t available;
+} mem_pool_t;
+
+typedef struct
+{
+  uint16_t size;
+  uint16_t count;
+  uint16_t used;
+  uint16_t max_used;
+  uint32_t failures;
+  uint32_t errors;
+} mem_pool_stats_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+/* Frees every block. Returns false if the semaphore cannot be created */
+bool mem_pool_init(mem_pool_t* pool);
+
+/*
+ * Takes a block, waiting up to timeout ticks for one to be freed (0 does not
+ * wait). Returns NULL if none was. Not from interrupts.
+ */
+void* mem_pool_alloc(mem_pool_t* pool, TickType_t timeout);
+
+/* Returns the block to the pool, false if it is not a block in use */
+bool mem_pool_free(mem_pool_t* pool, void* block);
+
+/*
+ * The same from the interrupt handlers, whose priority must not be above
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY. woken is set to pdTRUE when a task
+ * waiting for a block has to run, see portYIELD_FROM_ISR().
+ */
+void* mem_pool_alloc_from_isr(mem_pool_t* pool);
+bool mem_pool_free_from_isr(mem_pool_t* pool, void* block, BaseType_t* woken);
+
+/*
+ * Debugging: the task that took a block (MEM_POOL_OWNER_ISR if an interrupt
+ * did), NULL if it is free, and the blocks a task holds, NULL for all.
+ */
+void* mem_pool_owner(const mem_pool_t* pool, const void* block);
+uint16_t mem_pool_owned(const mem_pool_t* pool, const void* owner);
+
+void mem_pool_get_stats(const mem_pool_t* pool, mem_pool_stats_t* stats);
+
+/*--------------------------------variables-----------------------------------*/
+/*----------------------------------public------------------------------------*/
+/*---------------------------------private------------------------------------*/
+/*--------------------------------interrupts----------------------------------*/
+
+#endif /* MEM_POOL_H_ */
@@ -38,6 +38,9 @@
 
 #include "driverlib.h"
 
+#include "gpio_driver.h"
+#include "timer_driver.h"
+
 /*---------------------------------defines------------------------------------*/
 
 #define LED_RED_PORT            ( GPIO_PORT_P1 )
@@ -62,13 +65,11 @@
 #define BUTTON_S1_PIN           ( GPIO_PIN1 )
 #define BUTTON_S1_EDGE          ( GPIO_HIGH_TO_LOW_TRANSITION )
 
-#define BUTTON_IRQ              ( INT_PORT1 )
-#define BUTTON_IRQ_PRIO         ( 0xFF )
-
 #define BUTTON_S2_PORT          ( GPIO_PORT_P1)
 #define BUTTON_S2_PIN           ( GPIO_PIN4 )
 #define BUTTON_S2_EDGE          ( GPIO_HIGH_TO_LOW_TRANSITION )
-#define BUTTON_S2_IRQ_PRIO      ( 0xFF )
+
+#define HEARTBEAT_LED           ( MSP432_LAUNCHPAD_LED_RED )
 
 #define LCD_CS_PORT             ( GPIO_PORT_P5 )
 #define LCD_CS_PIN              ( GPIO_PIN0 )
@@ -87,6 +88,8 @@ typedef struct
   uint16_t pin;
   uint8_t edge;
   callback_t callback;
+  debounce_callback_t event_callback;
+  debounce_input_t debounce;
 } button_cfg_t;
 
 /*--------------------------------prototypes----------------------------------*/
@@ -95,6 +98,9 @@ static void board_init_leds(void);
 static void board_init_debug(void);
 static void board_init_buttons(void);
 static void board_init_clk(void);
+static void board_buttons_edge(uint8_t port, uint16_t pin);
+static void board_heartbeat_step(void);
+static void board_buttons_event(uint8_t button, uint8_t event, uint32_t timestamp_ms);
 
 /*--------------------------------variables-----------------------------------*/
 
@@ -108,8 +114,10 @@ static gpio_cfg_t leds[] =
 
 static button_cfg_t buttons[] =
 {
-  {BUTTON_S1_PORT, BUTTON_S1_PIN, BUTTON_S1_EDGE, NULL},
-  {BUTTON_S2_PORT, BUTTON_S2_PIN, BUTTON_S2_EDGE, NULL},
+  {BUTTON_S1_PORT, BUTTON_S1_PIN, BUTTON_S1_EDGE, NULL, NULL,
+   {BUTTON_S1_PORT, BUTTON_S1_PIN, MSP432_LAUNCHPAD_BUTTON_S1, board_buttons_event}},
+  {BUTTON_S2_PORT, BUTTON_S2_PIN, BUTTON_S2_EDGE, NULL, NULL,
+   {BUTTON_S2_PORT, BUTTON_S2_PIN, MSP432_LAUNCHPAD_BUTTON_S2, board_buttons_event}},
 };
 
 static gpio_cfg_t debug[] =
@@ -120,6 +128,18 @@ static gpio_cfg_t debug[] =
   {DEBUG4_PORT, DEBUG4_PIN},
 };
 
+// Heartbeat on/off durations, the LED is on during the even steps
+static uint16_t heartbeat_pattern[BOARD_HEARTBEAT_PATTERN_MAX];
+static uint8_t heartbeat_length = 0;
+static uint8_t heartbeat_step;
+static bool heartbeat_alive;
+
+// Set by each registered client once per heartbeat cycle
+static volatile bool heartbeat_kicked[BOARD_HEARTBEAT_CLIENTS_MAX];
+static uint8_t heartbeat_clients = 0;
+
+static timer_entry_t heartbeat_timer;
+
 /*----------------------------------public------------------------------------*/
 
 void board_init(void)
@@ -153,6 +173,80 @@ void board_buttons_clear_callback(uint8_t button)
   }
 }
 
+// Press, release, long press and double click events, see debounce.h
+void board_buttons_set_event_callback(uint8_t button, debounce_callback_t callback)
+{
+  if (button < MSP432_LAUNCHPAD_BUTTON_ELEMENTS)
+  {
+    buttons[button].event_callback = callback;
+  }
+}
+
+/*
+ * Blinks the red LED from the timer interrupt following pattern_ms, a list of
+ * on and off durations starting with on, so no task has to wake up for it.
+ * While clients are registered the LED only blinks in the cycles after all
+ * of them called board_heartbeat_kick().
+ */
+bool board_heartbeat_start(const uint16_t* pattern_ms, uint8_t length)
+{
+  uint8_t i;
+
+  if ((length < 2) || (length > BOARD_HEARTBEAT_PATTERN_MAX) || ((length % 2) != 0))
+  {
+    return false;
+  }
+
+  for (i = 0; i < length; i++)
+  {
+    if (pattern_ms[i] == 0)
+    {
+      return false;
+    }
+    heartbeat_pattern[i] = pattern_ms[i];
+  }
+
+  heartbeat_length = length;
+  heartbeat_step = 0;
+  heartbeat_alive = true;
+
+  led_on(HEARTBEAT_LED);
+
+  timer_driver_init();
+  timer_start(&heartbeat_timer, heartbeat_pattern[0] * 1000, 0, board_heartbeat_step);
+
+  return true;
+}
+
+void board_heartbeat_stop(void)
+{
+  timer_cancel(&heartbeat_timer);
+  heartbeat_length = 0;
+
+  led_off(HEARTBEAT_LED);
+}
+
+// Adds a client to the liveness check, returns its id or -1 if full
+int8_t board_heartbeat_register(void)
+{
+  if (heartbeat_clients >= BOARD_HEARTBEAT_CLIENTS_MAX)
+  {
+    return -1;
+  }
+
+  heartbeat_kicked[heartbeat_clients] = true;
+
+  return heartbeat_clients++;
+}
+
+void board_heartbeat_kick(uint8_t client)
+{
+  if (client < heartbeat_clients)
+  {
+    heartbeat_kicked[client] = true;
+  }
+}
+
 void led_on(uint8_t led)
 {
   if (led < MSP432_LAUNCHPAD_LED_ELEMENTS)
@@ -226,16 +320,82 @@ static void board_init_debug(void)
 static void board_init_buttons(void)
 {
   uint16_t i;
+
+  gpio_driver_init();
+  debounce_init();
+
   for (i = 0; i < MSP432_LAUNCHPAD_BUTTON_ELEMENTS; i++)
   {
+    debounce_register(&buttons[i].debounce);
+
     MAP_GPIO_setAsInputPinWithPullUpResistor(buttons[i].port, buttons[i].pin);
-    MAP_GPIO_clearInterruptFlag(buttons[i].port, buttons[i].pin);
-    MAP_GPIO_interruptEdgeSelect(buttons[i].port, buttons[i].pin, buttons[i].edge);
-    MAP_GPIO_enableInterrupt(buttons[i].port, buttons[i].pin);
+    gpio_driver_register(buttons[i].port, buttons[i].pin, buttons[i].edge, board_buttons_edge, false);
   }
+}
+
+static void board_buttons_edge(uint8_t port, uint16_t pin)
+{
+  uint8_t i;
 
-  MAP_Interrupt_setPriority(BUTTON_IRQ, BUTTON_IRQ_PRIO);
-  MAP_Interrupt_enableInterrupt(BUTTON_IRQ);
+  for (i = 0; i < MSP432_LAUNCHPAD_BUTTON_ELEMENTS; i++)
+  {
+    if ((buttons[i].port == port) && (buttons[i].pin == pin))
+    {
+      debounce_edge(&buttons[i].debounce);
+    }
+  }
+}
+
+static void board_heartbeat_step(void)
+{
+  uint8_t i;
+
+  if (heartbeat_length == 0)
+  {
+    return;
+  }
+
+  heartbeat_step = (heartbeat_step + 1) % heartbeat_length;
+
+  /* A new cycle only blinks if every client was alive during the last one */
+  if (heartbeat_step == 0)
+  {
+    heartbeat_alive = true;
+    for (i = 0; i < heartbeat_clients; i++)
+    {
+      if (heartbeat_kicked[i] == false)
+      {
+        heartbeat_alive = false;
+      }
+      heartbeat_kicked[i] = false;
+    }
+  }
+
+  if (((heartbeat_step % 2) == 0) && (heartbeat_alive == true))
+  {
+    led_on(HEARTBEAT_LED);
+  }
+  else
+  {
+    led_off(HEARTBEAT_LED);
+  }
+
+  /* From the last deadline, so the latency of this interrupt does not add up */
+  timer_restart(&heartbeat_timer, heartbeat_pattern[heartbeat_step] * 1000);
+}
+
+// The plain callback keeps its meaning: one call per debounced press
+static void board_buttons_event(uint8_t button, uint8_t event, uint32_t timestamp_ms)
+{
+  if ((event == DEBOUNCE_EVENT_PRESS) && (buttons[button].callback != NULL))
+  {
+    buttons[button].callback();
+  }
+
+  if (buttons[button].event_callback != NULL)
+  {
+    buttons[button].event_callback(button, event, timestamp_ms);
+  }
 }
 
 static void board_init_clk(void)
@@ -285,23 +445,3 @@ static void board_init_clk(void)
 }
 
 /*--------------------------------interrupts----------------------------------*/
-
-void PORT1_Handler(void)
-{
-  uint_fast16_t status;
-
-  status = MAP_GPIO_getEnabledInterruptStatus(BUTTON_S1_PORT);
-  MAP_GPIO_clearInterruptFlag(BUTTON_S1_PORT, status);
-
-  if (((status & BUTTON_S1_PIN) == BUTTON_S1_PIN) &&
-      (buttons[MSP432_LAUNCHPAD_BUTTON_S1].callback != NULL))
-  {
-    buttons[MSP432_LAUNCHPAD_BUTTON_S1].callback();
-  }
-
-  if (((status & BUTTON_S2_PIN) == BUTTON_S2_PIN) &&
-      (buttons[MSP432_LAUNCHPAD_BUTTON_S2].callback != NULL))
-  {
-    buttons[MSP432_LAUNCHPAD_BUTTON_S2].callback();
-  }
-}
@@ -42,6 +42,7 @@
 #include <stdint.h>
 
 #include "callback.h"
+#include "debounce.h"
 
 /*---------------------------------defines------------------------------------*/
 
@@ -59,6 +60,9 @@ enum {
   MSP432_LAUNCHPAD_BUTTON_ELEMENTS
 };
 
+#define BOARD_HEARTBEAT_PATTERN_MAX   ( 8 )
+#define BOARD_HEARTBEAT_CLIENTS_MAX   ( 8 )
+
 enum {
   MSP432_LAUNCHPAD_DEBUG_0 = 0,
   MSP432_LAUNCHPAD_DEBUG_1,
@@ -75,6 +79,12 @@ void board_lock(void);
 
 void board_buttons_set_callback(uint8_t button, callback_t callback);
 void board_buttons_clear_callback(uint8_t button);
+void board_buttons_set_event_callback(uint8_t button, debounce_callback_t callback);
+
+bool board_heartbeat_start(const uint16_t* pattern_ms, uint8_t length);
+void board_heartbeat_stop(void);
+int8_t board_heartbeat_register(void);
+void board_heartbeat_kick(uint8_t client);
 
 void led_on(uint8_t led);
 void led_off(uint8_t led);
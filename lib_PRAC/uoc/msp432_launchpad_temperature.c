@@ -34,26 +34,59 @@
 
 /*--------------------------------includes------------------------------------*/
 
-#include <math.h>
+#include <stddef.h>
 
 #include "driverlib.h"
 
 #include "msp432_launchpad_temperature.h"
+#include "adc_driver.h"
 
 /*---------------------------------defines------------------------------------*/
 /*---------------------------------typedefs-----------------------------------*/
 /*--------------------------------prototypes----------------------------------*/
+
+static void temperature_sensor_done(const uint16_t* results, uint8_t length);
+
 /*--------------------------------variables-----------------------------------*/
 
 // Valores de calibracion de la temperatura de referencia del ADC
 static uint32_t adcRefTempCal_1_2v_30;
 static uint32_t adcRefTempCal_1_2v_85;
 
+// Filtro opcional (1 canal) aplicado a las muestras crudas del ADC
+static filter_pipeline_t* temperature_filter;
+static uint16_t temperature_raw;
+
+// Sobremuestreo: bits extra, pasadas por lectura y estado de la lectura actual
+static uint8_t oversampling_bits = 0;
+static uint8_t oversampling_passes = 1;
+static uint8_t oversampling_pass;
+static uint32_t oversampling_sum;
+
+// Secuencia de conversiones del canal A22 con la referencia interna de 1.2V.
+// Muestreo de 128 ciclos de MODOSC (> 5us, tiempo minimo del sensor)
+static uint32_t temperature_inputs[ADC_DRIVER_SEQUENCE_MAX];
+static adc_driver_sequence_t temperature_sequence =
+{
+  temperature_inputs,
+  1,
+  ADC_VREFPOS_INTBUF_VREFNEG_VSS,
+  ADC_CLOCKSOURCE_ADCOSC,
+  ADC_PULSE_WIDTH_128,
+  ADC_TEMPSENSEMAP,
+  temperature_sensor_done
+};
+
+static temperature_callback_t temperature_callback_func = NULL;
+static volatile bool temperature_reading = false;
+
 /*----------------------------------public------------------------------------*/
 
-// Inicializacion del ADC14 para medir temperatura del sensor interno
+// Inicializacion de la referencia y del sensor de temperatura interno
 void temperature_sensor_init(void)
 {
+  uint8_t i;
+
   // Lee los valores de calibracion
   adcRefTempCal_1_2v_30 = TLV->ADC14_REF1P2V_TS30C;
   adcRefTempCal_1_2v_85 = TLV->ADC14_REF1P2V_TS85C;
@@ -67,40 +100,125 @@ void temperature_sensor_init(void)
   // Habilita el sensor de temperatura
   REF_A->CTL0 &= ~REF_A_CTL0_TCOFF;
 
-  // Configura el ADC en pulse sample mode; ADC14_CTL0_SC trigger
-  // ADC ON, temperature sample period > 5us
-  ADC14->CTL0 |= ADC14_CTL0_SHT0_6 | ADC14_CTL0_ON | ADC14_CTL0_SHP;
-
-  // Habilita el sensor de temperatura interno
-  ADC14->CTL1 |= ADC14_CTL1_TCMAP;
+  // El ADC14 lo gestiona el driver de ADC, compartido con otros clientes
+  adc_driver_init();
 
-  // ADC input channel A22 para medida de temperatura
-  ADC14->MCTL[0] = ADC14_MCTLN_VRSEL_1 | ADC14_MCTLN_INCH_22;
+  // Todas las conversiones de la secuencia miden el canal A22
+  for (i = 0; i < ADC_DRIVER_SEQUENCE_MAX; i++)
+  {
+    temperature_inputs[i] = ADC_INPUT_A22;
+  }
 
   // Espera a que la tension de referencia sea estable
   while (!(REF_A->CTL0 & REF_A_CTL0_GENRDY));
+}
+
+// Configura la funcion que recibe cada lectura (desde la interrupcion del ADC)
+void temperature_sensor_set_callback(temperature_callback_t callback)
+{
+  temperature_callback_func = callback;
+}
 
-  // ADC enable conversion
-  ADC14->CTL0 |= ADC14_CTL0_ENC;
+// Solicita una lectura de temperatura sin esperar a que termine. El resultado
+// llega al callback. Devuelve false si ya hay una lectura en curso o el ADC
+// tiene la cola llena
+bool temperature_sensor_read(void)
+{
+  if (temperature_reading == true)
+  {
+    return false;
+  }
+
+  temperature_reading = true;
+  oversampling_pass = 0;
+  oversampling_sum = 0;
+
+  if (adc_driver_request(&temperature_sequence) == false)
+  {
+    temperature_reading = false;
+    return false;
+  }
+
+  return true;
 }
 
-// Lee el valor de la medida de temperatura
-float temperature_sensor_read(void)
+// Configura el filtro de las muestras de temperatura (NULL lo desactiva)
+void temperature_sensor_set_filter(filter_pipeline_t* pipeline)
 {
-  float temperature;
+  temperature_filter = pipeline;
+}
 
-  // Inicia el muestreo y la conversion A/D
-  ADC14->CTL0 |= ADC14_CTL0_SC;
+// Configura el sobremuestreo: cada lectura acumula 4^extra_bits conversiones
+// y las diezma a 14 + extra_bits bits. Con 0 se vuelve a una conversion por
+// lectura. El filtro solo se aplica a lecturas sin sobremuestreo
+bool temperature_sensor_set_oversampling(uint8_t extra_bits)
+{
+  uint32_t samples;
 
-  // Espera a que finalice la conversin A/D
-  while (ADC14->CTL0 & ADC14_CTL0_BUSY);
+  if ((extra_bits > TEMPERATURE_OVERSAMPLING_MAX_BITS) || (temperature_reading == true))
+  {
+    return false;
+  }
 
-  // Calcula el valor de temperatura en grados Celsius
-  temperature = (((float) ADC14->MEM[0] - adcRefTempCal_1_2v_30) * (85 - 30)) /
-          (adcRefTempCal_1_2v_85 - adcRefTempCal_1_2v_30) + 30.0f;
+  // Cada secuencia cubre hasta 32 conversiones
+  samples = (uint32_t)1 << (2 * extra_bits);
+  temperature_sequence.length = (samples < ADC_DRIVER_SEQUENCE_MAX) ? samples : ADC_DRIVER_SEQUENCE_MAX;
+  oversampling_passes = samples / temperature_sequence.length;
+  oversampling_bits = extra_bits;
 
-  return temperature;
+  return true;
 }
 
 /*---------------------------------private------------------------------------*/
+
+// Fin de una secuencia de conversiones (interrupcion del ADC)
+static void temperature_sensor_done(const uint16_t* results, uint8_t length)
+{
+  float raw;
+  uint16_t sample;
+  uint8_t i;
+
+  if (oversampling_bits == 0)
+  {
+    sample = results[0];
+
+    // Filtra la muestra; si el filtro la descarta se mantiene la anterior
+    if ((temperature_filter == NULL) || (filter_pipeline_process(temperature_filter, &sample, 1) > 0))
+    {
+      temperature_raw = sample;
+    }
+
+    raw = (float) temperature_raw;
+  }
+  else
+  {
+    for (i = 0; i < length; i++)
+    {
+      oversampling_sum += results[i];
+    }
+
+    // Siguiente pasada de la misma lectura
+    if (++oversampling_pass < oversampling_passes)
+    {
+      if (adc_driver_request(&temperature_sequence) == false)
+      {
+        temperature_reading = false;
+      }
+      return;
+    }
+
+    // Diezmado a 14 + bits bits, escalado de vuelta a LSB de 14 bits
+    raw = (float)(oversampling_sum >> oversampling_bits) / (1 << oversampling_bits);
+  }
+
+  temperature_reading = false;
+
+  // Calcula el valor de temperatura en grados Celsius
+  if (temperature_callback_func != NULL)
+  {
+    temperature_callback_func(((raw - adcRefTempCal_1_2v_30) * (85 - 30)) /
+                              (adcRefTempCal_1_2v_85 - adcRefTempCal_1_2v_30) + 30.0f);
+  }
+}
+
 /*--------------------------------interrupts----------------------------------*/
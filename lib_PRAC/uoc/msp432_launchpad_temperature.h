@@ -40,12 +40,25 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "filter.h"
+
 /*---------------------------------defines------------------------------------*/
+
+// Bits extra de resolucion por sobremuestreo (4^bits conversiones por lectura)
+#define TEMPERATURE_OVERSAMPLING_MAX_BITS   ( 4 )
+
 /*---------------------------------typedefs-----------------------------------*/
+
+// Recibe la temperatura en grados Celsius; se llama desde la interrupcion del ADC
+typedef void (*temperature_callback_t)(float temperature);
+
 /*--------------------------------prototypes----------------------------------*/
 
 void temperature_sensor_init(void);
-float temperature_sensor_read(void);
+void temperature_sensor_set_callback(temperature_callback_t callback);
+bool temperature_sensor_read(void);
+void temperature_sensor_set_filter(filter_pipeline_t* pipeline);
+bool temperature_sensor_set_oversampling(uint8_t extra_bits);
 
 /*--------------------------------variables-----------------------------------*/
 /*----------------------------------public------------------------------------*/
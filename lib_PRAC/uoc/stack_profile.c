@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <string.h>
+
+#include "driverlib.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "stack_profile.h"
+
+/*---------------------------------defines------------------------------------*/
+
+// Fill of the unused stack, tskSTACK_FILL_BYTE as the kernel paints the tasks
+#define STACK_PROFILE_FILL          ( 0xA5A5A5A5 )
+
+// Words left below the stack pointer of stack_profile_init() while painting
+#define STACK_PROFILE_INIT_RESERVE  ( 16 )
+
+/*---------------------------------typedefs-----------------------------------*/
+/*--------------------------------prototypes----------------------------------*/
+
+static void stack_profile_put(uint8_t* payload, uint16_t offset, uint16_t value);
+
+/*--------------------------------variables-----------------------------------*/
+
+#if defined(__MSP432P401R__) && !defined(HOST_SIMULATION)
+// Main stack from the linker, only the interrupts use it once the scheduler runs
+extern uint32_t __stack;
+extern uint32_t __STACK_END;
+#endif
+
+// Size in words of each task stack, indexed by task number
+static uint16_t stack_profile_sizes[STACK_PROFILE_MAX_TASKS];
+
+static TaskStatus_t stack_profile_status[STACK_PROFILE_MAX_TASKS];
+
+#if (configCHECK_FOR_STACK_OVERFLOW > 0)
+// Name of the task which overflowed its stack, for the debugger
+static volatile const char* stack_profile_overflow = NULL;
+#endif
+
+/*----------------------------------public------------------------------------*/
+
+// Paints the free part of the main stack, call it first thing in main()
+void stack_profile_init(void)
+{
+#if defined(__MSP432P401R__) && !defined(HOST_SIMULATION)
+  uint32_t* limit = (uint32_t*)__get_MSP() - STACK_PROFILE_INIT_RESERVE;
+  uint32_t* word;
+
+  for (word = &__stack; word < limit; word++)
+  {
+    *word = STACK_PROFILE_FILL;
+  }
+#endif
+}
+
+/*
+ * Fills profile with the high water of every stack and the sizes suggested
+ * from it. In the simulation tasks run on the stacks of their threads, so
+ * only the sizes are meaningful. Returns false if there are more than
+ * STACK_PROFILE_MAX_TASKS tasks.
+ */
+bool stack_profile_sample(stack_profile_t* profile)
+{
+  stack_profile_stack_t* stack;
+  TaskStatus_t* status;
+  UBaseType_t count;
+  UBaseType_t i;
+
+  count = uxTaskGetSystemState(stack_profile_status, STACK_PROFILE_MAX_TASKS, NULL);
+  if (count == 0)
+  {
+    return false;
+  }
+
+  memset(&profile->isr, 0, sizeof(profile->isr));
+  strcpy(profile->isr.name, "ISR");
+
+#if defined(__MSP432P401R__) && !defined(HOST_SIMULATION)
+  {
+    const uint32_t* word = &__stack;
+
+    while ((word < &__STACK_END) && (*word == STACK_PROFILE_FILL))
+    {
+      word++;
+    }
+
+    /* Includes what main() used before the scheduler started */
+    profile->isr.size = &__STACK_END - &__stack;
+    profile->isr.used = &__STACK_END - word;
+    profile->isr.suggested = stack_profile_suggest(profile->isr.used);
+  }
+#endif
+
+  profile->count = 0;
+
+  for (i = 0; i < count; i++)
+  {
+    status = &stack_profile_status[i];
+    stack = &profile->tasks[profile->count++];
+
+    stack->number = status->xTaskNumber;
+    strncpy(stack->name, status->pcTaskName, STACK_PROFILE_NAME_SIZE);
+    stack->name[STACK_PROFILE_NAME_SIZE] = '\0';
+
+    stack->size = 0;
+    stack->used = 0;
+    if (status->xTaskNumber < STACK_PROFILE_MAX_TASKS)
+    {
+      stack->size = stack_profile_sizes[status->xTaskNumber];
+      stack->used = stack->size - status->usStackHighWaterMark;
+    }
+    stack->suggested = stack_profile_suggest(stack->used);
+  }
+
+  return true;
+}
+
+// Returns the length of the payload, or 0 if it does not fit in size
+uint16_t stack_profile_encode(const stack_profile_t* profile, uint8_t* payload, uint16_t size)
+{
+  const stack_profile_stack_t* stack;
+  uint16_t length;
+  uint8_t i;
+
+  length = STACK_PROFILE_HEADER_SIZE + profile->count * STACK_PROFILE_TASK_SIZE;
+  if (length > size)
+  {
+    return 0;
+  }
+
+  stack_profile_put(payload, 0, profile->isr.size);
+  stack_profile_put(payload, 2, profile->isr.used);
+  stack_profile_put(payload, 4, profile->isr.suggested);
+  payload[6] = profile->count;
+  payload += STACK_PROFILE_HEADER_SIZE;
+
+  for (i = 0; i < profile->count; i++)
+  {
+    stack = &profile->tasks[i];
+
+    payload[0] = stack->number;
+    stack_profile_put(payload, 1, stack->size);
+    stack_profile_put(payload, 3, stack->used);
+    stack_profile_put(payload, 5, stack->suggested);
+    strncpy((char*)&payload[7], stack->name, STACK_PROFILE_NAME_SIZE);
+    payload += STACK_PROFILE_TASK_SIZE;
+  }
+
+  return length;
+}
+
+uint16_t stack_profile_suggest(uint16_t used)
+{
+  uint32_t margin = used >> STACK_PROFILE_MARGIN_SHIFT;
+  uint32_t suggested;
+
+  if (margin < STACK_PROFILE_MARGIN_MIN)
+  {
+    margin = STACK_PROFILE_MARGIN_MIN;
+  }
+
+  suggested = used + margin + STACK_PROFILE_ROUND - 1;
+  suggested -= suggested % STACK_PROFILE_ROUND;
+
+  return (suggested > UINT16_MAX) ? UINT16_MAX : suggested;
+}
+
+// traceTASK_CREATE(), end is the highest word of the stack
+void stack_profile_task_created(uint32_t number, void* stack, void* end)
+{
+  if (number < STACK_PROFILE_MAX_TASKS)
+  {
+    stack_profile_sizes[number] = (StackType_t*)end - (StackType_t*)stack + 1;
+  }
+}
+
+#if (configCHECK_FOR_STACK_OVERFLOW > 0)
+/*
+ * The kernel checks on every switch that the 16 bytes at the end of the stack
+ * switched out are still painted. A task which went past them may have
+ * corrupted anything, so this halts as a failed assertion.
+ */
+void vApplicationStackOverflowHook(TaskHandle_t task, char* name)
+{
+  (void) task;
+
+  stack_profile_overflow = name;
+  configASSERT(stack_profile_overflow == NULL);
+}
+#endif
+
+/*---------------------------------private------------------------------------*/
+
+// Little endian
+static void stack_profile_put(uint8_t* payload, uint16_t offset, uint16_t value)
+{
+  payload[offset] = (uint8_t)value;
+  payload[offset + 1] = (uint8_t)(value >> 8);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef STACK_PROFILE_H_
+#define STACK_PROFILE_H_
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*---------------------------------defines------------------------------------*/
+
+/* Tasks are found by their number, the stacks of later ones are not known */
+#define STACK_PROFILE_MAX_TASKS     ( 12 )
+#define STACK_PROFILE_NAME_SIZE     ( 8 )
+
+/*
+ * Suggested sizes are the high water plus a quarter, at least the margin
+ * (an exception frame with the FPU context is 26 words), rounded up
+ */
+#define STACK_PROFILE_MARGIN_SHIFT  ( 2 )
+#define STACK_PROFILE_MARGIN_MIN    ( 32 )
+#define STACK_PROFILE_ROUND         ( 8 )
+
+/*
+ * Payload of stack_profile_encode(), sizes in words (all fields little endian):
+ *
+ *   | isr_size (2) | isr_used (2) | isr_suggested (2) | count (1) |
+ *
+ * followed by count tasks of STACK_PROFILE_TASK_SIZE bytes:
+ *
+ *   | number (1) | size (2) | used (2) | suggested (2) | name (8) |
+ *
+ * The interrupts use the main stack, its size is 0 where it is not known.
+ */
+#define STACK_PROFILE_HEADER_SIZE   ( 7 )
+#define STACK_PROFILE_TASK_SIZE     ( 7 + STACK_PROFILE_NAME_SIZE )
+#define STACK_PROFILE_PAYLOAD_MAX_SIZE ( STACK_PROFILE_HEADER_SIZE + STACK_PROFILE_MAX_TASKS * STACK_PROFILE_TASK_SIZE )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  uint8_t number;
+  uint16_t size;            // words
+  uint16_t used;            // words ever used, the high water
+  uint16_t suggested;       // words
+  char name[STACK_PROFILE_NAME_SIZE + 1];
+} stack_profile_stack_t;
+
+typedef struct
+{
+  stack_profile_stack_t isr;
+  uint8_t count;
+  stack_profile_stack_t tasks[STACK_PROFILE_MAX_TASKS];
+} stack_profile_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+void stack_profile_init(void);
+bool stack_profile_sample(stack_profile_t* profile);
+uint16_t stack_profile_encode(const stack_profile_t* profile, uint8_t* payload, uint16_t size);
+uint16_t stack_profile_suggest(uint16_t used);
+
+/* Kernel hook, see FreeRTOSConfig.h */
+void stack_profile_task_created(uint32_t number, void* stack, void* end);
+
+/*--------------------------------variables-----------------------------------*/
+/*----------------------------------public------------------------------------*/
+/*---------------------------------private------------------------------------*/
+/*--------------------------------interrupts----------------------------------*/
+
+#endif /* STACK_PROFILE_H_ */
@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <string.h>
+
+#include "driverlib.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "task_stats.h"
+#include "timer_driver.h"
+
+/*---------------------------------defines------------------------------------*/
+/*---------------------------------typedefs-----------------------------------*/
+/*--------------------------------prototypes----------------------------------*/
+
+static void task_stats_put(uint8_t* payload, uint8_t offset, uint32_t value, uint8_t size);
+
+/*--------------------------------variables-----------------------------------*/
+
+// Counted from the context switch, indexed by task number
+static volatile uint32_t task_stats_switches[TASK_STATS_MAX_TASKS];
+static volatile uint32_t task_stats_switches_total = 0;
+static volatile uint32_t task_stats_current = 0;
+
+// Values of the previous sample, the next one reports the differences
+static TaskStatus_t task_stats_status[TASK_STATS_MAX_TASKS];
+static uint32_t task_stats_last_run_time[TASK_STATS_MAX_TASKS];
+static uint32_t task_stats_last_switches[TASK_STATS_MAX_TASKS];
+static uint32_t task_stats_last_switches_total = 0;
+static uint32_t task_stats_last_total = 0;
+
+/*----------------------------------public------------------------------------*/
+
+/*
+ * Fills stats with what happened since the previous call, or since the
+ * scheduler started for the first one. Not reentrant, call it from one task.
+ * Returns false if there are more than TASK_STATS_MAX_TASKS tasks.
+ */
+bool task_stats_sample(task_stats_t* stats)
+{
+  TaskHandle_t idle = xTaskGetIdleTaskHandle();
+  task_stats_task_t* task;
+  TaskStatus_t* status;
+  uint32_t total;
+  uint32_t switches;
+  UBaseType_t count;
+  UBaseType_t i;
+
+  count = uxTaskGetSystemState(task_stats_status, TASK_STATS_MAX_TASKS, &total);
+  if (count == 0)
+  {
+    return false;
+  }
+
+  /* Unsigned differences stay right across one wraparound of the counters */
+  stats->interval = total - task_stats_last_total;
+  stats->counter_hz = MAP_CS_getMCLK() >> TASK_STATS_COUNTER_SHIFT;
+  switches = task_stats_switches_total;
+  stats->switches = switches - task_stats_last_switches_total;
+  stats->idle_share = 0;
+  stats->count = 0;
+
+  task_stats_last_total = total;
+  task_stats_last_switches_total = switches;
+
+  for (i = 0; i < count; i++)
+  {
+    status = &task_stats_status[i];
+    task = &stats->tasks[stats->count++];
+
+    task->number = status->xTaskNumber;
+    task->priority = status->uxCurrentPriority;
+    task->state = status->eCurrentState;
+    strncpy(task->name, status->pcTaskName, TASK_STATS_NAME_SIZE);
+    task->name[TASK_STATS_NAME_SIZE] = '\0';
+
+    task->run_time = status->ulRunTimeCounter;
+    task->switches = 0;
+    if (status->xTaskNumber < TASK_STATS_MAX_TASKS)
+    {
+      task->run_time -= task_stats_last_run_time[status->xTaskNumber];
+      task_stats_last_run_time[status->xTaskNumber] = status->ulRunTimeCounter;
+
+      switches = task_stats_switches[status->xTaskNumber];
+      task->switches = switches - task_stats_last_switches[status->xTaskNumber];
+      task_stats_last_switches[status->xTaskNumber] = switches;
+    }
+
+    task->share = 0;
+    if (stats->interval != 0)
+    {
+      task->share = (uint16_t)(((uint64_t)task->run_time * TASK_STATS_SHARE_FULL) / stats->interval);
+    }
+
+    if (status->xHandle == idle)
+    {
+      stats->idle_share = task->share;
+    }
+  }
+
+  return true;
+}
+
+// Serializes stats as described in task_stats.h, returns the length or 0 if it does not fit
+uint16_t task_stats_encode(const task_stats_t* stats, uint8_t* payload, uint16_t size)
+{
+  const task_stats_task_t* task;
+  uint16_t length;
+  uint8_t i;
+
+  length = TASK_STATS_HEADER_SIZE + stats->count * TASK_STATS_TASK_SIZE;
+  if (length > size)
+  {
+    return 0;
+  }
+
+  task_stats_put(payload, 0, stats->interval, 4);
+  task_stats_put(payload, 4, stats->counter_hz, 4);
+  task_stats_put(payload, 8, stats->switches, 4);
+  task_stats_put(payload, 12, stats->idle_share, 2);
+  payload[14] = stats->count;
+  payload += TASK_STATS_HEADER_SIZE;
+
+  for (i = 0; i < stats->count; i++)
+  {
+    task = &stats->tasks[i];
+
+    payload[0] = task->number;
+    payload[1] = task->priority;
+    payload[2] = task->state;
+    task_stats_put(payload, 3, task->share, 2);
+    task_stats_put(payload, 5, task->switches, 4);
+    strncpy((char*)&payload[9], task->name, TASK_STATS_NAME_SIZE);
+    payload += TASK_STATS_TASK_SIZE;
+  }
+
+  return length;
+}
+
+// portCONFIGURE_TIMER_FOR_RUN_TIME_STATS(), the timer may already run
+void task_stats_timer_init(void)
+{
+  timer_driver_init();
+}
+
+// portGET_RUN_TIME_COUNTER_VALUE(), the low 32 bits of the scaled Timer32 time
+uint32_t task_stats_counter(void)
+{
+  return (uint32_t)(timer_now_ticks() >> TASK_STATS_COUNTER_SHIFT);
+}
+
+// traceTASK_SWITCHED_IN(), also called when the same task is selected again
+void task_stats_switched_in(uint32_t number)
+{
+  if (number == task_stats_current)
+  {
+    return;
+  }
+  task_stats_current = number;
+
+  task_stats_switches_total++;
+  if (number < TASK_STATS_MAX_TASKS)
+  {
+    task_stats_switches[number]++;
+  }
+}
+
+/*---------------------------------private------------------------------------*/
+
+// Little endian
+static void task_stats_put(uint8_t* payload, uint8_t offset, uint32_t value, uint8_t size)
+{
+  uint8_t i;
+
+  for (i = 0; i < size; i++)
+  {
+    payload[offset + i] = (uint8_t)(value >> (8 * i));
+  }
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef TASK_STATS_H_
+#define TASK_STATS_H_
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*---------------------------------defines------------------------------------*/
+
+/* The run time counter is MCLK / 16 from Timer32 0, 2.5 MHz at the 40 MHz MCLK,
+ * so it wraps every 28.6 minutes. Samples only use differences, so they must
+ * be taken more often */
+#define TASK_STATS_COUNTER_SHIFT    ( 4 )
+
+/* Tasks are found by their number, the switches of later ones are not counted */
+#define TASK_STATS_MAX_TASKS        ( 12 )
+#define TASK_STATS_NAME_SIZE        ( 8 )
+
+/* Shares are in hundredths of a percent */
+#define TASK_STATS_SHARE_FULL       ( 10000 )
+
+/*
+ * Payload of task_stats_encode() (all fields little endian):
+ *
+ *   | interval (4) | counter_hz (4) | switches (4) | idle_share (2) | count (1) |
+ *
+ * followed by count tasks of TASK_STATS_TASK_SIZE bytes:
+ *
+ *   | number (1) | priority (1) | state (1) | share (2) | switches (4) | name (8) |
+ *
+ * The name is padded with zeros and not terminated when it is 8 characters.
+ */
+#define TASK_STATS_HEADER_SIZE      ( 15 )
+#define TASK_STATS_TASK_SIZE        ( 9 + TASK_STATS_NAME_SIZE )
+#define TASK_STATS_PAYLOAD_MAX_SIZE ( TASK_STATS_HEADER_SIZE + TASK_STATS_MAX_TASKS * TASK_STATS_TASK_SIZE )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  uint8_t number;
+  uint8_t priority;
+  uint8_t state;            // eTaskState
+  uint16_t share;
+  uint32_t run_time;        // counts in the interval
+  uint32_t switches;        // times switched in during the interval
+  char name[TASK_STATS_NAME_SIZE + 1];
+} task_stats_task_t;
+
+typedef struct
+{
+  uint32_t interval;        // counts since the previous sample
+  uint32_t counter_hz;
+  uint32_t switches;
+  uint16_t idle_share;
+  uint8_t count;
+  task_stats_task_t tasks[TASK_STATS_MAX_TASKS];
+} task_stats_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+bool task_stats_sample(task_stats_t* stats);
+uint16_t task_stats_encode(const task_stats_t* stats, uint8_t* payload, uint16_t size);
+
+/* Kernel hooks, see FreeRTOSConfig.h */
+void task_stats_timer_init(void);
+uint32_t task_stats_counter(void);
+void task_stats_switched_in(uint32_t number);
+
+/*--------------------------------variables-----------------------------------*/
+/*----------------------------------public------------------------------------*/
+/*---------------------------------private------------------------------------*/
+/*--------------------------------interrupts----------------------------------*/
+
+#endif /* TASK_STATS_H_ */
@@ -0,0 +1,356 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stddef.h>
+
+#if defined(__MSP432P401R__)
+#include "driverlib.h"
+#include "interrupts.h"
+#endif
+
+#include "telemetry.h"
+#include "uart_driver.h"
+
+/*---------------------------------defines------------------------------------*/
+
+#define TELEMETRY_CRC32_SEED        ( 0xFFFFFFFF )
+#define TELEMETRY_CRC32_XOR         ( 0xFFFFFFFF )
+
+#define TELEMETRY_COBS_BLOCK_MAX    ( 0xFF )
+#define TELEMETRY_DELIMITER         ( 0x00 )
+
+/*---------------------------------typedefs-----------------------------------*/
+/*--------------------------------prototypes----------------------------------*/
+
+static uint16_t telemetry_cobs_encode(const uint8_t* src, uint16_t length, uint8_t* dst);
+static int16_t telemetry_cobs_decode(const uint8_t* src, uint16_t length, uint8_t* dst);
+static uint8_t telemetry_decoder_frame(telemetry_decoder_t* decoder, telemetry_frame_t* frame);
+
+/*--------------------------------variables-----------------------------------*/
+
+#if !defined(__MSP432P401R__)
+// Reflected CRC32 (0xEDB88320) lookup table, one entry per nibble
+static const uint32_t crc32_nibble_table[16] =
+{
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+  0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+  0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+#endif
+
+static uint8_t telemetry_sequence;
+
+/*----------------------------------public------------------------------------*/
+
+void telemetry_init(void)
+{
+  telemetry_sequence = 0;
+}
+
+// Encodes and queues a frame on the UART. Not reentrant, call it from one task.
+uint8_t telemetry_send(uint8_t type, const uint8_t* payload, uint16_t length)
+{
+  uint8_t frame[TELEMETRY_ENCODED_MAX_SIZE];
+  uint16_t frame_length;
+
+  if (length > TELEMETRY_PAYLOAD_MAX_SIZE)
+  {
+    return 1;
+  }
+
+  frame_length = telemetry_encode(telemetry_sequence, type, payload, length, frame);
+  telemetry_sequence++;
+
+  return uart_write(frame, frame_length);
+}
+
+// Builds a complete encoded frame (including the trailing delimiter) and
+// returns its length, or 0 if the payload does not fit
+uint16_t telemetry_encode(uint8_t sequence, uint8_t type, const uint8_t* payload, uint16_t length, uint8_t* frame)
+{
+  uint8_t raw[TELEMETRY_RAW_MAX_SIZE];
+  uint16_t raw_length = 0;
+  uint16_t frame_length;
+  uint32_t crc;
+  uint16_t i;
+
+  if (length > TELEMETRY_PAYLOAD_MAX_SIZE)
+  {
+    return 0;
+  }
+
+  /* Header */
+  raw[raw_length++] = sequence;
+  raw[raw_length++] = type;
+
+  /* Payload */
+  for (i = 0; i < length; i++)
+  {
+    raw[raw_length++] = payload[i];
+  }
+
+  /* Trailer */
+  crc = telemetry_crc32(raw, raw_length);
+  raw[raw_length++] = (uint8_t)(crc);
+  raw[raw_length++] = (uint8_t)(crc >> 8);
+  raw[raw_length++] = (uint8_t)(crc >> 16);
+  raw[raw_length++] = (uint8_t)(crc >> 24);
+
+  frame_length = telemetry_cobs_encode(raw, raw_length, frame);
+  frame[frame_length++] = TELEMETRY_DELIMITER;
+
+  return frame_length;
+}
+
+void telemetry_decoder_init(telemetry_decoder_t* decoder)
+{
+  decoder->length = 0;
+  decoder->overflow = false;
+  decoder->synchronized = false;
+  decoder->next_sequence = 0;
+  decoder->frames_ok = 0;
+  decoder->frames_error = 0;
+  decoder->frames_lost = 0;
+}
+
+// Feeds one received byte. Returns TELEMETRY_FRAME_NONE until a delimiter
+// completes a frame, then the result of validating it
+uint8_t telemetry_decoder_push(telemetry_decoder_t* decoder, uint8_t data, telemetry_frame_t* frame)
+{
+  uint8_t status;
+
+  if (data != TELEMETRY_DELIMITER)
+  {
+    if (decoder->length < TELEMETRY_ENCODED_MAX_SIZE)
+    {
+      decoder->buffer[decoder->length++] = data;
+    }
+    else
+    {
+      decoder->overflow = true;
+    }
+
+    return TELEMETRY_FRAME_NONE;
+  }
+
+  /* Consecutive delimiters (e.g. idle line fill) are not frames */
+  if ((decoder->length == 0) && (decoder->overflow == false))
+  {
+    return TELEMETRY_FRAME_NONE;
+  }
+
+  if (decoder->overflow == true)
+  {
+    status = TELEMETRY_FRAME_ERROR_OVERFLOW;
+  }
+  else
+  {
+    status = telemetry_decoder_frame(decoder, frame);
+  }
+
+  if (status == TELEMETRY_FRAME_OK)
+  {
+    /* Count frames skipped by the sender or dropped on the wire */
+    if (decoder->synchronized == true)
+    {
+      decoder->frames_lost += (uint8_t)(frame->sequence - decoder->next_sequence);
+    }
+
+    decoder->synchronized = true;
+    decoder->next_sequence = frame->sequence + 1;
+    decoder->frames_ok++;
+  }
+  else
+  {
+    decoder->frames_error++;
+  }
+
+  decoder->length = 0;
+  decoder->overflow = false;
+
+  return status;
+}
+
+uint32_t telemetry_crc32(const uint8_t* data, uint16_t length)
+{
+  uint32_t crc;
+  uint16_t i;
+
+#if defined(__MSP432P401R__)
+  uint32_t irq_status;
+
+  /* The CRC32 module is shared, keep the whole calculation atomic */
+  irq_status = interrupts_disable();
+
+  MAP_CRC32_setSeed(TELEMETRY_CRC32_SEED, CRC32_MODE);
+
+  for (i = 0; i < length; i++)
+  {
+    MAP_CRC32_set8BitData(data[i], CRC32_MODE);
+  }
+
+  crc = MAP_CRC32_getResultReversed(CRC32_MODE);
+
+  interrupts_restore(irq_status);
+#else
+  crc = TELEMETRY_CRC32_SEED;
+
+  for (i = 0; i < length; i++)
+  {
+    crc = (crc >> 4) ^ crc32_nibble_table[(crc ^ data[i]) & 0x0F];
+    crc = (crc >> 4) ^ crc32_nibble_table[(crc ^ (data[i] >> 4)) & 0x0F];
+  }
+#endif
+
+  return crc ^ TELEMETRY_CRC32_XOR;
+}
+
+/*---------------------------------private------------------------------------*/
+
+static uint16_t telemetry_cobs_encode(const uint8_t* src, uint16_t length, uint8_t* dst)
+{
+  uint16_t read_index = 0;
+  uint16_t write_index = 1;
+  uint16_t code_index = 0;
+  uint8_t code = 1;
+
+  while (read_index < length)
+  {
+    if (src[read_index] == 0)
+    {
+      /* Close the current block at the zero byte */
+      dst[code_index] = code;
+      code_index = write_index++;
+      code = 1;
+    }
+    else
+    {
+      dst[write_index++] = src[read_index];
+      code++;
+
+      /* Close a full block of 254 non-zero bytes */
+      if (code == TELEMETRY_COBS_BLOCK_MAX)
+      {
+        dst[code_index] = code;
+        code_index = write_index++;
+        code = 1;
+      }
+    }
+
+    read_index++;
+  }
+
+  dst[code_index] = code;
+
+  return write_index;
+}
+
+static int16_t telemetry_cobs_decode(const uint8_t* src, uint16_t length, uint8_t* dst)
+{
+  uint16_t read_index = 0;
+  uint16_t write_index = 0;
+  uint8_t code;
+  uint8_t i;
+
+  while (read_index < length)
+  {
+    code = src[read_index];
+
+    /* A block can not run past the end of the frame */
+    if ((code == 0) || ((uint16_t)(read_index + code) > length))
+    {
+      return -1;
+    }
+
+    read_index++;
+
+    for (i = 1; i < code; i++)
+    {
+      dst[write_index++] = src[read_index++];
+    }
+
+    /* Every block but full ones and the last one stands for a zero byte */
+    if ((code != TELEMETRY_COBS_BLOCK_MAX) && (read_index != length))
+    {
+      dst[write_index++] = 0;
+    }
+  }
+
+  return write_index;
+}
+
+static uint8_t telemetry_decoder_frame(telemetry_decoder_t* decoder, telemetry_frame_t* frame)
+{
+  uint8_t raw[TELEMETRY_ENCODED_MAX_SIZE];
+  int16_t raw_length;
+  uint16_t payload_length;
+  uint32_t crc;
+  uint16_t i;
+
+  raw_length = telemetry_cobs_decode(decoder->buffer, decoder->length, raw);
+
+  if ((raw_length < (TELEMETRY_HEADER_SIZE + TELEMETRY_CRC_SIZE)) ||
+      (raw_length > TELEMETRY_RAW_MAX_SIZE))
+  {
+    return TELEMETRY_FRAME_ERROR_FORMAT;
+  }
+
+  payload_length = raw_length - TELEMETRY_HEADER_SIZE - TELEMETRY_CRC_SIZE;
+
+  crc = ((uint32_t)raw[raw_length - 4]) |
+        ((uint32_t)raw[raw_length - 3] << 8) |
+        ((uint32_t)raw[raw_length - 2] << 16) |
+        ((uint32_t)raw[raw_length - 1] << 24);
+
+  if (crc != telemetry_crc32(raw, raw_length - TELEMETRY_CRC_SIZE))
+  {
+    return TELEMETRY_FRAME_ERROR_CRC;
+  }
+
+  frame->sequence = raw[0];
+  frame->type = raw[1];
+  frame->length = payload_length;
+
+  for (i = 0; i < payload_length; i++)
+  {
+    frame->payload[i] = raw[TELEMETRY_HEADER_SIZE + i];
+  }
+
+  return TELEMETRY_FRAME_OK;
+}
+
+/*--------------------------------interrupts----------------------------------*/
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*---------------------------------defines------------------------------------*/
+
+/*
+ * Frame layout before COBS encoding (all fields little endian):
+ *
+ *   | sequence (1) | type (1) | payload (0..TELEMETRY_PAYLOAD_MAX_SIZE) | crc32 (4) |
+ *
+ * The CRC32 (IEEE 802.3, same as zlib) covers sequence, type and payload. The
+ * encoded frame never contains a zero byte and is terminated by a single 0x00
+ * delimiter, so a receiver can resynchronize on any zero in the stream.
+ */
+
+#define TELEMETRY_HEADER_SIZE           ( 2 )
+#define TELEMETRY_CRC_SIZE              ( 4 )
+#define TELEMETRY_PAYLOAD_MAX_SIZE      ( 248 )
+#define TELEMETRY_RAW_MAX_SIZE          ( TELEMETRY_HEADER_SIZE + TELEMETRY_PAYLOAD_MAX_SIZE + TELEMETRY_CRC_SIZE )
+#define TELEMETRY_ENCODED_MAX_SIZE      ( TELEMETRY_RAW_MAX_SIZE + (TELEMETRY_RAW_MAX_SIZE / 254) + 2 )
+
+enum
+{
+  TELEMETRY_FRAME_NONE = 0,
+  TELEMETRY_FRAME_OK,
+  TELEMETRY_FRAME_ERROR_FORMAT,
+  TELEMETRY_FRAME_ERROR_CRC,
+  TELEMETRY_FRAME_ERROR_OVERFLOW
+};
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  uint8_t sequence;
+  uint8_t type;
+  uint16_t length;
+  uint8_t payload[TELEMETRY_PAYLOAD_MAX_SIZE];
+} telemetry_frame_t;
+
+typedef struct
+{
+  uint8_t buffer[TELEMETRY_ENCODED_MAX_SIZE];
+  uint16_t length;
+  bool overflow;
+  bool synchronized;
+  uint8_t next_sequence;
+  uint32_t frames_ok;
+  uint32_t frames_error;
+  uint32_t frames_lost;
+} telemetry_decoder_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+void telemetry_init(void);
+uint8_t telemetry_send(uint8_t type, const uint8_t* payload, uint16_t length);
+
+uint16_t telemetry_encode(uint8_t sequence, uint8_t type, const uint8_t* payload, uint16_t length, uint8_t* frame);
+
+void telemetry_decoder_init(telemetry_decoder_t* decoder);
+uint8_t telemetry_decoder_push(telemetry_decoder_t* decoder, uint8_t data, telemetry_frame_t* frame);
+
+uint32_t telemetry_crc32(const uint8_t* data, uint16_t length);
+
+/*--------------------------------variables-----------------------------------*/
+/*----------------------------------public------------------------------------*/
+/*---------------------------------private------------------------------------*/
+/*--------------------------------interrupts----------------------------------*/
+
+#endif /* TELEMETRY_H_ */
@@ -0,0 +1,308 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*--------------------------------includes------------------------------------*/
+
+#if defined(__MSP432P401R__) && !defined(HOST_SIMULATION)
+#include "driverlib.h"
+#endif
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "tickless.h"
+#include "debounce.h"
+
+/*---------------------------------defines------------------------------------*/
+
+// The simulation and the host keep the tick, only the accounting builds there
+#if defined(__MSP432P401R__) && !defined(HOST_SIMULATION)
+#define TICKLESS_HARDWARE
+#endif
+
+// CCR0 of TA1 paces the debouncer, CCR1 is free
+#define TICKLESS_TIMER_REGS         ( TIMER_A1 )
+#define TICKLESS_CCR                ( 1 )
+
+#define TICKLESS_MAX_TICKS          ( ((uint32_t) TICKLESS_MAX_COUNTS * configTICK_RATE_HZ) / TICKLESS_TIMER_HZ )
+
+/*---------------------------------typedefs-----------------------------------*/
+/*--------------------------------prototypes----------------------------------*/
+
+#if defined(TICKLESS_HARDWARE)
+static uint16_t tickless_read_counter(void);
+#endif
+
+static void tickless_put(uint8_t* payload, uint16_t offset, uint32_t value);
+
+/*--------------------------------variables-----------------------------------*/
+
+static volatile bool tickless_ready = false;
+
+static tickless_stats_t tickless_stats;
+
+/*----------------------------------public------------------------------------*/
+
+void tickless_init(void)
+{
+  /* The debouncer owns TA1, start it if the buttons did not */
+  debounce_init();
+
+#if defined(TICKLESS_HARDWARE)
+  TICKLESS_TIMER_REGS->CCTL[TICKLESS_CCR] = 0;
+#endif
+
+  tickless_ready = true;
+}
+
+void tickless_get_stats(tickless_stats_t* stats)
+{
+  taskENTER_CRITICAL();
+  *stats = tickless_stats;
+  taskEXIT_CRITICAL();
+}
+
+uint16_t tickless_encode(const tickless_stats_t* stats, uint32_t ticks, uint8_t* payload, uint16_t size)
+{
+  if (size < TICKLESS_PAYLOAD_SIZE)
+  {
+    return 0;
+  }
+
+  tickless_put(payload, 0, stats->sleeps);
+  tickless_put(payload, 4, stats->timer_wakeups);
+  tickless_put(payload, 8, stats->early_wakeups);
+  tickless_put(payload, 12, stats->aborted);
+  tickless_put(payload, 16, stats->ticks_suppressed);
+  tickless_put(payload, 20, ticks);
+
+  return TICKLESS_PAYLOAD_SIZE;
+}
+
+uint32_t tickless_sleep_counts(uint32_t cycles_to_tick, uint32_t cycles_per_tick, uint32_t expected, uint32_t mclk_hz)
+{
+  uint64_t cycles = cycles_to_tick + (uint64_t)(expected - 1) * cycles_per_tick;
+  uint64_t counts = (cycles * TICKLESS_TIMER_HZ) / mclk_hz;
+
+  return (counts > TICKLESS_MAX_COUNTS) ? TICKLESS_MAX_COUNTS : (uint32_t) counts;
+}
+
+uint32_t tickless_elapsed(uint32_t slept, bool on_edge, uint32_t mclk_hz)
+{
+  uint64_t half_counts = 2 * (uint64_t) slept;
+
+  if ((on_edge == true) && (half_counts != 0))
+  {
+    half_counts--;
+  }
+
+  return (uint32_t)((half_counts * mclk_hz) / (2 * TICKLESS_TIMER_HZ));
+}
+
+/*
+ * When the compare woke the core the tick that unblocks a task is still to
+ * come, SysTick raises it at once so that the kernel switches to the task
+ */
+void tickless_account(uint32_t cycles_to_tick, uint32_t cycles_per_tick, uint32_t elapsed,
+                      uint32_t expected, tickless_account_t* account)
+{
+  uint32_t extra;
+
+  if (elapsed < cycles_to_tick)
+  {
+    account->steps = 0;
+    account->reload = cycles_to_tick - elapsed;
+  }
+  else
+  {
+    extra = elapsed - cycles_to_tick;
+    account->steps = 1 + extra / cycles_per_tick;
+    account->reload = cycles_per_tick - (extra % cycles_per_tick);
+
+    if (account->steps >= expected)
+    {
+      account->steps = expected - 1;
+      account->reload = TICKLESS_RELOAD_MIN;
+    }
+  }
+
+  if (account->reload < TICKLESS_RELOAD_MIN)
+  {
+    account->reload = TICKLESS_RELOAD_MIN;
+  }
+}
+
+#if defined(TICKLESS_HARDWARE) && (configUSE_TICKLESS_IDLE == 2)
+
+/*
+ * Called by the idle task with the scheduler suspended when no task is ready
+ * for at least configEXPECTED_IDLE_TIME_BEFORE_SLEEP ticks
+ */
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime)
+{
+  tickless_account_t account;
+  uint32_t cycles_per_tick;
+  uint32_t cycles_to_tick;
+  uint32_t mclk_hz;
+  uint32_t elapsed;
+  uint16_t start;
+  uint16_t slept;
+  TickType_t expected;
+  bool timer_woke;
+  bool on_edge;
+
+  /* Without the time base, sleep until the next interrupt or tick */
+  if (tickless_ready == false)
+  {
+    __DSB();
+    __WFI();
+    __ISB();
+    return;
+  }
+
+  if (xExpectedIdleTime > TICKLESS_MAX_TICKS)
+  {
+    xExpectedIdleTime = TICKLESS_MAX_TICKS;
+  }
+
+  /* Interrupts still wake the core while masked, they run after the accounting */
+  __disable_irq();
+  __DSB();
+  __ISB();
+
+  SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+  cycles_per_tick = SysTick->LOAD + 1;
+
+  /* A task became ready meanwhile, finish the tick in progress */
+  if (eTaskConfirmSleepModeStatus() == eAbortSleep)
+  {
+    SysTick->LOAD = SysTick->VAL;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    SysTick->LOAD = cycles_per_tick - 1;
+
+    tickless_stats.aborted++;
+
+    __enable_irq();
+    return;
+  }
+
+  /* At 0 the tick interrupt is pending and SysTick reloads a whole period */
+  cycles_to_tick = (SysTick->VAL != 0) ? SysTick->VAL : cycles_per_tick;
+  mclk_hz = cycles_per_tick * configTICK_RATE_HZ;
+
+  start = tickless_read_counter();
+  TICKLESS_TIMER_REGS->CCR[TICKLESS_CCR] = start + tickless_sleep_counts(cycles_to_tick, cycles_per_tick,
+                                                                         xExpectedIdleTime, mclk_hz);
+  TICKLESS_TIMER_REGS->CCTL[TICKLESS_CCR] = TIMER_A_CCTLN_CCIE;
+
+  expected = xExpectedIdleTime;
+  configPRE_SLEEP_PROCESSING(expected);
+  __DSB();
+  __WFI();
+  __ISB();
+  configPOST_SLEEP_PROCESSING(expected);
+
+  timer_woke = ((TICKLESS_TIMER_REGS->CCTL[TICKLESS_CCR] & TIMER_A_CCTLN_CCIFG) != 0);
+  on_edge = (timer_woke == true) || ((TICKLESS_TIMER_REGS->CTL & TIMER_A_CTL_IFG) != 0);
+  TICKLESS_TIMER_REGS->CCTL[TICKLESS_CCR] = 0;
+
+  slept = tickless_read_counter() - start;
+  elapsed = tickless_elapsed(slept, on_edge, mclk_hz);
+
+  tickless_account(cycles_to_tick, cycles_per_tick, elapsed, xExpectedIdleTime, &account);
+
+  /* Restart from the end of the tick in progress, then whole periods */
+  SysTick->LOAD = account.reload - 1;
+  SysTick->VAL = 0;
+  SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+  SysTick->LOAD = cycles_per_tick - 1;
+
+  vTaskStepTick(account.steps);
+
+  tickless_stats.sleeps++;
+  tickless_stats.ticks_suppressed += account.steps;
+  if (timer_woke == true)
+  {
+    tickless_stats.timer_wakeups++;
+  }
+  else
+  {
+    tickless_stats.early_wakeups++;
+  }
+
+  __enable_irq();
+}
+
+/*
+ * Only LPM0 is supported, the core sleeps with SLEEPDEEP clear. LPM3 would
+ * stop MCLK and SMCLK, and with them both Timer32 (the timing wheel, the
+ * heartbeat, the run-time stats, the accelerometer), the UART, Timer_A0, A2,
+ * A3 and the ADC, which the application keeps running while its tasks are
+ * blocked.
+ */
+void vPreSleepProcessing(uint32_t ulExpectedIdleTime)
+{
+  (void) ulExpectedIdleTime;
+
+  SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+}
+
+#endif
+
+/*---------------------------------private------------------------------------*/
+
+#if defined(TICKLESS_HARDWARE)
+// ACLK is asynchronous to MCLK, read until two values agree
+static uint16_t tickless_read_counter(void)
+{
+  uint16_t counter;
+
+  do
+  {
+    counter = TICKLESS_TIMER_REGS->R;
+  } while (counter != TICKLESS_TIMER_REGS->R);
+
+  return counter;
+}
+#endif
+
+static void tickless_put(uint8_t* payload, uint16_t offset, uint32_t value)
+{
+  payload[offset + 0] = (uint8_t)(value >> 0);
+  payload[offset + 1] = (uint8_t)(value >> 8);
+  payload[offset + 2] = (uint8_t)(value >> 16);
+  payload[offset + 3] = (uint8_t)(value >> 24);
+}
+
+/*--------------------------------interrupts----------------------------------*/
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2017 Universitat Oberta de Catalunya - http://www.uoc.edu/
+ *
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the
+ *    distribution.
+ *
+ *    Neither the name of Universitat Oberta de Catalunya nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef TICKLESS_H_
+#define TICKLESS_H_
+
+/*--------------------------------includes------------------------------------*/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*---------------------------------defines------------------------------------*/
+
+/*
+ * While every task is blocked the idle task stops SysTick and sleeps in LPM0
+ * until the next task has to run, woken by a compare of TA1, which counts ACLK
+ * for debounce.c. On waking, by the compare or by any
+ * other interrupt, the ticks that went by are added to the kernel at once and
+ * SysTick restarts where the tick in progress ends.
+ */
+#define TICKLESS_TIMER_HZ           ( 32768 )
+
+/* TA1 is 16 bits and wraps every 2 s, the wake-up must be less than that away */
+#define TICKLESS_MAX_COUNTS         ( 0xFF00 )
+
+/* Shortest SysTick reload, in MCLK cycles, when a tick is already overdue */
+#define TICKLESS_RELOAD_MIN         ( 32 )
+
+/*
+ * Payload of tickless_encode() (all fields little endian, 4 bytes each):
+ *
+ *   | sleeps | timer_wakeups | early_wakeups | aborted | ticks_suppressed |
+ *   | ticks |
+ *
+ * ticks is the tick count when encoded, so ticks - ticks_suppressed SysTick
+ * interrupts ran.
+ */
+#define TICKLESS_PAYLOAD_SIZE       ( 24 )
+
+/*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  uint32_t sleeps;            // times the idle task slept without the tick
+  uint32_t timer_wakeups;     // woken by the TA1 compare
+  uint32_t early_wakeups;     // woken by another interrupt first
+  uint32_t aborted;           // a task became ready before the sleep
+  uint32_t ticks_suppressed;  // ticks added on waking instead of by SysTick
+} tickless_stats_t;
+
+/* What to do with the kernel and SysTick after sleeping, see tickless_account() */
+typedef struct
+{
+  uint32_t steps;             // ticks to add with vTaskStepTick()
+  uint32_t reload;            // MCLK cycles to the end of the tick in progress
+} tickless_account_t;
+
+/*--------------------------------prototypes----------------------------------*/
+
+/*
+ * Starts the TA1 time base. Until then the idle task sleeps with the tick
+ * running.
+ */
+void tickless_init(void);
+
+void tickless_get_stats(tickless_stats_t* stats);
+uint16_t tickless_encode(const tickless_stats_t* stats, uint32_t ticks, uint8_t* payload, uint16_t size);
+
+/*
+ * ACLK counts to sleep from cycles_to_tick MCLK cycles before the next tick
+ * until expected ticks later, rounded down so that the last tick comes from
+ * SysTick.
+ */
+uint32_t tickless_sleep_counts(uint32_t cycles_to_tick, uint32_t cycles_per_tick, uint32_t expected, uint32_t mclk_hz);
+
+/*
+ * MCLK cycles in slept ACLK counts. The counter is read at a random phase of
+ * ACLK before sleeping, but the compare and the overflow of TA1 wake the core
+ * on an edge, so half a count is taken off then not to run the kernel time
+ * ahead.
+ */
+uint32_t tickless_elapsed(uint32_t slept, bool on_edge, uint32_t mclk_hz);
+
+/*
+ * Splits elapsed MCLK cycles slept, from cycles_to_tick before the next tick,
+ * in whole ticks, never more than expected - 1, and the reload that ends the
+ * tick in progress.
+ */
+void tickless_account(uint32_t cycles_to_tick, uint32_t cycles_per_tick, uint32_t elapsed,
+                      uint32_t expected, tickless_account_t* account);
+
+/*--------------------------------variables-----------------------------------*/
+/*----------------------------------public------------------------------------*/
+/*---------------------------------private------------------------------------*/
+/*--------------------------------interrupts----------------------------------*/
+
+#endif /* TICKLESS_H_ */
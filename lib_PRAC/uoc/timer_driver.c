@@ -39,68 +39,485 @@
 #include "driverlib.h"
 
 #include "timer_driver.h"
+#include "interrupts.h"
+#include "kernel_trace.h"
+
+#include "FreeRTOSConfig.h"
 
 /*---------------------------------defines------------------------------------*/
 
-#define TIMER_BASE            ( TIMER_A2_BASE )
-#define TIMER_MODE            ( TIMER_A_UP_MODE )
-#define TIMER_REGISTER        ( TIMER_A_CAPTURECOMPARE_REGISTER_0 )
-#define TIMER_INTERRUPT       ( INT_TA2_0 )
-#define TIMER_IRQ_HANDLER     ( TA2_0_IRQHandler )
-#define TIMER_PERIOD          ( 32768 )
+// Timer_A2 drives the BoosterPack blue LED, so the timers run on Timer32 0
+#define TIMER_BASE            ( TIMER32_0_BASE )
+#define TIMER_REGS            ( TIMER32_1 )
+#define TIMER_INTERRUPT       ( INT_T32_INT1 )
+
+// Counts shorter than this are not reprogrammed, the interrupt is too close
+#define TIMER_MIN_TICKS       ( 64 )
+
+#define TIMER_WHEEL_MASK      ( TIMER_WHEEL_SLOTS - 1 )
+
+// Level of a timer: the highest digit where its expiry differs from now
+#define TIMER_LEVEL(diff)     ( (31 - __CLZ(diff)) / TIMER_WHEEL_BITS )
+#define TIMER_LOWEST_BIT(x)   ( 31 - __CLZ((x) & (0u - (x))) )
 
 /*---------------------------------typedefs-----------------------------------*/
 /*--------------------------------prototypes----------------------------------*/
+
+static uint64_t timer_ticks(void);
+static void timer_insert(timer_entry_t* timer);
+static void timer_unlink(timer_entry_t* timer);
+static bool timer_next_slot(uint8_t* level, uint8_t* slot, uint32_t* start);
+static void timer_process(uint32_t now);
+static void timer_program(uint32_t now);
+static void timer_reload(uint32_t load);
+
 /*--------------------------------variables-----------------------------------*/
 
-// Timer_A UpMode Configuration
-static Timer_A_UpModeConfig timer_config =
-{
-  TIMER_A_CLOCKSOURCE_ACLK,           // ACLK source = 32.768 kHz
-  TIMER_A_CLOCKSOURCE_DIVIDER_64,     // ACLK/64 = 512 Hz = 1.95 ms
-  TIMER_PERIOD,                       // 1 seconds
-  TIMER_A_TAIE_INTERRUPT_DISABLE,     // Disable Timer interrupt
-  TIMER_A_CCIE_CCR0_INTERRUPT_ENABLE, // Enable CCR0 interrupt
-  TIMER_A_DO_CLEAR                    // Clear value
-};
+/*
+ * Hierarchical timing wheel. A timer is filed at the level of the highest
+ * digit (TIMER_WHEEL_BITS wide) where its expiry differs from timer_wheel_now,
+ * in the slot of that digit, so every level fires before the ones above it.
+ * A slot of level 0 holds timers expiring at one microsecond. When the start
+ * of a slot of a higher level is reached its timers are filed again and fall
+ * to lower levels. Insert and cancel are O(1) and the next deadline is found
+ * from the occupancy bitmaps, so the hardware timer only interrupts then.
+ */
+static timer_entry_t* timer_wheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+static uint16_t timer_occupied[TIMER_WHEEL_LEVELS];
+static uint8_t timer_levels_occupied = 0;
+static uint32_t timer_wheel_now = 0;
+
+// Ticks counted before the current Timer32 load, and that load
+static uint64_t timer_base_ticks = 0;
+static uint32_t timer_load;
+static uint32_t timer_ticks_per_us;
+static uint32_t timer_max_sleep_us;
 
-static callback_t timer_callback;
+// Time of the programmed interrupt
+static uint32_t timer_deadline;
+
+// Backs the single periodic timer of timer_init()
+static timer_entry_t timer_legacy;
+
+static bool timer_initialized = false;
 
 /*----------------------------------public------------------------------------*/
 
-void timer_init(uint32_t period_ms, callback_t callback)
+void timer_driver_init(void)
 {
-  /* Store timer callback */
-  timer_callback = callback;
+  if (timer_initialized == true)
+  {
+    return;
+  }
 
-  /* Set the timer period (maximum = 127 s) */
-  timer_config.timerPeriod = period_ms / 1.95;
+  /* Timer32 counts MCLK down and reloads, the load is the time to the next deadline */
+  timer_ticks_per_us = MAP_CS_getMCLK() / 1000000;
+  timer_max_sleep_us = 0xFFFFFFFF / timer_ticks_per_us;
+  timer_load = timer_max_sleep_us * timer_ticks_per_us;
+  timer_deadline = timer_max_sleep_us;
 
-  /* Configure timer in up mode */
-  MAP_Timer_A_configureUpMode(TIMER_BASE, &timer_config);
+  MAP_Timer32_initModule(TIMER_BASE, TIMER32_PRESCALER_1, TIMER32_32BIT, TIMER32_PERIODIC_MODE);
+  MAP_Timer32_setCount(TIMER_BASE, timer_load);
+  MAP_Timer32_clearInterruptFlag(TIMER_BASE);
+  MAP_Timer32_enableInterrupt(TIMER_BASE);
 
-  /* Enable timer interrupt */
+  MAP_Interrupt_setPriority(TIMER_INTERRUPT, configMAX_SYSCALL_INTERRUPT_PRIORITY);
   MAP_Interrupt_enableInterrupt(TIMER_INTERRUPT);
 
-  /* Enable master interrupt */
-  MAP_Interrupt_enableMaster();
+  MAP_Timer32_startTimer(TIMER_BASE, false);
+
+  timer_initialized = true;
+}
+
+/*
+ * Calls callback from the timer interrupt delay_us from now and then every
+ * period_us, or only once if period_us is 0. A running timer is restarted.
+ * Can be called from tasks, interrupts and timer callbacks.
+ */
+void timer_start(timer_entry_t* timer, uint32_t delay_us, uint32_t period_us, callback_t callback)
+{
+  uint32_t irq_status;
+  uint32_t now;
+
+  if (delay_us > TIMER_MAX_DELAY_US)
+  {
+    delay_us = TIMER_MAX_DELAY_US;
+  }
+  if (period_us > TIMER_MAX_DELAY_US)
+  {
+    period_us = TIMER_MAX_DELAY_US;
+  }
+
+  irq_status = interrupts_disable();
+
+  timer_unlink(timer);
+
+  now = timer_now_us();
+  timer->expires = now + delay_us;
+  timer->period_us = period_us;
+  timer->callback = callback;
+  timer_insert(timer);
+
+  /* Bring the interrupt forward if this timer is the first one */
+  if ((int32_t)(timer->expires - timer_deadline) < 0)
+  {
+    timer_program(now);
+  }
+
+  interrupts_restore(irq_status);
+}
+
+/*
+ * Starts timer again delay_us after its last expiry rather than after now,
+ * with the same period and callback, so that a callback chaining one-shot
+ * steps does not add the interrupt latency to every step. A deadline that
+ * is already past is skipped and counted from now, as for periodic timers.
+ */
+void timer_restart(timer_entry_t* timer, uint32_t delay_us)
+{
+  uint32_t irq_status;
+  uint32_t now;
+
+  if (delay_us > TIMER_MAX_DELAY_US)
+  {
+    delay_us = TIMER_MAX_DELAY_US;
+  }
+
+  irq_status = interrupts_disable();
+
+  timer_unlink(timer);
+
+  now = timer_now_us();
+  timer->expires += delay_us;
+  if ((int32_t)(timer->expires - now) <= 0)
+  {
+    timer->expires = now + delay_us;
+  }
+  timer_insert(timer);
+
+  if ((int32_t)(timer->expires - timer_deadline) < 0)
+  {
+    timer_program(now);
+  }
+
+  interrupts_restore(irq_status);
+}
+
+// Stops a timer, its callback is not called anymore. The hardware deadline
+// is left as it is, an early interrupt only finds nothing to do
+void timer_cancel(timer_entry_t* timer)
+{
+  uint32_t irq_status;
+
+  irq_status = interrupts_disable();
+  timer_unlink(timer);
+  interrupts_restore(irq_status);
+}
+
+bool timer_is_active(const timer_entry_t* timer)
+{
+  return (timer->pprev != NULL);
+}
+
+// Microseconds since timer_driver_init(), wraps every 71 minutes
+uint32_t timer_now_us(void)
+{
+  uint32_t irq_status;
+  uint64_t ticks;
+
+  irq_status = interrupts_disable();
+  ticks = timer_ticks();
+  interrupts_restore(irq_status);
+
+  return (uint32_t)(ticks / timer_ticks_per_us);
+}
+
+// MCLK cycles since timer_driver_init(), without the division of timer_now_us()
+uint64_t timer_now_ticks(void)
+{
+  uint32_t irq_status;
+  uint64_t ticks;
+
+  irq_status = interrupts_disable();
+  ticks = timer_ticks();
+  interrupts_restore(irq_status);
+
+  return ticks;
+}
+
+// Single periodic callback, kept on top of the timing wheel
+void timer_init(uint32_t period_ms, callback_t callback)
+{
+  timer_driver_init();
+  timer_start(&timer_legacy, period_ms * 1000, period_ms * 1000, callback);
+}
 
-  /* Let timer start counting */
-  MAP_Timer_A_startCounter(TIMER_BASE, TIMER_MODE);
+void timer_stop(void)
+{
+  timer_cancel(&timer_legacy);
 }
 
 /*---------------------------------private------------------------------------*/
 
-/*--------------------------------interrupts----------------------------------*/
+// Ticks since timer_driver_init(). Interrupts must be disabled
+static uint64_t timer_ticks(void)
+{
+  uint64_t base;
+  uint32_t value;
 
-void TA2_0_IRQHandler(void)
+  value = TIMER_REGS->VALUE;
+  base = timer_base_ticks;
+
+  /* Reloaded but the interrupt did not account for it yet */
+  if ((TIMER_REGS->RIS & TIMER32_RIS_RAW_IFG) != 0)
+  {
+    value = TIMER_REGS->VALUE;
+    base += timer_load;
+  }
+
+  /* The counter stays at zero until the tick that reloads it */
+  if (value == 0)
+  {
+    value = timer_load;
+  }
+
+  return base + (timer_load - value);
+}
+
+// Files timer relative to timer_wheel_now. Interrupts must be disabled
+static void timer_insert(timer_entry_t* timer)
+{
+  timer_entry_t** head;
+  uint32_t diff;
+  uint8_t level;
+  uint8_t slot;
+
+  /* Already due, fire at the next chance */
+  if ((int32_t)(timer->expires - timer_wheel_now) < 0)
+  {
+    timer->expires = timer_wheel_now;
+  }
+
+  diff = timer->expires ^ timer_wheel_now;
+  level = (diff != 0) ? TIMER_LEVEL(diff) : 0;
+  slot = (timer->expires >> (level * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK;
+
+  head = &timer_wheel[level][slot];
+  timer->next = *head;
+  if (timer->next != NULL)
+  {
+    timer->next->pprev = &timer->next;
+  }
+  *head = timer;
+  timer->pprev = head;
+
+  timer_occupied[level] |= (1u << slot);
+  timer_levels_occupied |= (1u << level);
+}
+
+// Removes timer from its list, if any. Interrupts must be disabled
+static void timer_unlink(timer_entry_t* timer)
+{
+  timer_entry_t** pprev = timer->pprev;
+  uint32_t index;
+
+  if (pprev == NULL)
+  {
+    return;
+  }
+
+  *pprev = timer->next;
+  if (timer->next != NULL)
+  {
+    timer->next->pprev = pprev;
+  }
+  timer->pprev = NULL;
+
+  /* The timer was the last one of a wheel slot */
+  if ((*pprev == NULL) &&
+      (pprev >= &timer_wheel[0][0]) && (pprev < &timer_wheel[0][0] + TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS))
+  {
+    index = pprev - &timer_wheel[0][0];
+    timer_occupied[index / TIMER_WHEEL_SLOTS] &= ~(1u << (index % TIMER_WHEEL_SLOTS));
+    if (timer_occupied[index / TIMER_WHEEL_SLOTS] == 0)
+    {
+      timer_levels_occupied &= ~(1u << (index / TIMER_WHEEL_SLOTS));
+    }
+  }
+}
+
+// Finds the first occupied slot and the time it starts at
+static bool timer_next_slot(uint8_t* level, uint8_t* slot, uint32_t* start)
 {
-  /* Clear timer interrupt */
-  MAP_Timer_A_clearCaptureCompareInterrupt(TIMER_BASE, TIMER_A_CAPTURECOMPARE_REGISTER_0);
+  uint32_t occupied;
+  uint32_t later;
+  uint8_t shift;
+  uint8_t current;
+
+  if (timer_levels_occupied == 0)
+  {
+    return false;
+  }
 
-  /* Execute timer callback */
-  if (timer_callback != NULL)
+  /* Lower levels always expire first */
+  *level = TIMER_LOWEST_BIT(timer_levels_occupied);
+  shift = *level * TIMER_WHEEL_BITS;
+  current = (timer_wheel_now >> shift) & TIMER_WHEEL_MASK;
+
+  /* Only the top level wraps around, below it every slot is ahead of now */
+  occupied = timer_occupied[*level];
+  later = occupied & (0xFFFFu << current) & 0xFFFF;
+  *slot = TIMER_LOWEST_BIT((later != 0) ? later : occupied);
+
+  if (shift + TIMER_WHEEL_BITS >= 32)
   {
-    timer_callback();
+    *start = (uint32_t)*slot << shift;
   }
+  else
+  {
+    *start = (timer_wheel_now & ~((1u << (shift + TIMER_WHEEL_BITS)) - 1)) | ((uint32_t)*slot << shift);
+  }
+
+  return true;
+}
+
+// Fires every timer due at now. Called from the timer interrupt with
+// interrupts disabled, they are enabled while the callbacks run
+static void timer_process(uint32_t now)
+{
+  timer_entry_t* pending;
+  timer_entry_t* timer;
+  uint32_t start;
+  uint8_t level;
+  uint8_t slot;
+
+  while (timer_next_slot(&level, &slot, &start) == true)
+  {
+    if ((int32_t)(start - now) > 0)
+    {
+      break;
+    }
+
+    timer_wheel_now = start;
+
+    /* Take the whole slot, callbacks may still cancel timers in it */
+    pending = timer_wheel[level][slot];
+    timer_wheel[level][slot] = NULL;
+    pending->pprev = &pending;
+    timer_occupied[level] &= ~(1u << slot);
+    if (timer_occupied[level] == 0)
+    {
+      timer_levels_occupied &= ~(1u << level);
+    }
+
+    while ((timer = pending) != NULL)
+    {
+      timer_unlink(timer);
+
+      if (level > 0)
+      {
+        /* Cascade to a lower level */
+        timer_insert(timer);
+        continue;
+      }
+
+      if (timer->period_us != 0)
+      {
+        /* Keep the period, but skip the ones already missed */
+        timer->expires += timer->period_us;
+        if ((int32_t)(timer->expires - now) <= 0)
+        {
+          timer->expires = now + timer->period_us;
+        }
+        timer_insert(timer);
+      }
+
+      if (timer->callback != NULL)
+      {
+        __enable_irq();
+        timer->callback();
+        __disable_irq();
+      }
+    }
+  }
+
+  /* Nothing is due before now, filing against it keeps the levels low */
+  if ((int32_t)(now - timer_wheel_now) > 0)
+  {
+    timer_wheel_now = now;
+  }
+}
+
+// Reloads Timer32 with the time to the next deadline. Interrupts must be disabled
+static void timer_program(uint32_t now)
+{
+  uint32_t delay = timer_max_sleep_us;
+  uint32_t start;
+  uint8_t level;
+  uint8_t slot;
+
+  if (timer_next_slot(&level, &slot, &start) == true)
+  {
+    delay = ((int32_t)(start - now) > 0) ? (start - now) : 0;
+    if (delay > timer_max_sleep_us)
+    {
+      delay = timer_max_sleep_us;
+    }
+  }
+
+  timer_deadline = now + delay;
+
+  delay *= timer_ticks_per_us;
+  timer_reload((delay < TIMER_MIN_TICKS) ? TIMER_MIN_TICKS : delay);
+}
+
+// Restarts the count from load. Interrupts must be disabled
+static void timer_reload(uint32_t load)
+{
+  uint32_t value;
+
+  value = TIMER_REGS->VALUE;
+
+  /* Too close to the reload to change it safely, the interrupt reprograms it */
+  if (((TIMER_REGS->RIS & TIMER32_RIS_RAW_IFG) != 0) || (value < TIMER_MIN_TICKS))
+  {
+    return;
+  }
+
+  /* Writing the load restarts the count, the ticks elapsed so far are kept */
+  timer_base_ticks += timer_load - value;
+  timer_load = load;
+  TIMER_REGS->LOAD = timer_load;
+}
+
+/*--------------------------------interrupts----------------------------------*/
+
+void T32_INT1_IRQHandler(void)
+{
+  uint32_t irq_status;
+  uint32_t now;
+
+  KERNEL_TRACE_ISR_ENTER(INT_T32_INT1);
+
+  irq_status = interrupts_disable();
+
+  /* The counter reloaded with the same load and keeps counting */
+  TIMER_REGS->INTCLR = 0;
+  timer_base_ticks += timer_load;
+
+  /*
+   * Only one reload is seen per interrupt, and a short load would reload
+   * again while the callbacks run, so count from the longest one meanwhile
+   */
+  timer_reload(timer_max_sleep_us * timer_ticks_per_us);
+
+  now = (uint32_t)(timer_ticks() / timer_ticks_per_us);
+  timer_process(now);
+
+  /* Callbacks took time, program from the current time */
+  timer_program(timer_now_us());
+
+  interrupts_restore(irq_status);
+
+  KERNEL_TRACE_ISR_EXIT(INT_T32_INT1);
 }
@@ -43,11 +43,39 @@
 #include "callback.h"
 
 /*---------------------------------defines------------------------------------*/
+
+/* Timing wheel: 8 levels of 16 slots cover the 32 bit microsecond time */
+#define TIMER_WHEEL_BITS        ( 4 )
+#define TIMER_WHEEL_SLOTS       ( 1 << TIMER_WHEEL_BITS )
+#define TIMER_WHEEL_LEVELS      ( 32 / TIMER_WHEEL_BITS )
+
+/* Delays and periods must stay below 2^31 us (about 35 minutes) */
+#define TIMER_MAX_DELAY_US      ( 0x7FFFFFFF )
+
 /*---------------------------------typedefs-----------------------------------*/
 
+/* Owned by the caller, the driver only links it while it is running */
+typedef struct timer_entry
+{
+  struct timer_entry* next;
+  struct timer_entry** pprev;
+  uint32_t expires;
+  uint32_t period_us;     // 0 for one-shot timers
+  callback_t callback;
+} timer_entry_t;
+
 /*--------------------------------prototypes----------------------------------*/
 
+void timer_driver_init(void);
+void timer_start(timer_entry_t* timer, uint32_t delay_us, uint32_t period_us, callback_t callback);
+void timer_restart(timer_entry_t* timer, uint32_t delay_us);
+void timer_cancel(timer_entry_t* timer);
+bool timer_is_active(const timer_entry_t* timer);
+uint32_t timer_now_us(void);
+uint64_t timer_now_ticks(void);
+
 void timer_init(uint32_t period_ms, callback_t callback);
+void timer_stop(void);
 
 /*--------------------------------variables-----------------------------------*/
 /*----------------------------------public------------------------------------*/
@@ -56,16 +56,43 @@
 
 #define TX_BUFFER_RETRY_COUNT       ( 10 )
 
+#define UART_BAUDRATE               ( 57600 )
+
+#define UART_OVERSAMPLING_MIN_N     ( 16 )
+#define UART_LOW_FREQUENCY_MIN_N    ( 3 )
+#define UART_FRACTION_SCALE         ( 10000 )
+
+/*
+ * Worst drift of an edge within a character (start, 8 data and stop bits),
+ * in 1/1000 of a bit. The receiver samples each bit in its middle, and the
+ * other end drifts too, so rates off by more than 5% are refused.
+ */
+#define UART_CHARACTER_BITS         ( 10 )
+#define UART_EDGE_ERROR_MAX         ( 50 )
+
 /*---------------------------------typedefs-----------------------------------*/
+
+typedef struct
+{
+  uint16_t fraction;
+  uint8_t brs;
+} uart_brs_t;
+
 /*--------------------------------prototypes----------------------------------*/
+
+static uint8_t uart_compute_config(uint32_t clock, uint32_t baudrate, eUSCI_UART_Config* config);
+static uint8_t uart_lookup_brs(uint32_t clock, uint32_t baudrate);
+static uint32_t uart_edge_error(uint32_t clock, uint32_t baudrate, const eUSCI_UART_Config* config);
+
 /*--------------------------------variables-----------------------------------*/
 
-static const eUSCI_UART_Config uart_config =
+// Divider fields are computed at runtime from SMCLK, see uart_set_baudrate
+static eUSCI_UART_Config uart_config =
 {
   EUSCI_A_UART_CLOCKSOURCE_SMCLK,          // SMCLK Clock Source
-  43,                                      // BRDIV = 78
-  6,                                       // UCxBRF = 2
-  0,                                       // UCxBRS = 0
+  0,                                       // UCxBRW
+  0,                                       // UCxBRF
+  0,                                       // UCxBRS
   EUSCI_A_UART_NO_PARITY,                  // No Parity
   EUSCI_A_UART_LSB_FIRST,                  // LSB First
   EUSCI_A_UART_ONE_STOP_BIT,               // One stop bit
@@ -73,6 +100,22 @@ static const eUSCI_UART_Config uart_config =
   EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION  // Oversampling
 };
 
+// UCBRSx modulation pattern for the fractional part of N = fBRCLK / baudrate
+// (in 1/10000 units), from the eUSCI UART chapter of the MSP432P4xx TRM
+static const uart_brs_t uart_brs_table[] =
+{
+  {   0, 0x00}, { 529, 0x01}, { 715, 0x02}, { 835, 0x04}, {1001, 0x08},
+  {1252, 0x10}, {1430, 0x20}, {1670, 0x11}, {2147, 0x21}, {2224, 0x22},
+  {2503, 0x44}, {3000, 0x25}, {3335, 0x49}, {3575, 0x4A}, {3753, 0x52},
+  {4003, 0x92}, {4286, 0x53}, {4378, 0x55}, {5002, 0xAA}, {5715, 0x6B},
+  {6003, 0xAD}, {6254, 0xB5}, {6432, 0xB6}, {6667, 0xD6}, {7001, 0xB7},
+  {7147, 0xBB}, {7503, 0xDD}, {7861, 0xED}, {8004, 0xEE}, {8333, 0xBF},
+  {8464, 0xDF}, {8572, 0xEF}, {8751, 0xF7}, {9004, 0xFB}, {9170, 0xFD},
+  {9288, 0xFE},
+};
+
+static uint32_t uart_clock;
+
 static uint8_t uart_tx_buffer[UART_BUFFER_TX_SIZE];
 static uint8_t uart_rx_buffer[UART_BUFFER_RX_SIZE];
 
@@ -89,6 +132,8 @@ void uart_init(uart_rx_cb_t callback)
   MAP_GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P1, GPIO_PIN2 | GPIO_PIN3, GPIO_PRIMARY_MODULE_FUNCTION);
 
   /* Initialize UART */
+  uart_clock = MAP_CS_getSMCLK();
+  uart_compute_config(uart_clock, UART_BAUDRATE, &uart_config);
   MAP_UART_initModule(UART_BASE, &uart_config);
 
   /* Enable UART */
@@ -168,15 +213,199 @@ uint8_t uart_print(char* s)
   return 0;
 }
 
+uint8_t uart_write(const uint8_t *data, uint16_t length)
+{
+  uint16_t i;
+
+  /* Unlike uart_print, binary data may contain NULL characters */
+  for (i = 0; i < length; i++)
+  {
+    uint8_t retryCount = 0;
+
+    /* Try to put a byte to the transmit buffer */
+    while (uart_put_char(data[i]) != 0)
+    {
+      retryCount++;
+
+      /* If we have gone above the retries limit */
+      if (retryCount > TX_BUFFER_RETRY_COUNT)
+      {
+        return 1;
+      }
+    }
+  }
+
+  return 0;
+}
+
+uint8_t uart_set_baudrate(uint32_t baudrate)
+{
+  uint32_t clock = MAP_CS_getSMCLK();
+  eUSCI_UART_Config config = uart_config;
+
+  /* Check the baudrate can be generated from the current SMCLK closely
+   * enough to be received, the UART keeps its configuration if it cannot */
+  if (uart_compute_config(clock, baudrate, &config) != 0)
+  {
+    return 1;
+  }
+
+  uart_config = config;
+  uart_clock = clock;
+
+  /* Let the character in the shift register finish */
+  while (MAP_UART_queryStatusFlags(UART_BASE, EUSCI_A_UART_BUSY))
+    ;
+
+  /* Re-initialize UART, this clears the interrupt enables */
+  MAP_UART_initModule(UART_BASE, &uart_config);
+  MAP_UART_enableModule(UART_BASE);
+  MAP_UART_enableInterrupt(UART_BASE, UART_INTERRUPT_RX);
+
+  /* Resume pending transmission at the new baudrate */
+  if (circ_buffer_is_empty(&buffer_tx) == false)
+  {
+    MAP_UART_enableInterrupt(UART_BASE, UART_INTERRUPT_TX);
+  }
+
+  return 0;
+}
+
+uint32_t uart_get_baudrate(void)
+{
+  uint32_t divider;
+  uint8_t brs = uart_config.secondModReg;
+  uint8_t brs_bits = 0;
+
+  /* Each UCBRSx bit set stretches one bit of the character by one BRCLK */
+  while (brs)
+  {
+    brs_bits += brs & 0x01;
+    brs >>= 1;
+  }
+
+  /* Average divider in 1/8 BRCLK units */
+  if (uart_config.overSampling == EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION)
+  {
+    divider = (16 * uart_config.clockPrescalar + uart_config.firstModReg) * 8 + brs_bits;
+  }
+  else
+  {
+    divider = uart_config.clockPrescalar * 8 + brs_bits;
+  }
+
+  return (uint32_t)(((uint64_t)uart_clock * 8 + divider / 2) / divider);
+}
+
 /*---------------------------------private------------------------------------*/
 
+static uint8_t uart_compute_config(uint32_t clock, uint32_t baudrate, eUSCI_UART_Config* config)
+{
+  uint32_t n;
+
+  if (baudrate == 0)
+  {
+    return 1;
+  }
+
+  n = clock / baudrate;
+
+  if (n >= UART_OVERSAMPLING_MIN_N)
+  {
+    /* Oversampling: UCBRx = INT(N/16), UCBRFx = INT((N/16 - INT(N/16)) * 16) */
+    config->overSampling = EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION;
+    config->clockPrescalar = clock / (16 * baudrate);
+    config->firstModReg = (clock % (16 * baudrate)) / baudrate;
+  }
+  else if (n >= UART_LOW_FREQUENCY_MIN_N)
+  {
+    /* Low frequency (needed above fBRCLK / 16): UCBRx = INT(N) */
+    config->overSampling = EUSCI_A_UART_LOW_FREQUENCY_BAUDRATE_GENERATION;
+    config->clockPrescalar = n;
+    config->firstModReg = 0;
+  }
+  else
+  {
+    return 1;
+  }
+
+  if (config->clockPrescalar > 0xFFFF)
+  {
+    return 1;
+  }
+
+  config->secondModReg = uart_lookup_brs(clock, baudrate);
+
+  if (uart_edge_error(clock, baudrate, config) > UART_EDGE_ERROR_MAX)
+  {
+    return 1;
+  }
+
+  return 0;
+}
+
+static uint8_t uart_lookup_brs(uint32_t clock, uint32_t baudrate)
+{
+  uint32_t fraction;
+  uint16_t i;
+
+  /* Fractional part of N, without floating point */
+  fraction = (uint32_t)(((uint64_t)(clock % baudrate) * UART_FRACTION_SCALE) / baudrate);
+
+  /* Take the largest table entry not above the fraction */
+  i = sizeof(uart_brs_table) / sizeof(uart_brs_table[0]) - 1;
+  while (uart_brs_table[i].fraction > fraction)
+  {
+    i--;
+  }
+
+  return uart_brs_table[i].brs;
+}
+
+// Worst distance of an edge of a character from the ideal one, in 1/1000 of a bit
+static uint32_t uart_edge_error(uint32_t clock, uint32_t baudrate, const eUSCI_UART_Config* config)
+{
+  uint64_t cycles = 0;
+  uint64_t actual;
+  uint64_t ideal;
+  uint32_t error;
+  uint32_t error_max = 0;
+  uint8_t bit;
+
+  for (bit = 0; bit < UART_CHARACTER_BITS; bit++)
+  {
+    /* Each bit lasts the divider plus the UCBRSx bit that modulates it */
+    if (config->overSampling == EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION)
+    {
+      cycles += 16 * config->clockPrescalar + config->firstModReg;
+    }
+    else
+    {
+      cycles += config->clockPrescalar;
+    }
+    cycles += (config->secondModReg >> (bit % 8)) & 0x01;
+
+    /* Compared in BRCLK cycles times baudrate, the ideal edge is at (bit + 1) * clock */
+    actual = cycles * baudrate;
+    ideal = (uint64_t)(bit + 1) * clock;
+    error = (uint32_t)((((actual > ideal) ? actual - ideal : ideal - actual) * 1000) / clock);
+    if (error > error_max)
+    {
+      error_max = error;
+    }
+  }
+
+  return error_max;
+}
+
 /*--------------------------------interrupts----------------------------------*/
 
 void EUSCIA0_IRQHandler(void)
 {
-  /* Read and clear UART interrupt status */
+  /* Read and clear UART interrupt status. TXIFG stays set while TXBUF is
+   * empty, writing TXBUF clears it */
   uint32_t status = MAP_UART_getEnabledInterruptStatus(UART_BASE);
-  MAP_UART_clearInterruptFlag(UART_BASE, status);
+  MAP_UART_clearInterruptFlag(UART_BASE, status & ~EUSCI_A_UART_TRANSMIT_INTERRUPT_FLAG);
 
   /* If we have received a character */
   if (status & EUSCI_A_UART_RECEIVE_INTERRUPT_FLAG)
@@ -216,10 +445,8 @@ void EUSCIA0_IRQHandler(void)
     }
     else
     {
-      /* Transmit a new line character */
-      MAP_UART_transmitData(UART_BASE, '\0');
-
-      /* Disable UART transmit interrupt */
+      /* Disable UART transmit interrupt, uart_put_char() enables it again.
+       * A filler byte here would split the zero delimited telemetry frames */
       MAP_UART_disableInterrupt(UART_BASE, UART_INTERRUPT_TX);
     }
   }
@@ -53,6 +53,9 @@ void uart_init(uart_rx_cb_t callback);
 uint8_t uart_put_char(uint8_t data);
 uint8_t uart_get_char(char *data);
 uint8_t uart_print(char *s);
+uint8_t uart_write(const uint8_t *data, uint16_t length);
+uint8_t uart_set_baudrate(uint32_t baudrate);
+uint32_t uart_get_baudrate(void);
 
 /*--------------------------------variables-----------------------------------*/
 /*----------------------------------public------------------------------------*/